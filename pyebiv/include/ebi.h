@@ -15,9 +15,23 @@ namespace EBI {
 	bool CheckDirectoryExistence(const std::string& dirIN);
 	std::string FileBaseName(const std::string& sIN);
 	std::string FileReplaceExtension(const std::string& sIN, const std::string& newExt);
+
+	std::vector<EBI::SampleWindow> FlowSampleWindows(
+		const EBI::EventFlowEvalParams& params,	//!< sample size and grid steps, image size in imgW, imgH
+		const int64_t tStart,		//!< start of first sample in [usec]
+		const int64_t tEnd			//!< no sample extends beyond this time in [usec]
+	);
 	
 	int32_t DetermineOffsetTime(
-		EBI::EventData& evData, 		//!< input data
+		const EBI::EventData& evData, 	//!< input data
+		const double freqInHz,			//!< sampling frequency = light pulsing frequency
+		const int32_t nBinWidthInMicrosec = 5,	//!< in [usec]
+		const int32_t nPeriods = 50,	//!< number of periods to sample
+		const int32_t nStartPeriod = 1,	//!< at which period to begin sampling
+		const int32_t nDebug = 0		//!< enables debugging output
+	);
+	int32_t DetermineOffsetTime(
+		const EBI::EventView& evData, 	//!< input data
 		const double freqInHz,			//!< sampling frequency = light pulsing frequency
 		const int32_t nBinWidthInMicrosec = 5,	//!< in [usec]
 		const int32_t nPeriods = 50,	//!< number of periods to sample
@@ -26,7 +40,15 @@ namespace EBI {
 	);
 
 	std::vector<double> MeanPulseHistogram(
-		EBI::EventData& evData, 		//!< input data
+		const EBI::EventData& evData, 	//!< input data
+		const double freqInHz,			//!< sampling frequency = light pulsing frequency
+		const int32_t nBinWidthInMicrosec = 5,
+		const int32_t nPeriods = 50,	//!< number of periods to sample
+		const int32_t nStartPeriod = 1, //!< at which period to begin sampling
+		const int32_t nDebug = 0		//!< enables debugging output
+	);
+	std::vector<double> MeanPulseHistogram(
+		const EBI::EventView& evData, 	//!< input data
 		const double freqInHz,			//!< sampling frequency = light pulsing frequency
 		const int32_t nBinWidthInMicrosec = 5,
 		const int32_t nPeriods = 50,	//!< number of periods to sample
@@ -0,0 +1,161 @@
+#ifndef _EBI_COLUMNS_H__INCLUDED_
+#define _EBI_COLUMNS_H__INCLUDED_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <string>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "ebi_structs.h"
+#include "ebi_data.h"
+
+namespace EBI {
+
+	/*!
+	Allocator for std::vector with storage aligned to \a Align bytes, so that
+	columns start on a cache line and vector loads never split one.
+	*/
+	template <typename T, size_t Align = 64>
+	struct AlignedAllocator
+	{
+		typedef T value_type;
+		template <typename U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+		AlignedAllocator() noexcept {}
+		template <typename U> AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+		T* allocate(const size_t n)
+		{
+			void* p = nullptr;
+#ifdef _WIN32
+			p = _aligned_malloc(n * sizeof(T), Align);
+#else
+			if (posix_memalign(&p, Align, n * sizeof(T)) != 0)
+				p = nullptr;
+#endif
+			if (p == nullptr)
+				throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+		void deallocate(T* p, const size_t) noexcept
+		{
+#ifdef _WIN32
+			_aligned_free(p);
+#else
+			free(p);
+#endif
+		}
+	};
+	template <typename T, typename U, size_t Align>
+	bool operator==(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) { return true; }
+	template <typename T, typename U, size_t Align>
+	bool operator!=(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) { return false; }
+
+	/*!
+	Event data set stored as structure of arrays: time, x, y and polarity are
+	kept in separate aligned columns. Filters only touch the columns they test
+	and are written as plain loops over the columns that the compiler can vectorize.
+	Times are 32 bits without time segments, loading of RAW files stops at
+	EBI::TIME_SEGMENT_USEC after the first event.
+	Methods have the same meaning as those of EBI::EventData, conversion from
+	and to EBI::EventData is a single pass over the events.
+
+	Usage:
+		EBI::EventColumns evCols;
+		evCols.load("recording.raw");
+		EBI::EventColumns sample;
+		evCols.getSample(sample, 100, 100, 40, 40, 10000, 20000);
+	*/
+	class EventColumns
+	{
+	public:
+		template <typename T> using Column = std::vector<T, EBI::AlignedAllocator<T> >;
+
+		EventColumns();
+		EventColumns(const EBI::EventData& src);
+		~EventColumns();
+
+		// conversion from and to array of EBI::Event
+		bool copyFrom(const EBI::EventData& src);
+		bool copyTo(EBI::EventData& dst) const;
+		void assign(const std::vector<EBI::Event>& events);
+		void toEvents(std::vector<EBI::Event>& events) const;
+
+		bool copyFrom(const EBI::EventColumns& src,
+			const EBI::EventPolarity polMode,
+			const int32_t offsetUSec = 0, const int32_t durationUSec = 0,
+			bool bSubtractOffsetTime = true);
+		bool copyFrom(const EBI::EventColumns& src,
+			const EBI::EventPolarity polMode,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0);
+		bool copyFrom(const EBI::EventColumns& src,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0);
+
+		bool cropROI(const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0);
+		size_t getSample(EBI::EventColumns& sample,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0) const;
+
+		bool load(const std::string& fnameEvents,
+			const EBI::EventFilter& filter = EBI::EventFilter());
+
+		void clear();
+		void reserve(const size_t n);
+		void resize(const size_t n);
+		void append(const EBI::Event* pEvents, const size_t n);
+		void push_back(const EBI::Event& ev) { append(&ev, 1); }
+		size_t size() const { return m_t.size(); }
+		bool empty() const { return m_t.empty(); }
+		//! event \a i assembled from the columns
+		EBI::Event at(const size_t i) const { return EBI::Event(m_x[i], m_y[i], m_p[i], m_t[i]); }
+
+		// direct access to the columns, size() elements each
+		uint32_t* t() { return m_t.data(); }
+		uint16_t* x() { return m_x.data(); }
+		uint16_t* y() { return m_y.data(); }
+		int8_t* p() { return m_p.data(); }
+		const uint32_t* t() const { return m_t.data(); }
+		const uint16_t* x() const { return m_x.data(); }
+		const uint16_t* y() const { return m_y.data(); }
+		const int8_t* p() const { return m_p.data(); }
+
+		std::vector<EBI::TriggerEvent>& triggerRef() { return m_triggerEvents; }
+		int32_t imageWidth() const { return static_cast<int32_t>(m_camSpecs.sensorW); }
+		int32_t imageHeight() const { return static_cast<int32_t>(m_camSpecs.sensorH); }
+		uint64_t timeStamp() const { return m_timeStamp; }
+
+		void setDebugLevel(const int32_t nLevel) { m_nDebugLevel = nLevel; }
+		void setMaximumSize(const uint64_t nMaxSize) { m_maxEvents = nMaxSize; }
+		void setDecodeParams(const EBI::RawDecodeParams& decParams) { m_decodeParams = decParams; }
+		const EBI::EventLoadStats& loadStats() const { return m_loadStats; }
+
+	private:
+		void init();
+
+		Column<uint32_t> m_t;	//!< time in [usec]
+		Column<uint16_t> m_x;	//!< pixel coordinate X
+		Column<uint16_t> m_y;	//!< pixel coordinate Y
+		Column<int8_t> m_p;		//!< polarity [0,1]
+		std::vector<EBI::TriggerEvent> m_triggerEvents;
+		EBI::EventCameraSpecs m_camSpecs;
+		uint64_t m_timeStamp;
+		uint64_t m_maxEvents;
+		int32_t m_nDebugLevel;
+		EBI::RawDecodeParams m_decodeParams;
+		EBI::EventLoadStats m_loadStats;	//!< statistics of last load()
+	};
+} // namespace EBI
+
+#endif /* _EBI_COLUMNS_H__INCLUDED_ */
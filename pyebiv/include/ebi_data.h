@@ -4,10 +4,100 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include "ebi_structs.h"
 
 namespace EBI {
 
+	//! start of the time segment of event \a i in [usec], see EBI::TimeSegment
+	inline uint64_t SegmentBase(const std::vector<EBI::TimeSegment>& segments, const size_t i)
+	{
+		if (segments.empty() || (i < segments[0].iFirst))
+			return 0;
+		auto it = std::upper_bound(segments.begin(), segments.end(), i,
+			[](const size_t n, const EBI::TimeSegment& seg) { return n < seg.iFirst; });
+		return (it - 1)->tBase;
+	}
+
+	/*!
+	Index of event times in buckets of at least one millisecond. For each bucket
+	the index of the first event that may fall into it is stored, so a time window
+	is found by a lookup plus a binary search within one bucket.
+	Each time segment of the events (see EBI::TimeSegment) is indexed separately,
+	a window crossing segments is found by a lookup in the first and the last one.
+	Events are usually sorted in time; if not, range() stays correct but only
+	narrows down to whole buckets, see EventData::timeRange().
+	*/
+	class TimeIndex
+	{
+	public:
+		TimeIndex();
+		void build(const std::vector<EBI::Event>& events,
+			const std::vector<EBI::TimeSegment>& segments = std::vector<EBI::TimeSegment>());
+		void clear();
+		bool isBuilt() const { return m_bBuilt; }
+		bool isSorted() const { return m_bSorted; }
+		size_t size() const { return m_nEvents; }	//!< number of events indexed
+		size_t bucketCount() const { return m_first.size() - m_parts.size(); }
+		size_t segmentCount() const { return m_parts.size(); }	//!< number of time segments holding events
+		uint64_t timeMax() const { return m_parts.empty() ? 0 : m_parts.back().tBase + m_parts.back().tMax; }	//!< latest event
+		void range(const std::vector<EBI::Event>& events, const uint64_t t1, const uint64_t t2,
+			size_t& iFirst, size_t& iEnd) const;
+
+	private:
+		//! buckets of the events of one time segment
+		struct Part
+		{
+			size_t iFirst, iEnd;	//!< events of the segment
+			uint64_t tBase;			//!< start of the segment in [usec]
+			bool bSorted;			//!< times are non-decreasing
+			uint32_t tMin, tMax;	//!< earliest and latest event, relative to tBase
+			uint32_t bucketUSec;	//!< width of buckets in [usec]
+			size_t nBuckets;
+			size_t nFirst0;			//!< position of the buckets of the segment in m_first
+			size_t nEnd0;			//!< position of the buckets of the segment in m_end
+		};
+		void buildPart(const std::vector<EBI::Event>& events, Part& part);
+		void rangePart(const std::vector<EBI::Event>& events, const Part& part,
+			const uint32_t t1, const uint32_t t2, size_t& iFirst, size_t& iEnd) const;
+
+		bool m_bBuilt;
+		size_t m_nEvents;
+		bool m_bSorted;		//!< times are non-decreasing in all segments
+		std::vector<Part> m_parts;	//!< segments holding events, in order
+		std::vector<size_t> m_first;	//!< events before m_first[b] are earlier than bucket b
+		std::vector<size_t> m_end;		//!< events from m_end[b] on are later than bucket b, only for unsorted events
+	};
+
+	/*!
+	Index of events by spatial tile of \a tileSize x \a tileSize pixels. Event numbers
+	are grouped by tile and sorted in time within each tile, so a sub-volume is found
+	by a binary search in each tile overlapping its region.
+	*/
+	class TileIndex
+	{
+	public:
+		TileIndex();
+		void build(const std::vector<EBI::Event>& events, const uint32_t tileSize,
+			const std::vector<EBI::TimeSegment>& segments = std::vector<EBI::TimeSegment>());
+		void clear();
+		bool isBuilt() const { return m_bBuilt; }
+		size_t size() const { return m_nEvents; }	//!< number of events indexed
+		uint32_t tileSize() const { return m_tileSize; }
+		bool select(const std::vector<EBI::Event>& events,
+			const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+			const uint64_t t1, const uint64_t t2, std::vector<uint32_t>& indices) const;
+
+	private:
+		bool m_bBuilt;
+		size_t m_nEvents;
+		uint32_t m_tileSize;
+		std::vector<EBI::TimeSegment> m_segments;	//!< time segments of the events indexed
+		uint32_t m_tilesX, m_tilesY;	//!< number of tiles, 0 if the events are not indexed
+		std::vector<size_t> m_tileFirst;	//!< start of each tile in m_order
+		std::vector<uint32_t> m_order;		//!< event numbers grouped by tile, sorted in time within tile
+	};
+
 	class EventData
 	{
 	public:
@@ -15,61 +105,117 @@ namespace EBI {
 		EventData(const std::string& fnameRawEvents);
 		EventData(const EBI::EventData& src,
 			const EBI::EventPolarity polMode,
-			const int32_t offsetUSec = 0, const int32_t durationUSec = 0,
+			const int64_t offsetUSec = 0, const int32_t durationUSec = 0,
 			bool bSubtractOffsetTime = true);
 		EventData(const EBI::EventData& src,
 			const EBI::EventPolarity polMode,
 			const int32_t x, const int32_t y,
 			const int32_t w, const int32_t h,
-			const int32_t t0 = 0, const int32_t dur = 0);
+			const int64_t t0 = 0, const int32_t dur = 0);
 		EventData(const EBI::EventData& src,
 			const int32_t x, const int32_t y,
 			const int32_t w, const int32_t h,
-			const int32_t t0 = 0, const int32_t dur = 0);
+			const int64_t t0 = 0, const int32_t dur = 0);
+		// int32_t offsets, so that calls with int arguments do not match the ROI overloads instead
+		EventData(const EBI::EventData& src, const EBI::EventPolarity polMode,
+			const int32_t offsetUSec, const int32_t durationUSec, bool bSubtractOffsetTime)
+			: EventData(src, polMode, static_cast<int64_t>(offsetUSec), durationUSec, bSubtractOffsetTime) {}
+		EventData(const EBI::EventData& src, const EBI::EventPolarity polMode,
+			const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+			const int32_t t0, const int32_t dur = 0)
+			: EventData(src, polMode, x, y, w, h, static_cast<int64_t>(t0), dur) {}
+		EventData(const EBI::EventData& src) = default;
+		EventData(EBI::EventData&& src) noexcept;
 		~EventData();
+		EBI::EventData& operator=(const EBI::EventData& src) = default;
+		EBI::EventData& operator=(EBI::EventData&& src) noexcept;
 		friend class EventImage;
+		friend class EventStream;
+		friend class EventColumns;
+		friend class PackedEventData;
+		friend class EventView;
+		friend class PagedEventData;
 
 		bool copyFrom(const EBI::EventData& src);
 
 		bool copyFrom(const EBI::EventData& src,
-			const int32_t offsetUSec, const int32_t durationUSec);
+			const int64_t offsetUSec, const int32_t durationUSec);
 
 		bool copyFrom(const EBI::EventData& src,
 			const EBI::EventPolarity polMode,
-			const int32_t offsetUSec = 0, const int32_t durationUSec = 0,
+			const int64_t offsetUSec = 0, const int32_t durationUSec = 0,
 			bool bSubtractOffsetTime = true);
 
 		bool copyFrom(const EBI::EventData& src,
 			const EBI::EventPolarity polMode, 
 			const int32_t x, const int32_t y,
 			const int32_t w, const int32_t h,
-			const int32_t t0 = 0, const int32_t dur = 0);
+			const int64_t t0 = 0, const int32_t dur = 0);
 
 		bool copyFrom(const EBI::EventData& src,
 			const int32_t x, const int32_t y,
 			const int32_t w, const int32_t h,
-			const int32_t t0 = 0, const int32_t dur = 0);
+			const int64_t t0 = 0, const int32_t dur = 0);
+
+		// int32_t offsets, so that calls with int arguments do not match the ROI overloads instead
+		bool copyFrom(const EBI::EventData& src, const EBI::EventPolarity polMode,
+			const int32_t offsetUSec, const int32_t durationUSec, bool bSubtractOffsetTime)
+		{
+			return copyFrom(src, polMode, static_cast<int64_t>(offsetUSec), durationUSec, bSubtractOffsetTime);
+		}
+		bool copyFrom(const EBI::EventData& src, const EBI::EventPolarity polMode,
+			const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+			const int32_t t0, const int32_t dur = 0)
+		{
+			return copyFrom(src, polMode, x, y, w, h, static_cast<int64_t>(t0), dur);
+		}
 
 		bool isNull();
 		void clear();
-		std::vector<EBI::Event> data();
+		std::vector<EBI::Event> data() const;	// copy of event data
 		std::vector<EBI::Event>& dataRef();	// access to reference of image data
+		const std::vector<EBI::Event>& dataRef() const { return m_events; }	// read access, never copies
+		size_t size() const { return m_events.size(); }
+		bool empty() const { return m_events.empty(); }
 		std::vector<EBI::Event> getSample(
 			const int32_t x, const int32_t y,
 			const int32_t w, const int32_t h,
-			const int32_t t0 = 0, const int32_t dur = 0);
+			const int64_t t0 = 0, const int32_t dur = 0);
+		std::vector<std::vector<EBI::Event> > getSamples(
+			const std::vector<EBI::SampleWindow>& windows);
+		void setTileSize(const uint32_t tileSize);
+		uint32_t tileSize() const { return m_tileSize; }
 
 		bool cropROI(const int32_t x, const int32_t y,
 			const int32_t w, const int32_t h,
-			const int32_t t0 = 0, const int32_t dur = 0);
+			const int64_t t0 = 0, const int32_t dur = 0);
 
 		bool save(const std::string& fnameEvents,
-			const uint32_t offsetUSec = 0, const uint32_t durationUSec = 0);
+			const uint64_t offsetUSec = 0, const uint32_t durationUSec = 0,
+			const EBI::FileFormat eFormat = EBI::FILE_FORMAT_EVT3);
+		bool saveTiled(const std::string& fnameEvents, const EBI::EventFlowEvalParams& params,
+			const uint64_t offsetUSec = 0, const uint32_t durationUSec = 0);
+		bool load(const std::string& fnameEvents,
+			const uint64_t offsetUSec = 0, const uint32_t durationUSec = 0);
 		bool load(const std::string& fnameEvents,
-			const uint32_t offsetUSec = 0, const uint32_t durationUSec = 0);
+			const EBI::RawDecodeParams& decParams,
+			const uint64_t offsetUSec = 0, const uint32_t durationUSec = 0);
+		bool load(const std::string& fnameEvents,
+			const EBI::EventFilter& filter);
+
+		const EBI::TimeIndex& timeIndex() const;
+		void timeRange(const uint64_t t1, const uint64_t t2, size_t& iFirst, size_t& iEnd) const;
+		//! start of each time segment after the first, empty if all times fit into 32 bits, see EBI::TimeSegment
+		const std::vector<EBI::TimeSegment>& timeSegments() const { return m_timeSegments; }
+		const std::vector<EBI::TimeSegment>& triggerSegments() const { return m_triggerSegments; }
+		//! time of event \a i relative to the first event of the recording in [usec]
+		uint64_t eventTime(const size_t i) const { return EBI::SegmentBase(m_timeSegments, i) + m_events[i].t; }
+		//! time of trigger event \a i relative to the first event of the recording in [usec]
+		uint64_t triggerTime(const size_t i) const { return EBI::SegmentBase(m_triggerSegments, i) + m_triggerEvents[i].t; }
 
 		std::vector<EBI::TriggerEvent> triggerEvents();
 		std::vector<EBI::TriggerEvent>& triggerRef();
+		const std::vector<EBI::TriggerEvent>& triggerRef() const { return m_triggerEvents; }
 
 		int32_t imageWidth() const { return static_cast<int32_t>(m_camSpecs.sensorW); }
 		int32_t imageHeight() const { return static_cast<int32_t>(m_camSpecs.sensorH); }
@@ -78,22 +224,139 @@ namespace EBI {
 
 		void setDebugLevel(const int32_t nLevel);
 		void setMaximumSize(const uint64_t nMaxSize);
+		void setDecodeParams(const EBI::RawDecodeParams& decParams);
+		const EBI::RawDecodeParams& decodeParams() const { return m_decodeParams; }
+		void setThreadCount(const int32_t nThreads) { m_nThreads = nThreads; }	//!< threads of copyFrom(), cropROI(), getSample(), load() and save() of EVT4 / EVTZ files, 0 for all cores
+		int32_t threadCount() const { return m_nThreads; }
+		const EBI::EventLoadStats& loadStats() const { return m_loadStats; }
 
 	protected:
 		std::vector<EBI::Event> m_events;
+		std::vector<EBI::TimeSegment> m_timeSegments;	//!< time segments of m_events after the first
+		mutable EBI::TimeIndex m_timeIndex;	//!< built on first time query, cleared when m_events changes
+		EBI::TileIndex m_tileIndex;	//!< built on first getSample() if m_tileSize > 0, cleared when m_events changes
+		uint32_t m_tileSize;		//!< size of tiles of m_tileIndex in [pixel], 0 for no tile index
 		std::vector<EBI::TriggerEvent> m_triggerEvents;
+		std::vector<EBI::TimeSegment> m_triggerSegments;	//!< time segments of m_triggerEvents after the first
 		EBI::EventCameraSpecs m_camSpecs;
 		std::string m_errMsg;
 		int32_t m_nDebugLevel;
+		int32_t m_nThreads = 0;	//!< threads used for selections, kept by init() unlike the other settings
 
 		uint64_t m_timeStamp;
 		uint64_t m_maxEvents;
+		EBI::RawDecodeParams m_decodeParams;
+		EBI::EventLoadStats m_loadStats;	//!< statistics of last load()
 		bool loadRawData(const std::string& fnameRawEvents,
-			const uint32_t offsetUSec = 0, const uint32_t durationUSec = 0);
+			const EBI::EventFilter& filter = EBI::EventFilter());
+		void invalidateIndex();
+		const EBI::TileIndex* tileIndex();
 	private:
 		void init();
 		// specifics for camera
 	};
+
+	/*!
+	Non-owning view of a slice of an EBI::EventData: the range of events that may fall
+	into the time window, plus the time window, ROI and polarity of the slice.
+	Nothing is copied; readers visit the range and skip events failing contains(),
+	relative() subtracts the time offset and the ROI origin as the copy constructors do.
+	Windows may cross time segments of the source (see EBI::TimeSegment), times are compared
+	relative to the window start modulo 2^32, which is exact for windows shorter than a segment.
+	A view is only valid as long as the events of its source are not changed.
+
+	Usage:
+		EBI::EventView slab(evData, EBI::PolarityPositive, 10000, 20000);
+		EBI::EventImage img(slab);
+		for (const EBI::Event& ev : slab)
+			if (slab.contains(ev))
+				process(slab.relative(ev));
+	*/
+	class EventView
+	{
+	public:
+		EventView();
+		EventView(const EBI::EventData& src);
+		EventView(const EBI::EventData& src,
+			const EBI::EventPolarity polMode,
+			const int64_t offsetUSec = 0, const int32_t durationUSec = 0,
+			bool bSubtractOffsetTime = true);
+		EventView(const EBI::EventData& src,
+			const EBI::EventPolarity polMode,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int64_t t0 = 0, const int32_t dur = 0);
+		EventView(const EBI::EventData& src,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int64_t t0 = 0, const int32_t dur = 0);
+		// int32_t offsets, so that calls with int arguments do not match the ROI overloads instead
+		EventView(const EBI::EventData& src, const EBI::EventPolarity polMode,
+			const int32_t offsetUSec, const int32_t durationUSec, bool bSubtractOffsetTime)
+			: EventView(src, polMode, static_cast<int64_t>(offsetUSec), durationUSec, bSubtractOffsetTime) {}
+		EventView(const EBI::EventData& src, const EBI::EventPolarity polMode,
+			const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+			const int32_t t0, const int32_t dur = 0)
+			: EventView(src, polMode, x, y, w, h, static_cast<int64_t>(t0), dur) {}
+		EventView(const EBI::Event* pEvents, const size_t nEvents,
+			const EBI::EventCameraSpecs& camSpecs, const uint64_t timeStamp = 0);
+
+		const EBI::Event* begin() const { return m_pBegin; }
+		const EBI::Event* end() const { return m_pEnd; }
+		size_t size() const { return static_cast<size_t>(m_pEnd - m_pBegin); }	//!< number of events in range, see count()
+		bool empty() const { return m_pBegin == m_pEnd; }
+		size_t count() const;
+
+		//! true if \a ev is within time window, ROI and polarity of the view
+		bool contains(const EBI::Event& ev) const
+		{
+			if (static_cast<uint32_t>(ev.t - m_t1) > m_tSpan)
+				return false;
+			if (m_bROI && ((ev.x < m_roiX) || (ev.x >= m_roiX + m_roiW) || (ev.y < m_roiY) || (ev.y >= m_roiY + m_roiH)))
+				return false;
+			return (m_polMode == EBI::PolarityBoth)
+				|| ((ev.p > 0) && (m_polMode == EBI::PolarityPositive))
+				|| ((ev.p == 0) && (m_polMode == EBI::PolarityNegative));
+		}
+		//! \a ev relative to time offset and ROI origin of the view
+		EBI::Event relative(EBI::Event ev) const
+		{
+			ev.t -= static_cast<uint32_t>(m_timeOffset);
+			ev.x -= static_cast<uint16_t>(m_roiX);
+			ev.y -= static_cast<uint16_t>(m_roiY);
+			return ev;
+		}
+		uint64_t time(const EBI::Event& ev) const;
+		void toEvents(std::vector<EBI::Event>& events) const;
+		bool save(const std::string& fnameEvents, const EBI::FileFormat eFormat = EBI::FILE_FORMAT_EVT3) const;
+		bool saveTiled(const std::string& fnameEvents, const EBI::EventFlowEvalParams& params) const;
+
+		EBI::EventPolarity polarity() const { return m_polMode; }
+		uint32_t duration() const { return m_duration; }	//!< length of time window in [usec]
+		int32_t imageWidth() const { return m_bROI ? m_roiW : static_cast<int32_t>(m_pCamSpecs->sensorW); }
+		int32_t imageHeight() const { return m_bROI ? m_roiH : static_cast<int32_t>(m_pCamSpecs->sensorH); }
+		const EBI::EventCameraSpecs& camSpecs() const { return *m_pCamSpecs; }
+		uint64_t timeStamp() const { return m_timeStamp; }
+
+	private:
+		void init();
+		void setSource(const EBI::EventData& src);
+		void setRange(const EBI::EventData& src, const uint64_t t1, const uint64_t t2);
+
+		const EBI::Event* m_pBegin;
+		const EBI::Event* m_pEnd;
+		const EBI::Event* m_pOrigin;	//!< first event of the source, for its time segments
+		const std::vector<EBI::TimeSegment>* m_pSegments;	//!< time segments of the source, nullptr if none
+		const EBI::EventCameraSpecs* m_pCamSpecs;
+		uint64_t m_timeStamp;
+		uint32_t m_t1, m_tSpan;		//!< time window [m_t1, m_t1 + m_tSpan] in [usec], m_t1 within its segment
+		uint64_t m_timeOffset;		//!< subtracted from event times by relative()
+		uint32_t m_duration;
+		EBI::EventPolarity m_polMode;
+		bool m_bROI;				//!< false for the entire detector
+		int32_t m_roiX, m_roiY, m_roiW, m_roiH;
+		int32_t m_nThreads;			//!< threads of the source, used by save()
+	};
 } // namespace EBI
 
 #endif /* _EBI_EVENTDATA_H__INCLUDED_ */
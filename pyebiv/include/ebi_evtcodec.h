@@ -0,0 +1,34 @@
+#ifndef _EBI_EVTCODEC_H__INCLUDED_
+#define _EBI_EVTCODEC_H__INCLUDED_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ebi_evtfile.h"
+
+namespace EBI {
+
+	/*!
+	Lossless codec of the blocks of compressed event files ("EVTZ"), see _EVENT_FILE_BLOCK.
+	A block of packed events with times relative to its first event is coded as
+
+		uint32_t nTimeBytes, nRowBytes, nColBytes	sizes of the three streams below
+		polarity bits, one per event, lowest bit first
+		time stream: time difference to the previous run and number of events per run of equal time
+		row stream: y difference to the previous run and number of events per run of equal y
+		column stream: x difference to the previous event per event
+
+	Differences are zigzag coded signed integers stored as varints of 7 bits per byte,
+	so runs of events read out together and x steps within a row take one byte each.
+	Blocks are independent of each other and are coded in parallel by the callers.
+	*/
+	size_t EncodeEventBlock(const PACKED_EVENT* pEvents, const size_t nEvents, std::vector<uint8_t>& out);
+	bool DecodeEventBlock(const uint8_t* pData, const size_t nBytes, const size_t nEvents, PACKED_EVENT* pEvents);
+
+	//! upper bound of the size of a coded block of \a nEvents
+	inline size_t EncodedBlockBound(const size_t nEvents) { return 12 + (nEvents + 7) / 8 + nEvents * 20; }
+
+} // namespace EBI
+
+#endif /* _EBI_EVTCODEC_H__INCLUDED_ */
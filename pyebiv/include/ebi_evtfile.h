@@ -0,0 +1,120 @@
+#ifndef _EBI_EVTFILE_H__INCLUDED_
+#define _EBI_EVTFILE_H__INCLUDED_
+
+#include <cstdint>
+
+// Layout of the library's own event files (*.evt), see EBI::EventData::save()
+
+/*! \cond
+ * header for event data files
+ */
+struct _EVENT_FILE_HDR 
+{
+	int32_t		Signature;		//!< "EVT3", "EVT4" for files in blocks, "EVTZ" for compressed blocks or "EVTT" for tiles
+	uint64_t	FileSize;		//!< size in bytes including header
+	uint64_t	EventCount;		//!< number of events in file
+	uint64_t	TimeStamp;		//!< time in [usec] of first event from RAW file
+	uint32_t	Duration;		//!< in [usec]
+	uint32_t	HeaderLength;	//!< should be 64 
+	uint32_t	cols, rows;		//!< size of image
+	uint32_t	SegmentCount;	//!< number of _EVENT_FILE_SEGMENT following the events, valid with SegmentSignature
+	uint32_t	SegmentSignature;	//!< "SEGS" if the file has time segments, older files may hold anything here
+	uint32_t	DurationHigh;	//!< upper 32 bits of duration, valid with SegmentSignature
+	uint32_t	_reserved4; //!< bytes 61...64
+};
+#define _EVENT_FILE_HDR_SIZE 64
+#define _EVENT_FILE_SIGNATURE 0x33545645 // "EVT3"
+#define _EVENT_FILE_SEGMENT_SIGNATURE 0x53474553 // "SEGS"
+
+/*
+ * Event times are stored in 31 bits. Longer recordings are split into time segments
+ * of 2^31 usec, the start of each segment after the first is listed after the events.
+ */
+struct _EVENT_FILE_SEGMENT
+{
+	uint64_t	TimeBase;		//!< start of segment in [usec], multiple of 2^31
+	uint64_t	FirstEvent;		//!< index of first event of segment
+};
+#define _EVENT_FILE_SEGMENT_SIZE 16
+#define _EVENT_FILE_SEGMENT_USEC (1ULL << 31)
+
+struct PACKED_EVENT
+{
+	uint16_t	x, y;		//!< pixel coords
+	uint32_t	timePol;	//!< time in [usec] with polarity in lowest bit
+};
+#define _PACKED_EVENT_SIZE 8
+
+/*
+ * Files with signature "EVT4" keep the header, with SegmentSignature set and no time segments.
+ * Events are stored in blocks of up to _EVENT_FILE_BLOCK_EVENTS, times in [usec] relative to the
+ * first event of their block, which never spans more than 31 bits nor crosses a multiple of 2^32.
+ * The blocks are listed in order of time in an index after the events, found through the
+ * footer in the last bytes of the file.
+ * Files with signature "EVTZ" have the same layout with each block coded by EBI::EncodeEventBlock().
+ */
+#define _EVENT_FILE_BLOCKS_SIGNATURE 0x34545645 // "EVT4"
+#define _EVENT_FILE_CODED_SIGNATURE 0x5A545645 // "EVTZ"
+
+struct _EVENT_FILE_BLOCK
+{
+	uint64_t	Offset;			//!< byte offset of the events of the block
+	uint64_t	TimeFirst;		//!< time of first event of block in [usec], times of events are relative to it
+	uint64_t	TimeLast;		//!< time of latest event of block in [usec]
+	uint32_t	EventCount;		//!< number of events of the block
+	uint16_t	xMin, yMin;		//!< bounding box of the events of the block
+	uint16_t	xMax, yMax;		//!< including the maximum
+	uint32_t	ByteCount;		//!< size of the events of the block in bytes, coded or packed
+};
+#define _EVENT_FILE_BLOCK_SIZE 40
+#define _EVENT_FILE_BLOCK_EVENTS 16384
+
+struct _EVENT_FILE_FOOTER
+{
+	uint64_t	IndexOffset;	//!< byte offset of the first _EVENT_FILE_BLOCK
+	uint32_t	BlockCount;		//!< number of _EVENT_FILE_BLOCK in the index
+	uint32_t	BlockEvents;	//!< maximum number of events per block
+	uint32_t	Version;		//!< 1
+	uint32_t	Signature;		//!< "EIDX"
+};
+#define _EVENT_FILE_FOOTER_SIZE 24
+#define _EVENT_FILE_FOOTER_SIGNATURE 0x58444945 // "EIDX"
+#define _EVENT_FILE_BLOCKS_VERSION 1
+
+/*
+ * Files with signature "EVTT" keep the header and hold the events grouped by tiles of the image,
+ * in row-major order, and within each tile in blocks of time. Each block holds the events of
+ * one tile within [k * BlockUSec, (k + 1) * BlockUSec) for some k, in order of the file, as
+ * columns of times relative to TimeFirst (uint32_t), event numbers relative to FirstEvent
+ * (uint32_t), x and y (uint16_t) and polarity (uint8_t), padded to 8 bytes. The block index,
+ * grouped by tile, is followed by the first block of each tile and the footer.
+ */
+#define _EVENT_FILE_TILES_SIGNATURE 0x54545645 // "EVTT"
+
+struct _EVENT_FILE_TILE_BLOCK
+{
+	uint64_t	Offset;			//!< byte offset of the columns of the block
+	uint64_t	FirstEvent;		//!< number of the first event of the block in the file
+	uint64_t	TimeFirst;		//!< time of earliest event of block in [usec], times of events are relative to it
+	uint64_t	TimeLast;		//!< time of latest event of block in [usec]
+	uint32_t	EventCount;		//!< number of events of the block
+	uint32_t	Tile;			//!< number of the tile, row-major
+};
+#define _EVENT_FILE_TILE_BLOCK_SIZE 40
+
+struct _EVENT_FILE_TILES_FOOTER
+{
+	uint64_t	IndexOffset;	//!< byte offset of the first _EVENT_FILE_TILE_BLOCK
+	uint32_t	BlockCount;		//!< number of _EVENT_FILE_TILE_BLOCK, followed by TilesX * TilesY + 1 uint32_t first blocks
+	uint32_t	BlockUSec;		//!< duration of the time blocks in [usec]
+	uint32_t	TileW, TileH;	//!< size of tiles in [pixel]
+	uint32_t	TilesX, TilesY;	//!< number of tiles
+	uint32_t	Version;		//!< 1
+	uint32_t	Signature;		//!< "ETIL"
+};
+#define _EVENT_FILE_TILES_FOOTER_SIZE 40
+#define _EVENT_FILE_TILES_FOOTER_SIGNATURE 0x4C495445 // "ETIL"
+#define _EVENT_FILE_TILES_VERSION 1
+//! \endcond
+
+#endif /* _EBI_EVTFILE_H__INCLUDED_ */
@@ -0,0 +1,52 @@
+#ifndef _EBI_FILE_H__INCLUDED_
+#define _EBI_FILE_H__INCLUDED_
+
+#include <cstdint>
+#include <string>
+
+namespace EBI {
+
+	/*!
+	Read-only memory mapping of an entire file.
+	Uses mmap() on POSIX systems and file mapping objects on Windows.
+	*/
+	class MappedFile
+	{
+	public:
+		enum AccessHint
+		{
+			AccessNormal = 0,
+			AccessSequential = 1,	//!< data is read once from start to end
+			AccessRandom = 2,
+		};
+
+		MappedFile();
+		~MappedFile();
+
+		bool open(const std::string& fname, const AccessHint eHint = AccessNormal);
+		void close();
+		bool isOpen() const { return (m_pData != nullptr); }
+
+		const uint8_t* data() const { return m_pData; }
+		uint64_t size() const { return m_nSize; }
+
+		void advise(const AccessHint eHint);
+		void release(const uint64_t offset, const uint64_t length);
+
+	private:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const uint8_t* m_pData;
+		uint64_t m_nSize;
+#ifdef _WIN32
+		void* m_hFile;
+		void* m_hMapping;
+#else
+		int m_fd;
+#endif
+	};
+
+} // namespace EBI
+
+#endif /* _EBI_FILE_H__INCLUDED_ */
@@ -15,6 +15,9 @@
 
 namespace EBI {
 
+	class PackedEventData;
+	class PagedEventData;
+
 	class EventImage
 	{
 	public:
@@ -22,6 +25,14 @@ namespace EBI {
 		EventImage(const EBI::EventData& src, const EBI::EventPolarity polMode,
 			const uint32_t offsetUSec = 0, const uint32_t durationUSec = 0,
 			const int32_t refTimeUSec = 0, const bool bSumEvents = false);
+		EventImage(const EBI::PackedEventData& src, const EBI::EventPolarity polMode,
+			const uint32_t offsetUSec = 0, const uint32_t durationUSec = 0,
+			const int32_t refTimeUSec = 0, const bool bSumEvents = false);
+		EventImage(const EBI::EventView& src,
+			const int32_t refTimeUSec = 0, const bool bSumEvents = false);
+		EventImage(const EBI::PagedEventData& src, const EBI::EventPolarity polMode,
+			const uint64_t offsetUSec, const uint32_t durationUSec,
+			const int32_t refTimeUSec = 0, const bool bSumEvents = false);
 
 		void clear();
 		bool fromEventData(const EBI::EventData& src,
@@ -31,6 +42,22 @@ namespace EBI {
 			const int32_t refTimeUSec = 0,
 			const bool bSumEvents = false);
 		bool addFromEventData(const EBI::EventData& data, const EBI::EventPolarity polMode, const bool bSumEvents = false);
+		bool fromEventData(const EBI::PackedEventData& src,
+			const EBI::EventPolarity polMode,
+			const uint32_t offsetUSec = 0,
+			const uint32_t durationUSec = 0,
+			const int32_t refTimeUSec = 0,
+			const bool bSumEvents = false);
+		bool addFromEventData(const EBI::PackedEventData& data, const EBI::EventPolarity polMode, const bool bSumEvents = false);
+		bool fromEventData(const EBI::EventView& src,
+			const int32_t refTimeUSec = 0,
+			const bool bSumEvents = false);
+		bool fromEventData(const EBI::PagedEventData& src,
+			const EBI::EventPolarity polMode,
+			const uint64_t offsetUSec,
+			const uint32_t durationUSec,
+			const int32_t refTimeUSec = 0,
+			const bool bSumEvents = false);
 		void setReferenceTime(const int32_t refTimeUSec);
 		int32_t referenceTime() const;
 
@@ -74,7 +101,14 @@ namespace EBI {
 		double m_statsMean, m_statsVar, m_statsMin, m_statsMax;
 	private:
 		void init();
-		bool alloc(const EBI::EventData& src);
+		bool alloc(const EBI::EventCameraSpecs& camSpecs);
+		template <typename EventT>
+		bool addEvents(const std::vector<EventT>& events, const EBI::EventCameraSpecs& camSpecs,
+			const EBI::EventPolarity polMode, const bool bSumEvents);
+		template <typename EventT, typename RangeFn>
+		bool fromEvents(const std::vector<EventT>& events, RangeFn timeRange, const EBI::EventCameraSpecs& camSpecs,
+			const EBI::EventPolarity polMode, const uint32_t offsetUSec, const uint32_t durationUSec,
+			const int32_t refTimeUSec, const bool bSumEvents);
 	};
 }
 
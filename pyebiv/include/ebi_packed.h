@@ -0,0 +1,98 @@
+#ifndef _EBI_PACKED_H__INCLUDED_
+#define _EBI_PACKED_H__INCLUDED_
+
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include "ebi_structs.h"
+#include "ebi_data.h"
+
+namespace EBI {
+
+	/*!
+	Event data set stored as EBI::PackedEvent, 8 instead of 12 bytes per event.
+	Times are limited to EBI::PACKED_TIME_MAX (31 bits), loading stops there.
+	Methods have the same meaning as those of EBI::EventData, conversion from
+	and to EBI::EventData is a single pass over the events. EBI::EventImage
+	accepts the packed events directly.
+
+	Usage:
+		EBI::PackedEventData evPacked;
+		evPacked.load("recording.raw");
+		EBI::PackedEventData sample;
+		evPacked.getSample(sample, 100, 100, 40, 40, 10000, 20000);
+	*/
+	class PackedEventData
+	{
+	public:
+		PackedEventData();
+		PackedEventData(const EBI::EventData& src);
+		~PackedEventData();
+		friend class EventImage;
+
+		// conversion from and to array of EBI::Event
+		bool copyFrom(const EBI::EventData& src);
+		bool copyTo(EBI::EventData& dst) const;
+		void assign(const std::vector<EBI::Event>& events);
+		void toEvents(std::vector<EBI::Event>& events) const;
+
+		bool copyFrom(const EBI::PackedEventData& src,
+			const EBI::EventPolarity polMode,
+			const int32_t offsetUSec = 0, const int32_t durationUSec = 0,
+			bool bSubtractOffsetTime = true);
+		bool copyFrom(const EBI::PackedEventData& src,
+			const EBI::EventPolarity polMode,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0);
+		bool copyFrom(const EBI::PackedEventData& src,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0);
+
+		bool cropROI(const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0);
+		size_t getSample(EBI::PackedEventData& sample,
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int32_t t0 = 0, const int32_t dur = 0) const;
+
+		bool load(const std::string& fnameEvents,
+			const EBI::EventFilter& filter = EBI::EventFilter());
+
+		void clear();
+		void reserve(const size_t n) { m_events.reserve(n); }
+		void append(const EBI::Event* pEvents, const size_t n);
+		size_t size() const { return m_events.size(); }
+		bool empty() const { return m_events.empty(); }
+
+		std::vector<EBI::PackedEvent>& dataRef() { return m_events; }
+		const std::vector<EBI::PackedEvent>& dataRef() const { return m_events; }
+		std::vector<EBI::TriggerEvent>& triggerRef() { return m_triggerEvents; }
+		int32_t imageWidth() const { return static_cast<int32_t>(m_camSpecs.sensorW); }
+		int32_t imageHeight() const { return static_cast<int32_t>(m_camSpecs.sensorH); }
+		uint64_t timeStamp() const { return m_timeStamp; }
+
+		void setDebugLevel(const int32_t nLevel) { m_nDebugLevel = nLevel; }
+		void setMaximumSize(const uint64_t nMaxSize) { m_maxEvents = nMaxSize; }	//!< limit of load() for all types of file
+		void setDecodeParams(const EBI::RawDecodeParams& decParams) { m_decodeParams = decParams; }
+		const EBI::EventLoadStats& loadStats() const { return m_loadStats; }
+
+	private:
+		void init();
+		bool loadEventFile(const std::string& fnameEvents, const EBI::EventFilter& filter);
+
+		std::vector<EBI::PackedEvent> m_events;
+		std::vector<EBI::TriggerEvent> m_triggerEvents;
+		EBI::EventCameraSpecs m_camSpecs;
+		uint64_t m_timeStamp;
+		uint64_t m_maxEvents;
+		int32_t m_nDebugLevel;
+		EBI::RawDecodeParams m_decodeParams;
+		EBI::EventLoadStats m_loadStats;	//!< statistics of last load()
+	};
+} // namespace EBI
+
+#endif /* _EBI_PACKED_H__INCLUDED_ */
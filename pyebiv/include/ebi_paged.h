@@ -0,0 +1,112 @@
+#ifndef _EBI_PAGED_H__INCLUDED_
+#define _EBI_PAGED_H__INCLUDED_
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+
+#include "ebi_structs.h"
+#include "ebi_data.h"
+
+namespace EBI {
+
+	/*!
+	Event data set of any length kept on disk, for recordings larger than memory.
+	On first open() of a RAW or EVT file, its events are written in a single pass
+	to the block file <file>.ebpg next to it, split into blocks of fixed duration.
+	Queries read only the blocks overlapping their time window; the most recently
+	used blocks stay resident up to setCacheSize() bytes, so memory is bounded
+	independent of the recording length. Times are 64-bit relative to the first
+	event, as EventData::eventTime(). Queries modify the cache, so an instance
+	must not be used by several threads at once.
+
+	Usage:
+		EBI::PagedEventData evPaged;
+		evPaged.setCacheSize(256 << 20);
+		if (evPaged.open("recording.raw")) {
+			for (uint64_t t0 = 0; t0 < evPaged.duration(); t0 += 10000) {
+				std::vector<EBI::Event> sample = evPaged.getSample(100, 100, 40, 40, t0, 10000);
+				...
+			}
+		}
+	*/
+	class PagedEventData
+	{
+	public:
+		PagedEventData();
+		~PagedEventData();
+
+		bool open(const std::string& fnameEvents, const uint32_t blockUSec = 100000);
+		void close();
+		bool isOpen() const { return m_file.is_open(); }
+		//! name of the block file of \a fnameEvents
+		static std::string fileName(const std::string& fnameEvents) { return fnameEvents + ".ebpg"; }
+
+		std::vector<EBI::Event> getSample(
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int64_t t0 = 0, const int32_t dur = 0) const;
+		std::vector<std::vector<EBI::Event> > getSamples(
+			const std::vector<EBI::SampleWindow>& windows) const;
+		bool copyTo(EBI::EventData& dst, const EBI::EventPolarity polMode,
+			const int64_t offsetUSec, const int32_t durationUSec) const;
+
+		uint64_t size() const { return m_nEvents; }
+		bool empty() const { return m_nEvents == 0; }
+		uint64_t duration() const { return m_duration; }	//!< time of last event in [usec]
+		size_t blockCount() const { return m_blocks.size(); }
+		uint32_t blockDuration() const { return m_blockUSec; }
+		int32_t imageWidth() const { return static_cast<int32_t>(m_camSpecs.sensorW); }
+		int32_t imageHeight() const { return static_cast<int32_t>(m_camSpecs.sensorH); }
+		uint64_t timeStamp() const { return m_timeStamp; }
+
+		void setCacheSize(const uint64_t nBytes);
+		uint64_t cacheSize() const { return m_nCacheBytes; }
+		uint64_t residentBytes() const { return m_nResidentBytes; }	//!< size of the blocks in memory
+		uint64_t blockReads() const { return m_nBlockReads; }		//!< blocks read from disk since open()
+		void setTileSize(const uint32_t tileSize);
+		void setDecodeParams(const EBI::RawDecodeParams& decParams) { m_decodeParams = decParams; }
+		void setDebugLevel(const int32_t nLevel) { m_nDebugLevel = nLevel; }
+
+	private:
+		PagedEventData(const PagedEventData&) = delete;
+		PagedEventData& operator=(const PagedEventData&) = delete;
+
+		bool build(const std::string& fnameEvents, const std::string& fnamePaged, const uint32_t blockUSec);
+		bool openBlockFile(const std::string& fnamePaged, const uint64_t nSourceSize, const uint32_t blockUSec);
+		EBI::EventData& block(const size_t k) const;
+		template <typename Fn>
+		void forEachBlock(const uint64_t t1, const uint64_t t2, Fn fn) const;
+
+		struct BlockEntry
+		{
+			uint64_t offset;	//!< byte offset of the events of the block in the block file
+			uint64_t nEvents;	//!< number of events of the block
+		};
+		struct CachedBlock
+		{
+			size_t k;			//!< index of the block
+			uint64_t lastUse;	//!< value of m_nUseCount at the last access
+			EBI::EventData events;	//!< times relative to the start of the block
+		};
+
+		mutable std::ifstream m_file;
+		std::vector<BlockEntry> m_blocks;
+		mutable std::vector<CachedBlock> m_cache;
+		mutable uint64_t m_nUseCount;
+		mutable uint64_t m_nBlockReads;
+		mutable uint64_t m_nResidentBytes;
+		uint64_t m_nCacheBytes;		//!< resident blocks are evicted beyond this size, the block in use is always kept
+		mutable uint32_t m_tileSize;		//!< tile size of the resident blocks, see EventData::setTileSize()
+		uint32_t m_blockUSec;		//!< duration of each block in [usec]
+		uint64_t m_nEvents;
+		uint64_t m_duration;
+		EBI::EventCameraSpecs m_camSpecs;
+		uint64_t m_timeStamp;
+		EBI::RawDecodeParams m_decodeParams;
+		int32_t m_nDebugLevel;
+	};
+} // namespace EBI
+
+#endif /* _EBI_PAGED_H__INCLUDED_ */
@@ -0,0 +1,49 @@
+#ifndef _EBI_PARALLEL_H__INCLUDED_
+#define _EBI_PARALLEL_H__INCLUDED_
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace EBI {
+
+	//! number of threads to use for a requested count of \a nThreads, all cores for 0 or less
+	inline int32_t ThreadCount(const int32_t nThreads)
+	{
+		int32_t n = nThreads;
+		if (n < 1)
+			n = static_cast<int32_t>(std::thread::hardware_concurrency());
+		return (n < 1) ? 1 : n;
+	}
+
+	/*!
+	Run \a fn(i) for i in [0, nItems) on up to \a nThreads worker threads
+	*/
+	template <class Fn>
+	void ParallelFor(const size_t nItems, const int32_t nThreads, Fn fn)
+	{
+		size_t nWorkers = (nThreads > 0) ? static_cast<size_t>(nThreads) : 1;
+		if (nWorkers > nItems)
+			nWorkers = nItems;
+		if (nWorkers <= 1) {
+			for (size_t i = 0; i < nItems; i++)
+				fn(i);
+			return;
+		}
+		std::atomic<size_t> nNext(0);
+		std::vector<std::thread> workers;
+		for (size_t w = 0; w < nWorkers; w++) {
+			workers.emplace_back([&]() {
+				for (size_t i = nNext++; i < nItems; i = nNext++)
+					fn(i);
+			});
+		}
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+} // namespace EBI
+
+#endif /* _EBI_PARALLEL_H__INCLUDED_ */
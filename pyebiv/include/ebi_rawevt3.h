@@ -0,0 +1,338 @@
+#ifndef _EBI_RAWEVT3_H__INCLUDED_
+#define _EBI_RAWEVT3_H__INCLUDED_
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <istream>
+#include <fstream>
+#include <functional>
+#include <atomic>
+
+#include "ebi_structs.h"
+
+// The following code is derived from Prophesee's Metavision SDK
+// see: ./ Prophesee / share / metavision / standalone_samples / metavision_evt3_raw_file_decoder/
+namespace Metavision {
+	namespace Evt3 {
+
+		// Event Data 3.0 is a 16 bits vectorized data format. It has been designed to comply with both data compactness
+		// necessity and vector event data support.
+		// This EVT3.0 event format avoids transmitting redundant event data for the time, y and x values.
+		enum class EventTypes : uint8_t {
+			EVT_ADDR_Y = 0x0,  // Identifies a CD event and its y coordinate
+			EVT_ADDR_X = 0x2,  // Marks a valid single event and identifies its polarity and X coordinate. The event's type and
+							   // timestamp are considered to be the last ones sent
+			VECT_BASE_X = 0x3, // Transmits the base address for a subsequent vector event and identifies its polarity and base
+								// X coordinate. This event does not represent a CD sensor event in itself and should not be
+								// processed as such,  it only sets the base x value for following VECT_12 and VECT_8 events.
+			VECT_12 = 0x4, // Vector event with 12 valid bits. This event encodes the validity bits for events of the same type,
+							// timestamp and y coordinate as previously sent events, while consecutive in x coordinate with
+							// respect to the last sent VECT_BASE_X event. After processing this event, the X position value
+							// on the receiver side should be incremented by 12 with respect to the X position when the event was
+							// received, so that the VECT_BASE_X is updated like follows: VECT_BASE_X.x = VECT_BASE_X.x + 12
+			VECT_8 = 0x5,  // Vector event with 8 valid bits. This event encodes the validity bits for events of the same type,
+						// timestamp and y coordinate as previously sent events, while consecutive in x coordinate with
+						// respect to the last sent VECT_BASE_X event. After processing this event, the X position value
+						// on the receiver side should be incremented by 8 with respect to the X position when the event was
+						// received, so that the VECT_BASE_X is updated like follows: VECT_BASE_X.x = VECT_BASE_X.x + 8
+			EVT_TIME_LOW = 0x6, // Encodes the lower 12b of the timebase range (range 11 to 0). Note that the TIME_LOW value is
+								// only monotonic for a same event source, but can be non-monotonic when multiple event sources
+								// are considered. They should however refer to the same TIME_HIGH value. As the time low has
+								// 12b with a 1us resolution, it can encode time values from 0us to 4095us (4095 = 2^12 - 1).
+								// After 4095us, the time_low value wraps and returns to 0us, at which point the TIME_HIGH value
+								// should be incremented.
+			EVT_TIME_HIGH = 0x8, // Encodes the higher portion of the timebase (range 23 to 12). Since it encodes the 12 higher
+									// bits over the 24 used to encode a timestamp, it has a resolution of 4096us (= 2^(24-12)) and
+									// it can encode time values from 0us to 16777215us (= 16.777215s). After 16773120us the
+									// time_high value wraps and returns to 0us.																													 EXT_TRIGGER = 0xA    // External trigger output
+			EXT_TRIGGER = 0xA    // External trigger output
+		};
+		// Evt3 raw events are 16-bit words
+		struct RawEvent {
+			uint16_t pad : 12; // Padding
+			uint16_t type : 4; // Event type
+		};
+
+		struct RawEventTime {
+			uint16_t time : 12;
+			uint16_t type : 4; // Event type : EventTypes::EVT_TIME_LOW OR EventTypes::EVT_TIME_HIGH
+		};
+
+		struct RawEventXPos {
+			uint16_t x : 11;   // Pixel X coordinate
+			uint16_t pol : 1;  // Event polarity:
+							   // '0': decrease in illumination
+							   // '1': increase in illumination
+			uint16_t type : 4; // Event type : EventTypes::X_POS
+		};
+
+		struct RawEventVect12 {
+			uint16_t valid : 12; // Encodes the validity of the events in the vector :
+								 // foreach i in 0 to 11
+								 //   if valid[i] is '1'
+								 //      valid event at X = X_BASE.x + i
+			uint16_t type : 4;   // Event type : EventTypes::VECT_12
+		};
+
+		struct RawEventVect8 {
+			uint16_t valid : 8; // Encodes the validity of the events in the vector :
+								// foreach i in  0 to 7
+								//   if valid[i] is '1'
+								//      valid event at X = X_BASE.x + i
+			uint16_t unused : 4;
+			uint16_t type : 4; // Event type : EventTypes::VECT_8
+		};
+
+		struct RawEventY {
+			uint16_t y : 11;   // Pixel Y coordinate
+			uint16_t orig : 1; // Identifies the System Type:
+							   // '0': Master Camera (Left Camera in Stereo Systems)
+							   // '1': Slave Camera (Right Camera in Stereo Systems)
+			uint16_t type : 4; // Event type : EventTypes::CD_Y OR EventTypes::EM_Y
+		};
+
+		struct RawEventXBase {
+			uint16_t x : 11;   // Pixel X coordinate
+			uint16_t pol : 1;  // Event polarity:
+							   // '0': decrease in illumination
+							   // '1': increase in illumination
+			uint16_t type : 4; // Event type : EventTypes::X_BASE
+		};
+
+		struct RawEventExtTrigger {
+			uint16_t value : 1; // Trigger current value (edge polarity):
+								// - '0' (falling edge);
+								// - '1' (rising edge).
+			uint16_t unused : 7;
+			uint16_t id : 4;   // Trigger channel ID.
+			uint16_t type : 4; // Event type : EventTypes::EXT_TRIGGER
+		};
+
+		using timestamp_t = uint64_t; // Type for timestamp, in microseconds
+
+	} // namespace Evt3
+} // namespace Metavision
+
+namespace EBI {
+
+	class EventColumns;
+	class PackedEventData;
+
+	/*!
+	State of the EVT3 decoder that is carried from one raw word to the next
+	*/
+	struct Evt3DecoderState
+	{
+		uint64_t timeBase;		//!< time high bits including time high loops in [usec]
+		uint64_t time;			//!< current time in [usec]
+		uint32_t nTimeHighLoops;	//!< counter of the time high loops
+		uint16_t y;				//!< current y coordinate (of CD events)
+		uint16_t xBase;			//!< current base x coordinate for vector events
+		uint16_t polarity;		//!< current polarity for vector events
+		uint16_t sensorW;		//!< detector width, used for range check of x
+		uint16_t sensorH;		//!< detector height, used for range check of y
+		bool bTimeBaseSet;		//!< false until first EVT_TIME_HIGH was seen
+
+		void init()
+		{
+			timeBase = time = 0;
+			nTimeHighLoops = 0;
+			y = xBase = polarity = 0;
+			sensorW = sensorH = 1;
+			bTimeBaseSet = false;
+		}
+		Evt3DecoderState() { init(); }
+	};
+
+	/*!
+	Entry of the index of a RAW file: decoder state right before an EVT_TIME_HIGH word.
+	Decoding can be started at \a wordPos with this state instead of at the start of the file.
+	*/
+	struct RawIndexEntry
+	{
+		uint64_t wordPos;		//!< position of the EVT_TIME_HIGH word in 16-bit words from start of event data
+		uint64_t startTime;		//!< time base set by this word relative to first event in [usec]
+		uint64_t timeBase;		//!< decoder state before the word, see Evt3DecoderState
+		uint64_t time;
+		uint32_t nTimeHighLoops;
+		uint16_t y;
+		uint16_t xBase;
+		uint16_t polarity;
+		uint16_t _reserved1;
+		uint32_t _reserved2;
+	};
+
+	/*!
+	Time-to-offset index of a Metavision RAW file, saved next to the file as <file>.ebidx.
+	Allows loading of a time window without decoding the file from its start.
+	*/
+	class RawFileIndex
+	{
+	public:
+		RawFileIndex();
+		~RawFileIndex();
+
+		void clear();
+		bool build(const std::string& fnameRaw, const uint32_t nInterval, const bool bDebugMessages = false);
+		bool load(const std::string& fnameIndex);
+		bool save(const std::string& fnameIndex) const;
+		bool isValidFor(const uint64_t nRawFileSize, const uint64_t nPayloadOffset) const;
+		const EBI::RawIndexEntry* find(const uint64_t nStartTime) const;
+
+		size_t size() const { return m_entries.size(); }
+		uint64_t timeStamp() const { return m_timeStamp; }
+		uint32_t interval() const { return m_nInterval; }
+
+		static std::string fileName(const std::string& fnameRaw) { return fnameRaw + ".ebidx"; }
+
+	private:
+		std::vector<EBI::RawIndexEntry> m_entries;
+		uint64_t m_nRawFileSize;	//!< size of the indexed RAW file in bytes
+		uint64_t m_nPayloadOffset;	//!< byte offset of the event data in the RAW file
+		uint64_t m_timeStamp;		//!< time of first event in the RAW file
+		uint32_t m_nInterval;		//!< time between entries in [usec]
+	};
+
+	/*!
+	Incremental decoder of a Metavision RAW file: each call of read() decodes
+	the next block of raw words, so a file of any length can be processed in
+	portions of bounded size.
+
+	With setFollow(true) the reader tails a file that is still being recorded:
+	the end of file is not the end of the data, read() returns the words appended
+	since the previous call and the decoder state is kept in between.
+	*/
+	class RawEventReader
+	{
+	public:
+		//! receives each batch of newly decoded events, return false to stop following
+		typedef std::function<bool(const std::vector<EBI::Event>&,
+			const std::vector<EBI::TriggerEvent>&)> FollowCallback;
+
+		RawEventReader();
+		~RawEventReader();
+
+		bool open(const std::string& fname,
+			const uint64_t nStartTime = 0, const uint64_t nDuration = 0,
+			const EBI::RawDecodeParams& decParams = EBI::RawDecodeParams(),
+			const bool bDebugMessages = false);
+		void close();
+		uint64_t read(std::vector<EBI::Event>& evData,
+			std::vector<EBI::TriggerEvent>& evTrigger,
+			const uint64_t nWords = 262144);
+		uint64_t read(std::vector<EBI::Event>& evData,
+			std::vector<EBI::TriggerEvent>& evTrigger,
+			std::vector<EBI::TimeSegment>& evSegments,
+			std::vector<EBI::TimeSegment>& triggerSegments,
+			const uint64_t nWords = 262144);
+
+		void setFollow(const bool bFollow) { m_bFollow = bFollow; }
+		uint64_t follow(const FollowCallback& callback,
+			const uint32_t pollIntervalMSec = 10,
+			const uint32_t idleTimeoutMSec = 0,
+			const uint64_t nWords = 262144);
+		void stop() { m_bStop = true; }	//!< end follow(), may be called from another thread
+
+		bool isOpen() const { return m_file.is_open(); }
+		bool isEnd() const { return m_bEnd; }
+		uint64_t timeStamp() const { return m_timeStamp; }
+		const EBI::EventCameraSpecs& cameraSpecs() const { return m_camSpecs; }
+
+	private:
+		uint64_t readWords(std::vector<EBI::Event>& evData,
+			std::vector<EBI::TriggerEvent>& evTrigger,
+			std::vector<EBI::TimeSegment>* pSegments,
+			std::vector<EBI::TimeSegment>* pTriggerSegments,
+			const uint64_t nWords);
+
+		std::ifstream m_file;
+		std::vector<uint16_t> m_buffer;	//!< raw words of the current block
+		EBI::EventCameraSpecs m_camSpecs;
+		EBI::Evt3DecoderState m_state;
+		EBI::RawVectorKernel m_vecKernel;
+		uint64_t m_timeStamp;		//!< time of first event in file
+		uint64_t m_evCount;			//!< CD events decoded so far, 0 while m_timeStamp is unknown
+		uint64_t m_nStartTime;		//!< events before this time are skipped
+		uint64_t m_nEndTime;		//!< reading ends after this time
+		uint64_t m_segBase;			//!< start of time segment of the latest event
+		uint64_t m_trigSegBase;		//!< start of time segment of the latest trigger event
+		bool m_bEnd;				//!< end of file or time window reached
+		bool m_bFollow;				//!< file is still growing, end of file is not the end of data
+		uint64_t m_nFilePos;		//!< byte offset of the next raw word to read
+		std::atomic<bool> m_bStop;	//!< request to end follow()
+	};
+
+	bool GetRawFileIndex(const std::string& fnameRaw,
+		const uint32_t nInterval,
+		EBI::RawFileIndex& index,
+		const bool bDebugMessages);
+
+	bool ReadRawFileHeader(std::istream& inFile,
+		EBI::EventCameraSpecs& camSpecs,
+		const std::string& fname,
+		const bool bDebugMessages);
+
+	bool LoadRawEventData(const std::string& fname,
+		std::vector<EBI::Event>& evData,
+		std::vector<EBI::TriggerEvent>& evTrigger,
+		std::vector<EBI::TimeSegment>& evSegments,
+		std::vector<EBI::TimeSegment>& triggerSegments,
+		uint64_t& timeStamp,
+		EBI::EventCameraSpecs& camSpecs,
+		const uint64_t nStartTime,
+		const uint64_t nDuration,
+		const uint64_t nMaxEventCount,
+		const EBI::RawDecodeParams& decParams,
+		EBI::EventLoadStats& stats,
+		const EBI::EventFilter& filter,
+		const bool bDebugMessages);
+
+	bool LoadRawEventData(const std::string& fname,
+		EBI::EventColumns& evColumns,
+		std::vector<EBI::TriggerEvent>& evTrigger,
+		uint64_t& timeStamp,
+		EBI::EventCameraSpecs& camSpecs,
+		const uint64_t nStartTime,
+		const uint64_t nDuration,
+		const uint64_t nMaxEventCount,
+		const EBI::RawDecodeParams& decParams,
+		EBI::EventLoadStats& stats,
+		const EBI::EventFilter& filter,
+		const bool bDebugMessages);
+
+	bool LoadRawEventData(const std::string& fname,
+		EBI::PackedEventData& evPacked,
+		std::vector<EBI::TriggerEvent>& evTrigger,
+		uint64_t& timeStamp,
+		EBI::EventCameraSpecs& camSpecs,
+		const uint64_t nStartTime,
+		const uint64_t nDuration,
+		const uint64_t nMaxEventCount,
+		const EBI::RawDecodeParams& decParams,
+		EBI::EventLoadStats& stats,
+		const EBI::EventFilter& filter,
+		const bool bDebugMessages);
+
+	bool ScanTriggers(const std::string& fname,
+		std::vector<EBI::TriggerEvent>& evTrigger,
+		std::vector<EBI::TimeSegment>& triggerSegments,
+		std::vector<uint32_t>& eventRate,
+		uint64_t& timeStamp,
+		EBI::EventCameraSpecs& camSpecs,
+		const EBI::RawDecodeParams& decParams = EBI::RawDecodeParams(),
+		const bool bDebugMessages = false);
+
+	uint64_t DecodeRawEvt3Words(const uint8_t* pData,
+		const uint64_t nWords,
+		EBI::Evt3DecoderState& state,
+		std::vector<EBI::Event>& evData,
+		std::vector<EBI::TriggerEvent>& evTrigger,
+		uint64_t& timeStamp,
+		const EBI::RawVectorKernel vecKernel);
+
+	EBI::RawVectorKernel GetRawVectorKernel(const EBI::RawVectorKernel vecKernel);
+
+} // namespace EBI
+
+#endif /* _EBI_RAWEVT3_H__INCLUDED_ */
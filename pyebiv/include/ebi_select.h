@@ -0,0 +1,129 @@
+#ifndef _EBI_SELECT_H__INCLUDED_
+#define _EBI_SELECT_H__INCLUDED_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include "ebi_structs.h"
+
+namespace EBI {
+
+	static constexpr size_t SELECT_BLOCK = 4096;	//!< events tested per pass, the mask stays in L1 cache
+	static constexpr size_t MASK_GROUP = 16;		//!< events per group of fixed size, vectorized even at -O2
+
+	/*!
+	Selection of events by time window, ROI and polarity, used by EBI::EventColumns and
+	EBI::PackedEventData. An event is kept if t - tMin <= tSpan, x - x0 < w and y - y0 < h,
+	all compared unsigned, so each test is a single comparison.
+	Mask loops should work on a local copy, so that the members are not reloaded
+	after each store to the mask.
+	*/
+	struct EventSelection
+	{
+		uint32_t tMin, tSpan;	//!< time window [tMin, tMin + tSpan]
+		uint32_t tSub;			//!< subtracted from time of kept events
+		int32_t x0, y0;			//!< top-left of ROI, subtracted from coordinates of kept events
+		uint32_t w, h;			//!< size of ROI
+		uint8_t keepNeg, keepPos;	//!< 1 to keep events of that polarity
+		bool bNone;				//!< empty time window, nothing is kept
+
+		EventSelection()
+		{
+			tMin = 0;
+			tSpan = UINT32_MAX;
+			tSub = 0;
+			x0 = y0 = 0;
+			w = h = UINT32_MAX;
+			keepNeg = keepPos = 1;
+			bNone = false;
+		}
+
+		void setPolarity(const EBI::EventPolarity polMode)
+		{
+			keepNeg = (polMode != EBI::PolarityPositive) ? 1 : 0;
+			keepPos = (polMode != EBI::PolarityNegative) ? 1 : 0;
+		}
+
+		//! time window [t1, t2], or [t1, t2) if \a bOpenEnd
+		void setTime(const uint32_t t1, const uint32_t t2, const bool bOpenEnd)
+		{
+			tMin = t1;
+			if ((t2 < t1) || (bOpenEnd && (t2 == t1)))
+				bNone = true;
+			else
+				tSpan = t2 - t1 - (bOpenEnd ? 1 : 0);
+		}
+
+		void setROI(const int32_t x, const int32_t y, const int32_t wIN, const int32_t hIN)
+		{
+			x0 = x;
+			y0 = y;
+			w = (wIN > 0) ? static_cast<uint32_t>(wIN) : 0;
+			h = (hIN > 0) ? static_cast<uint32_t>(hIN) : 0;
+		}
+
+		//! 1 if an event at time \a t and \a x, \a y of positive polarity \a bPos is kept, 0 otherwise
+		uint8_t keeps(const uint32_t t, const uint16_t x, const uint16_t y, const bool bPos) const
+		{
+			const uint8_t inT = (t - tMin <= tSpan) ? 1 : 0;
+			const uint8_t inX = (static_cast<uint32_t>(x - x0) < w) ? 1 : 0;
+			const uint8_t inY = (static_cast<uint32_t>(y - y0) < h) ? 1 : 0;
+			const uint8_t inP = bPos ? keepPos : keepNeg;
+			return inT & inX & inY & inP;
+		}
+	};
+
+	//! number of events marked in \a mask
+	inline size_t CountMask(const uint8_t* __restrict mask, const size_t n)
+	{
+		size_t nSel = 0;
+		size_t i = 0;
+		for (; i + MASK_GROUP <= n; i += MASK_GROUP) {
+			uint8_t nGroup = 0;
+			for (size_t j = i; j < i + MASK_GROUP; j++)
+				nGroup += mask[j];
+			nSel += nGroup;
+		}
+		for (; i < n; i++)
+			nSel += mask[i];
+		return nSel;
+	}
+
+	/*!
+	Select from \a nSrc events in blocks of SELECT_BLOCK: \a markBlock(nFirst, n, mask) marks
+	the kept events of the block starting at \a nFirst, \a storeBlock(nFirst, n, nSel, nOut, mask)
+	stores the \a nSel marked events behind the first \a nOut of the output and returns their number.
+	\return number of events in the output, starting from \a nOut
+	*/
+	template <class MarkFn, class StoreFn>
+	size_t SelectBlocks(const size_t nSrc, size_t nOut, std::vector<uint8_t>& mask, MarkFn markBlock, StoreFn storeBlock)
+	{
+		mask.resize(SELECT_BLOCK);
+		for (size_t nFirst = 0; nFirst < nSrc; nFirst += SELECT_BLOCK) {
+			const size_t n = std::min(SELECT_BLOCK, nSrc - nFirst);
+			markBlock(nFirst, n, mask.data());
+			const size_t nSel = CountMask(mask.data(), n);
+			if (nSel > 0)
+				nOut += storeBlock(nFirst, n, nSel, nOut, mask.data());
+		}
+		return nOut;
+	}
+
+	//! limit ROI of \a roi to an image of \a imgW x \a imgH as EventData::cropROI(), \return false if invalid
+	inline bool ClipSelectionROI(EBI::EventFilter& roi, const int32_t imgW, const int32_t imgH)
+	{
+		if (roi.clipROI(imgW, imgH))
+			return true;
+		std::cerr << "ERROR: invalid ROI: X=" << roi.roiX << " Y=" << roi.roiY
+			<< " W=" << roi.roiW << " H=" << roi.roiH
+			<< "  image size: " << imgW << "(W) x " << imgH << "(H)"
+			<< std::endl;
+		return false;
+	}
+
+} // namespace EBI
+
+#endif /* _EBI_SELECT_H__INCLUDED_ */
@@ -0,0 +1,118 @@
+#ifndef _EBI_STREAM_H__INCLUDED_
+#define _EBI_STREAM_H__INCLUDED_
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+
+#include "ebi_structs.h"
+#include "ebi_data.h"
+#include "ebi_rawevt3.h"
+
+namespace EBI {
+
+	/*!
+	Sequential reader of a Metavision RAW or EVT file that returns the events
+	in batches of fixed duration or fixed count. The file is read in blocks,
+	so memory use only depends on the batch size, not on the recording length.
+
+	Usage:
+		EBI::EventStream stream;
+		stream.setBatchDuration(10000);
+		if (stream.open("recording.raw")) {
+			while (stream.next()) {
+				const std::vector<EBI::Event>& ev = stream.events();
+				...
+			}
+		}
+	*/
+	class EventStream
+	{
+	public:
+		EventStream();
+		~EventStream();
+
+		bool open(const std::string& fnameEvents,
+			const uint32_t offsetUSec = 0, const uint32_t durationUSec = 0);
+		void close();
+		bool isOpen() const { return m_eType != EBI::FILE_FORMAT_UNKNOWN; }
+
+		void setBatchDuration(const uint32_t durationUSec);
+		void setBatchSize(const uint64_t nEvents);
+		void setDecodeParams(const EBI::RawDecodeParams& decParams);
+		void setDebugLevel(const int32_t nLevel);
+
+		bool next();
+		bool next(EBI::EventData& evData);
+
+		//! events of the current batch, times are relative to the first event in the file and to their time segment
+		const std::vector<EBI::Event>& events() const { return m_batch; }
+		const std::vector<EBI::TriggerEvent>& triggerEvents() const { return m_batchTrigger; }
+		//! time segments of the current batch, empty if all its times fit into 32 bits, see EBI::TimeSegment
+		const std::vector<EBI::TimeSegment>& timeSegments() const { return m_batchSegments; }
+		const std::vector<EBI::TimeSegment>& triggerSegments() const { return m_batchTriggerSegments; }
+		//! time of event \a i of the current batch relative to the first event in the file in [usec]
+		uint64_t eventTime(const size_t i) const { return EBI::SegmentBase(m_batchSegments, i) + m_batch[i].t; }
+		uint64_t batchStartTime() const { return m_batchStart; }	//!< in [usec]
+		uint64_t batchEndTime() const { return m_batchEnd; }		//!< in [usec], first time after the batch
+		uint64_t batchIndex() const { return m_nBatch; }			//!< number of current batch, starting at 1
+
+		int32_t imageWidth() const { return static_cast<int32_t>(m_camSpecs.sensorW); }
+		int32_t imageHeight() const { return static_cast<int32_t>(m_camSpecs.sensorH); }
+		uint64_t timeStamp() const { return m_timeStamp; }
+
+	private:
+		bool fillBatch(std::vector<EBI::Event>& evBatch, std::vector<EBI::TriggerEvent>& evTrigger,
+			std::vector<EBI::TimeSegment>& evSegments, std::vector<EBI::TimeSegment>& triggerSegments);
+		bool refill();
+		bool readEvtBlock();
+		uint64_t pendingTime(const size_t i) const { return EBI::SegmentBase(m_pendingSegments, i) + m_pending[i].t; }
+		uint64_t pendingTriggerTime(const size_t i) const
+		{
+			return EBI::SegmentBase(m_pendingTriggerSegments, i) + m_pendingTrigger[i].t;
+		}
+
+		EBI::FileFormat m_eType;
+		EBI::RawEventReader m_rawReader;
+		std::ifstream m_evtFile;
+		std::vector<uint8_t> m_evtBuffer;	//!< packed events of the current block of an EVT file
+		std::vector<uint8_t> m_evtCoded;	//!< current compressed block of an EVTZ file
+		std::vector<uint32_t> m_evtBlockBytes;	//!< sizes of the compressed blocks of an EVTZ file, empty for other files
+		size_t m_nEvtBlock;			//!< next entry of m_evtBlockBytes
+		std::vector<EBI::TimeSegment> m_evtSegments;	//!< time segments of an EVT file
+		size_t m_nEvtSegment;		//!< next entry of m_evtSegments
+		uint64_t m_evtTimeBase;		//!< start of the time segment of the next event of an EVT file
+		uint64_t m_nEvtIndex;		//!< index of the next event of an EVT file
+		uint64_t m_nEvtLeft;		//!< events of an EVT file not read yet
+		EBI::RawDecodeParams m_decodeParams;
+		EBI::EventCameraSpecs m_camSpecs;
+		uint64_t m_timeStamp;
+		int32_t m_nDebugLevel;
+
+		uint32_t m_batchDuration;	//!< duration of batches in [usec], 0 if batches have a fixed count
+		uint64_t m_batchSize;		//!< events per batch if m_batchDuration is 0
+		uint64_t m_startTime;		//!< start of the requested time window
+		uint64_t m_nextStart;		//!< start time of the next batch
+		uint64_t m_endTime;			//!< end of the requested time window
+		bool m_bSourceEnd;			//!< all events of the time window are in the pending buffers
+
+		// events read from file, not yet returned in a batch
+		std::vector<EBI::Event> m_pending;
+		std::vector<EBI::TriggerEvent> m_pendingTrigger;
+		std::vector<EBI::TimeSegment> m_pendingSegments;	//!< time segments of m_pending
+		std::vector<EBI::TimeSegment> m_pendingTriggerSegments;	//!< time segments of m_pendingTrigger
+		size_t m_nPendingPos;
+		size_t m_nPendingTriggerPos;
+
+		std::vector<EBI::Event> m_batch;
+		std::vector<EBI::TriggerEvent> m_batchTrigger;
+		std::vector<EBI::TimeSegment> m_batchSegments;
+		std::vector<EBI::TimeSegment> m_batchTriggerSegments;
+		uint64_t m_batchStart;
+		uint64_t m_batchEnd;
+		uint64_t m_nBatch;
+	};
+} // namespace EBI
+
+#endif /* _EBI_STREAM_H__INCLUDED_ */
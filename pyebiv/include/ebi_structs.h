@@ -24,6 +24,24 @@ namespace EBI {
 		FILE_FORMAT_TIFF = 2,
 		FILE_FORMAT_ASCII = 3,
 		FILE_FORMAT_NETCDF = 4,
+		FILE_FORMAT_EVT4 = 5,		// own event format in blocks with time index
+		FILE_FORMAT_EVTZ = 6,		// own event format in compressed blocks with time index
+		FILE_FORMAT_EVTT = 7,		// own event format in image tiles and time blocks, see EBI::TiledEventData
+	};
+	enum RawDecodeMode
+	{
+		RawDecodeStream = 0,	// buffered reads through std::ifstream
+		RawDecodeMapped = 1,	// decode directly from memory-mapped file, falls back to stream
+		RawDecodeParallel = 2,	// memory-mapped file decoded in chunks on several threads
+		RawDecodePipelined = 3,	// stream read on an I/O thread while the previous buffer is decoded
+	};
+	enum RawVectorKernel
+	{
+		RawVectorAuto = -1,		// fastest kernel supported by the CPU
+		RawVectorBitwise = 0,	// test every bit of the mask, one push_back per event
+		RawVectorScalar = 1,	// bit scan, writes into preallocated storage
+		RawVectorSSE2 = 2,		// groups of 4 events from a table of bit positions
+		RawVectorAVX2 = 3,		// groups of 8 events from a table of bit positions
 	};
 
 	enum ErrorCode
@@ -53,7 +71,7 @@ namespace EBI {
 	Single event
 	*/
 	struct Event {
-		uint32_t t;	//!< time in [usec]
+		uint32_t t;	//!< time in [usec], offset within its EBI::TimeSegment
 		uint16_t x;	//!< pixel coordinate X
 		uint16_t y;	//!< pixel coordinate Y
 		int8_t	p;	//!< polarity [+,-]
@@ -75,11 +93,60 @@ namespace EBI {
 		}
 	};
 
+	static constexpr uint64_t TIME_SEGMENT_USEC = 1ULL << 32;	//!< length of a time segment in [usec], about 71.6 minutes
+
+	/*!
+	Start of a time segment of a data set. Event times are stored as 32-bit offsets
+	within their segment, the time of an event relative to the first event of the
+	recording is \a tBase + \a t. Segments start at multiples of EBI::TIME_SEGMENT_USEC,
+	so \a t holds the lower 32 bits of the time. Events before the first segment
+	of a list have \a tBase = 0, see EventData::timeSegments().
+	*/
+	struct TimeSegment
+	{
+		uint64_t tBase;		//!< time of start of segment in [usec]
+		uint64_t iFirst;	//!< index of first event of segment
+
+		TimeSegment() : tBase(0), iFirst(0) {}
+		TimeSegment(const uint64_t tBaseIN, const uint64_t iFirstIN) : tBase(tBaseIN), iFirst(iFirstIN) {}
+	};
+
+	static constexpr uint32_t PACKED_TIME_MAX = 0x7FFFFFFF;	//!< latest time of EBI::PackedEvent in [usec], about 35 minutes
+
+	/*!
+	Single event packed into 8 bytes, same layout as in the library's own event files:
+	time in the upper 31 bits of \a timePol, polarity in the lowest bit
+	*/
+	struct PackedEvent {
+		uint16_t x;	//!< pixel coordinate X
+		uint16_t y;	//!< pixel coordinate Y
+		uint32_t timePol;	//!< time in [usec] << 1 | polarity
+
+		void init()
+		{
+			x = y = 0;
+			timePol = 0;
+		}
+		PackedEvent() { init(); }
+
+		PackedEvent(uint16_t px, uint16_t py, int8_t pol, uint32_t tim)
+		{
+			x = px;
+			y = py;
+			timePol = (tim << 1) | ((pol != 0) ? 1 : 0);
+		}
+		PackedEvent(const EBI::Event& ev) : PackedEvent(ev.x, ev.y, ev.p, ev.t) {}
+
+		uint32_t t() const { return timePol >> 1; }	//!< time in [usec]
+		int8_t p() const { return static_cast<int8_t>(timePol & 0x1); }	//!< polarity [0,1]
+		EBI::Event event() const { return EBI::Event(x, y, p(), t()); }
+	};
+
 	/*!
 	Single trigger event
 	*/
 	struct TriggerEvent {
-		uint32_t t;	//!< time in [usec]
+		uint32_t t;	//!< time in [usec], offset within its EBI::TimeSegment
 		int8_t	v;	//!< value
 		int8_t	id;	//!< trigger type
 
@@ -127,6 +194,120 @@ namespace EBI {
 		EventCameraSpecs() { init(); }
 	};
 
+	/*!
+	Options for decoding Metavision RAW files
+	*/
+	struct RawDecodeParams
+	{
+		RawDecodeMode decMode;	//!< how the raw data is transferred to the decoder
+		int32_t nThreads;		//!< number of decoding threads for RawDecodeParallel, 0 for all cores
+		RawVectorKernel vecKernel;	//!< expansion of VECT_12/VECT_8 validity masks into events
+		uint32_t indexInterval;	//!< time between entries of the index file <file>.ebidx in [usec], 0 to always decode from start
+		uint32_t nBufferWords;	//!< size of each read buffer of RawDecodePipelined in 16-bit words
+		uint32_t nQueueDepth;	//!< number of read buffers of RawDecodePipelined
+
+		void init() {
+			decMode = RawDecodeStream;
+			nThreads = 0;
+			vecKernel = RawVectorAuto;
+			indexInterval = 100000;
+			nBufferWords = 1000000;
+			nQueueDepth = 4;
+		}
+		RawDecodeParams() { init(); }
+	};
+
+	/*!
+	Selection of events applied while loading, see EventData::load()
+	*/
+	struct EventFilter
+	{
+		int32_t roiX,		//!< left edge of region of interest [pixel]
+			roiY,			//!< top edge of region of interest [pixel]
+			roiW,			//!< width of region of interest, 0 for entire detector
+			roiH;			//!< height of region of interest, 0 for entire detector
+		EventPolarity evPol;	//!< polarity of events to keep
+		uint64_t offsetUSec;	//!< start of time window relative to first event [usec]
+		uint32_t durationUSec;	//!< length of time window [usec], 0 until end of file
+
+		void init() {
+			roiX = roiY = 0;
+			roiW = roiH = 0;
+			evPol = PolarityBoth;
+			offsetUSec = 0;
+			durationUSec = 0;
+		}
+		EventFilter() { init(); }
+
+		bool hasROI() const { return (roiW > 0) && (roiH > 0); }
+
+		//! limit ROI to detector size \a imgW x \a imgH, same as EventData::cropROI()
+		//! \return false if the remaining ROI is too small
+		bool clipROI(const int32_t imgW, const int32_t imgH)
+		{
+			if (!hasROI())
+				return true;
+			if (roiX < 0)
+				roiX = 0;
+			if (roiY < 0)
+				roiY = 0;
+			if (roiX + roiW > imgW)
+				roiW = imgW - roiX;
+			if (roiY + roiH > imgH)
+				roiH = imgH - roiY;
+			return (roiW >= 4) && (roiH >= 4);
+		}
+		//! true if events of polarity \a p are kept
+		bool hasPolarity(const int8_t p) const
+		{
+			return (evPol == PolarityBoth) || ((p > 0) == (evPol == PolarityPositive));
+		}
+	};
+
+	/*!
+	Spatio-temporal sub-volume of events, see EventData::getSamples()
+	*/
+	struct SampleWindow
+	{
+		int32_t x, y;	//!< top-left of window [pixel]
+		int32_t w, h;	//!< size of window [pixel]
+		int64_t t0;		//!< start of window [usec]
+		int32_t dur;	//!< duration of window [usec], 0 for all times
+
+		void init() {
+			x = y = 0;
+			w = h = 0;
+			t0 = dur = 0;
+		}
+		SampleWindow() { init(); }
+		SampleWindow(const int32_t xIN, const int32_t yIN, const int32_t wIN, const int32_t hIN,
+			const int64_t t0IN = 0, const int32_t durIN = 0)
+			: x(xIN), y(yIN), w(wIN), h(hIN), t0(t0IN), dur(durIN) {}
+	};
+
+	/*!
+	Statistics of the last load of an event file, see EventData::loadStats()
+	*/
+	struct EventLoadStats
+	{
+		uint64_t nEvents;			//!< number of events loaded
+		uint64_t nTriggerEvents;	//!< number of trigger events loaded
+		uint64_t nBadTiming;		//!< events with time before their predecessor or after the last event
+		uint64_t nTimeRepaired;		//!< events after the last event, their time was set to the time of the predecessor
+		uint64_t nOutOfBounds;		//!< events and rows with coordinates beyond the detector, wrapped into the detector
+		bool bFirstEventRepaired;	//!< time of first event was after the last event and set to 0
+		bool bTruncated;			//!< loading stopped at the latest time the data set can hold, see EBI::EventColumns and EBI::PackedEventData
+
+		void init() {
+			nEvents = nTriggerEvents = 0;
+			nBadTiming = nTimeRepaired = 0;
+			nOutOfBounds = 0;
+			bFirstEventRepaired = false;
+			bTruncated = false;
+		}
+		EventLoadStats() { init(); }
+	};
+
 	struct EventFlowEvalParams
 	{
 		ProcessingMode procMode;	//!< method to use to retrieve optical flow
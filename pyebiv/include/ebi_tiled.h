@@ -0,0 +1,109 @@
+#ifndef _EBI_TILED_H__INCLUDED_
+#define _EBI_TILED_H__INCLUDED_
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <atomic>
+
+#include "ebi_structs.h"
+#include "ebi_file.h"
+
+namespace EBI {
+
+	/*!
+	Event file in image tiles and time blocks (FILE_FORMAT_EVTT), as written by
+	EventData::saveTiled() for the grid of an EBI::EventFlowEvalParams.
+	The file is mapped to memory and queries touch only the blocks of the tiles and time
+	blocks they overlap, so samples of different windows read disjoint parts of the file.
+	Queries do not modify the instance and may run on several threads at once.
+	Times are 64-bit relative to the start of the saved range, as EventData::eventTime().
+
+	Usage:
+		EBI::EventFlowEvalParams params;
+		params.imgW = evData.imageWidth();
+		params.imgH = evData.imageHeight();
+		evData.saveTiled("recording.evtt", params);
+
+		EBI::TiledEventData evTiled;
+		if (evTiled.open("recording.evtt")) {
+			std::vector<EBI::SampleWindow> windows = EBI::FlowSampleWindows(params, 0, evTiled.duration());
+			std::vector<std::vector<EBI::Event> > samples = evTiled.getSamples(windows);
+			...
+		}
+	*/
+	class TiledEventData
+	{
+	public:
+		TiledEventData();
+		~TiledEventData();
+
+		bool open(const std::string& fnameEvents);
+		void close();
+		bool isOpen() const { return m_file.isOpen(); }
+
+		std::vector<uint32_t> tiles(
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h) const;
+		std::vector<EBI::Event> getTiles(
+			const std::vector<uint32_t>& tiles,
+			const int64_t t0 = 0, const int32_t dur = 0) const;
+		std::vector<EBI::Event> getSample(
+			const int32_t x, const int32_t y,
+			const int32_t w, const int32_t h,
+			const int64_t t0 = 0, const int32_t dur = 0) const;
+		std::vector<std::vector<EBI::Event> > getSamples(
+			const std::vector<EBI::SampleWindow>& windows) const;
+
+		uint64_t size() const { return m_nEvents; }
+		bool empty() const { return m_nEvents == 0; }
+		uint64_t duration() const { return m_duration; }	//!< duration stored in the file in [usec]
+		int32_t imageWidth() const { return static_cast<int32_t>(m_camSpecs.sensorW); }
+		int32_t imageHeight() const { return static_cast<int32_t>(m_camSpecs.sensorH); }
+		uint64_t timeStamp() const { return m_timeStamp; }
+		int32_t tileWidth() const { return static_cast<int32_t>(m_tileW); }
+		int32_t tileHeight() const { return static_cast<int32_t>(m_tileH); }
+		int32_t tilesX() const { return static_cast<int32_t>(m_tilesX); }
+		int32_t tilesY() const { return static_cast<int32_t>(m_tilesY); }
+		uint32_t blockDuration() const { return m_blockUSec; }
+		size_t blockCount() const { return m_blocks.size(); }
+		uint64_t bytesRead() const { return m_nBytesRead; }	//!< bytes of the blocks touched by queries since open()
+
+		void setThreadCount(const int32_t nThreads) { m_nThreads = nThreads; }	//!< threads of getSamples(), 0 for all cores
+		int32_t threadCount() const { return m_nThreads; }
+		void setDebugLevel(const int32_t nLevel) { m_nDebugLevel = nLevel; }
+
+	private:
+		TiledEventData(const TiledEventData&) = delete;
+		TiledEventData& operator=(const TiledEventData&) = delete;
+
+		void select(const std::vector<uint32_t>& tiles, const uint64_t tSel1, const uint64_t tSel2,
+			const int32_t x1, const int32_t y1, const int32_t x2, const int32_t y2,
+			const uint64_t tOffset, std::vector<EBI::Event>& events) const;
+
+		struct BlockEntry
+		{
+			uint64_t offset;	//!< byte offset of the columns of the block in the file
+			uint64_t firstEvent;	//!< number of the first event of the block in the file
+			uint64_t timeFirst;	//!< earliest time of the block, times of its events are relative to it
+			uint64_t timeLast;	//!< latest time of the block
+			uint32_t nEvents;	//!< number of events of the block
+		};
+
+		EBI::MappedFile m_file;
+		std::vector<BlockEntry> m_blocks;	//!< grouped by tile, by time block within each tile
+		std::vector<uint32_t> m_tileFirst;	//!< first block of each tile, followed by the number of blocks
+		uint32_t m_tileW, m_tileH;
+		uint32_t m_tilesX, m_tilesY;
+		uint32_t m_blockUSec;		//!< duration of each time block in [usec]
+		uint64_t m_nEvents;
+		uint64_t m_duration;
+		EBI::EventCameraSpecs m_camSpecs;
+		uint64_t m_timeStamp;
+		mutable std::atomic<uint64_t> m_nBytesRead;
+		int32_t m_nThreads;
+		int32_t m_nDebugLevel;
+	};
+} // namespace EBI
+
+#endif /* _EBI_TILED_H__INCLUDED_ */
@@ -76,12 +76,12 @@ rem Compile C++ files
 FOR %%F IN (pyebiv_wrap pyebiv) do (
    %CXX% -c %CXXFLAGS% %DEFINES% %INCPATH% -Fo%OUTDIR%\%%F.obj %%F.cpp
 )
-FOR %%F IN (ebi_events ebi_image ebi_utils) do (
+FOR %%F IN (ebi_events ebi_rawevt3 ebi_stream ebi_columns ebi_packed ebi_paged ebi_evtcodec ebi_tiled ebi_image ebi_utils) do (
    %CXX% -c %CXXFLAGS% %DEFINES% %INCPATH% -Fo%OUTDIR%\%%F.obj %LIBSRC%\%%F.cpp
 )
 
 rem call Linker
-set OBJECTS=.\x64\obj\pyebiv.obj .\x64\obj\pyebiv_wrap.obj .\x64\obj\ebi_events.obj .\x64\obj\ebi_image.obj .\x64\obj\ebi_utils.obj
+set OBJECTS=.\x64\obj\pyebiv.obj .\x64\obj\pyebiv_wrap.obj .\x64\obj\ebi_events.obj .\x64\obj\ebi_rawevt3.obj .\x64\obj\ebi_stream.obj .\x64\obj\ebi_columns.obj .\x64\obj\ebi_packed.obj .\x64\obj\ebi_paged.obj .\x64\obj\ebi_evtcodec.obj .\x64\obj\ebi_tiled.obj .\x64\obj\ebi_image.obj .\x64\obj\ebi_utils.obj
 %LINKER% %LFLAGS% /MANIFEST:embed /OUT:%OUTDLL% %OBJECTS% %LIBS%
  
 rem convert/copy to python lib
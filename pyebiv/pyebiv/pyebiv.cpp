@@ -9,6 +9,7 @@
 
 #include "ebi.h"
 #include "ebi_image.h"
+#include "ebi_rawevt3.h"
 
 #include <errno.h>
 #include <string>
@@ -115,6 +116,33 @@ void EBIV::setDebugLevel(const int32_t nLevel)
 	std::cout << "pyEBIV: debugging set to level " << m_nDebugLevel << std::endl;
 }
 
+/*!
+Select how RAW files are read by subsequent calls to loadRaw()
+[0] buffered stream, [1] memory-mapped file, [2] parallel decoding of memory-mapped file,
+[3] buffered stream read on a separate thread while decoding
+*/
+void EBIV::setDecodeMode(const int32_t nMode)
+{
+	EBI::RawDecodeParams decParams = m_evData.decodeParams();
+	decParams.decMode = static_cast<EBI::RawDecodeMode>(nMode);
+	m_evData.setDecodeParams(decParams);
+	if (m_nDebugLevel > 0)
+		std::cout << "pyEBIV: raw decoding mode set to " << nMode << std::endl;
+}
+
+/*!
+Number of threads for parallel RAW decoding and for selecting events, 0 for all cores
+*/
+void EBIV::setThreadCount(const int32_t nThreads)
+{
+	EBI::RawDecodeParams decParams = m_evData.decodeParams();
+	decParams.nThreads = nThreads;
+	m_evData.setDecodeParams(decParams);
+	m_evData.setThreadCount(nThreads);
+	if (m_nDebugLevel > 0)
+		std::cout << "pyEBIV: number of threads set to " << nThreads << std::endl;
+}
+
 void EBIV::init()
 {
 	m_nImgWidth = m_nImgHeight = 0;
@@ -134,7 +162,7 @@ bool EBIV::isNull()
 
 int64_t EBIV::eventCount() 
 {
-	return static_cast<int64_t>(m_evData.data().size());
+	return static_cast<int64_t>(m_evData.size());
 }
 
 int64_t EBIV::timeStamp()
@@ -143,9 +171,13 @@ int64_t EBIV::timeStamp()
 }
 
 
-bool EBIV::save(const std::string& strFileName, const uint32_t t0, const uint32_t duration)
+bool EBIV::save(const std::string& strFileName, const uint64_t t0, const uint32_t duration, const int32_t version, const bool compress)
 {
-	if (m_evData.save(strFileName, t0, duration)) {
+	// version 4 writes the events in blocks with a time index, see EBI::FILE_FORMAT_EVT4,
+	// compress codes these blocks losslessly, see EBI::FILE_FORMAT_EVTZ
+	const EBI::FileFormat eFormat = compress ? EBI::FILE_FORMAT_EVTZ
+		: ((version == 4) ? EBI::FILE_FORMAT_EVT4 : EBI::FILE_FORMAT_EVT3);
+	if (m_evData.save(strFileName, t0, duration, eFormat)) {
 		if (m_nDebugLevel > 0)
 			std::cout << "Event data stored in " << strFileName.c_str() << std::endl;
 		return true;
@@ -155,17 +187,24 @@ bool EBIV::save(const std::string& strFileName, const uint32_t t0, const uint32_
 }
 
 
-bool EBIV::loadRaw(const std::string& strFileName)
+/*!
+Load events from RAW file, optionally only the time window [t0, t0 + duration] in [usec]
+relative to the first event.
+Windows of RAW files are read using an index file that is created next to the RAW file on first use.
+Own EVT files are accepted as well, with the same window.
+*/
+bool EBIV::loadRaw(const std::string& strFileName, const uint64_t t0, const uint32_t duration)
 {
 	if(m_nDebugLevel > 0)
 		std::cout << "loading event data from: " << strFileName << std::endl;
 
-	if(!m_evData.load(strFileName))
+	if(!m_evData.load(strFileName, t0, duration))
 		return false;
 
-	if (m_nDebugLevel > 0) {
-		std::cout << "Current number of events in file: " << (m_evData.data().size()) << std::endl;
-		double msecs = static_cast<double>(m_evData.data()[m_evData.data().size() - 1].t - m_evData.data()[0].t) / 1000;
+	if ((m_nDebugLevel > 0) && !m_evData.empty()) {
+		const EBI::EventData& evData = m_evData;
+		std::cout << "Current number of events in file: " << (evData.size()) << std::endl;
+		double msecs = static_cast<double>(evData.dataRef().back().t - evData.dataRef().front().t) / 1000;
 		std::cout << "duration: " << msecs << " millisec\n";
 	}
 
@@ -174,6 +213,43 @@ bool EBIV::loadRaw(const std::string& strFileName)
 	return false;
 }
 
+/*!
+Read only the trigger events of a RAW file, without loading its events.
+The number of events per second is available from eventRate() afterwards.
+Loaded event data is not changed.
+\return trigger events as int vector of length N*3 grouped as (t,value,id)
+*/
+std::vector<int32_t> EBIV::scanTriggers(const std::string& strFileName)
+{
+	std::vector<int32_t> v;
+	std::vector<EBI::TriggerEvent> evTrigger;
+	std::vector<EBI::TimeSegment> triggerSegments;	// the int32 times of the result wrap, as all int32 times returned to Python
+	uint64_t timeStamp = 0;
+	EBI::EventCameraSpecs camSpecs;
+	if (!EBI::ScanTriggers(strFileName, evTrigger, triggerSegments, m_eventRate, timeStamp, camSpecs,
+		m_evData.decodeParams(), m_nDebugLevel > 0))
+		return v;
+
+	v.resize(evTrigger.size() * 3);
+	size_t ii = 0;
+	for (const EBI::TriggerEvent& ev : evTrigger) {
+		v[ii++] = static_cast<int32_t>(ev.t);
+		v[ii++] = ev.v;
+		v[ii++] = ev.id;
+	}
+	if (m_nDebugLevel > 0)
+		std::cout << "pyEBIV: " << evTrigger.size() << " trigger events in " << m_eventRate.size() << " seconds" << std::endl;
+	return v;
+}
+
+/*!
+* \return number of events in each second of the file of the last call to scanTriggers()
+*/
+std::vector<int32_t> EBIV::eventRate()
+{
+	return std::vector<int32_t>(m_eventRate.begin(), m_eventRate.end());
+}
+
 //bool EBIV::fromNumpy(double* npyArray2D, int npyLength1D, int npyLength2D)
 //{
 //	//if (!alloc(npyLength2D, npyLength1D))
@@ -219,11 +295,38 @@ std::vector<int32_t> EBIV::events()
 	if (m_evData.isNull())
 		return v;
 
-	size_t N = m_evData.data().size();
+	const EBI::EventData& evData = m_evData;	// read access, keeps the indexes
+	size_t N = evData.size();
 	v.resize(N*4);
 	size_t ii = 0;
 	for (size_t i = 0; i < N; i++) {
-		EBI::Event ev = m_evData.dataRef()[i];
+		EBI::Event ev = evData.dataRef()[i];
+		v[ii++] = ev.t;
+		v[ii++] = ev.x;
+		v[ii++] = ev.y;
+		v[ii++] = ev.p;
+	}
+	return v;
+}
+
+/*!
+* Events in region (x,y,w,h) and time window [t0, t0+duration), relative to (x,y,t0),
+* found through a tile index of the events, built on first call
+* \return list of (t,x,y,p)
+*/
+std::vector<int32_t> EBIV::sample(const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+	const int64_t t0, const int32_t duration)
+{
+	std::vector<int32_t> v;
+	if (m_evData.isNull())
+		return v;
+	if (m_evData.tileSize() == 0)
+		m_evData.setTileSize(32);
+
+	std::vector<EBI::Event> events = m_evData.getSample(x, y, w, h, t0, duration);
+	v.resize(events.size() * 4);
+	size_t ii = 0;
+	for (const EBI::Event& ev : events) {
 		v[ii++] = ev.t;
 		v[ii++] = ev.x;
 		v[ii++] = ev.y;
@@ -241,10 +344,11 @@ std::vector<int32_t> EBIV::time()
 	if (m_evData.isNull())
 		return v;
 
-	size_t N = m_evData.dataRef().size();
+	const EBI::EventData& evData = m_evData;	// read access, keeps the indexes
+	size_t N = evData.size();
 	v.resize(N);
 	for (size_t i = 0; i < N; i++) {
-		v[i] = m_evData.dataRef()[i].t;
+		v[i] = evData.dataRef()[i].t;
 	}
 	//std::cout << "copying event times: " << (n) << std::endl;
 	return v;
@@ -259,10 +363,11 @@ std::vector<int32_t> EBIV::x()
 	std::vector<int32_t> v;
 	if (m_evData.isNull())
 		return v;
-	size_t N = m_evData.dataRef().size();
+	const EBI::EventData& evData = m_evData;	// read access, keeps the indexes
+	size_t N = evData.size();
 	v.resize(N);
 	for (size_t i = 0; i < N; i++) {
-		v[i] = m_evData.dataRef()[i].x;
+		v[i] = evData.dataRef()[i].x;
 	}
 	return v;
 }
@@ -276,10 +381,11 @@ std::vector<int32_t> EBIV::y()
 	std::vector<int32_t> v;
 	if (m_evData.isNull())
 		return v;
-	size_t N = m_evData.dataRef().size();
+	const EBI::EventData& evData = m_evData;	// read access, keeps the indexes
+	size_t N = evData.size();
 	v.resize(N);
 	for (size_t i = 0; i < N; i++) {
-		v[i] = m_evData.dataRef()[i].y;
+		v[i] = evData.dataRef()[i].y;
 	}
 	return v;
 }
@@ -293,10 +399,11 @@ std::vector<int32_t> EBIV::p()
 	std::vector<int32_t> v;
 	if (m_evData.isNull())
 		return v;
-	size_t N = m_evData.data().size();
+	const EBI::EventData& evData = m_evData;	// read access, keeps the indexes
+	size_t N = evData.size();
 	v.resize(N);
 	for (size_t i = 0; i < N; i++) {
-		v[i] = m_evData.dataRef()[i].p;
+		v[i] = evData.dataRef()[i].p;
 	}
 	return v;
 }
@@ -325,9 +432,9 @@ std::vector<float> EBIV::pseudoImage(
 			<< "  duration=" << duration 
 			<< "  polarity=" << int(evPol) << ")" 
 			<< std::endl;
-	EBI::EventData evSlab(m_evData, evPol, t0_usec, duration);
+	EBI::EventView evSlab(m_evData, evPol, t0_usec, duration);
 	// convert to pseudo-image
-	EBI::EventImage evImg(evSlab, evPol, 0, 0, 0, false);
+	EBI::EventImage evImg(evSlab, 0, false);
 	size_t N = evImg.width() * evImg.height();
 	v.resize(N);
 	//std::cout << "pseudoImage() - v resized to " << N << " elements" << std::endl;
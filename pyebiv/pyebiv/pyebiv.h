@@ -34,8 +34,10 @@ public:
 	EBIV(const std::string& strFileName);
 	//EBIV(double* npyArray2D, int npyLength1D, int npyLength2D);
 
-	bool loadRaw(const std::string& strFileName);
-	bool save(const std::string& strFileName, const uint32_t t0=0, const uint32_t duration=0);
+	bool loadRaw(const std::string& strFileName, const uint64_t t0=0, const uint32_t duration=0);
+	bool save(const std::string& strFileName, const uint64_t t0=0, const uint32_t duration=0, const int32_t version=3, const bool compress=false);
+	std::vector<int32_t> scanTriggers(const std::string& strFileName);
+	std::vector<int32_t> eventRate();
 
 	int width() const { return m_nImgWidth; }
 	int height() const { return m_nImgHeight; }
@@ -49,6 +51,8 @@ public:
 
 	//std::vector<EBI::Event> events(); // return event data as list
 	std::vector<int32_t> events(); // return event data as list of (t,x,y,p)
+	std::vector<int32_t> sample(const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+		const int64_t t0 = 0, const int32_t duration = 0); // events of sub-volume as list of (t,x,y,p)
 	std::vector<int32_t> time();
 	std::vector<int32_t> x();
 	std::vector<int32_t> y();
@@ -69,6 +73,8 @@ public:
 		const int32_t nStartPeriod);
 
 	void setDebugLevel(const int32_t nLevel);
+	void setDecodeMode(const int32_t nMode);
+	void setThreadCount(const int32_t nThreads);
 
 #ifdef PYBIND11
 	py::array_t<double> pseudoImagePyBind(const int32_t t0_usec, const int32_t duration, const int32_t polarity);
@@ -85,6 +91,7 @@ private:
 	int32_t m_nDebugLevel;
 
 	EBI::EventData m_evData;
+	std::vector<uint32_t> m_eventRate;	//!< events per second from last scanTriggers()
 };
 
 #endif // _PYEBIV_H_INCLUDED_
@@ -23,9 +23,13 @@ PYBIND11_MODULE(pyebiv, m) {
             .def(py::init<>())  // constructor
             .def(py::init<std::string const&>()) // constructor
             //.def_readwrite("aPublicMember", &EBIV::aPublicMember)
-            .def("loadRaw", &EBIV::loadRaw)
-            .def("save", &EBIV::save)
+            .def("loadRaw", &EBIV::loadRaw, py::arg("fname"), py::arg("t0") = 0, py::arg("duration") = 0)
+            .def("save", &EBIV::save, py::arg("fname"), py::arg("t0") = 0, py::arg("duration") = 0, py::arg("version") = 3, py::arg("compress") = false)
+            .def("scanTriggers", &EBIV::scanTriggers)
+            .def("eventRate", &EBIV::eventRate)
             .def("setDebugLevel", &EBIV::setDebugLevel)
+            .def("setDecodeMode", &EBIV::setDecodeMode)
+            .def("setThreadCount", &EBIV::setThreadCount)
             .def("width", &EBIV::width)
             .def("height", &EBIV::height)
             .def("eventCount", &EBIV::eventCount)
@@ -34,6 +38,7 @@ PYBIND11_MODULE(pyebiv, m) {
             .def("estimatePulseOffsetTime", &EBIV::estimatePulseOffsetTime)
             .def("pseudoImage", &EBIV::pseudoImage)
             .def("events", &EBIV::events)
+            .def("sample", &EBIV::sample, py::arg("x"), py::arg("y"), py::arg("w"), py::arg("h"), py::arg("t0") = 0, py::arg("duration") = 0)
             .def("sensorSize", &EBIV::sensorSize)
             .def("x", &EBIV::x)
             .def("y", &EBIV::y)
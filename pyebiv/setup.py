@@ -20,6 +20,13 @@ ext_modules = [
         "pyebiv",
         [
         "src/ebi_events.cpp",
+        "src/ebi_rawevt3.cpp",
+        "src/ebi_stream.cpp",
+        "src/ebi_columns.cpp",
+        "src/ebi_packed.cpp",
+        "src/ebi_paged.cpp",
+        "src/ebi_evtcodec.cpp",
+        "src/ebi_tiled.cpp",
         "src/ebi_image.cpp",
         "src/ebi_utils.cpp",
         "pyebiv/pyebiv.cpp",
@@ -0,0 +1,386 @@
+#include "ebi.h"
+#include "ebi_columns.h"
+#include "ebi_rawevt3.h"
+#include "ebi_select.h"
+#include <iostream>
+#include <algorithm>
+
+//! mark selected events of a block in \a mask, branch free so that the loop is vectorized
+static void _selectMask(const uint32_t* __restrict t, const uint16_t* __restrict x,
+	const uint16_t* __restrict y, const int8_t* __restrict p,
+	const size_t n, const EBI::EventSelection& sel, uint8_t* __restrict mask)
+{
+	const EBI::EventSelection s = sel;
+	size_t i = 0;
+	for (; i + EBI::MASK_GROUP <= n; i += EBI::MASK_GROUP) {
+		for (size_t j = i; j < i + EBI::MASK_GROUP; j++)
+			mask[j] = s.keeps(t[j], x[j], y[j], p[j] != 0);
+	}
+	for (; i < n; i++)
+		mask[i] = s.keeps(t[i], x[i], y[i], p[i] != 0);
+}
+
+/*!
+Store the \a nSel events of a block marked in \a mask at \a dT..., shifted by the selection offsets.
+If most events are selected, every event is written and the output position only
+advances for selected ones, so one element beyond the selected events must be writable.
+Output may overlap the input if it does not start behind it (compaction in place).
+\return number of events stored
+*/
+static size_t _compactBlock(const uint32_t* t, const uint16_t* x, const uint16_t* y, const int8_t* p,
+	const uint8_t* mask, const size_t n, const size_t nSel, const EBI::EventSelection& sel,
+	uint32_t* dT, uint16_t* dX, uint16_t* dY, int8_t* dP)
+{
+	const uint32_t tSub = sel.tSub;
+	const uint16_t x0 = static_cast<uint16_t>(sel.x0), y0 = static_cast<uint16_t>(sel.y0);
+	size_t k = 0;
+	if (4 * nSel < n) {
+		// sparse selection: branch mispredictions are cheaper than writing all events
+		for (size_t i = 0; i < n; i++) {
+			if (mask[i]) {
+				dT[k] = t[i] - tSub;
+				dX[k] = static_cast<uint16_t>(x[i] - x0);
+				dY[k] = static_cast<uint16_t>(y[i] - y0);
+				dP[k] = p[i];
+				k++;
+			}
+		}
+		return k;
+	}
+	for (size_t i = 0; i < n; i++) {
+		const uint32_t ti = t[i];
+		const uint16_t xi = x[i], yi = y[i];
+		const int8_t pi = p[i];
+		dT[k] = ti - tSub;
+		dX[k] = static_cast<uint16_t>(xi - x0);
+		dY[k] = static_cast<uint16_t>(yi - y0);
+		dP[k] = pi;
+		k += mask[i];
+	}
+	return k;
+}
+
+/*!
+Fill \a dst with the events of \a src selected by \a sel, \a dst may be \a src
+*/
+static void _selectColumns(const EBI::EventColumns& src, const EBI::EventSelection& sel,
+	EBI::EventColumns& dst, std::vector<uint8_t>& mask)
+{
+	const bool bInPlace = (&src == &dst);
+	const size_t nSrc = src.size();
+	if (!bInPlace)
+		dst.resize(0);
+	if (sel.bNone || (nSrc == 0)) {
+		dst.resize(0);
+		return;
+	}
+	const size_t nOut = EBI::SelectBlocks(nSrc, 0, mask,
+		[&](const size_t nFirst, const size_t n, uint8_t* pMask) {
+			_selectMask(src.t() + nFirst, src.x() + nFirst, src.y() + nFirst, src.p() + nFirst, n, sel, pMask);
+		},
+		[&](const size_t nFirst, const size_t n, const size_t nSel, const size_t nDst, const uint8_t* pMask) {
+			if (!bInPlace)
+				dst.resize(nDst + nSel + 1);	// one slack element for _compactBlock()
+			return _compactBlock(src.t() + nFirst, src.x() + nFirst, src.y() + nFirst, src.p() + nFirst,
+				pMask, n, nSel, sel, dst.t() + nDst, dst.x() + nDst, dst.y() + nDst, dst.p() + nDst);
+		});
+	dst.resize(nOut);
+}
+
+EBI::EventColumns::EventColumns()
+{
+	init();
+}
+
+/*!
+Constructor converting from array of events
+*/
+EBI::EventColumns::EventColumns(const EBI::EventData& src)
+{
+	init();
+	copyFrom(src);
+}
+
+EBI::EventColumns::~EventColumns()
+{
+
+}
+
+void EBI::EventColumns::init()
+{
+	m_t.clear();
+	m_x.clear();
+	m_y.clear();
+	m_p.clear();
+	m_triggerEvents.resize(0);
+	m_timeStamp = 0;
+	m_camSpecs.init();
+	m_nDebugLevel = 0;
+	m_maxEvents = 100'000'000;	// same as EBI::EventData
+	m_decodeParams.init();
+	m_loadStats.init();
+}
+
+void EBI::EventColumns::clear()
+{
+	init();
+}
+
+void EBI::EventColumns::reserve(const size_t n)
+{
+	m_t.reserve(n);
+	m_x.reserve(n);
+	m_y.reserve(n);
+	m_p.reserve(n);
+}
+
+/*!
+Change number of events to \a n, new events are zero
+*/
+void EBI::EventColumns::resize(const size_t n)
+{
+	m_t.resize(n);
+	m_x.resize(n);
+	m_y.resize(n);
+	m_p.resize(n);
+}
+
+/*!
+Append \a n events, scattering their members into the columns
+*/
+void EBI::EventColumns::append(const EBI::Event* pEvents, const size_t n)
+{
+	const size_t nOld = size();
+	resize(nOld + n);
+	uint32_t* pT = m_t.data() + nOld;
+	uint16_t* pX = m_x.data() + nOld;
+	uint16_t* pY = m_y.data() + nOld;
+	int8_t* pP = m_p.data() + nOld;
+	for (size_t i = 0; i < n; i++) {
+		pT[i] = pEvents[i].t;
+		pX[i] = pEvents[i].x;
+		pY[i] = pEvents[i].y;
+		pP[i] = pEvents[i].p;
+	}
+}
+
+/*!
+Replace events by \a events
+*/
+void EBI::EventColumns::assign(const std::vector<EBI::Event>& events)
+{
+	resize(0);
+	if (!events.empty())
+		append(events.data(), events.size());
+}
+
+/*!
+Store events as array of EBI::Event in \a events
+*/
+void EBI::EventColumns::toEvents(std::vector<EBI::Event>& events) const
+{
+	const size_t n = size();
+	events.resize(n);
+	EBI::Event* pEv = events.data();
+	for (size_t i = 0; i < n; i++) {
+		pEv[i].t = m_t[i];
+		pEv[i].x = m_x[i];
+		pEv[i].y = m_y[i];
+		pEv[i].p = m_p[i];
+	}
+}
+
+/*!
+Make a complete copy of \a src, including trigger events
+*/
+bool EBI::EventColumns::copyFrom(const EBI::EventData& src)
+{
+	assign(src.m_events);
+	m_triggerEvents = src.m_triggerEvents;
+	m_camSpecs = src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	m_loadStats = src.m_loadStats;
+	return true;
+}
+
+/*!
+Store a complete copy in \a dst, including trigger events
+*/
+bool EBI::EventColumns::copyTo(EBI::EventData& dst) const
+{
+	dst.init();
+	toEvents(dst.m_events);
+	dst.m_triggerEvents = m_triggerEvents;
+	dst.m_camSpecs = m_camSpecs;
+	dst.m_timeStamp = m_timeStamp;
+	dst.m_loadStats = m_loadStats;
+	return true;
+}
+
+/*!
+Copy events of \a src in [offsetUSec, offsetUSec + durationUSec] with polarity \a polMode,
+same as EventData::copyFrom()
+*/
+bool EBI::EventColumns::copyFrom(const EBI::EventColumns& src,
+	const EBI::EventPolarity polMode,	//!< copy only events with the specified polarity
+	const int32_t offsetUSec,
+	const int32_t durationUSec,
+	bool bSubtractOffsetTime)
+{
+	std::vector<uint8_t> mask;
+	EBI::EventSelection sel;
+	if (!src.empty()) {
+		const uint32_t t1 = static_cast<uint32_t>(offsetUSec);
+		// use end time in source for durationUSec = 0
+		const uint32_t t2 = (durationUSec == 0) ? src.m_t[src.size() - 1] : static_cast<uint32_t>(offsetUSec + durationUSec);
+		sel.setTime(t1, t2, false);
+		sel.tSub = bSubtractOffsetTime ? t1 : 0;
+		sel.setPolarity(polMode);
+	}
+	_selectColumns(src, sel, *this, mask);
+	m_triggerEvents.resize(0);
+	m_camSpecs = src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	if (m_nDebugLevel > 0)
+		std::cout << "EventColumns::copyFrom(t0=" << offsetUSec << "  duration=" << durationUSec << ") "
+			<< size() << " events" << std::endl;
+	return true;
+}
+
+/*!
+Copy events of \a src within the ROI and [t0, t0 + dur) with polarity \a polMode,
+coordinates and time are relative to the ROI and \a t0. For \a dur = 0 events
+of all times are copied. Same as EventData::copyFrom().
+*/
+bool EBI::EventColumns::copyFrom(const EBI::EventColumns& src,
+	const EBI::EventPolarity polMode,	//!< copy only events with the specified polarity
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for entire set
+)
+{
+	std::vector<uint8_t> mask;
+	EBI::EventSelection sel;
+	if (durationUSec != 0)
+		sel.setTime(static_cast<uint32_t>(offsetUSec), static_cast<uint32_t>(offsetUSec + durationUSec), true);
+	sel.tSub = static_cast<uint32_t>(offsetUSec);
+	sel.setROI(x, y, w, h);
+	sel.setPolarity(polMode);
+	_selectColumns(src, sel, *this, mask);
+	m_triggerEvents.resize(0);
+	m_camSpecs = src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	m_camSpecs.sensorW = w;
+	m_camSpecs.sensorH = h;
+	return true;
+}
+
+bool EBI::EventColumns::copyFrom(const EBI::EventColumns& src,
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,
+	const int32_t durationUSec
+)
+{
+	return copyFrom(src, EBI::PolarityBoth, x, y, w, h, offsetUSec, durationUSec);
+}
+
+/*!
+Reduce event data set to specified region of interest (ROI), in place.
+Same as EventData::cropROI().
+\return TRUE on success, FALSE on invalid ROI or missing data
+*/
+bool EBI::EventColumns::cropROI(
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for entire set
+	)
+{
+	if (empty())
+		return false;
+	EBI::EventFilter roi;
+	roi.roiX = x;
+	roi.roiY = y;
+	roi.roiW = w;
+	roi.roiH = h;
+	if (!EBI::ClipSelectionROI(roi, imageWidth(), imageHeight()))
+		return false;
+	std::vector<uint8_t> mask;
+	EBI::EventSelection sel;
+	if (durationUSec != 0)
+		sel.setTime(static_cast<uint32_t>(offsetUSec), static_cast<uint32_t>(offsetUSec + durationUSec), true);
+	sel.tSub = static_cast<uint32_t>(offsetUSec);
+	sel.setROI(roi.roiX, roi.roiY, roi.roiW, roi.roiH);
+	_selectColumns(*this, sel, *this, mask);
+	m_camSpecs.sensorW = roi.roiW;
+	m_camSpecs.sensorH = roi.roiH;
+	return true;
+}
+
+/*!
+Sample the data set into \a sample, same as EventData::getSample().
+Also subtracts time \a t0 and top-left coordinates \a (x,y) from event
+\return number of events in sample
+*/
+size_t EBI::EventColumns::getSample(EBI::EventColumns& sample,
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for entire set
+	) const
+{
+	std::vector<uint8_t> mask;
+	EBI::EventSelection sel;
+	if (durationUSec != 0)
+		sel.setTime(static_cast<uint32_t>(offsetUSec), static_cast<uint32_t>(offsetUSec + durationUSec), true);
+	sel.tSub = static_cast<uint32_t>(offsetUSec);
+	sel.setROI(x, y, w, h);
+	_selectColumns(*this, sel, sample, mask);
+	sample.m_camSpecs.sensorW = w;
+	sample.m_camSpecs.sensorH = h;
+	sample.m_timeStamp = m_timeStamp;
+	return sample.size();
+}
+
+/*!
+Load only the events selected by \a filter, same as EventData::load().
+Metavision RAW files are decoded directly into the columns, own EVT3 files
+are loaded through EBI::EventData and converted.
+Clears existing event data set
+\return True on success
+*/
+bool EBI::EventColumns::load(
+	const std::string& fnameEvents,	//!< file name, can be either Metavision RAW or own EVT3
+	const EBI::EventFilter& filter	//!< time window, ROI and polarity of events to load
+)
+{
+	resize(0);
+	m_triggerEvents.resize(0);
+	m_timeStamp = 0;
+	m_camSpecs.init();
+	m_loadStats.init();
+	if (EBI::GetFileType(fnameEvents) == EBI::FILE_FORMAT_RAWEVT3) {
+		return EBI::LoadRawEventData(
+			fnameEvents,
+			*this,
+			m_triggerEvents,
+			m_timeStamp,
+			m_camSpecs,
+			filter.offsetUSec,
+			filter.durationUSec,
+			m_maxEvents,
+			m_decodeParams,
+			m_loadStats,
+			filter,
+			m_nDebugLevel > 0);
+	}
+	EBI::EventData evData;
+	evData.setDebugLevel(m_nDebugLevel);
+	evData.setMaximumSize(m_maxEvents);
+	evData.setDecodeParams(m_decodeParams);
+	if (!evData.load(fnameEvents, filter))
+		return false;
+	return copyFrom(evData);
+}
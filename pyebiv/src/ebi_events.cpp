@@ -1,640 +1,495 @@
 #include "ebi.h"
+#include "ebi_rawevt3.h"
+#include "ebi_evtfile.h"
+#include "ebi_parallel.h"
+#include "ebi_file.h"
+#include "ebi_evtcodec.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define _EBI_SSE2
+#include <emmintrin.h>
+#endif
 //#define _DEBUG2
 
-static std::vector<std::string> _stringSplit(const std::string str, char delim)
-{
-	std::vector<std::string> result;
-	std::istringstream ss{ str };
-	std::string token;
-	while (std::getline(ss, token, delim)) {
-		if (!token.empty()) {
-			result.push_back(token);
-		}
-	}
-	return result;
-}
-
-// The following code is derived from Prophesee's Metavision SDK
-// see: ./ Prophesee / share / metavision / standalone_samples / metavision_evt3_raw_file_decoder/
-namespace Metavision {
-	namespace Evt3 {
-
-		// Event Data 3.0 is a 16 bits vectorized data format. It has been designed to comply with both data compactness
-		// necessity and vector event data support.
-		// This EVT3.0 event format avoids transmitting redundant event data for the time, y and x values.
-		enum class EventTypes : uint8_t {
-			EVT_ADDR_Y = 0x0,  // Identifies a CD event and its y coordinate
-			EVT_ADDR_X = 0x2,  // Marks a valid single event and identifies its polarity and X coordinate. The event's type and
-							   // timestamp are considered to be the last ones sent
-			VECT_BASE_X = 0x3, // Transmits the base address for a subsequent vector event and identifies its polarity and base
-								// X coordinate. This event does not represent a CD sensor event in itself and should not be
-								// processed as such,  it only sets the base x value for following VECT_12 and VECT_8 events.
-			VECT_12 = 0x4, // Vector event with 12 valid bits. This event encodes the validity bits for events of the same type,
-							// timestamp and y coordinate as previously sent events, while consecutive in x coordinate with
-							// respect to the last sent VECT_BASE_X event. After processing this event, the X position value
-							// on the receiver side should be incremented by 12 with respect to the X position when the event was
-							// received, so that the VECT_BASE_X is updated like follows: VECT_BASE_X.x = VECT_BASE_X.x + 12
-			VECT_8 = 0x5,  // Vector event with 8 valid bits. This event encodes the validity bits for events of the same type,
-						// timestamp and y coordinate as previously sent events, while consecutive in x coordinate with
-						// respect to the last sent VECT_BASE_X event. After processing this event, the X position value
-						// on the receiver side should be incremented by 8 with respect to the X position when the event was
-						// received, so that the VECT_BASE_X is updated like follows: VECT_BASE_X.x = VECT_BASE_X.x + 8
-			EVT_TIME_LOW = 0x6, // Encodes the lower 12b of the timebase range (range 11 to 0). Note that the TIME_LOW value is
-								// only monotonic for a same event source, but can be non-monotonic when multiple event sources
-								// are considered. They should however refer to the same TIME_HIGH value. As the time low has
-								// 12b with a 1us resolution, it can encode time values from 0us to 4095us (4095 = 2^12 - 1).
-								// After 4095us, the time_low value wraps and returns to 0us, at which point the TIME_HIGH value
-								// should be incremented.
-			EVT_TIME_HIGH = 0x8, // Encodes the higher portion of the timebase (range 23 to 12). Since it encodes the 12 higher
-									// bits over the 24 used to encode a timestamp, it has a resolution of 4096us (= 2^(24-12)) and
-									// it can encode time values from 0us to 16777215us (= 16.777215s). After 16773120us the
-									// time_high value wraps and returns to 0us.																													 EXT_TRIGGER = 0xA    // External trigger output
-			EXT_TRIGGER = 0xA    // External trigger output
-		};
-		// Evt3 raw events are 16-bit words
-		struct RawEvent {
-			uint16_t pad : 12; // Padding
-			uint16_t type : 4; // Event type
-		};
-
-		struct RawEventTime {
-			uint16_t time : 12;
-			uint16_t type : 4; // Event type : EventTypes::EVT_TIME_LOW OR EventTypes::EVT_TIME_HIGH
-		};
-
-		struct RawEventXPos {
-			uint16_t x : 11;   // Pixel X coordinate
-			uint16_t pol : 1;  // Event polarity:
-							   // '0': decrease in illumination
-							   // '1': increase in illumination
-			uint16_t type : 4; // Event type : EventTypes::X_POS
-		};
+static constexpr uint32_t TIME_BUCKET_USEC = 1000;		// minimum width of buckets of EBI::TimeIndex
+static constexpr size_t TIME_BUCKET_MIN_EVENTS = 16;	// buckets are widened for sparse data to keep the index small
+static constexpr uint32_t TILE_SIZE_DEFAULT = 32;		// tile size of EBI::TileIndex used by getSamples() if none is set
+static constexpr size_t SELECT_PARALLEL_MIN_EVENTS = 1 << 20;	// smaller ranges are selected on the calling thread
+static constexpr size_t SELECT_CHUNKS_PER_THREAD = 4;
+static constexpr size_t SAVE_EVENTS_PER_WRITE = 1 << 19;	// events packed before each write of save(), 4 MB
+static constexpr size_t SAVE_BLOCKS_PER_WRITE = 64;		// blocks of EVT4 / EVTZ files coded before each write of save()
 
-		struct RawEventVect12 {
-			uint16_t valid : 12; // Encodes the validity of the events in the vector :
-								 // foreach i in 0 to 11
-								 //   if valid[i] is '1'
-								 //      valid event at X = X_BASE.x + i
-			uint16_t type : 4;   // Event type : EventTypes::VECT_12
-		};
+EBI::TimeIndex::TimeIndex()
+{
+	clear();
+}
 
-		struct RawEventVect8 {
-			uint16_t valid : 8; // Encodes the validity of the events in the vector :
-								// foreach i in  0 to 7
-								//   if valid[i] is '1'
-								//      valid event at X = X_BASE.x + i
-			uint16_t unused : 4;
-			uint16_t type : 4; // Event type : EventTypes::VECT_8
-		};
+void EBI::TimeIndex::clear()
+{
+	m_bBuilt = false;
+	m_nEvents = 0;
+	m_bSorted = true;
+	m_parts.clear();
+	m_first.clear();
+	m_end.clear();
+}
 
-		struct RawEventY {
-			uint16_t y : 11;   // Pixel Y coordinate
-			uint16_t orig : 1; // Identifies the System Type:
-							   // '0': Master Camera (Left Camera in Stereo Systems)
-							   // '1': Slave Camera (Right Camera in Stereo Systems)
-			uint16_t type : 4; // Event type : EventTypes::CD_Y OR EventTypes::EM_Y
-		};
+/*!
+Index times of \a events in each of their time \a segments,
+two passes over the events, three if not sorted in time
+*/
+void EBI::TimeIndex::build(const std::vector<EBI::Event>& events,
+	const std::vector<EBI::TimeSegment>& segments)
+{
+	clear();
+	m_bBuilt = true;
+	const size_t n = events.size();
+	m_nEvents = n;
+	for (size_t k = 0; k <= segments.size(); k++) {
+		Part part = {};
+		part.iFirst = (k == 0) ? 0 : std::min<size_t>(segments[k - 1].iFirst, n);
+		part.iEnd = (k == segments.size()) ? n : std::min<size_t>(segments[k].iFirst, n);
+		part.tBase = (k == 0) ? 0 : segments[k - 1].tBase;
+		if (part.iEnd <= part.iFirst)
+			continue;
+		buildPart(events, part);
+		m_bSorted = m_bSorted && part.bSorted;
+		m_parts.push_back(part);
+	}
+}
 
-		struct RawEventXBase {
-			uint16_t x : 11;   // Pixel X coordinate
-			uint16_t pol : 1;  // Event polarity:
-							   // '0': decrease in illumination
-							   // '1': increase in illumination
-			uint16_t type : 4; // Event type : EventTypes::X_BASE
-		};
+//! buckets of the events [part.iFirst, part.iEnd) appended to m_first and m_end
+void EBI::TimeIndex::buildPart(const std::vector<EBI::Event>& events, Part& part)
+{
+	const size_t i0 = part.iFirst;
+	const size_t n = part.iEnd;
+	part.bSorted = true;
+	part.tMin = part.tMax = events[i0].t;
+	for (size_t i = i0 + 1; i < n; i++) {
+		const uint32_t t = events[i].t;
+		if (t < events[i - 1].t)
+			part.bSorted = false;
+		part.tMin = std::min(part.tMin, t);
+		part.tMax = std::max(part.tMax, t);
+	}
+	part.bucketUSec = TIME_BUCKET_USEC;
+	const uint64_t span = static_cast<uint64_t>(part.tMax) - part.tMin + 1;
+	while ((part.bucketUSec < (1u << 30)) && ((span / part.bucketUSec) * TIME_BUCKET_MIN_EVENTS > n - i0))
+		part.bucketUSec *= 2;
+	const size_t nBuckets = static_cast<size_t>((span + part.bucketUSec - 1) / part.bucketUSec);
+	part.nBuckets = nBuckets;
+	part.nFirst0 = m_first.size();
+	part.nEnd0 = m_end.size();
+
+	// first event whose running maximum of time reaches the start of each bucket
+	m_first.resize(part.nFirst0 + nBuckets + 1);
+	size_t* pFirst = m_first.data() + part.nFirst0;
+	size_t b = 0;
+	uint32_t tMaxSoFar = 0;
+	for (size_t i = i0; (i < n) && (b < nBuckets); i++) {
+		tMaxSoFar = std::max(tMaxSoFar, events[i].t);
+		while ((b < nBuckets) && (tMaxSoFar >= part.tMin + static_cast<uint64_t>(b) * part.bucketUSec))
+			pFirst[b++] = i;
+	}
+	for (; b <= nBuckets; b++)
+		pFirst[b] = n;
+	if (part.bSorted)
+		return;
+
+	// first event from which on the running minimum of time (from the end) is beyond each bucket
+	m_end.resize(part.nEnd0 + nBuckets);
+	size_t* pEnd = m_end.data() + part.nEnd0;
+	pEnd[nBuckets - 1] = n;
+	int64_t bOpen = static_cast<int64_t>(nBuckets) - 2;
+	uint32_t tMinSoFar = UINT32_MAX;
+	for (size_t i = n; (i-- > i0) && (bOpen >= 0); ) {
+		tMinSoFar = std::min(tMinSoFar, events[i].t);
+		const int64_t bLast = static_cast<int64_t>((tMinSoFar - part.tMin) / part.bucketUSec) - 1;
+		while ((bOpen >= 0) && (bLast < bOpen))
+			pEnd[bOpen--] = i + 1;
+	}
+	for (; bOpen >= 0; bOpen--)
+		pEnd[bOpen] = i0;
+}
 
-		struct RawEventExtTrigger {
-			uint16_t value : 1; // Trigger current value (edge polarity):
-								// - '0' (falling edge);
-								// - '1' (rising edge).
-			uint16_t unused : 7;
-			uint16_t id : 4;   // Trigger channel ID.
-			uint16_t type : 4; // Event type : EventTypes::EXT_TRIGGER
-		};
+/*!
+Events [\a iFirst, \a iEnd) of \a events include all events with time in [\a t1, \a t2].
+For sorted events the range is exact, found by binary search within the first and last bucket.
+Times include the time segment, see EBI::TimeSegment.
+*/
+void EBI::TimeIndex::range(const std::vector<EBI::Event>& events, const uint64_t t1, const uint64_t t2,
+	size_t& iFirst, size_t& iEnd) const
+{
+	iFirst = iEnd = 0;
+	if (!m_bBuilt || events.empty() || (t2 < t1) || m_parts.empty())
+		return;
+	// first segment with events at or after t1, last one with events at or before t2
+	auto itFirst = std::partition_point(m_parts.begin(), m_parts.end(),
+		[t1](const Part& part) { return part.tBase + part.tMax < t1; });
+	auto itLast = std::partition_point(m_parts.begin(), m_parts.end(),
+		[t2](const Part& part) { return part.tBase + part.tMin <= t2; });
+	if ((itFirst == m_parts.end()) || (itLast == m_parts.begin()) || (itLast - 1 < itFirst))
+		return;
+	const Part& first = *itFirst;
+	const Part& last = *(itLast - 1);
+	auto local = [](const Part& part, const uint64_t t) {
+		return static_cast<uint32_t>(std::min<uint64_t>((t > part.tBase) ? t - part.tBase : 0, UINT32_MAX)); };
+	size_t iUnused;
+	if (&first == &last) {
+		rangePart(events, first, local(first, t1), local(first, t2), iFirst, iEnd);
+		return;
+	}
+	rangePart(events, first, local(first, t1), UINT32_MAX, iFirst, iUnused);
+	rangePart(events, last, 0, local(last, t2), iUnused, iEnd);
+	iEnd = std::max(iFirst, iEnd);
+}
 
-		using timestamp_t = uint64_t; // Type for timestamp, in microseconds
+//! range() within segment \a part, \a t1 and \a t2 relative to the start of the segment
+void EBI::TimeIndex::rangePart(const std::vector<EBI::Event>& events, const Part& part,
+	const uint32_t t1, const uint32_t t2, size_t& iFirst, size_t& iEnd) const
+{
+	iFirst = iEnd = part.iFirst;
+	if ((t2 < t1) || (t2 < part.tMin) || (t1 > part.tMax))
+		return;
+	const size_t* pFirst = m_first.data() + part.nFirst0;
+	const size_t b1 = (t1 <= part.tMin) ? 0 : (t1 - part.tMin) / part.bucketUSec;
+	const size_t b2 = std::min<size_t>((t2 - part.tMin) / part.bucketUSec, part.nBuckets - 1);
+	iFirst = pFirst[b1];
+	if (!part.bSorted) {
+		iEnd = std::max(iFirst, m_end[part.nEnd0 + b2]);
+		return;
+	}
+	auto timeLess = [](const EBI::Event& ev, const uint32_t t) { return ev.t < t; };
+	auto lessTime = [](const uint32_t t, const EBI::Event& ev) { return t < ev.t; };
+	iFirst = std::lower_bound(events.begin() + iFirst, events.begin() + pFirst[b1 + 1], t1, timeLess) - events.begin();
+	iEnd = std::upper_bound(events.begin() + pFirst[b2], events.begin() + pFirst[b2 + 1], t2, lessTime) - events.begin();
+	iEnd = std::max(iFirst, iEnd);
+}
 
-	} // namespace Evt3
-} // namespace Metavision
+EBI::TileIndex::TileIndex()
+{
+	clear();
+}
 
+void EBI::TileIndex::clear()
+{
+	m_bBuilt = false;
+	m_nEvents = 0;
+	m_tileSize = 0;
+	m_tilesX = m_tilesY = 0;
+	m_tileFirst.clear();
+	m_order.clear();
+	m_segments.clear();
+}
 
-static bool _loadRawEventData(const std::string& fname, 
-	std::vector<EBI::Event>& evData,
-	std::vector<EBI::TriggerEvent>& evTrigger,
-	uint64_t& timeStamp,	// from first event in file
-	EBI::EventCameraSpecs& camSpecs,
-	const uint64_t nStartTime,	//!< offset within file in microseconds (input)
-	const uint64_t nMaxEventCount,	//!< maximum number of events to load
-	const bool bDebugMessages	//!< true to enable diagnostic output
-	)
+/*!
+Group event numbers of \a events by tile of \a tileSize x \a tileSize pixels (counting sort),
+sort each tile in time if the events are not sorted. Times include the time \a segments of the events.
+\note Not usable for more than 2^32 events
+*/
+void EBI::TileIndex::build(const std::vector<EBI::Event>& events, const uint32_t tileSize,
+	const std::vector<EBI::TimeSegment>& segments)
 {
-	bool retCode = true; // on success
-	uint32_t trigCount = 0;
-	uint32_t nEventOutOfBounds = 0;
-	Metavision::Evt3::timestamp_t firstTimeStamp = 0;
+	clear();
+	m_bBuilt = true;
+	m_tileSize = tileSize;
+	m_segments = segments;
+	const size_t n = events.size();
+	m_nEvents = n;
+	if ((n == 0) || (tileSize == 0) || (n > UINT32_MAX))
+		return;
+
+	uint16_t maxX = 0, maxY = 0;
+	bool bSorted = true;
+	size_t nNextSegment = 0;
+	for (size_t i = 0; i < n; i++) {
+		maxX = std::max(maxX, events[i].x);
+		maxY = std::max(maxY, events[i].y);
+		if ((nNextSegment < segments.size()) && (segments[nNextSegment].iFirst == i))
+			nNextSegment++;	// time restarts with a new segment
+		else if ((i > 0) && (events[i].t < events[i - 1].t))
+			bSorted = false;
+	}
+	m_tilesX = maxX / tileSize + 1;
+	m_tilesY = maxY / tileSize + 1;
+	const size_t nTiles = static_cast<size_t>(m_tilesX) * m_tilesY;
+
+	m_tileFirst.assign(nTiles + 1, 0);
+	for (const EBI::Event& ev : events)
+		m_tileFirst[(ev.y / tileSize) * m_tilesX + ev.x / tileSize + 1]++;
+	for (size_t k = 0; k < nTiles; k++)
+		m_tileFirst[k + 1] += m_tileFirst[k];
+
+	m_order.resize(n);
+	std::vector<size_t> pos(m_tileFirst.begin(), m_tileFirst.end() - 1);
+	for (size_t i = 0; i < n; i++)
+		m_order[pos[(events[i].y / tileSize) * m_tilesX + events[i].x / tileSize]++] = static_cast<uint32_t>(i);
+	if (bSorted)
+		return;
+
+	auto earlier = [this, &events](const uint32_t a, const uint32_t b) {
+		return EBI::SegmentBase(m_segments, a) + events[a].t < EBI::SegmentBase(m_segments, b) + events[b].t; };
+	for (size_t k = 0; k < nTiles; k++)
+		std::stable_sort(m_order.begin() + m_tileFirst[k], m_order.begin() + m_tileFirst[k + 1], earlier);
+}
 
-	// open file
-	std::ifstream input_file(fname, std::ios::in | std::ios::binary);
-	try {
-		if (!input_file.is_open()) {
-			std::cerr << "Error : could not open file '" << fname.c_str() << "' for reading" << std::endl;
-			throw (-1);
+/*!
+Event numbers of all events of \a events in tiles overlapping the region (\a x, \a y, \a w, \a h)
+with time in [\a t1, \a t2], in ascending order. Events at the border of the tiles
+outside of the region still have to be rejected by the caller.
+\return false if the index cannot be used for \a events
+*/
+bool EBI::TileIndex::select(const std::vector<EBI::Event>& events,
+	const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+	const uint64_t t1, const uint64_t t2, std::vector<uint32_t>& indices) const
+{
+	indices.resize(0);
+	if (!m_bBuilt || (m_tilesX == 0) || (events.size() != m_nEvents))
+		return false;
+	const int64_t x2 = static_cast<int64_t>(x) + w - 1;
+	const int64_t y2 = static_cast<int64_t>(y) + h - 1;
+	if ((w <= 0) || (h <= 0) || (x2 < 0) || (y2 < 0) || (t2 < t1))
+		return true;
+	const uint32_t tx1 = static_cast<uint32_t>(std::max(x, 0)) / m_tileSize;
+	const uint32_t ty1 = static_cast<uint32_t>(std::max(y, 0)) / m_tileSize;
+	const uint32_t tx2 = static_cast<uint32_t>(std::min<int64_t>(x2 / m_tileSize, m_tilesX - 1));
+	const uint32_t ty2 = static_cast<uint32_t>(std::min<int64_t>(y2 / m_tileSize, m_tilesY - 1));
+
+	auto timeLess = [this, &events](const uint32_t i, const uint64_t t) { return EBI::SegmentBase(m_segments, i) + events[i].t < t; };
+	auto lessTime = [this, &events](const uint64_t t, const uint32_t i) { return t < EBI::SegmentBase(m_segments, i) + events[i].t; };
+	for (uint32_t ty = ty1; ty <= ty2; ty++) {
+		for (uint32_t tx = tx1; tx <= tx2; tx++) {
+			const size_t k = static_cast<size_t>(ty) * m_tilesX + tx;
+			auto itBegin = m_order.begin() + m_tileFirst[k];
+			auto itEnd = m_order.begin() + m_tileFirst[k + 1];
+			itBegin = std::lower_bound(itBegin, itEnd, t1, timeLess);
+			itEnd = std::upper_bound(itBegin, itEnd, t2, lessTime);
+			indices.insert(indices.end(), itBegin, itEnd);
 		}
-		// header reading part is modified to keep compatability with older raw data 
-		// (i.e. missing %end statement, missing sensor size info,...)
-
-		// header looks like this:
-		//	% camera_integrator_name CenturyArks
-		//	% date 2023 - 06 - 23 19:45 : 32
-		//	% evt 3.0
-		//	% format EVT3; height = 480; width = 640
-		//	% generation 3.1
-		//	% geometry 640x480
-		//	% integrator_name CenturyArks
-		//	% plugin_integrator_name CenturyArks
-		//	% plugin_name evc3a_plugin_gen31
-		//	% sensor_generation 3.1
-		//	% serial_number 00000097
-		//	% system_ID 40
-		//	% end
-		//-------------or------------
-		//	% date 2022 - 08 - 11 16:33 : 16
-		//	% evt 3.0
-		//	% firmware_version 4.3.0
-		//	% format EVT3
-		//	% geometry 1280x720
-		//	% integrator_name Prophesee
-		//	% plugin_name hal_plugin_gen41_evk2
-		//	% sensor_generation 4.1
-		//	% serial_number 0000a4e9
-		//	% system_ID 39
-		//----------- very early version ----
-		//  % date 2022 - 01 - 23 17:39 : 01
-		//	% evt 3.0
-		//	% firmware_version 4.3.0
-		//	% integrator_name Prophesee
-		//	% plugin_name hal_plugin_gen41_evk2
-		//	% serial_number 0000a4e9
-		//	% subsystem_ID 0
-		//	% system_ID 39
-		//-------------or-------------
-		//  % camera_integrator_name CenturyArks
-		//  % date 2024 - 01 - 26 15:39 : 08
-		//  % evt 3.0
-		//  % format EVT3; height = 720; width = 1280
-		//  % generation 4.2
-		//  % geometry 1280x720
-		//  % integrator_name CenturyArks
-		//  % plugin_integrator_name CenturyArks
-		//  % plugin_name evc4a_plugin_imx636
-		//  % sensor_generation 4.2
-		//  % serial_number 00000204
-		//  % system_ID 49
-		//  % end
-		//-------------or------------
-		//  % camera_integrator_name CenturyArks
-		//  % date 2024 - 02 - 01 14:54 : 01
-		//  % evt 3.0
-		//  % format EVT3; height = 720; width = 1280
-		//  % generation 4.2
-		//  % geometry 1280x720
-		//  % integrator_name CenturyArks
-		//  % plugin_integrator_name CenturyArks
-		//  % plugin_name silky_common_plugin
-		//  % sensor_generation 4.2
-		//  % sensor_name IMX636
-		//  % serial_number 00000204
-		//  % system_ID 49
-		//  % end
-
-		// Read the header of the input file, if present :
-		int line_first_char = input_file.peek();
-
-		if(bDebugMessages)
-			std::cout << "File: " << fname.c_str() << std::endl;
-		bool bIsEventFileType3 = false;
-		bool bhaveGeometry = false;
-		while (line_first_char == '%') {
-			std::string line;
-			std::getline(input_file, line);
-			//std::cout << line << std::endl;
-			if (line == "% end") {	// added in v4.0.0
-				break;
-			}
+	}
+	// restore the order of the events, tiles are sorted in time
+	if (!std::is_sorted(indices.begin(), indices.end()))
+		std::sort(indices.begin(), indices.end());
+	return true;
+}
 
-			std::vector<std::string> vals = _stringSplit(line, ' ');
-#ifdef _DEBUG2
-			for (std::string v : vals) {
-				std::cout << " '" << v << "' ";
-			}
-			std::cout << std::endl;
-#endif
+//! true if event \a ev has polarity \a polMode, as selected by the copy constructors
+static inline bool _hasPolarity(const EBI::Event& ev, const EBI::EventPolarity polMode)
+{
+	return (polMode == EBI::PolarityBoth)
+		|| ((ev.p > 0) && (polMode == EBI::PolarityPositive))
+		|| ((ev.p == 0) && (polMode == EBI::PolarityNegative));
+}
 
-			if (vals.size() == 3) {
-				if (vals[1] == "integrator_name")
-					camSpecs.strIntegrator = vals[2];
-				else if (vals[1] == "plugin_name")
-					camSpecs.strPlugin = vals[2];
-				else if (vals[1] == "firmware_version")
-					camSpecs.strFirmware = vals[2];
-				else if (vals[1] == "evt")
-					camSpecs.strEventType = vals[2];
-				else if (vals[1] == "serial_number")
-					camSpecs.strSerialNo = vals[2];
-				else if (vals[1] == "sensor_generation")
-					camSpecs.strSensorGeneration = vals[2];
-				else if (vals[1] == "generation") {
-					camSpecs.strSensorGeneration = vals[2];
-					// some implementations don't produce long headers so we assume EVT3.0 format 
-					// for later generation sensors
-					if (camSpecs.strSensorGeneration == "4.2") {
-						bIsEventFileType3 = true;
-					}
-				}
+/*!
+Split of the events [iFirst, iEnd) into chunks for parallel selection, several per thread
+so that threads finishing early take over remaining chunks
+*/
+struct _SelectionChunks
+{
+	size_t iFirst, iEnd;
+	size_t nChunks;
+	size_t nPerChunk;
+	int32_t nThreads;
 
-				else if (vals[1] == "date") {
-					camSpecs.strRecordingDate = vals[2];
-					camSpecs.strRecordingTime = vals[3];
-				}
-				else if (vals[1] == "geometry") {
-					if (vals[2] == "640x480") {
-						camSpecs.sensorH = 480;
-						camSpecs.sensorW = 640;
-						bhaveGeometry = true;
-					}
-					else if (vals[2] == "1280x720") {
-						camSpecs.sensorH = 720;
-						camSpecs.sensorW = 1280;
-						bhaveGeometry = true;
-					}
-				}
-			}
-			//std::cout << std::endl;
+	_SelectionChunks(const size_t iFirstIN, const size_t iEndIN, const int32_t nThreadsIN)
+		: iFirst(iFirstIN), iEnd(iEndIN)
+	{
+		const size_t n = iEnd - iFirst;
+		nThreads = (n < SELECT_PARALLEL_MIN_EVENTS) ? 1 : EBI::ThreadCount(nThreadsIN);
+		nChunks = (nThreads > 1) ? static_cast<size_t>(nThreads) * SELECT_CHUNKS_PER_THREAD : 1;
+		nPerChunk = (n + nChunks - 1) / nChunks;
+	}
+	size_t begin(const size_t k) const { return std::min(iEnd, iFirst + k * nPerChunk); }
+	size_t end(const size_t k) const { return std::min(iEnd, iFirst + (k + 1) * nPerChunk); }
+};
 
-			if (line == "% evt 3.0")
-				bIsEventFileType3 = true;
-			//else if(line.find("integrator_name"))
-			line_first_char = input_file.peek();
-		};
-		if (!bIsEventFileType3) {
-			std::cerr << "Error : not an event data file: '" << fname.c_str() << "'" 
-				<< std::endl;
-			throw (-2);
+/*!
+Append events [\a iFirst, \a iEnd) of \a src accepted by \a sel to \a dst, in order.
+\a sel(ev) tests event \a ev and may modify it, e.g. subtract the ROI origin. The events
+are counted first, so \a dst grows at most once and not at all if its capacity suffices.
+Large ranges are counted per chunk on \a nThreads threads (0 for all cores), then each
+chunk is written to its position from the prefix sum of the counts.
+*/
+template <typename SelectFn>
+static void _copySelected(const std::vector<EBI::Event>& src, const size_t iFirst, const size_t iEnd,
+	std::vector<EBI::Event>& dst, const int32_t nThreads, SelectFn sel)
+{
+	const _SelectionChunks chunks(iFirst, iEnd, nThreads);
+	if (chunks.nThreads <= 1) {
+		size_t n = 0;
+		for (size_t i = iFirst; i < iEnd; i++) {
+			EBI::Event ev = src[i];
+			if (sel(ev))
+				n++;
 		}
-
-		if (camSpecs.strIntegrator == "Prophesee") {
-			if (camSpecs.strPlugin == "hal_plugin_gen41_evk2") {
-				camSpecs.sensorH = 720;
-				camSpecs.sensorW = 1280;
-				bhaveGeometry = true;
-			}
-			else if (camSpecs.strPlugin == "hal_plugin_imx636_evk4") {
-				camSpecs.sensorH = 720;
-				camSpecs.sensorW = 1280;
-				bhaveGeometry = true;
-			}
-			else if (camSpecs.strPlugin == "evc3a_plugin_gen31") {
-				camSpecs.sensorH = 480;
-				camSpecs.sensorW = 640; 
-				bhaveGeometry = true;
-			}
+		dst.reserve(dst.size() + n);
+		for (size_t i = iFirst; i < iEnd; i++) {
+			EBI::Event ev = src[i];
+			if (sel(ev))
+				dst.push_back(ev);
 		}
-		else if (camSpecs.strIntegrator == "CenturyArks") {
-			
-			if (camSpecs.strPlugin == "evc4a_plugin_imx636") {
-				camSpecs.sensorH = 720;
-				camSpecs.sensorW = 1280;
-				bhaveGeometry = true;
-			}
-			else if (!bhaveGeometry) {
-				camSpecs.sensorH = 720;
-				camSpecs.sensorW = 1280;
-				//std::cerr << "Error : no geometry info in header - trying with default 1280x720" << std::endl;
-			}
+		return;
+	}
+
+	std::vector<size_t> offsets(chunks.nChunks + 1, 0);
+	EBI::ParallelFor(chunks.nChunks, chunks.nThreads, [&](const size_t k) {
+		size_t n = 0;
+		for (size_t i = chunks.begin(k); i < chunks.end(k); i++) {
+			EBI::Event ev = src[i];
+			if (sel(ev))
+				n++;
 		}
-		if (!bhaveGeometry) {
-			camSpecs.sensorH = 720;
-			camSpecs.sensorW = 1280;
-			std::cerr << "Error : no geometry info in header - trying with default 1280x720" << std::endl;
+		offsets[k + 1] = n;
+	});
+	offsets[0] = dst.size();
+	for (size_t k = 0; k < chunks.nChunks; k++)
+		offsets[k + 1] += offsets[k];
+	dst.resize(offsets[chunks.nChunks]);
+	EBI::Event* pDst = dst.data();
+	EBI::ParallelFor(chunks.nChunks, chunks.nThreads, [&](const size_t k) {
+		size_t nOut = offsets[k];
+		for (size_t i = chunks.begin(k); i < chunks.end(k); i++) {
+			EBI::Event ev = src[i];
+			if (sel(ev))
+				pDst[nOut++] = ev;
 		}
-		if(bDebugMessages)
-			std::cout << "Sensor: " << camSpecs.strIntegrator << " - " << camSpecs.strPlugin 
-				<< "\nSize: " << camSpecs.sensorW << "(W) x " << camSpecs.sensorH << "(H)"
-				<< std::endl;
-
-		// Vector where we'll read the raw data
-		static constexpr uint32_t WORDS_TO_READ = 1000000; // Number of words to read at a time
-		std::vector<Metavision::Evt3::RawEvent> buffer_read(WORDS_TO_READ);
-
-		// State variables needed for decoding
-		enum class EvType { CD, EM }; // To keep track of the current event type, event if we just decode CD in this example
-		EvType current_type = EvType::CD;
-		bool first_time_base_set = false;
-		Metavision::Evt3::timestamp_t current_time_base = 0; // time high bits
-		Metavision::Evt3::timestamp_t current_time_low = 0;
-		Metavision::Evt3::timestamp_t current_time = 0;
-		uint16_t current_cd_y = 0;
-		uint16_t current_x_base = 0;
-		uint16_t current_polarity = 0;
-		unsigned int n_time_high_loop = 0; // Counter of the time high loops
-		bool keep_triggers = true;
-
-		uint64_t evCount = 0;
-		timeStamp = 0UL;
-		std::string cd_str = "", trigg_str = "";
-
-		while (input_file) {
-			input_file.read(reinterpret_cast<char *>(buffer_read.data()),
-				WORDS_TO_READ * sizeof(Metavision::Evt3::RawEvent));
-			Metavision::Evt3::RawEvent *current_word = buffer_read.data();
-			Metavision::Evt3::RawEvent *last_word = current_word + input_file.gcount() / sizeof(Metavision::Evt3::RawEvent);
-
-			// If the first event in the input file is not of type EVT_TIME_HIGH, then the times
-			// of the first events might be wrong, because we don't have a time base yet. This is why
-			// we skip the events until we find the first time high, so that we can correctly set
-			// the current_time_base
-			for (; !first_time_base_set && current_word != last_word; ++current_word) {
-				Metavision::Evt3::EventTypes type = static_cast<Metavision::Evt3::EventTypes>(current_word->type);
-				if (type == Metavision::Evt3::EventTypes::EVT_TIME_HIGH) {
-					Metavision::Evt3::RawEventTime *ev_timehigh =
-						reinterpret_cast<Metavision::Evt3::RawEventTime *>(current_word);
-					current_time_base = (Metavision::Evt3::timestamp_t(ev_timehigh->time) << 12);					
-					//std::cout << "timestamp: " << current_time_base << std::endl;
-					if(!first_time_base_set)
-						firstTimeStamp = current_time_base;
-					first_time_base_set = true;
-					break;
-				}
-			}
-			for (; current_word != last_word; ++current_word) {
-				Metavision::Evt3::EventTypes type = static_cast<Metavision::Evt3::EventTypes>(current_word->type);
-				switch (type) {
-				case Metavision::Evt3::EventTypes::EVT_ADDR_X: {
-					Metavision::Evt3::RawEventXPos *ev_cd_posx =
-						reinterpret_cast<Metavision::Evt3::RawEventXPos *>(current_word);
-					// disabled in v2.3.1:
-					// current_x_base = ev_cd_posx->x; // X_POS also updates the X_BASE
-					if (current_type == EvType::CD) {
-						if (evCount == 0)
-							timeStamp = current_time;
-						// We have a new Event CD with
-						// x = ev_cd_posx->x //removed: ( = current_x_base as we just updated this variable in previous statement)
-						// y = current_cd_y
-						// polarity = ev_cd_posx->pol
-						// time = current_time (in us)
-						//cd_str += std::to_string(current_x_base) + "," + std::to_string(current_cd_y) + "," +
-						//	std::to_string(ev_cd_posx->pol) + "," + std::to_string(current_time) + "\n";
-						if (current_time - timeStamp > nStartTime) {
-							evData.push_back(EBI::Event(
-								(ev_cd_posx->x % camSpecs.sensorW), // range check added 20240328, 
-								// in v2.3.0: current_x_base,
-								current_cd_y,
-								ev_cd_posx->pol,
-								static_cast<uint32_t>(current_time - timeStamp)));
-#ifdef _DEBUG2
-							if (ev_cd_posx->x >= camSpecs.sensorW) {
-								nEventOutOfBounds++;
-							}
-#endif
-						}
-						evCount++;
-					}
-					break;
-				}
-				case Metavision::Evt3::EventTypes::VECT_12: {
-					uint16_t end = current_x_base + 12;
-
-					if (current_type == EvType::CD) {
-						Metavision::Evt3::RawEventVect12 *ev_vec_12 =
-							reinterpret_cast<Metavision::Evt3::RawEventVect12 *>(current_word);
-						uint32_t valid = ev_vec_12->valid;
-						for (uint16_t i = current_x_base; i != end; ++i) {
-							if (valid & 0x1) {
-								// We have a new Event CD with
-								// x = i
-								// y = current_cd_y
-								// polarity = current_polarity
-								// time = current_time (in us)
-								//cd_str += std::to_string(i) + "," + std::to_string(current_cd_y) + "," +
-								//	std::to_string(current_polarity) + "," + std::to_string(current_time) + "\n";
-								if (evCount == 0)
-									timeStamp = current_time;
-								if (current_time - timeStamp > nStartTime) {
-									evData.push_back(EBI::Event(
-										(i % camSpecs.sensorW), // range check added 20240328
-										current_cd_y,
-										static_cast<int8_t>(current_polarity),
-										static_cast<uint32_t>(current_time - timeStamp)
-									));
-#ifdef _DEBUG2
-									if (i >= camSpecs.sensorW) {
-										nEventOutOfBounds++;
-									}
-#endif
-								}
-								evCount++;
-							}
-							valid >>= 1;
-						}
-					}
-					current_x_base = end;
-					break;
-				}
-				case Metavision::Evt3::EventTypes::VECT_8: {
-					uint16_t end = current_x_base + 8;
-
-					if (current_type == EvType::CD) {
-						Metavision::Evt3::RawEventVect8 *ev_vec_8 =
-							reinterpret_cast<Metavision::Evt3::RawEventVect8 *>(current_word);
-						uint32_t valid = ev_vec_8->valid;
-						for (uint16_t i = current_x_base; i != end; ++i) {
-							if (valid & 0x1) {
-								// We have a new Event CD with
-								// x = i
-								// y = current_cd_y
-								// polarity = current_polarity
-								// time = current_time (in us)
-								//cd_str += std::to_string(i) + "," + std::to_string(current_cd_y) + "," +
-								//	std::to_string(current_polarity) + "," + std::to_string(current_time) + "\n";
-								if (evCount == 0)
-									timeStamp = current_time;
-								if (current_time - timeStamp > nStartTime) {
-									evData.push_back(EBI::Event(
-										(i % camSpecs.sensorW), // range check added 20240328
-										current_cd_y,
-										static_cast<int8_t>(current_polarity),
-										static_cast<uint32_t>(current_time - timeStamp)
-									));
-#ifdef _DEBUG2
-									if (i >= camSpecs.sensorW) {
-										nEventOutOfBounds++;
-									}
-#endif
-								}
-								evCount++;
-							}
-							valid >>= 1;
-						}
-					}
-					current_x_base = end;
-					break;
-				}
-				case Metavision::Evt3::EventTypes::EVT_ADDR_Y: {
-					current_type = EvType::CD;
-
-					Metavision::Evt3::RawEventY *ev_cd_y = reinterpret_cast<Metavision::Evt3::RawEventY *>(current_word);
-					// bugfix 20230208: issue with y out-of-bounds for data recorded with CenturyArks SilkyEvCam VGA
-#ifdef _DEBUG2
-					if (current_cd_y >= camSpecs.sensorH) {
-						nEventOutOfBounds++;
-					}
-#endif
-					//current_cd_y = ev_cd_y->y;
-					current_cd_y = ev_cd_y->y % camSpecs.sensorH;	// quick method to treat out-of-bounds
-					break;
-				}
-
-				case Metavision::Evt3::EventTypes::VECT_BASE_X: {
-					Metavision::Evt3::RawEventXBase *ev_xbase =
-						reinterpret_cast<Metavision::Evt3::RawEventXBase *>(current_word);
-					current_polarity = ev_xbase->pol;
-					current_x_base = ev_xbase->x;
-					break;
-				}
-				case Metavision::Evt3::EventTypes::EVT_TIME_HIGH: {
-					// Compute some useful constant variables :
-					//
-					// -> MaxTimestampBase is the maximum value that the variable current_time_base can have. It corresponds
-					// to the case where an event Metavision::Evt3::RawEventTime of type EVT_TIME_HIGH has all the bits of
-					// the field "timestamp" (12 bits total) set to 1 (value is (1 << 12) - 1). We then need to shift it by
-					// 12 bits because this field represents the most significant bits of the event time base (range 23 to
-					// 12). See the event description at the beginning of the file.
-					//
-					// -> TimeLoop is the loop duration (in us) before the time_high value wraps and returns to 0. Its value
-					// is MaxTimestampBase + (1 << 12)
-					//
-					// -> LoopThreshold is a threshold value used to detect if a new value of the time high has decreased
-					// because it looped. Theoretically, if the new value of the time high is lower than the last one, then
-					// it means that is has looped. In practice, to protect ourselves from a transmission error, we use a
-					// threshold value, so that we consider that the time high has looped only if it differs from the last
-					// value by a sufficient difference (i.e. greater than the threshold)
-					static constexpr Metavision::Evt3::timestamp_t MaxTimestampBase =
-						((Metavision::Evt3::timestamp_t(1) << 12) - 1) << 12;                               // = 16773120us
-					static constexpr Metavision::Evt3::timestamp_t TimeLoop = MaxTimestampBase + (1 << 12); // = 16777216us
-					static constexpr Metavision::Evt3::timestamp_t LoopThreshold =
-						(10 << 12); // It could be another value too, as long as it is a big enough value that we can be
-									// sure that the time high looped
-
-					Metavision::Evt3::RawEventTime *ev_timehigh =
-						reinterpret_cast<Metavision::Evt3::RawEventTime *>(current_word);
-					Metavision::Evt3::timestamp_t new_time_base = (Metavision::Evt3::timestamp_t(ev_timehigh->time) << 12);
-					new_time_base += n_time_high_loop * TimeLoop;
-
-					if ((current_time_base > new_time_base) &&
-						(current_time_base - new_time_base >= MaxTimestampBase - LoopThreshold)) {
-						// Time High loop :  we consider that we went in the past because the timestamp looped
-						new_time_base += TimeLoop;
-						++n_time_high_loop;
-					}
+	});
+}
 
-					current_time_base = new_time_base;
-					current_time = current_time_base;
-					break;
-				}
-				case Metavision::Evt3::EventTypes::EVT_TIME_LOW: {
-					Metavision::Evt3::RawEventTime *ev_timelow =
-						reinterpret_cast<Metavision::Evt3::RawEventTime *>(current_word);
-					current_time_low = ev_timelow->time;
-					current_time = current_time_base + current_time_low;
-					break;
-				}
-				case Metavision::Evt3::EventTypes::EXT_TRIGGER: {
-					if (keep_triggers) {
-						Metavision::Evt3::RawEventExtTrigger *ev_trigg =
-							reinterpret_cast<Metavision::Evt3::RawEventExtTrigger *>(current_word);
-
-						// We have a new Event Trigger with
-						// value = ev_trigg->value
-						// id = ev_trigg->id
-						// time = current_time (in us)
-						if (current_time - timeStamp > nStartTime) {
-							evTrigger.push_back(EBI::TriggerEvent(ev_trigg->value, ev_trigg->id, static_cast<uint32_t>(current_time - timeStamp + nStartTime)));
-							trigCount++;
-						}
-						//trigg_str += std::to_string(ev_trigg->value) + "," + std::to_string(ev_trigg->id) + "," +
-						//	std::to_string(current_time) + "\n";
-					}
-					break;
-				}
-				default:
-					break;
-				}
-			}
-			if (evData.size() >= nMaxEventCount) {
-			//if (evCount >= nMaxEventCount) {
-				// buffer full
-				break;
-			}
+/*!
+Move the events [\a iFirst, \a iEnd) of \a events accepted by \a sel, see _copySelected(),
+to position \a nOut <= \a iFirst on, in place without allocation; \a nOut is advanced past them.
+In parallel each chunk is compacted to its own start, then the chunks are moved together in order.
+*/
+template <typename SelectFn>
+static void _compactSelected(std::vector<EBI::Event>& events, const size_t iFirst, const size_t iEnd,
+	size_t& nOut, const int32_t nThreads, SelectFn sel)
+{
+	const _SelectionChunks chunks(iFirst, iEnd, nThreads);
+	if (chunks.nThreads <= 1) {
+		for (size_t i = iFirst; i < iEnd; i++) {
+			EBI::Event ev = events[i];
+			if (sel(ev))
+				events[nOut++] = ev;
 		}
+		return;
 	}
-	catch (int errCode) {
-		std::cerr << "_loadRawEventData() - ERROR(" << errCode << ")" << std::endl;
-		retCode = false;
+
+	std::vector<size_t> counts(chunks.nChunks, 0);
+	EBI::ParallelFor(chunks.nChunks, chunks.nThreads, [&](const size_t k) {
+		size_t nOut = chunks.begin(k);
+		for (size_t i = chunks.begin(k); i < chunks.end(k); i++) {
+			EBI::Event ev = events[i];
+			if (sel(ev))
+				events[nOut++] = ev;
+		}
+		counts[k] = nOut - chunks.begin(k);
+	});
+	for (size_t k = 0; k < chunks.nChunks; k++) {
+		auto itChunk = events.begin() + chunks.begin(k);
+		if (nOut != chunks.begin(k))
+			std::copy(itChunk, itChunk + counts[k], events.begin() + nOut);
+		nOut += counts[k];
 	}
-	if(input_file.is_open())
-		input_file.close();
+}
 
-	size_t lastIndex = evData.size() - 1;
-#ifdef _DEBUG2
-	std::cout << "_loadRawEventData() - Have " << nEventOutOfBounds << " out-of-bound events" << std::endl;
-	std::cout << "First time stamp at t=" << firstTimeStamp << " us\n" 
-		<< "First event at t=" << evData[0].t << " us  [x:" << evData[0].x
-		<< " y:" << evData[0].y << "]  pol=" << (evData[0].p ? "+" : "-") << std::endl;
-	std::cout << "Last event at  t=" << evData[lastIndex].t << " us  [x:" << evData[lastIndex].x
-		<< " y:" << evData[lastIndex].y << "]  pol=" << (evData[lastIndex].p ? "+" : "-") << std::endl;
+/*!
+Part of a time window of EBI::EventData within one time segment of the source and one of
+the output, see _forEachPiece()
+*/
+struct _WindowPiece
+{
+	size_t iFirst, iEnd;	//!< events that may belong to the piece
+	uint32_t tLow, tHigh;	//!< events with time in [tLow, tHigh] within their segment belong to the piece
+	uint32_t dt;			//!< added to the time of the events, modulo 2^32
+	uint64_t tOutBase;		//!< time segment of the output
+};
 
-#endif
-	// consistency check - not part of Metavision SDK
-	// tries to deal with corrupt data
-	// check if time is monotonic
-	int64_t t_prev = evData[0].t;
-	int64_t t_end = evData[lastIndex].t;
-
-	if (t_prev > t_end) {
-		std::cout << "CAUTION: data may be faulty! first event (" << t_prev 
-			<< " us) after end (" << t_end << " us)" << std::endl;
-		evData[0].t = 0;
-		t_prev = evData[0].t;
-	}
-	int nBadTiming = 0;
-	for (size_t i = 0; i < evData.size(); i++)
-	{
-		int64_t t_now = evData[i].t;
-		if (t_now > t_end) {
-			nBadTiming++;
-			// correct if exceeding t_max
-			evData[i].t = static_cast<uint32_t>(t_prev);
-		}
-		else if (t_now < t_prev) {
-			nBadTiming++;
+/*!
+Split the time window [\a t1, \a t2] of \a src at the starts of its time segments and of those
+of the output, whose times are reduced by \a tSub, and call \a fn(piece) for each _WindowPiece
+holding events. Times include the segments, see EBI::TimeSegment. All pieces are found before
+the first call, so \a fn may compact the events of \a src in place. A window within one segment
+of source and output is a single piece and needs no allocation.
+*/
+template <typename PieceFn>
+static void _forEachPiece(const EBI::EventData& src, const uint64_t t1, const uint64_t t2,
+	const uint64_t tSub, PieceFn fn)
+{
+	constexpr uint64_t SEGMENT_MASK = EBI::TIME_SEGMENT_USEC - 1;
+	if (src.empty() || (t2 < t1))
+		return;
+	_WindowPiece first = {};
+	bool bFirst = false;
+	std::vector<_WindowPiece> more;
+	for (uint64_t a = t1; ; ) {
+		// end of piece: end of window, of the segment of the source or of the output
+		uint64_t b = std::min(t2, a | SEGMENT_MASK);
+		if (a >= tSub)
+			b = std::min(b, tSub + ((a - tSub) | SEGMENT_MASK));
+		_WindowPiece piece;
+		src.timeRange(a, b, piece.iFirst, piece.iEnd);
+		if (piece.iEnd > piece.iFirst) {
+			const uint64_t tBase = a & ~SEGMENT_MASK;
+			piece.tLow = static_cast<uint32_t>(a - tBase);
+			piece.tHigh = static_cast<uint32_t>(b - tBase);
+			piece.dt = static_cast<uint32_t>(tBase - tSub);
+			piece.tOutBase = (a >= tSub) ? ((a - tSub) & ~SEGMENT_MASK) : 0;
+			if (!bFirst)
+				first = piece;
+			else
+				more.push_back(piece);
+			bFirst = true;
 		}
-		t_prev = evData[i].t;
-	}
-	if (nBadTiming > 0) {
-		std::cout << "CAUTION: data may be faulty! Have " << nBadTiming << " timing inconsistencies (non-monotonic)" << std::endl;
-	}
-	if (nEventOutOfBounds) {
-		std::cout << "CAUTION: data may be faulty! Have " << nEventOutOfBounds << " out-of-bound events" << std::endl;
+		if (b >= t2)
+			break;
+		a = b + 1;
 	}
+	if (!bFirst)
+		return;
+	fn(first);
+	for (const _WindowPiece& piece : more)
+		fn(piece);
+}
 
-	if (bDebugMessages) {
-		std::cout << "Number of events: " << evData.size() 
-			<< "\nNumber of trigger events: " << trigCount << std::endl;
-	}
-	return retCode;
+//! list output segment \a tBase of the events [nBefore, nAfter) in \a pSegments, if set and not yet listed
+static void _addSegment(std::vector<EBI::TimeSegment>* pSegments, const uint64_t tBase,
+	const size_t nBefore, const size_t nAfter)
+{
+	if ((pSegments == nullptr) || (nAfter == nBefore))
+		return;
+	if (tBase > (pSegments->empty() ? 0 : pSegments->back().tBase))
+		pSegments->push_back(EBI::TimeSegment(tBase, nBefore));
+}
+
+/*!
+Append the events of \a src with time in [\a t1, \a t2] accepted by \a sel to \a dst, times reduced
+by \a tSub. The time segments of \a dst are added to \a pDstSegments, if set.
+*/
+template <typename SelectFn>
+static void _copyWindow(const EBI::EventData& src, const uint64_t t1, const uint64_t t2, const uint64_t tSub,
+	std::vector<EBI::Event>& dst, std::vector<EBI::TimeSegment>* pDstSegments, const int32_t nThreads, SelectFn sel)
+{
+	_forEachPiece(src, t1, t2, tSub, [&](const _WindowPiece& piece) {
+		const size_t nBefore = dst.size();
+		const uint32_t tLow = piece.tLow, tHigh = piece.tHigh, dt = piece.dt;
+		_copySelected(src.dataRef(), piece.iFirst, piece.iEnd, dst, nThreads,
+			[tLow, tHigh, dt, &sel](EBI::Event& ev) {
+				if ((ev.t < tLow) || (ev.t > tHigh) || !sel(ev))
+					return false;
+				ev.t += dt;
+				return true;
+			});
+		_addSegment(pDstSegments, piece.tOutBase, nBefore, dst.size());
+	});
 }
 
 EBI::EventData::EventData()
@@ -651,16 +506,60 @@ EBI::EventData::EventData(const std::string& fnameRawEvents)
 	loadRawData(fnameRawEvents);
 }
 
+/*!
+Move constructor, takes over the events of \a src without copying; \a src is left empty
+*/
+EBI::EventData::EventData(EBI::EventData&& src) noexcept
+{
+	init();
+	*this = std::move(src);
+}
+
 EBI::EventData::~EventData()
 {
 
 }
 
+/*!
+Move assignment, takes over the events and indexes of \a src without copying; \a src is left empty
+*/
+EBI::EventData& EBI::EventData::operator=(EBI::EventData&& src) noexcept
+{
+	if (this == &src)
+		return *this;
+	m_events = std::move(src.m_events);
+	m_timeSegments = std::move(src.m_timeSegments);
+	m_timeIndex = std::move(src.m_timeIndex);
+	m_tileIndex = std::move(src.m_tileIndex);
+	m_tileSize = src.m_tileSize;
+	m_triggerEvents = std::move(src.m_triggerEvents);
+	m_triggerSegments = std::move(src.m_triggerSegments);
+	m_camSpecs = std::move(src.m_camSpecs);
+	m_errMsg = std::move(src.m_errMsg);
+	m_nDebugLevel = src.m_nDebugLevel;
+	m_nThreads = src.m_nThreads;
+	m_timeStamp = src.m_timeStamp;
+	m_maxEvents = src.m_maxEvents;
+	m_decodeParams = src.m_decodeParams;
+	m_loadStats = src.m_loadStats;
+	src.init();
+	return *this;
+}
+
 void EBI::EventData::setMaximumSize(const uint64_t nMaxCnt)
 {
 	m_maxEvents = nMaxCnt;
 }
 
+/*!
+Set options used for decoding of Metavision RAW files, 
+e.g. decoding from memory-mapped file instead of buffered reading
+*/
+void EBI::EventData::setDecodeParams(const EBI::RawDecodeParams& decParams)
+{
+	m_decodeParams = decParams;
+}
+
 bool EBI::EventData::isNull()
 {
 	return (m_events.size() == 0) 
@@ -680,7 +579,7 @@ Constructor copying from other instance
 */
 EBI::EventData::EventData(const EBI::EventData& src,
 	const EBI::EventPolarity polMode,	//!< copy only events iwth the specified polarity
-	const int32_t offsetUSec,
+	const int64_t offsetUSec,
 	const int32_t durationUSec,
 	bool bSubtractOffsetTime)
 {
@@ -698,17 +597,16 @@ bool EBI::EventData::copyFrom(const EBI::EventData& src)
 	m_timeStamp = src.m_timeStamp;
 	if (m_nDebugLevel > 0)
 		std::cout << "EventData::copyFrom() - complete copy" << std::endl;
-	for (EBI::Event ev : src.m_events) {
-		m_events.push_back(ev);
-	}
-	for (EBI::TriggerEvent ev : src.m_triggerEvents) {
-		m_triggerEvents.push_back(ev);
-	}
+	// assignment reuses the storage of this instance
+	m_events = src.m_events;
+	m_timeSegments = src.m_timeSegments;
+	m_triggerEvents = src.m_triggerEvents;
+	m_triggerSegments = src.m_triggerSegments;
 	return true;
 }
 
 bool EBI::EventData::copyFrom(const EBI::EventData& src,
-	const int32_t offsetUSec,
+	const int64_t offsetUSec,
 	const int32_t durationUSec)
 {
 	init();
@@ -716,25 +614,22 @@ bool EBI::EventData::copyFrom(const EBI::EventData& src,
 	m_timeStamp = src.m_timeStamp;
 	if (m_nDebugLevel > 0)
 		std::cout << "EventData::copyFrom(t0=" << offsetUSec << "  duration=" << durationUSec << ")" << std::endl;
-	int32_t t1 = offsetUSec;
-	int32_t t2 = offsetUSec + durationUSec;
+	if (src.m_events.empty())
+		return true;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	uint64_t t2 = t1 + static_cast<uint32_t>(durationUSec);
 	if (durationUSec == 0) {
 		// use end time in source
-		t2 = src.m_events[src.m_events.size() - 1].t;
-	}
-	for (EBI::Event ev : src.m_events) {
-		if (ev.t >= static_cast<uint32_t>(t1)) {
-			if (ev.t <= static_cast<uint32_t>(t2)) {
-				m_events.push_back(ev);
-			}
-		}
+		t2 = src.eventTime(src.m_events.size() - 1);
 	}
+	_copyWindow(src, t1, t2, 0, m_events, &m_timeSegments, m_nThreads,
+		[](EBI::Event&) { return true; });
 	return true;
 }
 
 bool EBI::EventData::copyFrom(const EBI::EventData& src,
 		const EBI::EventPolarity polMode,	//!< copy only events with the specified polarity
-		const int32_t offsetUSec,
+		const int64_t offsetUSec,
 		const int32_t durationUSec,
 		bool bSubtractOffsetTime)
 {
@@ -743,27 +638,17 @@ bool EBI::EventData::copyFrom(const EBI::EventData& src,
 	m_timeStamp = src.m_timeStamp;
 	if (m_nDebugLevel > 0)
 		std::cout << "EventData::copyFrom(t0=" << offsetUSec << "  duration=" << durationUSec << ")" << std::endl;
+	if (src.m_events.empty())
+		return true;
 	// only copy events within specified time
-	int32_t t1 = offsetUSec;
-	int32_t t2 = offsetUSec + durationUSec;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	uint64_t t2 = t1 + static_cast<uint32_t>(durationUSec);
 	if (durationUSec == 0) {
 		// use end time in source
-		t2 = src.m_events[src.m_events.size() - 1].t;
-	}
-	for (EBI::Event ev : src.m_events) {
-		if (ev.t >= static_cast<uint32_t>(t1)) {
-			if (ev.t <= static_cast<uint32_t>(t2)) {
-				if (bSubtractOffsetTime)
-					ev.t -= offsetUSec;
-				if (polMode == EBI::PolarityBoth)
-					m_events.push_back(ev);
-				else if ((ev.p > 0) && (polMode == EBI::PolarityPositive))
-					m_events.push_back(ev);
-				else if ((ev.p == 0) && (polMode == EBI::PolarityNegative))
-					m_events.push_back(ev);
-			}
-		}
+		t2 = src.eventTime(src.m_events.size() - 1);
 	}
+	_copyWindow(src, t1, t2, bSubtractOffsetTime ? t1 : 0, m_events, &m_timeSegments, m_nThreads,
+		[polMode](EBI::Event& ev) { return _hasPolarity(ev, polMode); });
 	return true;
 }
 
@@ -773,7 +658,7 @@ Constructor copying from other instance
 EBI::EventData::EventData(const EBI::EventData& src,
 	const int32_t x, const int32_t y,
 	const int32_t w, const int32_t h,
-	const int32_t offsetUSec,	//!< offset from start in [usec]  
+	const int64_t offsetUSec,	//!< offset from start in [usec]  
 	const int32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 )
 {
@@ -784,59 +669,11 @@ EBI::EventData::EventData(const EBI::EventData& src,
 bool EBI::EventData::copyFrom(const EBI::EventData& src,
 		const int32_t x, const int32_t y,
 		const int32_t w, const int32_t h,
-		const int32_t offsetUSec,	//!< offset from start in [usec]  
+		const int64_t offsetUSec,	//!< offset from start in [usec]  
 		const int32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 	)
 {
-	init();
-	m_camSpecs = src.m_camSpecs;
-	m_timeStamp = src.m_timeStamp;
-	// only copy events within specified time
-	int32_t t1 = offsetUSec;
-	int32_t t2 = t1 + durationUSec;
-	bool bUseFullTime = false;
-	if (m_nDebugLevel > 0)
-		std::cout << "EventData::copyFrom(t0=" << offsetUSec << "  duration=" << durationUSec << ")" << std::endl;
-	if (src.m_events.size() > 0) {
-		if (t2 == t1) {
-			// use end time
-			t2 = src.m_events[src.m_events.size() - 1].t;
-			bUseFullTime = true;
-		}
-
-		if (bUseFullTime) {
-			for (EBI::Event ev : src.m_events) {
-				if ((ev.y >= y) && (ev.y < (y + h))) {
-					if ((ev.x >= x) && (ev.x < (x + w))) {
-						ev.x -= x;
-						ev.y -= y;
-						ev.t -= t1;
-						m_events.push_back(ev);
-					}
-				}
-			}
-		}
-		else {
-			for (EBI::Event ev : src.m_events) {
-				if ((ev.t >= static_cast<uint32_t>(t1)) 
-					&& (ev.t < static_cast<uint32_t>(t2))
-					) {
-					if ((ev.y >= y) && (ev.y < (y + h))) {
-						if ((ev.x >= x) && (ev.x < (x + w))) {
-							ev.x -= x;
-							ev.y -= y;
-							ev.t -= t1;
-							m_events.push_back(ev);
-						}
-					}
-				}
-			}
-		}
-	}
-	// todo: add structure with ROI info
-	m_camSpecs.sensorH = h;	// probably should use individual identifier for ROI
-	m_camSpecs.sensorW = w;
-	return true;
+	return copyFrom(src, EBI::PolarityBoth, x, y, w, h, offsetUSec, durationUSec);
 }
 
 /*!
@@ -846,7 +683,7 @@ EBI::EventData::EventData(const EBI::EventData& src,
 	const EBI::EventPolarity polMode,	//!< copy only events iwth the specified polarity
 	const int32_t x, const int32_t y,
 	const int32_t w, const int32_t h,
-	const int32_t offsetUSec,	//!< offset from start in [usec]  
+	const int64_t offsetUSec,	//!< offset from start in [usec]  
 	const int32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 )
 {
@@ -858,7 +695,7 @@ bool EBI::EventData::copyFrom(const EBI::EventData& src,
 	const EBI::EventPolarity polMode,	//!< copy only events iwth the specified polarity
 	const int32_t x, const int32_t y,
 	const int32_t w, const int32_t h,
-	const int32_t offsetUSec,	//!< offset from start in [usec]  
+	const int64_t offsetUSec,	//!< offset from start in [usec]  
 	const int32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 )
 {
@@ -866,51 +703,24 @@ bool EBI::EventData::copyFrom(const EBI::EventData& src,
 	m_camSpecs = src.m_camSpecs;
 	m_timeStamp = src.m_timeStamp;
 	// only copy events within specified time
-	int32_t t1 = offsetUSec;
-	int32_t t2 = t1 + durationUSec;
-	bool bUseFullTime = false;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
 	if (m_nDebugLevel > 0)
 		std::cout << "EventData::copyFrom(t0=" << offsetUSec << "  duration=" << durationUSec << ")" << std::endl;
 	if (src.m_events.size() > 0) {
-		if (t2 == t1) {
-			// use end time
-			t2 = src.m_events[src.m_events.size() - 1].t;
-			bUseFullTime = true;
-		}
-
-		if (bUseFullTime) {
-			for (EBI::Event ev : src.m_events) {
-				if ((ev.y >= y) && (ev.y < (y + h))) {
-					if ((ev.x >= x) && (ev.x < (x + w))) {
-						ev.x -= x;
-						ev.y -= y;
-						ev.t -= t1;
-						if (polMode == EBI::PolarityBoth)
-							m_events.push_back(ev);
-						else if ((ev.p > 0) && (polMode == EBI::PolarityPositive))
-							m_events.push_back(ev);
-						else if ((ev.p == 0) && (polMode == EBI::PolarityNegative))
-							m_events.push_back(ev);
-						//m_events.push_back(ev);
-					}
-				}
-			}
+		auto selROI = [x, y, w, h, polMode](EBI::Event& ev) {
+			if ((ev.y < y) || (ev.y >= (y + h)) || (ev.x < x) || (ev.x >= (x + w)) || !_hasPolarity(ev, polMode))
+				return false;
+			ev.x -= x;
+			ev.y -= y;
+			return true;
+		};
+		if (durationUSec == 0) {
+			// use full duration
+			_copyWindow(src, 0, src.timeIndex().timeMax(), t1, m_events, &m_timeSegments, m_nThreads, selROI);
 		}
 		else {
-			for (EBI::Event ev : src.m_events) {
-				if ((ev.t >= static_cast<uint32_t>(t1))
-					&& (ev.t < static_cast<uint32_t>(t2))
-					) {
-					if ((ev.y >= y) && (ev.y < (y + h))) {
-						if ((ev.x >= x) && (ev.x < (x + w))) {
-							ev.x -= x;
-							ev.y -= y;
-							ev.t -= t1;
-							m_events.push_back(ev);
-						}
-					}
-				}
-			}
+			// [t1, t2)
+			_copyWindow(src, t1, t1 + static_cast<uint32_t>(durationUSec) - 1, t1, m_events, &m_timeSegments, m_nThreads, selROI);
 		}
 	}
 	// todo: add structure with ROI info
@@ -923,12 +733,18 @@ bool EBI::EventData::copyFrom(const EBI::EventData& src,
 void EBI::EventData::init()
 {
 	m_events.resize(0);
+	m_timeSegments.clear();
+	invalidateIndex();
+	m_tileSize = 0;
 	m_triggerEvents.resize(0);
+	m_triggerSegments.clear();
 	m_timeStamp = 0;
 	m_camSpecs.init();
 	m_errMsg = "";
 	m_nDebugLevel = 0;
 	m_maxEvents = 100'000'000;	// about 3.5s at 30MEv/s
+	m_decodeParams.init();
+	m_loadStats.init();
 }
 
 /*!
@@ -944,19 +760,73 @@ void EBI::EventData::setDebugLevel(const int32_t nLevel)
 /*!
 Access to event data; provides complete copy of vector
 */
-std::vector<EBI::Event> EBI::EventData::data()
+std::vector<EBI::Event> EBI::EventData::data() const
 {
 	return m_events;
 }
 
 /*!
-Access to reference of event data
+Access to reference of event data.
+The events may be changed through the reference, so time and tile index are rebuilt on next use.
 */
 std::vector<EBI::Event>& EBI::EventData::dataRef()
 {
+	invalidateIndex();
 	return m_events;
 }
 
+//! discard time and tile index after the events changed
+void EBI::EventData::invalidateIndex()
+{
+	m_timeIndex.clear();
+	m_tileIndex.clear();
+}
+
+/*!
+Use a tile index of \a tileSize x \a tileSize pixels in getSample(), 0 to scan all events of the time window.
+The index takes 4 bytes per event and is built on the next call of getSample().
+*/
+void EBI::EventData::setTileSize(const uint32_t tileSize)
+{
+	if (tileSize != m_tileSize)
+		m_tileIndex.clear();
+	m_tileSize = tileSize;
+}
+
+/*!
+Tile index, built on first use after the events changed
+\return nullptr if no tile size is set
+*/
+const EBI::TileIndex* EBI::EventData::tileIndex()
+{
+	if (m_tileSize == 0)
+		return nullptr;
+	if (!m_tileIndex.isBuilt() || (m_tileIndex.size() != m_events.size()))
+		m_tileIndex.build(m_events, m_tileSize, m_timeSegments);
+	return &m_tileIndex;
+}
+
+/*!
+Index of event times, built on first use after the events changed.
+Not safe to call from several threads while the index is built.
+*/
+const EBI::TimeIndex& EBI::EventData::timeIndex() const
+{
+	if (!m_timeIndex.isBuilt() || (m_timeIndex.size() != m_events.size()))
+		m_timeIndex.build(m_events, m_timeSegments);
+	return m_timeIndex;
+}
+
+/*!
+Events [\a iFirst, \a iEnd) include all events with time in [\a t1, \a t2], times including
+the time segment of the events, see eventTime(). For events sorted in time these are exactly
+the events of the window, otherwise callers still have to test the time of each event.
+*/
+void EBI::EventData::timeRange(const uint64_t t1, const uint64_t t2, size_t& iFirst, size_t& iEnd) const
+{
+	timeIndex().range(m_events, t1, t2, iFirst, iEnd);
+}
+
 /*!
 Access to trigger event data; provides complete copy of vector
 */
@@ -979,55 +849,34 @@ Load data from RAW data file
 \return true on success, false on failure (e.g. missing file, worng format)
 */
 bool EBI::EventData::loadRawData(const std::string& fnameRawEvents,
-	const uint32_t offsetUSec,	//!< offset from start in [usec]  
-	const uint32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
+	const EBI::EventFilter& filter	//!< time window, ROI and polarity of events to load
 )
 {
 #ifdef _DEBUG2
 	m_nDebugLevel = 1;
 #endif
 	m_events.resize(0);
+	invalidateIndex();
 	m_triggerEvents.resize(0);
 	m_timeStamp = 0;
 	m_camSpecs.init();
-	return _loadRawEventData(
+	return EBI::LoadRawEventData(
 		fnameRawEvents, 
 		m_events, 
 		m_triggerEvents, 
+		m_timeSegments,
+		m_triggerSegments,
 		m_timeStamp,
 		m_camSpecs, 
-		offsetUSec,
+		filter.offsetUSec,
+		filter.durationUSec,
 		m_maxEvents, 
+		m_decodeParams,
+		m_loadStats,
+		filter,
 		m_nDebugLevel>0);
 }
 
-/*! \cond
- * header for event data files
- */
-struct _EVENT_FILE_HDR 
-{
-	int32_t		Signature;		//!< "EVT3"
-	uint64_t	FileSize;		//!< size in bytes including header
-	uint64_t	EventCount;		//!< number of events in file
-	uint64_t	TimeStamp;		//!< time in [usec] of first event from RAW file
-	uint32_t	Duration;		//!< in [usec]
-	uint32_t	HeaderLength;	//!< should be 64 
-	uint32_t	cols, rows;		//!< size of image
-	uint32_t	_reserved1; //!< bytes 49...52
-	uint32_t	_reserved2; //!< bytes 53...56
-	uint32_t	_reserved3; //!< bytes 57...60
-	uint32_t	_reserved4; //!< bytes 61...64
-};
-#define _EVENT_FILE_HDR_SIZE 64
-
-struct PACKED_EVENT
-{
-	uint16_t	x, y;		//!< pixel coords
-	uint32_t	timePol;	//!< time in [usec] with polarity in lowest bit
-};
-#define _PACKED_EVENT_SIZE 8
-//! \endcond 
-
 /* alternative way
 union {
 	struct {
@@ -1055,108 +904,539 @@ union {
 //BitEventFast ev_f;
 //ev_f.ev = x | (y << 16) | (time << 32) | (t << 63);
 
-bool EBI::EventData::save(const std::string& fnameEvents,
-	const uint32_t offsetUSec, const uint32_t durationUSec)
+/*!
+Pack the events of \a view in [\a pFirst, \a pEnd) selected by the view to \a pOut and return
+the number packed. Times of all these events are \a tBase plus their time within their segment
+and lie within the file segment \a tSegment. Events are written unconditionally and the output
+advanced only for selected ones, so the loop has no branches besides contains().
+*/
+static size_t _packEvents(const EBI::EventView& view, const EBI::Event* pFirst, const EBI::Event* pEnd,
+	const uint64_t tBase, const uint64_t tSegment, PACKED_EVENT* pOut)
 {
-	if (m_events.size() == 0)
-		return false;	// no data to save
+	// time within the file segment is the time within the source segment plus dt, modulo 2^32
+	const uint32_t dt = static_cast<uint32_t>(tBase - tSegment);
+	size_t n = 0;
+	for (const EBI::Event* p = pFirst; p < pEnd; p++) {
+		const EBI::Event ev = view.relative(*p);
+		pOut[n].x = ev.x;
+		pOut[n].y = ev.y;
+		pOut[n].timePol = ((p->t + dt) << 1) | ((ev.p > 0) ? 0x1 : 0x0);
+		n += view.contains(*p) ? 1 : 0;
+	}
+	return n;
+}
 
-	// figure out which samples to write
-	uint32_t t1 = offsetUSec;
-	uint32_t t2 = t1 + durationUSec;
-	if (t1 >= m_events[m_events.size() - 1].t) {
-		// out of range
-		std::cerr << "EBI::EventData::save(): Error: start time beyond range" << std::endl;
-		return false;
+/*!
+Write the events of \a view selected by its window, ROI and polarity in blocks, followed by the
+block index and the footer, and set event count and file size of \a hdr. A block ends when it is
+full or when the next event is earlier than its first, more than 31 bits later or in another
+time segment, see _EVENT_FILE_BLOCK. With \a bCoded the blocks of each write are compressed
+on \a nThreads threads, see EBI::EncodeEventBlock().
+*/
+static void _writeEventBlocks(std::ofstream& outFile, const EBI::EventView& view, _EVENT_FILE_HDR& hdr,
+	const bool bCoded, const int32_t nThreads)
+{
+	std::vector<PACKED_EVENT> buffer(SAVE_BLOCKS_PER_WRITE * _EVENT_FILE_BLOCK_EVENTS);
+	std::vector<std::vector<uint8_t> > coded(bCoded ? SAVE_BLOCKS_PER_WRITE : 0);
+	std::vector<_EVENT_FILE_BLOCK> index;
+	size_t nPending = 0;	// blocks in buffer not written yet, the last is being filled
+	_EVENT_FILE_BLOCK block = {};
+	uint64_t nOffset = _EVENT_FILE_HDR_SIZE;
+	auto write = [&]() {
+		const size_t kFirst = index.size() - nPending;
+		if (bCoded) {
+			EBI::ParallelFor(nPending, nThreads, [&](const size_t k) {
+				coded[k].clear();
+				EBI::EncodeEventBlock(buffer.data() + k * _EVENT_FILE_BLOCK_EVENTS, index[kFirst + k].EventCount, coded[k]);
+			});
+		}
+		for (size_t k = 0; k < nPending; k++) {
+			_EVENT_FILE_BLOCK& entry = index[kFirst + k];
+			const char* pData = bCoded ? reinterpret_cast<const char*>(coded[k].data())
+				: reinterpret_cast<const char*>(buffer.data() + k * _EVENT_FILE_BLOCK_EVENTS);
+			entry.Offset = nOffset;
+			entry.ByteCount = static_cast<uint32_t>(bCoded ? coded[k].size() : entry.EventCount * _PACKED_EVENT_SIZE);
+			outFile.write(pData, entry.ByteCount);
+			nOffset += entry.ByteCount;
+		}
+		nPending = 0;
+	};
+	auto flush = [&]() {
+		hdr.EventCount += block.EventCount;
+		index.push_back(block);
+		block.EventCount = 0;
+		if (++nPending == SAVE_BLOCKS_PER_WRITE)
+			write();
+	};
+	for (const EBI::Event& evIn : view) {
+		if (!view.contains(evIn))
+			continue;
+		const EBI::Event ev = view.relative(evIn);
+		const uint64_t t = view.time(evIn);
+		if ((block.EventCount > 0) && ((block.EventCount == _EVENT_FILE_BLOCK_EVENTS) || (t < block.TimeFirst)
+			|| (t - block.TimeFirst > EBI::PACKED_TIME_MAX) || ((t ^ block.TimeFirst) >= EBI::TIME_SEGMENT_USEC)))
+			flush();
+		if (block.EventCount == 0) {
+			block.TimeFirst = block.TimeLast = t;
+			block.xMin = block.xMax = ev.x;
+			block.yMin = block.yMax = ev.y;
+		}
+		PACKED_EVENT& pe = buffer[nPending * _EVENT_FILE_BLOCK_EVENTS + block.EventCount++];
+		pe.x = ev.x;
+		pe.y = ev.y;
+		pe.timePol = (static_cast<uint32_t>(t - block.TimeFirst) << 1) | ((ev.p > 0) ? 0x1 : 0x0);
+		block.TimeLast = std::max(block.TimeLast, t);
+		block.xMin = std::min(block.xMin, ev.x);
+		block.xMax = std::max(block.xMax, ev.x);
+		block.yMin = std::min(block.yMin, ev.y);
+		block.yMax = std::max(block.yMax, ev.y);
+	}
+	if (block.EventCount > 0)
+		flush();
+	if (nPending > 0)
+		write();
+
+	_EVENT_FILE_FOOTER footer = {};
+	footer.IndexOffset = nOffset;
+	footer.BlockCount = static_cast<uint32_t>(index.size());
+	footer.BlockEvents = _EVENT_FILE_BLOCK_EVENTS;
+	footer.Version = _EVENT_FILE_BLOCKS_VERSION;
+	footer.Signature = _EVENT_FILE_FOOTER_SIGNATURE;
+	outFile.write(reinterpret_cast<const char*>(index.data()), index.size() * _EVENT_FILE_BLOCK_SIZE);
+	outFile.write(reinterpret_cast<const char*>(&footer), _EVENT_FILE_FOOTER_SIZE);
+	hdr.FileSize = nOffset + index.size() * _EVENT_FILE_BLOCK_SIZE + _EVENT_FILE_FOOTER_SIZE;
+}
+
+/*!
+Tile size and block duration of tiled event files written with the flow evaluation \a params:
+tiles of one grid step, so that each sample window covers whole tiles of the grid, and time
+blocks of one time step. Sample sizes are used for steps not set.
+*/
+static void _tileLayout(const EBI::EventFlowEvalParams& params, uint32_t& tileW, uint32_t& tileH, uint32_t& blockUSec)
+{
+	tileW = static_cast<uint32_t>((params.stepX > 0) ? params.stepX : ((params.sampleX > 0) ? params.sampleX : TILE_SIZE_DEFAULT));
+	tileH = static_cast<uint32_t>((params.stepY > 0) ? params.stepY : ((params.sampleY > 0) ? params.sampleY : TILE_SIZE_DEFAULT));
+	blockUSec = static_cast<uint32_t>((params.stepTime > 0) ? params.stepTime : ((params.sampleTime > 0) ? params.sampleTime : TIME_BUCKET_USEC));
+}
+
+/*!
+Write the events of \a view selected by its window, ROI and polarity grouped by tile of
+the image and by time block within each tile, followed by the block index, the first block
+of each tile and the footer, and set event count and file size of \a hdr, see
+_EVENT_FILE_TILES_FOOTER. Events are distributed to their tiles by a counting sort and
+ordered by time block within each tile, keeping their order of the file within each block.
+*/
+static void _writeEventTiles(std::ofstream& outFile, const EBI::EventView& view, _EVENT_FILE_HDR& hdr,
+	const EBI::EventFlowEvalParams& params)
+{
+	struct TileEvent
+	{
+		uint64_t t;		// time relative to the view
+		uint64_t n;		// number of the event in the file
+		uint16_t x, y;
+		uint8_t p;
+	};
+	_EVENT_FILE_TILES_FOOTER footer = {};
+	_tileLayout(params, footer.TileW, footer.TileH, footer.BlockUSec);
+	footer.TilesX = std::max<uint32_t>(1, (hdr.cols + footer.TileW - 1) / footer.TileW);
+	footer.TilesY = std::max<uint32_t>(1, (hdr.rows + footer.TileH - 1) / footer.TileH);
+	const size_t nTiles = static_cast<size_t>(footer.TilesX) * footer.TilesY;
+	auto tileOf = [&footer](const EBI::Event& ev) {
+		return std::min<uint32_t>(ev.y / footer.TileH, footer.TilesY - 1) * footer.TilesX
+			+ std::min<uint32_t>(ev.x / footer.TileW, footer.TilesX - 1);
+	};
+
+	// counting sort of the selected events by tile
+	std::vector<uint64_t> tileStart(nTiles + 1, 0);
+	for (const EBI::Event& evIn : view) {
+		if (view.contains(evIn))
+			tileStart[tileOf(view.relative(evIn)) + 1]++;
 	}
-	if (t2 > m_events[m_events.size() - 1].t) {
-		t2 = m_events[m_events.size() - 1].t + 1;
+	for (size_t k = 0; k < nTiles; k++)
+		tileStart[k + 1] += tileStart[k];
+	std::vector<TileEvent> events(tileStart[nTiles]);
+	std::vector<uint64_t> tileNext(tileStart.begin(), tileStart.end() - 1);
+	uint64_t n = 0;
+	for (const EBI::Event& evIn : view) {
+		if (!view.contains(evIn))
+			continue;
+		const EBI::Event ev = view.relative(evIn);
+		events[tileNext[tileOf(ev)]++] = { view.time(evIn), n++, ev.x, ev.y, static_cast<uint8_t>((ev.p > 0) ? 1 : 0) };
 	}
-	size_t idx1 = 0;
-	if (t1 > 0) {
-		for (size_t i = 0; i < m_events.size(); i++) {
-			if (m_events[i].t >= t1) {
-				idx1 = i;
-				break;
+
+	// blocks of events of a tile within one time block, with event numbers relative to the
+	// first of the block within 32 bits
+	std::vector<_EVENT_FILE_TILE_BLOCK> index;
+	std::vector<uint32_t> tileFirst(nTiles + 1, 0);
+	std::vector<char> buffer;
+	uint64_t nOffset = _EVENT_FILE_HDR_SIZE;
+	for (size_t k = 0; k < nTiles; k++) {
+		tileFirst[k] = static_cast<uint32_t>(index.size());
+		TileEvent* pTile = events.data() + tileStart[k];
+		TileEvent* pTileEnd = events.data() + tileStart[k + 1];
+		std::stable_sort(pTile, pTileEnd, [&footer](const TileEvent& a, const TileEvent& b) {
+			return a.t / footer.BlockUSec < b.t / footer.BlockUSec; });
+		for (const TileEvent* pBlock = pTile; pBlock < pTileEnd; ) {
+			const uint64_t key = pBlock->t / footer.BlockUSec;
+			_EVENT_FILE_TILE_BLOCK block = {};
+			block.Offset = nOffset;
+			block.FirstEvent = pBlock->n;	// event numbers rise within each time block of a tile
+			block.TimeFirst = block.TimeLast = pBlock->t;
+			block.Tile = static_cast<uint32_t>(k);
+			const TileEvent* pEnd = pBlock;
+			for (; (pEnd < pTileEnd) && (pEnd->t / footer.BlockUSec == key) && (pEnd->n - block.FirstEvent < UINT32_MAX); pEnd++) {
+				block.TimeFirst = std::min(block.TimeFirst, pEnd->t);
+				block.TimeLast = std::max(block.TimeLast, pEnd->t);
 			}
-		}
-	}
-	size_t idx2 = m_events.size();
-	if (t2 < m_events[m_events.size() - 1].t) {
-		for (size_t i = idx1; i < m_events.size(); i++) {
-			if (m_events[i].t > t2) {
-				idx2 = i;
-				break;
+			block.EventCount = static_cast<uint32_t>(pEnd - pBlock);
+
+			// columns of times, event numbers, x, y and polarity
+			const size_t nEvents = block.EventCount;
+			const size_t nBytes = (nEvents * 13 + 7) & ~static_cast<size_t>(7);
+			buffer.assign(nBytes, 0);
+			uint32_t* pT = reinterpret_cast<uint32_t*>(buffer.data());
+			uint32_t* pN = pT + nEvents;
+			uint16_t* pX = reinterpret_cast<uint16_t*>(pN + nEvents);
+			uint16_t* pY = pX + nEvents;
+			uint8_t* pP = reinterpret_cast<uint8_t*>(pY + nEvents);
+			for (size_t i = 0; i < nEvents; i++) {
+				const TileEvent& ev = pBlock[i];
+				pT[i] = static_cast<uint32_t>(ev.t - block.TimeFirst);
+				pN[i] = static_cast<uint32_t>(ev.n - block.FirstEvent);
+				pX[i] = ev.x;
+				pY[i] = ev.y;
+				pP[i] = ev.p;
 			}
+			outFile.write(buffer.data(), nBytes);
+			nOffset += nBytes;
+			index.push_back(block);
+			pBlock = pEnd;
 		}
 	}
-	size_t numEventsOut = idx2 - idx1;
+	tileFirst[nTiles] = static_cast<uint32_t>(index.size());
+
+	footer.IndexOffset = nOffset;
+	footer.BlockCount = static_cast<uint32_t>(index.size());
+	footer.Version = _EVENT_FILE_TILES_VERSION;
+	footer.Signature = _EVENT_FILE_TILES_FOOTER_SIGNATURE;
+	outFile.write(reinterpret_cast<const char*>(index.data()), index.size() * _EVENT_FILE_TILE_BLOCK_SIZE);
+	outFile.write(reinterpret_cast<const char*>(tileFirst.data()), tileFirst.size() * sizeof(uint32_t));
+	outFile.write(reinterpret_cast<const char*>(&footer), _EVENT_FILE_TILES_FOOTER_SIZE);
+	hdr.EventCount = n;
+	hdr.FileSize = nOffset + index.size() * _EVENT_FILE_TILE_BLOCK_SIZE + tileFirst.size() * sizeof(uint32_t)
+		+ _EVENT_FILE_TILES_FOOTER_SIZE;
+}
 
+/*!
+Write the events of \a view selected by its window, ROI and polarity to event file \a fnameEvents,
+times and coordinates relative to the view. \a durationUSec is stored in the header.
+Times beyond 31 bits are split into the time segments of the file, listed after the events.
+Events are packed in chunks of SAVE_EVENTS_PER_WRITE and each chunk is written at once.
+Files of format \a eFormat EVT4 or EVTZ are written in blocks with index instead, see _writeEventBlocks(),
+files of format EVTT in tiles of the grid of \a tileParams, see _writeEventTiles().
+*/
+static bool _saveEventFile(const std::string& fnameEvents, const EBI::EventView& view,
+	const uint64_t durationUSec, const EBI::FileFormat eFormat, const int32_t nThreads,
+	std::string& errMsg, const char* strCaller,
+	const EBI::EventFlowEvalParams& tileParams = EBI::EventFlowEvalParams())
+{
+	const bool bBlocks = (eFormat == EBI::FILE_FORMAT_EVT4) || (eFormat == EBI::FILE_FORMAT_EVTZ);
 	bool retCode = true;
 	std::ofstream outFile(fnameEvents, std::ios::out | std::ios::binary);
 	try {
 		if (!outFile.is_open()) {
-			m_errMsg = "failed opening file for output";
+			errMsg = "failed opening file for output";
 			throw (-1);
 		}
 
-		_EVENT_FILE_HDR hdr;
-		hdr.Signature = 0x33545645; // "EVT3"
+		_EVENT_FILE_HDR hdr = {};
+		hdr.Signature = (eFormat == EBI::FILE_FORMAT_EVTZ) ? _EVENT_FILE_CODED_SIGNATURE
+			: (bBlocks ? _EVENT_FILE_BLOCKS_SIGNATURE
+			: ((eFormat == EBI::FILE_FORMAT_EVTT) ? _EVENT_FILE_TILES_SIGNATURE : _EVENT_FILE_SIGNATURE));
 		//hdr.Signature = 0x32545645; // "EVT2" - older format
 
-		hdr.FileSize = (sizeof(_EVENT_FILE_HDR) + (numEventsOut * _PACKED_EVENT_SIZE));
-		hdr.EventCount = numEventsOut;
-		hdr.Duration = (t2 - t1);
-		hdr.TimeStamp = m_timeStamp;
-		hdr.cols = m_camSpecs.sensorW;
-		hdr.rows = m_camSpecs.sensorH;
+		hdr.Duration = static_cast<uint32_t>(durationUSec);
+		hdr.DurationHigh = static_cast<uint32_t>(durationUSec >> 32);
+		hdr.SegmentSignature = _EVENT_FILE_SEGMENT_SIGNATURE;
+		hdr.TimeStamp = view.timeStamp();
+		hdr.cols = static_cast<uint32_t>(view.imageWidth());
+		hdr.rows = static_cast<uint32_t>(view.imageHeight());
 		hdr.HeaderLength = sizeof(_EVENT_FILE_HDR);
 
+		// event count is known after writing, header is rewritten at the end
 		outFile.write(reinterpret_cast<char*>(&hdr), _EVENT_FILE_HDR_SIZE);
 
-		// write out data - probably could be optimized by writing bigger chunks
-		for (size_t i = idx1; i < idx1 + numEventsOut; i++) {
-			PACKED_EVENT pe;
-			pe.x = m_events[i].x;
-			pe.y = m_events[i].y;
-			pe.timePol = (m_events[i].t << 1);
-			if (m_events[i].p > 0)
-				pe.timePol |= 0x1;
-			outFile.write((char*)&pe, _PACKED_EVENT_SIZE);
+		if (bBlocks)
+			_writeEventBlocks(outFile, view, hdr, eFormat == EBI::FILE_FORMAT_EVTZ, nThreads);
+		else if (eFormat == EBI::FILE_FORMAT_EVTT)
+			_writeEventTiles(outFile, view, hdr, tileParams);
+		else {
+			std::vector<PACKED_EVENT> buffer(SAVE_EVENTS_PER_WRITE);
+			std::vector<_EVENT_FILE_SEGMENT> segments;
+			uint64_t tSegment = 0;
+			uint64_t nWritten = 0;
+			for (const EBI::Event* pChunk = view.begin(); pChunk < view.end(); ) {
+				const EBI::Event* pChunkEnd = pChunk + std::min<size_t>(SAVE_EVENTS_PER_WRITE, view.end() - pChunk);
+				// time segment of the source and of the file are the same for first and last event
+				// of most chunks, which are then packed in one pass
+				const uint64_t tFirst = view.time(*pChunk);
+				const uint64_t tLast = view.time(*(pChunkEnd - 1));
+				const uint64_t tBase = tFirst - pChunk->t;
+				size_t n = 0;
+				if ((tLast - pChunkEnd[-1].t == tBase) && (static_cast<int64_t>(tFirst) >= 0) && (tLast >= tFirst)
+					&& (tFirst - tSegment < _EVENT_FILE_SEGMENT_USEC) && (tLast - tSegment < _EVENT_FILE_SEGMENT_USEC)) {
+					n = _packEvents(view, pChunk, pChunkEnd, tBase, tSegment, buffer.data());
+				}
+				else {
+					for (const EBI::Event* p = pChunk; p < pChunkEnd; p++) {
+						if (!view.contains(*p))
+							continue;
+						const EBI::Event ev = view.relative(*p);
+						const uint64_t t = view.time(*p);
+						if ((static_cast<int64_t>(t) >= 0) && (t - tSegment >= _EVENT_FILE_SEGMENT_USEC)
+							&& ((t & ~(_EVENT_FILE_SEGMENT_USEC - 1)) > tSegment)) {
+							tSegment = t & ~(_EVENT_FILE_SEGMENT_USEC - 1);
+							segments.push_back({ tSegment, nWritten + n });
+						}
+						PACKED_EVENT& pe = buffer[n++];
+						pe.x = ev.x;
+						pe.y = ev.y;
+						pe.timePol = (static_cast<uint32_t>(t - tSegment) << 1);
+						if (ev.p > 0)
+							pe.timePol |= 0x1;
+					}
+				}
+				outFile.write(reinterpret_cast<const char*>(buffer.data()), n * _PACKED_EVENT_SIZE);
+				nWritten += n;
+				pChunk = pChunkEnd;
+			}
+			if (!segments.empty())
+				outFile.write(reinterpret_cast<const char*>(segments.data()), segments.size() * _EVENT_FILE_SEGMENT_SIZE);
+			hdr.EventCount = nWritten;
+			hdr.SegmentCount = static_cast<uint32_t>(segments.size());
+			hdr.FileSize = sizeof(_EVENT_FILE_HDR) + (nWritten * _PACKED_EVENT_SIZE) + segments.size() * _EVENT_FILE_SEGMENT_SIZE;
+		}
+		outFile.seekp(0, std::ios::beg);
+		outFile.write(reinterpret_cast<char*>(&hdr), _EVENT_FILE_HDR_SIZE);
+		if (!outFile) {
+			errMsg = "failed writing file";
+			throw (-2);
 		}
-		//for (EBI::Event ev : m_events) {
-		//	PACKED_EVENT pe;
-		//	pe.x = ev.x;
-		//	pe.y = ev.y;
-		//	pe.timePol = (ev.t << 1);
-		//	if (ev.p > 0)
-		//		pe.timePol |= 0x1;
-		//	outFile.write((char*)&pe, _PACKED_EVENT_SIZE);
-		//}
 	}
 	catch (int errCode)
 	{
-		std::cerr << "ERROR(" << errCode << "): EBI::EventData::save() " << m_errMsg << std::endl;
+		std::cerr << "ERROR(" << errCode << "): " << strCaller << " " << errMsg << std::endl;
 		retCode = false;
 	}
 	if (outFile.is_open())
 		outFile.close();
+	return retCode;
+}
+
+/*!
+Save the events in [\a offsetUSec, \a offsetUSec + \a durationUSec] to event file \a fnameEvents,
+all events from \a offsetUSec on for \a durationUSec = 0. Times stay relative to the first event.
+*/
+bool EBI::EventData::save(const std::string& fnameEvents,
+	const uint64_t offsetUSec, const uint32_t durationUSec,
+	const EBI::FileFormat eFormat	//!< FILE_FORMAT_EVT3, FILE_FORMAT_EVT4 for blocks with time index, FILE_FORMAT_EVTZ for compressed blocks or FILE_FORMAT_EVTT for tiles, see saveTiled()
+)
+{
+	if (eFormat == EBI::FILE_FORMAT_EVTT)
+		return saveTiled(fnameEvents, EBI::EventFlowEvalParams(), offsetUSec, durationUSec);
+	if (m_events.size() == 0)
+		return false;	// no data to save
+	if ((eFormat != EBI::FILE_FORMAT_EVT3) && (eFormat != EBI::FILE_FORMAT_EVT4) && (eFormat != EBI::FILE_FORMAT_EVTZ)) {
+		std::cerr << "EBI::EventData::save(): Error: unsupported file format" << std::endl;
+		return false;
+	}
+
+	// figure out which samples to write
+	const uint64_t tLast = eventTime(m_events.size() - 1);
+	const uint64_t t1 = offsetUSec;
+	uint64_t t2 = (durationUSec == 0) ? (tLast + 1) : (t1 + durationUSec);
+	if (t1 >= tLast) {
+		// out of range
+		std::cerr << "EBI::EventData::save(): Error: start time beyond range" << std::endl;
+		return false;
+	}
+	if (t2 > tLast) {
+		t2 = tLast + 1;
+	}
+	// events in [t1, t2], found through the time index
+	EBI::EventView range(*this, EBI::PolarityBoth, static_cast<int64_t>(t1), static_cast<int32_t>(durationUSec), false);
+	bool retCode = _saveEventFile(fnameEvents, range, t2 - t1, eFormat, EBI::ThreadCount(m_nThreads), m_errMsg, "EBI::EventData::save()");
 	if (m_nDebugLevel > 0)
 		std::cout << "EBI::EventData::save('" << fnameEvents << "') - OK" << std::endl;
 	return retCode;
 }
 
+/*!
+Save the events in [\a offsetUSec, \a offsetUSec + \a durationUSec] to tiled event file \a fnameEvents
+(FILE_FORMAT_EVTT), for reading the samples of the flow evaluation with \a params through
+EBI::TiledEventData. Tiles are of one grid step stepX x stepY, time blocks of stepTime.
+Same time window as save().
+*/
+bool EBI::EventData::saveTiled(const std::string& fnameEvents, const EBI::EventFlowEvalParams& params,
+	const uint64_t offsetUSec, const uint32_t durationUSec)
+{
+	if (m_events.size() == 0)
+		return false;	// no data to save
+	const uint64_t tLast = eventTime(m_events.size() - 1);
+	const uint64_t t1 = offsetUSec;
+	const uint64_t t2 = ((durationUSec == 0) || (t1 + durationUSec > tLast)) ? (tLast + 1) : (t1 + durationUSec);
+	if (t1 >= tLast) {
+		std::cerr << "EBI::EventData::saveTiled(): Error: start time beyond range" << std::endl;
+		return false;
+	}
+	EBI::EventView range(*this, EBI::PolarityBoth, static_cast<int64_t>(t1), static_cast<int32_t>(durationUSec), false);
+	bool retCode = _saveEventFile(fnameEvents, range, t2 - t1, EBI::FILE_FORMAT_EVTT, EBI::ThreadCount(m_nThreads),
+		m_errMsg, "EBI::EventData::saveTiled()", params);
+	if (m_nDebugLevel > 0)
+		std::cout << "EBI::EventData::saveTiled('" << fnameEvents << "') - OK" << std::endl;
+	return retCode;
+}
+
+/*!
+Unpack the events of \a pIn with time within their file segment in [\a tLow, \a tHigh] and
+within ROI and polarity of \a pFilter (nullptr for all) to \a pOut, times plus \a tAdd and
+coordinates relative to the ROI, and return the number unpacked. Events are written
+unconditionally and the output advanced only for selected ones, the output must hold
+\a nEvents events.
+*/
+static size_t _unpackEventsScalar(const PACKED_EVENT* pIn, const size_t nEvents,
+	const uint32_t tAdd, const uint32_t tLow, const uint32_t tHigh,
+	const EBI::EventFilter* pFilter, EBI::Event* pOut)
+{
+	const uint16_t roiX = pFilter ? static_cast<uint16_t>(pFilter->roiX) : 0;
+	const uint16_t roiY = pFilter ? static_cast<uint16_t>(pFilter->roiY) : 0;
+	size_t n = 0;
+	for (size_t i = 0; i < nEvents; i++) {
+		const PACKED_EVENT pe = pIn[i];
+		const uint32_t t = pe.timePol >> 1;
+		EBI::Event& ev = pOut[n];
+		ev.t = tAdd + t;
+		ev.x = static_cast<uint16_t>(pe.x - roiX);
+		ev.y = static_cast<uint16_t>(pe.y - roiY);
+		ev.p = static_cast<int8_t>(pe.timePol & 0x1);
+		bool bSelected = (t - tLow <= tHigh - tLow);
+		if (pFilter)
+			bSelected = bSelected && (ev.x < pFilter->roiW) && (ev.y < pFilter->roiH) && pFilter->hasPolarity(ev.p);
+		n += bSelected ? 1 : 0;
+	}
+	return n;
+}
+
+#ifdef _EBI_SSE2
+static_assert((sizeof(EBI::Event) == 12) && (offsetof(EBI::Event, t) == 0) && (offsetof(EBI::Event, x) == 4)
+	&& (offsetof(EBI::Event, y) == 6) && (offsetof(EBI::Event, p) == 8), "unexpected layout of EBI::Event");
+static_assert((sizeof(PACKED_EVENT) == 8) && (offsetof(PACKED_EVENT, timePol) == 4), "unexpected layout of PACKED_EVENT");
+
+/*!
+Same as _unpackEventsScalar() without filter: groups of four events are unpacked at once
+and stored as a whole if all are within [\a tLow, \a tHigh], which is the case except at
+the edges of the time window
+*/
+static size_t _unpackEventsSSE2(const PACKED_EVENT* pIn, const size_t nEvents,
+	const uint32_t tAdd, const uint32_t tLow, const uint32_t tHigh, EBI::Event* pOut)
+{
+	// times within a file segment have 31 bits and are compared signed
+	const __m128i add = _mm_set1_epi32(static_cast<int>(tAdd));
+	const __m128i lowMinus1 = _mm_set1_epi32(static_cast<int>(tLow) - 1);
+	const __m128i high = _mm_set1_epi32(static_cast<int>(tHigh));
+	const __m128i one = _mm_set1_epi32(1);
+	size_t n = 0, i = 0;
+	for (; i + 4 <= nEvents; i += 4) {
+		// [xy0 tp0 xy1 tp1] [xy2 tp2 xy3 tp3] -> xy, time and polarity of four events
+		const __m128 a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i)));
+		const __m128 b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i + 2)));
+		const __m128 xy = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128i tp = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		const __m128i t = _mm_srli_epi32(tp, 1);
+		const __m128i inWindow = _mm_andnot_si128(_mm_cmpgt_epi32(t, high), _mm_cmpgt_epi32(t, lowMinus1));
+		if (_mm_movemask_ps(_mm_castsi128_ps(inWindow)) != 0xF) {
+			n += _unpackEventsScalar(pIn + i, 4, tAdd, tLow, tHigh, nullptr, pOut + n);
+			continue;
+		}
+		// four events occupy three registers: [t0 xy0 p0 t1] [xy1 p1 t2 xy2] [p2 t3 xy3 p3]
+		const __m128 p = _mm_castsi128_ps(_mm_and_si128(tp, one));
+		const __m128 ts = _mm_castsi128_ps(_mm_add_epi32(t, add));
+		const __m128 lo = _mm_unpacklo_ps(ts, xy);	// t0 xy0 t1 xy1
+		const __m128 hi = _mm_unpackhi_ps(ts, xy);	// t2 xy2 t3 xy3
+		const __m128 out0 = _mm_shuffle_ps(lo, _mm_shuffle_ps(p, lo, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+		const __m128 out1 = _mm_shuffle_ps(_mm_shuffle_ps(lo, p, _MM_SHUFFLE(1, 1, 3, 3)), hi, _MM_SHUFFLE(1, 0, 2, 0));
+		const __m128 out2 = _mm_shuffle_ps(_mm_shuffle_ps(p, hi, _MM_SHUFFLE(2, 2, 2, 2)),
+			_mm_shuffle_ps(hi, p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		float* pDst = reinterpret_cast<float*>(pOut + n);
+		_mm_storeu_ps(pDst, out0);
+		_mm_storeu_ps(pDst + 4, out1);
+		_mm_storeu_ps(pDst + 8, out2);
+		n += 4;
+	}
+	return n + _unpackEventsScalar(pIn + i, nEvents - i, tAdd, tLow, tHigh, nullptr, pOut + n);
+}
+#endif
+
+//! see _unpackEventsScalar()
+static size_t _unpackEvents(const PACKED_EVENT* pIn, const size_t nEvents,
+	const uint32_t tAdd, const uint32_t tLow, const uint32_t tHigh,
+	const EBI::EventFilter* pFilter, EBI::Event* pOut)
+{
+#ifdef _EBI_SSE2
+	if (pFilter == nullptr)
+		return _unpackEventsSSE2(pIn, nEvents, tAdd, tLow, tHigh, pOut);
+#endif
+	return _unpackEventsScalar(pIn, nEvents, tAdd, tLow, tHigh, pFilter, pOut);
+}
+
+/*!
+Load event data using the specified options for decoding RAW files
+\return True on success
+*/
+bool EBI::EventData::load(
+	const std::string& fnameEvents,
+	const EBI::RawDecodeParams& decParams,
+	const uint64_t offsetUSec,
+	const uint32_t durationUSec
+)
+{
+	setDecodeParams(decParams);
+	return load(fnameEvents, offsetUSec, durationUSec);
+}
+
 /*!
 Load event data
 Clears existing event data set
 \return True on success
 */
 bool EBI::EventData::load(
-	const std::string& fnameEvents, //!< file name, can be either Metavision RAW or own EVT3
-	const uint32_t offsetUSec,	//!< offset from start in [usec]  
+	const std::string& fnameEvents, //!< file name, can be either Metavision RAW or own EVT3 / EVT4 / EVTZ
+	const uint64_t offsetUSec,	//!< offset from start in [usec]  
 	const uint32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 )
 {
+	EBI::EventFilter filter;
+	filter.offsetUSec = offsetUSec;
+	filter.durationUSec = durationUSec;
+	return load(fnameEvents, filter);
+}
+
+/*!
+Load only the events selected by \a filter, without loading the entire data set first.
+With a ROI, coordinates and image size are relative to the ROI as after cropROI(),
+times remain relative to the first event in the file.
+Clears existing event data set
+\return True on success
+*/
+bool EBI::EventData::load(
+	const std::string& fnameEvents, //!< file name, can be either Metavision RAW or own EVT3 / EVT4 / EVTZ
+	const EBI::EventFilter& filter	//!< time window, ROI and polarity of events to load
+)
+{
+	const uint64_t offsetUSec = filter.offsetUSec;
+	const uint32_t durationUSec = filter.durationUSec;
+	EBI::EventFilter roiFilter = filter;
+
 	// determine type of file
 	EBI::FileFormat eType = EBI::GetFileType(fnameEvents);
 	if (eType == EBI::FILE_FORMAT_UNKNOWN) {
@@ -1164,75 +1444,236 @@ bool EBI::EventData::load(
 		return false;
 	}
 	else if (eType == EBI::FILE_FORMAT_RAWEVT3) {
-		return loadRawData(fnameEvents, offsetUSec, durationUSec);
+		return loadRawData(fnameEvents, filter);
+	}
+	else if (eType == EBI::FILE_FORMAT_EVTT) {
+		m_errMsg = "tiled event files are read through EBI::TiledEventData";
+		std::cerr << "ERROR: EBI::EventData::load() " << m_errMsg << std::endl;
+		return false;
 	}
 
-	// load EVT3 type instead...
+	// load own EVT3, EVT4 or EVTZ type instead...
 	bool retCode = true;
-	std::ifstream inFile(fnameEvents, std::ios::in | std::ios::binary);
+	m_loadStats.init();
+	EBI::MappedFile mappedFile;
 	try {
-		if (!inFile.is_open()) {
+		if (!mappedFile.open(fnameEvents, EBI::MappedFile::AccessRandom)) {
 			m_errMsg = "failed opening file";
 			throw (-1);
 		}
 		m_events.resize(0);
+		m_timeSegments.clear();
+		invalidateIndex();
 
+		if (mappedFile.size() < _EVENT_FILE_HDR_SIZE) {
+			m_errMsg = "file too short";
+			throw (-5);
+		}
 		_EVENT_FILE_HDR hdr;
-		inFile.read((char*)&hdr, _EVENT_FILE_HDR_SIZE);
-		//inFile.read(reinterpret_cast<char*>(hdr), _EVENT_FILE_HDR_SIZE);
+		memcpy(&hdr, mappedFile.data(), _EVENT_FILE_HDR_SIZE);
+		m_camSpecs.init();
+		m_camSpecs.sensorW = hdr.cols;
+		m_camSpecs.sensorH = hdr.rows;
+		m_timeStamp = hdr.TimeStamp;
+
+		// events of older files without time segments fill the rest of the file,
+		// the time segments of newer files are listed after the events
+		const bool bCoded = (hdr.Signature == _EVENT_FILE_CODED_SIGNATURE);
+		const bool bBlocks = bCoded || (hdr.Signature == _EVENT_FILE_BLOCKS_SIGNATURE);
+		const bool bSegmented = (hdr.SegmentSignature == _EVENT_FILE_SEGMENT_SIGNATURE);
+		const uint64_t nDuration = bSegmented ? ((static_cast<uint64_t>(hdr.DurationHigh) << 32) | hdr.Duration) : hdr.Duration;
+		const uint64_t nEventsInFile = (bSegmented || bBlocks) ? hdr.EventCount : ((mappedFile.size() - _EVENT_FILE_HDR_SIZE) / _PACKED_EVENT_SIZE);
+		std::vector<_EVENT_FILE_SEGMENT> fileSegments;
+		std::vector<_EVENT_FILE_BLOCK> fileBlocks;
+		if (bBlocks) {
+			// block index found through the footer, see _EVENT_FILE_BLOCK
+			_EVENT_FILE_FOOTER footer = {};
+			if (mappedFile.size() >= _EVENT_FILE_HDR_SIZE + _EVENT_FILE_FOOTER_SIZE)
+				memcpy(&footer, mappedFile.data() + mappedFile.size() - _EVENT_FILE_FOOTER_SIZE, _EVENT_FILE_FOOTER_SIZE);
+			if ((footer.Signature != _EVENT_FILE_FOOTER_SIGNATURE) || (footer.Version != _EVENT_FILE_BLOCKS_VERSION)
+				|| (footer.IndexOffset + footer.BlockCount * _EVENT_FILE_BLOCK_SIZE + _EVENT_FILE_FOOTER_SIZE > mappedFile.size())) {
+				m_errMsg = "failed reading block index";
+				throw (-6);
+			}
+			fileBlocks.resize(footer.BlockCount);
+			memcpy(fileBlocks.data(), mappedFile.data() + footer.IndexOffset, fileBlocks.size() * _EVENT_FILE_BLOCK_SIZE);
+			for (const _EVENT_FILE_BLOCK& block : fileBlocks) {
+				if (block.Offset + (bCoded ? block.ByteCount : block.EventCount * _PACKED_EVENT_SIZE) > footer.IndexOffset) {
+					m_errMsg = "failed reading block index";
+					throw (-6);
+				}
+			}
+		}
+		else if (bSegmented) {
+			const uint64_t nSegmentsOffset = _EVENT_FILE_HDR_SIZE + nEventsInFile * _PACKED_EVENT_SIZE;
+			if (nSegmentsOffset + hdr.SegmentCount * _EVENT_FILE_SEGMENT_SIZE > mappedFile.size()) {
+				m_errMsg = "failed reading time segments";
+				throw (-4);
+			}
+			fileSegments.resize(hdr.SegmentCount);
+			memcpy(fileSegments.data(), mappedFile.data() + nSegmentsOffset, fileSegments.size() * _EVENT_FILE_SEGMENT_SIZE);
+		}
+		const PACKED_EVENT* pEvents = reinterpret_cast<const PACKED_EVENT*>(mappedFile.data() + _EVENT_FILE_HDR_SIZE);
 
 		if (m_nDebugLevel > 0)
 			std::cout
 				<< "File size:        " << hdr.FileSize << std::endl
 				<< "Event count:      "  << hdr.EventCount << std::endl
-				<< "Duration [usec]:  " << hdr.Duration << std::endl
+				<< "Duration [usec]:  " << nDuration << std::endl
 				<< "TimeStamp [usec]: " << hdr.TimeStamp << std::endl;
 
-		if (offsetUSec > hdr.Duration) {
+		if (offsetUSec > nDuration) {
 			m_errMsg = "start beyond end of file";
 			throw (-2);
 		}
+		if (!roiFilter.clipROI(static_cast<int32_t>(hdr.cols), static_cast<int32_t>(hdr.rows))) {
+			m_errMsg = "invalid ROI";
+			throw (-3);
+		}
+		const bool bFilter = roiFilter.hasROI() || (roiFilter.evPol != EBI::PolarityBoth);
+		if (!roiFilter.hasROI()) {
+			roiFilter.roiW = static_cast<int32_t>(hdr.cols);
+			roiFilter.roiH = static_cast<int32_t>(hdr.rows);
+		}
 
-		// read first event
+		// time of event i of the file, including its segment
+		auto segmentBase = [&fileSegments](const uint64_t i) {
+			auto it = std::upper_bound(fileSegments.begin(), fileSegments.end(), i,
+				[](const uint64_t idx, const _EVENT_FILE_SEGMENT& seg) { return idx < seg.FirstEvent; });
+			return (it == fileSegments.begin()) ? 0 : (it - 1)->TimeBase;
+		};
+		auto fileTime = [&](const PACKED_EVENT& pe) {
+			const uint64_t i = static_cast<uint64_t>(&pe - pEvents);
+			return segmentBase(i) + (pe.timePol >> 1);
+		};
 
-		PACKED_EVENT pe;
-		inFile.read((char*)&pe, _PACKED_EVENT_SIZE);
-		uint64_t t0 = (pe.timePol >> 1) + offsetUSec;
-		uint64_t tN = t0 + durationUSec;
-		if (durationUSec == 0)
-			tN = (pe.timePol >> 1) + hdr.Duration;
+		// time window relative to the first event
+		const uint64_t tFirstEvent = bBlocks ? (fileBlocks.empty() ? 0 : fileBlocks[0].TimeFirst)
+			: ((nEventsInFile > 0) ? fileTime(pEvents[0]) : 0);
+		const uint64_t t0 = tFirstEvent + offsetUSec;
+		const uint64_t tN = (durationUSec == 0) ? (tFirstEvent + nDuration) : (t0 + durationUSec);
+
+		// unpack events with times tBase plus their 31 bits, all within one segment of the output
+		size_t nOut = 0;
+		uint64_t tSegment = 0;
+		auto addSegment = [&](const uint64_t tBase) {
+			const uint64_t tOutSegment = tBase & ~(EBI::TIME_SEGMENT_USEC - 1);
+			if (tOutSegment > tSegment) {
+				tSegment = tOutSegment;
+				if (!m_timeSegments.empty() && (m_timeSegments.back().iFirst == nOut))
+					m_timeSegments.back().tBase = tSegment;
+				else
+					m_timeSegments.push_back(EBI::TimeSegment(tSegment, nOut));
+			}
+		};
+		auto unpackTo = [&](const PACKED_EVENT* pIn, const uint64_t nIn, const uint64_t tBase, EBI::Event* pOut) -> size_t {
+			const uint64_t tLow = (t0 > tBase) ? std::min<uint64_t>(t0 - tBase, EBI::PACKED_TIME_MAX) : 0;
+			const uint64_t tHigh = std::min<uint64_t>(tN - tBase, EBI::PACKED_TIME_MAX);
+			if (tLow > tHigh)
+				return 0;
+			return _unpackEvents(pIn, static_cast<size_t>(nIn), static_cast<uint32_t>(tBase),
+				static_cast<uint32_t>(tLow), static_cast<uint32_t>(tHigh), bFilter ? &roiFilter : nullptr, pOut);
+		};
+		auto unpackPiece = [&](const PACKED_EVENT* pIn, const uint64_t nIn, const uint64_t tBase) {
+			if ((nIn == 0) || (tN < tBase))
+				return;
+			addSegment(tBase);
+			nOut += unpackTo(pIn, nIn, tBase, m_events.data() + nOut);
+		};
 
-		while (inFile) {
-			uint32_t curTime = (pe.timePol >> 1);
-			if (curTime < t0) {
-				// skip - load more events
+		if (bBlocks) {
+			// blocks overlapping the time window by binary search of the index, those outside the ROI are skipped
+			auto itFirst = std::partition_point(fileBlocks.begin(), fileBlocks.end(),
+				[t0](const _EVENT_FILE_BLOCK& block) { return block.TimeLast < t0; });
+			auto itEnd = std::partition_point(itFirst, fileBlocks.end(),
+				[tN](const _EVENT_FILE_BLOCK& block) { return block.TimeFirst <= tN; });
+			auto inROI = [&roiFilter](const _EVENT_FILE_BLOCK& block) {
+				return (block.xMax >= roiFilter.roiX) && (block.xMin < roiFilter.roiX + roiFilter.roiW)
+					&& (block.yMax >= roiFilter.roiY) && (block.yMin < roiFilter.roiY + roiFilter.roiH);
+			};
+			std::vector<const _EVENT_FILE_BLOCK*> selected;
+			std::vector<size_t> firstOut;
+			uint64_t nCandidates = 0;
+			for (auto it = itFirst; it != itEnd; ++it) {
+				if (inROI(*it) && (it->EventCount > 0)) {
+					selected.push_back(&*it);
+					firstOut.push_back(static_cast<size_t>(nCandidates));
+					nCandidates += it->EventCount;
+				}
 			}
-			else if (curTime > tN) {
-				// skip - done
-				break;
+			m_events.resize(static_cast<size_t>(nCandidates));
+
+			// blocks are decoded and unpacked in parallel to the start of their share of the output,
+			// then moved together in order
+			const int32_t nThreads = (nCandidates < SELECT_PARALLEL_MIN_EVENTS) ? 1 : EBI::ThreadCount(m_nThreads);
+			const size_t nChunks = std::min(selected.size(), static_cast<size_t>(nThreads) * SELECT_CHUNKS_PER_THREAD);
+			std::vector<size_t> nUnpacked(selected.size(), 0);
+			std::atomic<bool> bDamaged(false);
+			EBI::ParallelFor(nChunks, nThreads, [&](const size_t c) {
+				std::vector<PACKED_EVENT> decoded;
+				for (size_t k = selected.size() * c / nChunks; k < selected.size() * (c + 1) / nChunks; k++) {
+					const _EVENT_FILE_BLOCK& block = *selected[k];
+					const PACKED_EVENT* pIn = reinterpret_cast<const PACKED_EVENT*>(mappedFile.data() + block.Offset);
+					if (bCoded) {
+						decoded.resize(std::max<size_t>(decoded.size(), block.EventCount));
+						if (!EBI::DecodeEventBlock(mappedFile.data() + block.Offset, block.ByteCount, block.EventCount, decoded.data())) {
+							bDamaged = true;
+							continue;
+						}
+						pIn = decoded.data();
+					}
+					nUnpacked[k] = unpackTo(pIn, block.EventCount, block.TimeFirst, m_events.data() + firstOut[k]);
+				}
+			});
+			if (bDamaged) {
+				m_errMsg = "damaged block";
+				throw (-7);
+			}
+			for (size_t k = 0; k < selected.size(); k++) {
+				addSegment(selected[k]->TimeFirst);
+				if (firstOut[k] != nOut)
+					std::copy(m_events.begin() + firstOut[k], m_events.begin() + firstOut[k] + nUnpacked[k], m_events.begin() + nOut);
+				nOut += nUnpacked[k];
 			}
-			else {
-				EBI::Event ev;
-				ev.x = pe.x;
-				ev.y = pe.y;
-				ev.t = curTime;
-				ev.p = (pe.timePol & 0x1) ? 1 : 0;
-				m_events.push_back(ev);
+		}
+		else if (nEventsInFile > 0) {
+			// time window by binary search, as events are in order of time
+			const PACKED_EVENT* pFirst = std::partition_point(pEvents, pEvents + nEventsInFile,
+				[&](const PACKED_EVENT& pe) { return fileTime(pe) < t0; });
+			const PACKED_EVENT* pEnd = std::partition_point(pFirst, pEvents + nEventsInFile,
+				[&](const PACKED_EVENT& pe) { return fileTime(pe) <= tN; });
+			const uint64_t iFirst = static_cast<uint64_t>(pFirst - pEvents);
+			const uint64_t iEnd = static_cast<uint64_t>(pEnd - pEvents);
+			m_events.resize(static_cast<size_t>(iEnd - iFirst));
+
+			// unpack piecewise within the file segments, each lies within one segment of the output
+			size_t nNextSegment = std::upper_bound(fileSegments.begin(), fileSegments.end(), iFirst,
+				[](const uint64_t idx, const _EVENT_FILE_SEGMENT& seg) { return idx < seg.FirstEvent; }) - fileSegments.begin();
+			for (uint64_t a = iFirst; a < iEnd; ) {
+				const uint64_t tFileBase = (nNextSegment == 0) ? 0 : fileSegments[nNextSegment - 1].TimeBase;
+				const uint64_t b = (nNextSegment < fileSegments.size()) ? std::min(iEnd, fileSegments[nNextSegment].FirstEvent) : iEnd;
+				nNextSegment++;
+				if (b > a)
+					unpackPiece(pEvents + a, b - a, tFileBase);
+				a = std::max(a, b);
 			}
-			// load next
-			inFile.read((char*)&pe, _PACKED_EVENT_SIZE);
 		}
+		m_events.resize(nOut);
+		// segments without any event selected are not listed
+		if (!m_timeSegments.empty() && (m_timeSegments.back().iFirst == m_events.size()))
+			m_timeSegments.pop_back();
+		if (filter.hasROI()) {
+			m_camSpecs.sensorW = static_cast<uint32_t>(roiFilter.roiW);
+			m_camSpecs.sensorH = static_cast<uint32_t>(roiFilter.roiH);
+		}
+		m_loadStats.nEvents = m_events.size();
 	}
 	catch (int errCode)
 	{
 		std::cerr << "ERROR(" << errCode << "): EBI::EventData::load() " << m_errMsg << std::endl;
-		if (inFile.is_open())
-			inFile.close();
-
 		retCode = false;
 	}
-	if (inFile.is_open())
-		inFile.close();
+	mappedFile.close();
 
 #ifdef _DEBUG
 	if (retCode) {
@@ -1262,7 +1703,7 @@ bool EBI::EventData::cropROI(
 	const int32_t x, const int32_t y,
 	const int32_t w, const int32_t h,
 	//const uint32_t t1IN, const uint32_t t2IN)
-	const int32_t offsetUSec,	//!< offset from start in [usec]  
+	const int64_t offsetUSec,	//!< offset from start in [usec]  
 	const int32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 	)
 {
@@ -1290,63 +1731,60 @@ bool EBI::EventData::cropROI(
 			<< std::endl;
 		return false;
 	}
-	uint32_t t1 = offsetUSec;
-	uint32_t t2 = t1 + durationUSec;
-	bool bUseFullTime = false;
-	if (t2 == t1) {
-		// use end time
-		t2 = m_events[m_events.size() - 1].t;
-		bUseFullTime = true;
-	}
-	std::vector<EBI::Event> roiData;
-
-	if (bUseFullTime) {
-		for (EBI::Event ev : m_events) {
-			if ((ev.y >= roiY) && (ev.y < (roiY + roiH))) {
-				if ((ev.x >= roiX) && (ev.x < (roiX + roiW))) {
-					ev.x -= roiX;
-					ev.y -= roiY;
-					ev.t -= t1;
-					roiData.push_back(ev);
-				}
-			}
-		}
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	uint64_t t2 = t1 + static_cast<uint32_t>(durationUSec) - 1;	// [t1, t1 + dur)
+	uint64_t tStart = t1;
+	if (durationUSec == 0) {
+		// use full duration
+		tStart = 0;
+		t2 = timeIndex().timeMax();
 	}
-	else {
-		for (EBI::Event ev : m_events) {
-			if ((ev.t >= t1) && (ev.t < t2)) {
-				if ((ev.y >= roiY) && (ev.y < (roiY + roiH))) {
-					if ((ev.x >= roiX) && (ev.x < (roiX + roiW))) {
-						ev.x -= roiX;
-						ev.y -= roiY;
-						ev.t -= t1;
-						roiData.push_back(ev);
-					}
-				}
-			}
+	auto selROI = [roiX, roiY, roiW, roiH](EBI::Event& ev) {
+		if ((ev.y < roiY) || (ev.y >= (roiY + roiH)) || (ev.x < roiX) || (ev.x >= (roiX + roiW)))
+			return false;
+		ev.x -= roiX;
+		ev.y -= roiY;
+		return true;
+	};
+	// compact the current data set in place, events are only moved to the front,
+	// the list of segments is rebuilt in its own storage
+	size_t nOut = 0;
+	size_t nSegments = 0;
+	_forEachPiece(*this, tStart, t2, t1, [&](const _WindowPiece& piece) {
+		const size_t nBefore = nOut;
+		const uint32_t tLow = piece.tLow, tHigh = piece.tHigh, dt = piece.dt;
+		_compactSelected(m_events, piece.iFirst, piece.iEnd, nOut, m_nThreads,
+			[tLow, tHigh, dt, &selROI](EBI::Event& ev) {
+				if ((ev.t < tLow) || (ev.t > tHigh) || !selROI(ev))
+					return false;
+				ev.t += dt;
+				return true;
+			});
+		if ((nOut > nBefore) && (piece.tOutBase > ((nSegments == 0) ? 0 : m_timeSegments[nSegments - 1].tBase))) {
+			if (nSegments < m_timeSegments.size())
+				m_timeSegments[nSegments] = EBI::TimeSegment(piece.tOutBase, nBefore);
+			else
+				m_timeSegments.push_back(EBI::TimeSegment(piece.tOutBase, nBefore));
+			nSegments++;
 		}
-	}
-	// copy back to current data set
-	m_events.resize(0);
-	//// Copying vector by assign function
-	//m_events.assign(roiData.begin(), roiData.end());
-	for (int i = 0; i < roiData.size(); i++)
-		m_events.push_back(roiData[i]);
+	});
+	m_events.resize(nOut);
+	m_timeSegments.resize(nSegments);
+	invalidateIndex();
 	m_camSpecs.sensorH = roiH;	// probably should use individual identifier for ROI
 	m_camSpecs.sensorW = roiW;
-	roiData.resize(0);
 	return true;
 }
 
 /*!
 Sample the data set
 Also subtracts time \a t1 and top-left coordinates \a (x,y) from event
-\note Uses all events
+\note Uses all events, only those of the overlapping tiles if a tile size is set, see setTileSize()
 */
 std::vector<EBI::Event> EBI::EventData::getSample(
 	const int32_t x, const int32_t y,
 	const int32_t w, const int32_t h,
-	const int32_t offsetUSec,	//!< offset from start in [usec]  
+	const int64_t offsetUSec,	//!< offset from start in [usec]  
 	const int32_t durationUSec	//!< duration to long in [usec], 0 to load entire set
 	)
 {
@@ -1359,43 +1797,266 @@ std::vector<EBI::Event> EBI::EventData::getSample(
 	int32_t x2 = x1 + w;
 	int32_t y1 = y;
 	int32_t y2 = y1 + h;
-	int32_t t1 = offsetUSec;
-	int32_t t2 = t1 + durationUSec;
-	bool bUseFullTime = false;
-	if (t2 == t1) {
-		// use end time
-		t2 = m_events[m_events.size() - 1].t;
-		bUseFullTime = true;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	uint64_t tSel1 = t1;
+	uint64_t tSel2 = t1 + static_cast<uint32_t>(durationUSec) - 1;	// [t1, t1 + dur)
+	if (durationUSec == 0) {
+		// use full duration
+		tSel1 = 0;
+		tSel2 = timeIndex().timeMax();
 	}
 
-	// data is sorted in time
-	if (bUseFullTime) {
-		for (EBI::Event ev : m_events) {
-			if ((ev.y >= y1) && (ev.y < y2)) {
-				if ((ev.x >= x1) && (ev.x < x2)) {
+	// events of the tiles overlapping the region, if a tile index is set
+	std::vector<uint32_t> indices;
+	const EBI::TileIndex* pTiles = tileIndex();
+	if ((pTiles != nullptr) && pTiles->select(m_events, x, y, w, h, tSel1, tSel2, indices)) {
+		sample.reserve(indices.size());
+		for (const uint32_t i : indices) {
+			EBI::Event ev = m_events[i];
+			const uint64_t t = eventTime(i);
+			if ((t >= tSel1) && (t <= tSel2)) {
+				if ((ev.y >= y1) && (ev.y < y2)) {
+					if ((ev.x >= x1) && (ev.x < x2)) {
 						ev.x -= x1;
 						ev.y -= y1;
-						ev.t -= t1;
+						ev.t = static_cast<uint32_t>(t - t1);
 						sample.push_back(ev);
-				}
-			}
-		}
-	}
-	else {
-		for (EBI::Event ev : m_events) {
-			if ((ev.t >= static_cast<uint32_t>(t1)) 
-				&& (ev.t < static_cast<uint32_t>(t2))
-				) {
-				if ((ev.y >= y1) && (ev.y < y2)) {
-					if ((ev.x >= x1) && (ev.x < x2)) {
-							ev.x -= x1;
-							ev.y -= y1;
-							ev.t -= t1;
-							sample.push_back(ev);
 					}
 				}
 			}
 		}
+		return sample;
 	}
+
+	auto selROI = [x1, x2, y1, y2](EBI::Event& ev) {
+		if ((ev.y < y1) || (ev.y >= y2) || (ev.x < x1) || (ev.x >= x2))
+			return false;
+		ev.x -= x1;
+		ev.y -= y1;
+		return true;
+	};
+	_copyWindow(*this, tSel1, tSel2, t1, sample, nullptr, m_nThreads, selROI);
 	return sample;
 }
+
+/*!
+Sample the data set in each of \a windows, same as getSample() for each window.
+Builds a tile index of default size if none is set, see setTileSize()
+*/
+std::vector<std::vector<EBI::Event> > EBI::EventData::getSamples(
+	const std::vector<EBI::SampleWindow>& windows)
+{
+	if (m_tileSize == 0)
+		setTileSize(TILE_SIZE_DEFAULT);
+	std::vector<std::vector<EBI::Event> > samples(windows.size());
+	for (size_t k = 0; k < windows.size(); k++) {
+		const EBI::SampleWindow& win = windows[k];
+		samples[k] = getSample(win.x, win.y, win.w, win.h, win.t0, win.dur);
+	}
+	return samples;
+}
+
+static const EBI::EventCameraSpecs _noCamSpecs;	// camera of an empty EBI::EventView
+
+EBI::EventView::EventView()
+{
+	init();
+}
+
+/*!
+View of all events of \a src
+*/
+EBI::EventView::EventView(const EBI::EventData& src)
+{
+	init();
+	setSource(src);
+	m_pBegin = src.m_events.data();
+	m_pEnd = m_pBegin + src.m_events.size();
+	if (!src.m_events.empty())
+		m_duration = static_cast<uint32_t>(std::min<uint64_t>(src.eventTime(src.m_events.size() - 1) - src.eventTime(0), UINT32_MAX));
+}
+
+/*!
+View of the events of \a src with polarity \a polMode in [offsetUSec, offsetUSec + durationUSec],
+same selection as EventData::copyFrom()
+*/
+EBI::EventView::EventView(const EBI::EventData& src,
+	const EBI::EventPolarity polMode,
+	const int64_t offsetUSec,
+	const int32_t durationUSec,
+	bool bSubtractOffsetTime)
+{
+	init();
+	setSource(src);
+	m_polMode = polMode;
+	if (src.m_events.empty())
+		return;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	const uint64_t t2 = (durationUSec == 0) ? src.eventTime(src.m_events.size() - 1) : t1 + static_cast<uint32_t>(durationUSec);
+	setRange(src, t1, t2);
+	if (bSubtractOffsetTime)
+		m_timeOffset = t1;
+}
+
+/*!
+View of the events of \a src with polarity \a polMode in ROI (\a x, \a y, \a w, \a h) and
+time window [t0, t0 + dur), same selection as EventData::copyFrom()
+*/
+EBI::EventView::EventView(const EBI::EventData& src,
+	const EBI::EventPolarity polMode,
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int64_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for all events
+)
+	: EventView(src, x, y, w, h, offsetUSec, durationUSec)
+{
+	m_polMode = polMode;
+}
+
+/*!
+View of the events of \a src in ROI (\a x, \a y, \a w, \a h) and time window [t0, t0 + dur),
+same selection as EventData::copyFrom()
+*/
+EBI::EventView::EventView(const EBI::EventData& src,
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int64_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for all events
+)
+{
+	init();
+	setSource(src);
+	m_bROI = true;
+	m_roiX = x;
+	m_roiY = y;
+	m_roiW = w;
+	m_roiH = h;
+	m_timeOffset = static_cast<uint64_t>(offsetUSec);
+	if (src.m_events.empty())
+		return;
+	if (durationUSec == 0) {
+		m_pBegin = src.m_events.data();
+		m_pEnd = m_pBegin + src.m_events.size();
+		// no events if t0 is past the last one, spans beyond 32 bits are cut as in the view of all events
+		const uint64_t tLast = src.eventTime(src.m_events.size() - 1);
+		m_duration = (m_timeOffset > tLast) ? 0 : static_cast<uint32_t>(std::min<uint64_t>(tLast - m_timeOffset, UINT32_MAX));
+	}
+	else {
+		setRange(src, m_timeOffset, m_timeOffset + static_cast<uint32_t>(durationUSec) - 1);	// [t0, t0 + dur)
+		m_duration = static_cast<uint32_t>(durationUSec);
+	}
+}
+
+/*!
+View of \a nEvents events at \a pEvents, without selection
+*/
+EBI::EventView::EventView(const EBI::Event* pEvents, const size_t nEvents,
+	const EBI::EventCameraSpecs& camSpecs, const uint64_t timeStamp)
+{
+	init();
+	m_pCamSpecs = &camSpecs;
+	m_timeStamp = timeStamp;
+	m_pBegin = pEvents;
+	m_pEnd = pEvents + nEvents;
+	m_pOrigin = pEvents;
+	if (nEvents > 0)
+		m_duration = pEvents[nEvents - 1].t - pEvents[0].t;
+}
+
+void EBI::EventView::init()
+{
+	m_pBegin = m_pEnd = nullptr;
+	m_pOrigin = nullptr;
+	m_pSegments = nullptr;
+	m_pCamSpecs = &_noCamSpecs;
+	m_timeStamp = 0;
+	m_t1 = 0;
+	m_tSpan = UINT32_MAX;
+	m_timeOffset = 0;
+	m_duration = 0;
+	m_polMode = EBI::PolarityBoth;
+	m_bROI = false;
+	m_roiX = m_roiY = m_roiW = m_roiH = 0;
+	m_nThreads = 0;
+}
+
+//! camera, time stamp, time segments and thread count of \a src
+void EBI::EventView::setSource(const EBI::EventData& src)
+{
+	m_pCamSpecs = &src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	m_pOrigin = src.m_events.data();
+	m_pSegments = src.m_timeSegments.empty() ? nullptr : &src.m_timeSegments;
+	m_nThreads = src.m_nThreads;
+}
+
+//! limit the view to events of \a src with time in [\a t1, \a t2], found through its time index
+void EBI::EventView::setRange(const EBI::EventData& src, const uint64_t t1, const uint64_t t2)
+{
+	size_t iFirst, iEnd;
+	src.timeRange(t1, t2, iFirst, iEnd);
+	m_pBegin = src.m_events.data() + iFirst;
+	m_pEnd = src.m_events.data() + iEnd;
+	m_t1 = static_cast<uint32_t>(t1);
+	m_tSpan = static_cast<uint32_t>(std::min<uint64_t>(t2 - t1, UINT32_MAX));
+	m_duration = m_tSpan;
+}
+
+/*!
+Time of \a ev, an event of the range of the view, relative to the time offset of the view,
+including the time segment of the event (see EBI::TimeSegment)
+*/
+uint64_t EBI::EventView::time(const EBI::Event& ev) const
+{
+	const uint64_t tBase = (m_pSegments == nullptr) ? 0 : EBI::SegmentBase(*m_pSegments, static_cast<size_t>(&ev - m_pOrigin));
+	return tBase + ev.t - m_timeOffset;
+}
+
+/*!
+\return number of events within time window, ROI and polarity, one pass over the range
+*/
+size_t EBI::EventView::count() const
+{
+	size_t n = 0;
+	for (const EBI::Event& ev : *this)
+		n += contains(ev) ? 1 : 0;
+	return n;
+}
+
+/*!
+Copy of the selected events, relative to the view, same as the corresponding copy constructor of EBI::EventData
+*/
+void EBI::EventView::toEvents(std::vector<EBI::Event>& events) const
+{
+	events.resize(0);
+	for (const EBI::Event& ev : *this) {
+		if (contains(ev))
+			events.push_back(relative(ev));
+	}
+}
+
+/*!
+Save the selected events to event file \a fnameEvents, same formats as EventData::save()
+*/
+bool EBI::EventView::save(const std::string& fnameEvents, const EBI::FileFormat eFormat) const
+{
+	std::string errMsg;
+	if (eFormat == EBI::FILE_FORMAT_EVTT)
+		return saveTiled(fnameEvents, EBI::EventFlowEvalParams());
+	if ((eFormat != EBI::FILE_FORMAT_EVT3) && (eFormat != EBI::FILE_FORMAT_EVT4) && (eFormat != EBI::FILE_FORMAT_EVTZ)) {
+		std::cerr << "EBI::EventView::save(): Error: unsupported file format" << std::endl;
+		return false;
+	}
+	return _saveEventFile(fnameEvents, *this, m_duration, eFormat, EBI::ThreadCount(m_nThreads), errMsg, "EBI::EventView::save()");
+}
+
+/*!
+Save the selected events to tiled event file \a fnameEvents, same layout as EventData::saveTiled()
+*/
+bool EBI::EventView::saveTiled(const std::string& fnameEvents, const EBI::EventFlowEvalParams& params) const
+{
+	std::string errMsg;
+	return _saveEventFile(fnameEvents, *this, m_duration, EBI::FILE_FORMAT_EVTT, EBI::ThreadCount(m_nThreads),
+		errMsg, "EBI::EventView::saveTiled()", params);
+}
@@ -0,0 +1,172 @@
+#include "ebi_evtcodec.h"
+#include <cstring>
+
+static constexpr size_t BLOCK_PREFIX_SIZE = 12;	// sizes of time, row and column streams
+
+static inline uint32_t _zigzag(const int32_t v)
+{
+	return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+static inline int32_t _unzigzag(const uint32_t u)
+{
+	return static_cast<int32_t>(u >> 1) ^ -static_cast<int32_t>(u & 0x1);
+}
+
+static inline uint8_t* _putVarint(uint8_t* p, uint32_t v)
+{
+	while (v >= 0x80) {
+		*p++ = static_cast<uint8_t>(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = static_cast<uint8_t>(v);
+	return p;
+}
+
+/*!
+Read a varint from \a p to \a v
+\return position after the varint, nullptr if it exceeds \a pEnd or 32 bits
+*/
+static inline const uint8_t* _getVarint(const uint8_t* p, const uint8_t* pEnd, uint32_t& v)
+{
+	// most differences take a single byte
+	if ((p < pEnd) && (*p < 0x80)) {
+		v = *p;
+		return p + 1;
+	}
+	v = 0;
+	for (int shift = 0; (p < pEnd) && (shift < 35); shift += 7) {
+		const uint8_t b = *p++;
+		v |= static_cast<uint32_t>(b & 0x7F) << shift;
+		if (b < 0x80)
+			return p;
+	}
+	return nullptr;
+}
+
+/*!
+Code the \a nEvents packed events of \a pEvents, times relative to the first event of the
+block, and append them to \a out
+\return number of bytes appended
+*/
+size_t EBI::EncodeEventBlock(const PACKED_EVENT* pEvents, const size_t nEvents, std::vector<uint8_t>& out)
+{
+	const size_t nStart = out.size();
+	out.resize(nStart + EncodedBlockBound(nEvents));
+	uint8_t* pBlock = out.data() + nStart;
+	uint8_t* p = pBlock + BLOCK_PREFIX_SIZE;
+
+	// polarity bits
+	const size_t nPolBytes = (nEvents + 7) / 8;
+	memset(p, 0, nPolBytes);
+	for (size_t i = 0; i < nEvents; i++)
+		p[i >> 3] |= static_cast<uint8_t>((pEvents[i].timePol & 0x1) << (i & 0x7));
+	p += nPolBytes;
+
+	// runs of events with the same time, as read out together by the sensor
+	uint8_t* pStream = p;
+	int32_t tPrev = 0;
+	for (size_t i = 0; i < nEvents; ) {
+		const uint32_t timeRun = pEvents[i].timePol >> 1;
+		size_t iEnd = i + 1;
+		while ((iEnd < nEvents) && ((pEvents[iEnd].timePol >> 1) == timeRun))
+			iEnd++;
+		p = _putVarint(p, _zigzag(static_cast<int32_t>(timeRun) - tPrev));
+		p = _putVarint(p, static_cast<uint32_t>(iEnd - i - 1));
+		tPrev = static_cast<int32_t>(timeRun);
+		i = iEnd;
+	}
+	const uint32_t nTimeBytes = static_cast<uint32_t>(p - pStream);
+
+	// runs of events in the same row
+	pStream = p;
+	int32_t yPrev = 0;
+	for (size_t i = 0; i < nEvents; ) {
+		size_t iEnd = i + 1;
+		while ((iEnd < nEvents) && (pEvents[iEnd].y == pEvents[i].y))
+			iEnd++;
+		p = _putVarint(p, _zigzag(static_cast<int32_t>(pEvents[i].y) - yPrev));
+		p = _putVarint(p, static_cast<uint32_t>(iEnd - i - 1));
+		yPrev = pEvents[i].y;
+		i = iEnd;
+	}
+	const uint32_t nRowBytes = static_cast<uint32_t>(p - pStream);
+
+	// column differences, small within a run of a row
+	pStream = p;
+	int32_t xPrev = 0;
+	for (size_t i = 0; i < nEvents; i++) {
+		p = _putVarint(p, _zigzag(static_cast<int32_t>(pEvents[i].x) - xPrev));
+		xPrev = pEvents[i].x;
+	}
+	const uint32_t nColBytes = static_cast<uint32_t>(p - pStream);
+
+	memcpy(pBlock, &nTimeBytes, 4);
+	memcpy(pBlock + 4, &nRowBytes, 4);
+	memcpy(pBlock + 8, &nColBytes, 4);
+	const size_t nBytes = static_cast<size_t>(p - pBlock);
+	out.resize(nStart + nBytes);
+	return nBytes;
+}
+
+/*!
+Decode the block of \a nBytes at \a pData to \a nEvents packed events at \a pEvents
+\return false if the block is damaged or holds another number of events
+*/
+bool EBI::DecodeEventBlock(const uint8_t* pData, const size_t nBytes, const size_t nEvents, PACKED_EVENT* pEvents)
+{
+	const size_t nPolBytes = (nEvents + 7) / 8;
+	if (nBytes < BLOCK_PREFIX_SIZE + nPolBytes)
+		return false;
+	uint32_t nTimeBytes, nRowBytes, nColBytes;
+	memcpy(&nTimeBytes, pData, 4);
+	memcpy(&nRowBytes, pData + 4, 4);
+	memcpy(&nColBytes, pData + 8, 4);
+	const uint8_t* pPol = pData + BLOCK_PREFIX_SIZE;
+	const uint8_t* p = pPol + nPolBytes;
+	if (static_cast<uint64_t>(nTimeBytes) + nRowBytes + nColBytes != nBytes - BLOCK_PREFIX_SIZE - nPolBytes)
+		return false;
+
+	// times with polarity
+	const uint8_t* pEnd = p + nTimeBytes;
+	int32_t t = 0;
+	for (size_t i = 0; i < nEvents; ) {
+		uint32_t dt, nRun;
+		if (((p = _getVarint(p, pEnd, dt)) == nullptr) || ((p = _getVarint(p, pEnd, nRun)) == nullptr)
+			|| (nRun >= nEvents - i))
+			return false;
+		t += _unzigzag(dt);
+		const uint32_t timeRun = static_cast<uint32_t>(t) << 1;
+		for (const size_t iEnd = i + nRun + 1; i < iEnd; i++)
+			pEvents[i].timePol = timeRun | ((pPol[i >> 3] >> (i & 0x7)) & 0x1);
+	}
+	if (p != pEnd)
+		return false;
+
+	// rows
+	pEnd = p + nRowBytes;
+	int32_t y = 0;
+	for (size_t i = 0; i < nEvents; ) {
+		uint32_t dy, nRun;
+		if (((p = _getVarint(p, pEnd, dy)) == nullptr) || ((p = _getVarint(p, pEnd, nRun)) == nullptr)
+			|| (nRun >= nEvents - i))
+			return false;
+		y += _unzigzag(dy);
+		for (const size_t iEnd = i + nRun + 1; i < iEnd; i++)
+			pEvents[i].y = static_cast<uint16_t>(y);
+	}
+	if (p != pEnd)
+		return false;
+
+	// columns
+	pEnd = p + nColBytes;
+	int32_t x = 0;
+	for (size_t i = 0; i < nEvents; i++) {
+		uint32_t v;
+		if ((p = _getVarint(p, pEnd, v)) == nullptr)
+			return false;
+		x += _unzigzag(v);
+		pEvents[i].x = static_cast<uint16_t>(x);
+	}
+	return (p == pEnd);
+}
@@ -1,7 +1,10 @@
 #include "ebi.h"
 #include "ebi_image.h"
+#include "ebi_packed.h"
+#include "ebi_paged.h"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #ifdef LIBTIFF
 # include "tiffio.h"
@@ -26,6 +29,43 @@ EBI::EventImage::EventImage(const EBI::EventData& src,
 	fromEventData(src, polMode, offsetUSec, durationUSec, nRefTimeUSec, bSumEvents);
 }
 
+/*!
+Construct pseudo-image from packed event data
+*/
+EBI::EventImage::EventImage(const EBI::PackedEventData& src,
+	const EBI::EventPolarity polMode,
+	const uint32_t offsetUSec, const uint32_t durationUSec,
+	const int nRefTimeUSec,
+	const bool bSumEvents)
+{
+	init();
+	fromEventData(src, polMode, offsetUSec, durationUSec, nRefTimeUSec, bSumEvents);
+}
+
+/*!
+Construct pseudo-image from a view of event data, see fromEventData()
+*/
+EBI::EventImage::EventImage(const EBI::EventView& src,
+	const int nRefTimeUSec,
+	const bool bSumEvents)
+{
+	init();
+	fromEventData(src, nRefTimeUSec, bSumEvents);
+}
+
+/*!
+Construct pseudo-image from a time window of paged event data, see fromEventData()
+*/
+EBI::EventImage::EventImage(const EBI::PagedEventData& src,
+	const EBI::EventPolarity polMode,
+	const uint64_t offsetUSec, const uint32_t durationUSec,
+	const int nRefTimeUSec,
+	const bool bSumEvents)
+{
+	init();
+	fromEventData(src, polMode, offsetUSec, durationUSec, nRefTimeUSec, bSumEvents);
+}
+
 void EBI::EventImage::init()
 {
 	clear();
@@ -53,10 +93,10 @@ void EBI::EventImage::clear()
 	m_bNeedStats = false;
 }
 
-bool EBI::EventImage::alloc(const EBI::EventData& src)
+bool EBI::EventImage::alloc(const EBI::EventCameraSpecs& camSpecs)
 {
-	uint32_t h = src.m_camSpecs.sensorH;
-	uint32_t w = src.m_camSpecs.sensorW;
+	uint32_t h = camSpecs.sensorH;
+	uint32_t w = camSpecs.sensorW;
 	if ((h == 0) || (w == 0)) {
 		std::cerr << "EBI::EventImage::alloc() - failed allocating space for image" << std::endl;
 			return false;
@@ -90,62 +130,107 @@ int32_t EBI::EventImage::referenceTime() const
 	return m_refTime;
 }
 
-bool EBI::EventImage::addFromEventData(const EBI::EventData& dataIN, const EBI::EventPolarity polMode, const bool bSumEvents)
+//! event as EBI::Event, for filling images from either event type
+static inline EBI::Event _unpack(const EBI::Event& ev) { return ev; }
+static inline EBI::Event _unpack(const EBI::PackedEvent& ev) { return ev.event(); }
+
+/*!
+Enter event \a ev into image \a imgData of width \a imgWidth
+\return true if the event was used
+*/
+static inline bool _addEvent(const EBI::Event& ev, const EBI::EventPolarity polMode, const bool bSumEvents,
+	std::vector<float>& imgData, const uint32_t imgWidth)
+{
+	bool bUsed = false;
+	uint32_t ixy = (ev.y * imgWidth) + ev.x;
+	// TODO: choice of how to encode intensity
+	float val = imgData[ixy];
+	switch (polMode) {
+	case EBI::PolarityNegative:
+		if (ev.p == 0) {
+			val = static_cast<float>(ev.t);
+			bUsed = true;
+		}
+		break;
+	case EBI::PolarityBoth:
+		val = static_cast<float>(ev.t);
+		bUsed = true;
+		break;
+	case EBI::PolarityPositive:
+	default:
+		if (ev.p > 0) {
+			val = static_cast<float>(ev.t);
+			bUsed = true;
+		}
+		break;
+	}
+	if (bSumEvents)
+		imgData[ixy]++;
+	else
+		// place newer events on top of older ones (overwrite pixel value)
+		imgData[ixy] = val;
+	return bUsed;
+}
+
+/*!
+Enter the \a nEvents events at \a pEvents with time in [t1, t2] into image \a imgData of width \a imgWidth
+\return number of events used
+*/
+template <typename EventT>
+static uint64_t _addEvents(const EventT* pEvents, const size_t nEvents,
+	const uint32_t t1, const uint32_t t2,
+	const EBI::EventPolarity polMode, const bool bSumEvents,
+	std::vector<float>& imgData, const uint32_t imgWidth)
+{
+	uint64_t nUsed = 0;
+	for (size_t i = 0; i < nEvents; i++) {
+		const EBI::Event ev = _unpack(pEvents[i]);
+		if ((ev.t < t1) || (ev.t > t2))
+			continue;
+		if (_addEvent(ev, polMode, bSumEvents, imgData, imgWidth))
+			nUsed++;
+	}
+	return nUsed;
+}
+
+//! set all pixels without events to \a refTime
+static void _fillReferenceTime(std::vector<float>& imgData, const int32_t refTime)
+{
+	for (size_t i = 0; i < imgData.size(); i++) {
+		if (imgData[i] < 1)
+			imgData[i] = static_cast<float>(refTime);
+	}
+}
+
+/*!
+Add events of \a events to the image, allocated from \a camSpecs if empty
+*/
+template <typename EventT>
+bool EBI::EventImage::addEvents(const std::vector<EventT>& events, const EBI::EventCameraSpecs& camSpecs,
+	const EBI::EventPolarity polMode, const bool bSumEvents)
 {
 	if ((m_imgHeight == 0) || (m_imgWidth == 0)) {
-		if (!alloc(dataIN))
+		if (!alloc(camSpecs))
 			return false;
 	}
-	if ((m_imgHeight != dataIN.m_camSpecs.sensorH)
-		|| (m_imgWidth != dataIN.m_camSpecs.sensorW)) {
+	if ((m_imgHeight != camSpecs.sensorH)
+		|| (m_imgWidth != camSpecs.sensorW)) {
 		std::cerr << "EBI::EventImage::addFromEventData() - size mismatch" << std::endl;
 		return false;
 	}
 	// fill image
-	for (EBI::Event ev : dataIN.m_events) {
-		uint32_t ixy = (ev.y * m_imgWidth) + ev.x;
-		// TODO: choice of how to encode intensity
-		float val = m_imgData[ixy];
-		switch (polMode) {
-		case EBI::PolarityNegative:
-			if (ev.p == 0) {
-				val = static_cast<float>(ev.t);
-				m_eventsUsed++;
-			}
-			if (bSumEvents)
-				m_imgData[ixy]++;
-			else
-				m_imgData[ixy] = val;
-			break;
-		case EBI::PolarityBoth:
-			val = static_cast<float>(ev.t);
-			m_eventsUsed++;
-			if (bSumEvents)
-				m_imgData[ixy]++;
-			else
-				// place newer events on top of older ones (overwrite pixel value)
-				m_imgData[ixy] = val;
-			break;
-		case EBI::PolarityPositive:
-		default:
-			if (ev.p > 0) {
-				val = static_cast<float>(ev.t);
-				m_eventsUsed++;
-			}
-			if (bSumEvents)
-				m_imgData[ixy]++;
-			else
-				// place newer events on top of older ones (overwrite pixel value)
-				m_imgData[ixy] = val;
-			break;
-		}
-	}
+	m_eventsUsed += _addEvents(events.data(), events.size(), 0, UINT32_MAX, polMode, bSumEvents, m_imgData, m_imgWidth);
 	m_bNeedStats = true;
 	return true;
 }
 
-bool EBI::EventImage::fromEventData(
-	const EBI::EventData& src,
+/*!
+Image of the events in [offsetUSec, offsetUSec + durationUSec] of \a events.
+\a timeRange(t1, t2, iFirst, iEnd) limits the events visited to [iFirst, iEnd).
+*/
+template <typename EventT, typename RangeFn>
+bool EBI::EventImage::fromEvents(const std::vector<EventT>& events, RangeFn timeRange,
+	const EBI::EventCameraSpecs& camSpecs,
 	const EBI::EventPolarity polMode,
 	const uint32_t offsetUSec,
 	const uint32_t durationUSec,
@@ -154,69 +239,131 @@ bool EBI::EventImage::fromEventData(
 )
 {
 	clear();
-	if (src.m_events.size() == 0) // no data
+	if (events.size() == 0) // no data
 		return false;
-	if (!alloc(src)) {
+	if (!alloc(camSpecs)) {
 		return false;
 	}
 	uint32_t t1 = offsetUSec;
 	uint32_t t2 = t1 + durationUSec;
 	if (t2 == t1) {
 		// use full duration of data set
-		t2 = src.m_events[src.m_events.size() - 1].t;
+		t2 = _unpack(events[events.size() - 1]).t;
 	}
 	m_duration = (t2 - t1);
 	// fill image
-	for (EBI::Event ev : src.m_events) {
-		if (ev.t >= t1) {
-			if (ev.t <= t2) {
-				uint32_t ixy = (ev.y * m_imgWidth) + ev.x;
-				// TODO: choice of how to encode intensity
-				float val = m_imgData[ixy];
-				switch (polMode) {
-				case EBI::PolarityNegative:
-					if (ev.p == 0) {
-						val = static_cast<float>(ev.t);
-						m_eventsUsed++;
-					}
-					if(bSumEvents)
-						m_imgData[ixy]++;
-					else
-						// place newer events on top of older ones (overwrite pixel value)
-						m_imgData[ixy] = val;
-					break;
-				case EBI::PolarityBoth:
-					val = static_cast<float>(ev.t);
-					m_eventsUsed++;
-					if (bSumEvents)
-						m_imgData[ixy]++;
-					else
-						// place newer events on top of older ones (overwrite pixel value)
-						m_imgData[ixy] = val;
-					break;
-				case EBI::PolarityPositive:
-				default:
-					if (ev.p > 0) {
-						val = static_cast<float>(ev.t);
-						m_eventsUsed++;
-					}
-					if (bSumEvents)
-						m_imgData[ixy]++;
-					else
-						// place newer events on top of older ones (overwrite pixel value)
-						m_imgData[ixy] = val;
-				}
-			}
-		}
-	}
+	size_t iFirst, iEnd;
+	timeRange(t1, t2, iFirst, iEnd);
+	m_eventsUsed += _addEvents(events.data() + iFirst, iEnd - iFirst, t1, t2, polMode, bSumEvents, m_imgData, m_imgWidth);
 	if (nRefTimeUSec > 0) {
 		m_refTime = nRefTimeUSec;
 		// set all zero intensities to refTime
 		//std::cout << "setting reference time: " << nRefTimeUSec << " usec\n";
-		for (size_t i = 0; i < m_imgData.size(); i++) {
-			if(m_imgData[i] < 1)
-				m_imgData[i] = static_cast<float>(m_refTime);
-		}
+		_fillReferenceTime(m_imgData, m_refTime);
+	}
+	m_bNeedStats = true;
+	return true;
+}
+
+bool EBI::EventImage::addFromEventData(const EBI::EventData& dataIN, const EBI::EventPolarity polMode, const bool bSumEvents)
+{
+	return addEvents(dataIN.m_events, dataIN.m_camSpecs, polMode, bSumEvents);
+}
+
+/*!
+Add packed events, same as addFromEventData() for EBI::EventData
+*/
+bool EBI::EventImage::addFromEventData(const EBI::PackedEventData& dataIN, const EBI::EventPolarity polMode, const bool bSumEvents)
+{
+	return addEvents(dataIN.m_events, dataIN.m_camSpecs, polMode, bSumEvents);
+}
+
+bool EBI::EventImage::fromEventData(
+	const EBI::EventData& src,
+	const EBI::EventPolarity polMode,
+	const uint32_t offsetUSec,
+	const uint32_t durationUSec,
+	const int32_t nRefTimeUSec,
+	const bool bSumEvents
+)
+{
+	auto timeRange = [&src](const uint32_t t1, const uint32_t t2, size_t& iFirst, size_t& iEnd) {
+		src.timeRange(t1, t2, iFirst, iEnd); };
+	return fromEvents(src.m_events, timeRange, src.m_camSpecs, polMode, offsetUSec, durationUSec, nRefTimeUSec, bSumEvents);
+}
+
+/*!
+Image from packed events, same as fromEventData() for EBI::EventData
+*/
+bool EBI::EventImage::fromEventData(
+	const EBI::PackedEventData& src,
+	const EBI::EventPolarity polMode,
+	const uint32_t offsetUSec,
+	const uint32_t durationUSec,
+	const int32_t nRefTimeUSec,
+	const bool bSumEvents
+)
+{
+	const size_t nEvents = src.m_events.size();
+	auto timeRange = [nEvents](const uint32_t, const uint32_t, size_t& iFirst, size_t& iEnd) {
+		iFirst = 0;
+		iEnd = nEvents; };
+	return fromEvents(src.m_events, timeRange, src.m_camSpecs, polMode, offsetUSec, durationUSec, nRefTimeUSec, bSumEvents);
+}
+
+/*!
+Image of the events in [offsetUSec, offsetUSec + durationUSec] of paged event data,
+only the blocks of this window are read. Pixel times are relative to \a offsetUSec,
+as times beyond 32 bits do not fit the image. \a durationUSec = 0 reads until the
+end of the recording into memory.
+*/
+bool EBI::EventImage::fromEventData(
+	const EBI::PagedEventData& src,
+	const EBI::EventPolarity polMode,
+	const uint64_t offsetUSec,
+	const uint32_t durationUSec,
+	const int32_t nRefTimeUSec,
+	const bool bSumEvents
+)
+{
+	EBI::EventData window;
+	if (!src.copyTo(window, EBI::PolarityBoth, static_cast<int64_t>(offsetUSec), static_cast<int32_t>(durationUSec))) {
+		clear();
+		return false;
+	}
+	return fromEventData(window, polMode, 0, durationUSec, nRefTimeUSec, bSumEvents);
+}
+
+/*!
+Image of the events selected by \a src, with the polarity mode, times and coordinates of the view;
+the events are visited in place without copying
+*/
+bool EBI::EventImage::fromEventData(
+	const EBI::EventView& src,
+	const int32_t nRefTimeUSec,
+	const bool bSumEvents
+)
+{
+	clear();
+	if (src.empty()) // no data
+		return false;
+	EBI::EventCameraSpecs camSpecs;
+	camSpecs.sensorW = static_cast<uint32_t>(std::max(src.imageWidth(), 0));
+	camSpecs.sensorH = static_cast<uint32_t>(std::max(src.imageHeight(), 0));
+	if (!alloc(camSpecs)) {
+		return false;
+	}
+	m_duration = src.duration();
+	const EBI::EventPolarity polMode = src.polarity();
+	for (const EBI::Event& ev : src) {
+		if (!src.contains(ev))
+			continue;
+		if (_addEvent(src.relative(ev), polMode, bSumEvents, m_imgData, m_imgWidth))
+			m_eventsUsed++;
+	}
+	if (nRefTimeUSec > 0) {
+		m_refTime = nRefTimeUSec;
+		_fillReferenceTime(m_imgData, m_refTime);
 	}
 	m_bNeedStats = true;
 	return true;
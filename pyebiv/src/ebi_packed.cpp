@@ -0,0 +1,443 @@
+#include "ebi.h"
+#include "ebi_packed.h"
+#include "ebi_rawevt3.h"
+#include "ebi_evtfile.h"
+#include "ebi_select.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+static constexpr size_t READ_BLOCK = 65536;		// events read at once from own event files
+
+//! mark selected events of a block in \a mask, branch free so that the loop is vectorized
+static void _selectMask(const EBI::PackedEvent* __restrict ev, const size_t n,
+	const EBI::EventSelection& sel, uint8_t* __restrict mask)
+{
+	const EBI::EventSelection s = sel;
+	for (size_t i = 0; i < n; i++) {
+		const uint32_t tp = ev[i].timePol;
+		mask[i] = s.keeps(tp >> 1, ev[i].x, ev[i].y, (tp & 0x1) != 0);
+	}
+}
+
+/*!
+Store the events of a block marked in \a mask at \a dst, shifted by the selection offsets.
+Every event is written and the output position only advances for selected ones,
+so one element beyond the selected events must be writable.
+Output may overlap the input if it does not start behind it (compaction in place).
+\return number of events stored
+*/
+static size_t _compactBlock(const EBI::PackedEvent* src, const uint8_t* mask, const size_t n,
+	const EBI::EventSelection& sel, EBI::PackedEvent* dst)
+{
+	const uint32_t tpSub = sel.tSub << 1;	// leaves the polarity bit untouched
+	const uint16_t x0 = static_cast<uint16_t>(sel.x0), y0 = static_cast<uint16_t>(sel.y0);
+	size_t k = 0;
+	for (size_t i = 0; i < n; i++) {
+		EBI::PackedEvent ev = src[i];
+		ev.x = static_cast<uint16_t>(ev.x - x0);
+		ev.y = static_cast<uint16_t>(ev.y - y0);
+		ev.timePol -= tpSub;
+		dst[k] = ev;
+		k += mask[i];
+	}
+	return k;
+}
+
+/*!
+Append the events of \a src selected by \a sel to the first \a nOut events of \a dst.
+\a src may be the data of \a dst at or behind position \a nOut (compaction in place),
+in that case \a dst is not resized and no slack element is needed.
+\return number of events in \a dst
+*/
+static size_t _selectEvents(const EBI::PackedEvent* src, const size_t nSrc, const EBI::EventSelection& sel,
+	std::vector<EBI::PackedEvent>& dst, const size_t nOut, std::vector<uint8_t>& mask)
+{
+	if (sel.bNone)
+		return nOut;
+	const bool bInPlace = (src >= dst.data()) && (src < dst.data() + dst.size());
+	return EBI::SelectBlocks(nSrc, nOut, mask,
+		[&](const size_t nFirst, const size_t n, uint8_t* pMask) { _selectMask(src + nFirst, n, sel, pMask); },
+		[&](const size_t nFirst, const size_t n, const size_t nSel, const size_t nDst, const uint8_t* pMask) {
+			if (!bInPlace)
+				dst.resize(nDst + nSel + 1);	// one slack element for _compactBlock()
+			return _compactBlock(src + nFirst, pMask, n, sel, dst.data() + nDst);
+		});
+}
+
+//! fill \a dst with the events of \a src selected by \a sel, \a dst may be \a src
+static void _selectEvents(const std::vector<EBI::PackedEvent>& src, const EBI::EventSelection& sel,
+	std::vector<EBI::PackedEvent>& dst)
+{
+	std::vector<uint8_t> mask;
+	if (&src != &dst)
+		dst.resize(0);
+	const size_t nOut = _selectEvents(src.data(), src.size(), sel, dst, 0, mask);
+	dst.resize(nOut);
+}
+
+EBI::PackedEventData::PackedEventData()
+{
+	init();
+}
+
+/*!
+Constructor converting from array of events
+*/
+EBI::PackedEventData::PackedEventData(const EBI::EventData& src)
+{
+	init();
+	copyFrom(src);
+}
+
+EBI::PackedEventData::~PackedEventData()
+{
+
+}
+
+void EBI::PackedEventData::init()
+{
+	m_events.resize(0);
+	m_triggerEvents.resize(0);
+	m_timeStamp = 0;
+	m_camSpecs.init();
+	m_nDebugLevel = 0;
+	m_maxEvents = 100'000'000;	// same as EBI::EventData
+	m_decodeParams.init();
+	m_loadStats.init();
+}
+
+void EBI::PackedEventData::clear()
+{
+	init();
+}
+
+/*!
+Append \a n events, packing each into 8 bytes
+*/
+void EBI::PackedEventData::append(const EBI::Event* pEvents, const size_t n)
+{
+	const size_t nOld = m_events.size();
+	m_events.resize(nOld + n);
+	EBI::PackedEvent* pDst = m_events.data() + nOld;
+	for (size_t i = 0; i < n; i++)
+		pDst[i] = EBI::PackedEvent(pEvents[i]);
+}
+
+/*!
+Replace events by \a events
+*/
+void EBI::PackedEventData::assign(const std::vector<EBI::Event>& events)
+{
+	m_events.resize(0);
+	if (!events.empty())
+		append(events.data(), events.size());
+}
+
+/*!
+Store events as array of EBI::Event in \a events
+*/
+void EBI::PackedEventData::toEvents(std::vector<EBI::Event>& events) const
+{
+	const size_t n = m_events.size();
+	events.resize(n);
+	EBI::Event* pEv = events.data();
+	for (size_t i = 0; i < n; i++)
+		pEv[i] = m_events[i].event();
+}
+
+/*!
+Make a complete copy of \a src, including trigger events.
+Times beyond EBI::PACKED_TIME_MAX are not representable and wrap around.
+*/
+bool EBI::PackedEventData::copyFrom(const EBI::EventData& src)
+{
+	assign(src.m_events);
+	m_triggerEvents = src.m_triggerEvents;
+	m_camSpecs = src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	m_loadStats = src.m_loadStats;
+	return true;
+}
+
+/*!
+Store a complete copy in \a dst, including trigger events
+*/
+bool EBI::PackedEventData::copyTo(EBI::EventData& dst) const
+{
+	dst.init();
+	toEvents(dst.m_events);
+	dst.m_triggerEvents = m_triggerEvents;
+	dst.m_camSpecs = m_camSpecs;
+	dst.m_timeStamp = m_timeStamp;
+	dst.m_loadStats = m_loadStats;
+	return true;
+}
+
+/*!
+Copy events of \a src in [offsetUSec, offsetUSec + durationUSec] with polarity \a polMode,
+same as EventData::copyFrom()
+*/
+bool EBI::PackedEventData::copyFrom(const EBI::PackedEventData& src,
+	const EBI::EventPolarity polMode,	//!< copy only events with the specified polarity
+	const int32_t offsetUSec,
+	const int32_t durationUSec,
+	bool bSubtractOffsetTime)
+{
+	EBI::EventSelection sel;
+	if (!src.empty()) {
+		const uint32_t t1 = static_cast<uint32_t>(offsetUSec);
+		// use end time in source for durationUSec = 0
+		const uint32_t t2 = (durationUSec == 0) ? src.m_events.back().t() : static_cast<uint32_t>(offsetUSec + durationUSec);
+		sel.setTime(t1, t2, false);
+		sel.tSub = bSubtractOffsetTime ? t1 : 0;
+		sel.setPolarity(polMode);
+	}
+	_selectEvents(src.m_events, sel, m_events);
+	m_triggerEvents.resize(0);
+	m_camSpecs = src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	if (m_nDebugLevel > 0)
+		std::cout << "PackedEventData::copyFrom(t0=" << offsetUSec << "  duration=" << durationUSec << ") "
+			<< size() << " events" << std::endl;
+	return true;
+}
+
+/*!
+Copy events of \a src within the ROI and [t0, t0 + dur) with polarity \a polMode,
+coordinates and time are relative to the ROI and \a t0. For \a dur = 0 events
+of all times are copied. Same as EventData::copyFrom().
+*/
+bool EBI::PackedEventData::copyFrom(const EBI::PackedEventData& src,
+	const EBI::EventPolarity polMode,	//!< copy only events with the specified polarity
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for entire set
+)
+{
+	EBI::EventSelection sel;
+	if (durationUSec != 0)
+		sel.setTime(static_cast<uint32_t>(offsetUSec), static_cast<uint32_t>(offsetUSec + durationUSec), true);
+	sel.tSub = static_cast<uint32_t>(offsetUSec);
+	sel.setROI(x, y, w, h);
+	sel.setPolarity(polMode);
+	_selectEvents(src.m_events, sel, m_events);
+	m_triggerEvents.resize(0);
+	m_camSpecs = src.m_camSpecs;
+	m_timeStamp = src.m_timeStamp;
+	m_camSpecs.sensorW = w;
+	m_camSpecs.sensorH = h;
+	return true;
+}
+
+bool EBI::PackedEventData::copyFrom(const EBI::PackedEventData& src,
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,
+	const int32_t durationUSec
+)
+{
+	return copyFrom(src, EBI::PolarityBoth, x, y, w, h, offsetUSec, durationUSec);
+}
+
+/*!
+Reduce event data set to specified region of interest (ROI), in place.
+Same as EventData::cropROI().
+\return TRUE on success, FALSE on invalid ROI or missing data
+*/
+bool EBI::PackedEventData::cropROI(
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for entire set
+	)
+{
+	if (empty())
+		return false;
+	EBI::EventFilter roi;
+	roi.roiX = x;
+	roi.roiY = y;
+	roi.roiW = w;
+	roi.roiH = h;
+	if (!EBI::ClipSelectionROI(roi, imageWidth(), imageHeight()))
+		return false;
+	EBI::EventSelection sel;
+	if (durationUSec != 0)
+		sel.setTime(static_cast<uint32_t>(offsetUSec), static_cast<uint32_t>(offsetUSec + durationUSec), true);
+	sel.tSub = static_cast<uint32_t>(offsetUSec);
+	sel.setROI(roi.roiX, roi.roiY, roi.roiW, roi.roiH);
+	_selectEvents(m_events, sel, m_events);
+	m_camSpecs.sensorW = roi.roiW;
+	m_camSpecs.sensorH = roi.roiH;
+	return true;
+}
+
+/*!
+Sample the data set into \a sample, same as EventData::getSample().
+Also subtracts time \a t0 and top-left coordinates \a (x,y) from event
+\return number of events in sample
+*/
+size_t EBI::PackedEventData::getSample(EBI::PackedEventData& sample,
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int32_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for entire set
+	) const
+{
+	EBI::EventSelection sel;
+	if (durationUSec != 0)
+		sel.setTime(static_cast<uint32_t>(offsetUSec), static_cast<uint32_t>(offsetUSec + durationUSec), true);
+	sel.tSub = static_cast<uint32_t>(offsetUSec);
+	sel.setROI(x, y, w, h);
+	_selectEvents(m_events, sel, sample.m_events);
+	sample.m_camSpecs.sensorW = w;
+	sample.m_camSpecs.sensorH = h;
+	sample.m_timeStamp = m_timeStamp;
+	return sample.size();
+}
+
+/*!
+Load only the events selected by \a filter, same as EventData::load().
+Metavision RAW files are decoded directly into packed events, only the first
+EBI::PACKED_TIME_MAX microseconds are loaded. Own EVT3 files already store
+packed events and are read in blocks.
+Loading stops at setMaximumSize() events for any type of file, RAW files
+are decoded in blocks and may end up to a block beyond the limit.
+Clears existing event data set
+\return True on success
+*/
+bool EBI::PackedEventData::load(
+	const std::string& fnameEvents,	//!< file name, can be either Metavision RAW or own EVT3
+	const EBI::EventFilter& filter	//!< time window, ROI and polarity of events to load
+)
+{
+	m_events.resize(0);
+	m_triggerEvents.resize(0);
+	m_timeStamp = 0;
+	m_camSpecs.init();
+	m_loadStats.init();
+	EBI::FileFormat eType = EBI::GetFileType(fnameEvents);
+	if (eType == EBI::FILE_FORMAT_UNKNOWN) {
+		std::cerr << "ERROR: Unknown fiile type!" << std::endl;
+		return false;
+	}
+	if (eType == EBI::FILE_FORMAT_RAWEVT3) {
+		return EBI::LoadRawEventData(
+			fnameEvents,
+			*this,
+			m_triggerEvents,
+			m_timeStamp,
+			m_camSpecs,
+			filter.offsetUSec,
+			filter.durationUSec,
+			m_maxEvents,
+			m_decodeParams,
+			m_loadStats,
+			filter,
+			m_nDebugLevel > 0);
+	}
+	if ((eType == EBI::FILE_FORMAT_EVT4) || (eType == EBI::FILE_FORMAT_EVTZ) || (eType == EBI::FILE_FORMAT_EVTT)) {
+		// blocks are found through their index and decoded by EventData, events beyond EBI::PACKED_TIME_MAX
+		// are not loaded as from EVT3 files, tiled files are refused
+		EBI::EventData evData;
+		evData.setDebugLevel(m_nDebugLevel);
+		evData.setMaximumSize(m_maxEvents);
+		if (!evData.load(fnameEvents, filter))
+			return false;
+		std::vector<EBI::Event>& events = evData.dataRef();
+		const size_t nMax = static_cast<size_t>(std::min<uint64_t>(events.size(), m_maxEvents));
+		size_t nKeep = 0;
+		while ((nKeep < nMax) && (evData.eventTime(nKeep) <= EBI::PACKED_TIME_MAX))
+			nKeep++;
+		events.resize(nKeep);
+		return copyFrom(evData);
+	}
+	return loadEventFile(fnameEvents, filter);
+}
+
+/*!
+Load own EVT3 file, same selection of events as EventData::load()
+\return True on success
+*/
+bool EBI::PackedEventData::loadEventFile(const std::string& fnameEvents, const EBI::EventFilter& filter)
+{
+	std::ifstream inFile(fnameEvents, std::ios::in | std::ios::binary);
+	if (!inFile.is_open()) {
+		std::cerr << "ERROR: EBI::PackedEventData::load() failed opening file '" << fnameEvents << "'" << std::endl;
+		return false;
+	}
+	_EVENT_FILE_HDR hdr;
+	inFile.read((char*)&hdr, _EVENT_FILE_HDR_SIZE);
+	const bool bSegmented = (hdr.SegmentSignature == _EVENT_FILE_SEGMENT_SIGNATURE);
+	const uint64_t nDuration = bSegmented ? ((static_cast<uint64_t>(hdr.DurationHigh) << 32) | hdr.Duration) : hdr.Duration;
+	if (!inFile || (filter.offsetUSec > nDuration)) {
+		std::cerr << "ERROR: EBI::PackedEventData::load() start beyond end of file" << std::endl;
+		return false;
+	}
+	EBI::EventFilter roiFilter = filter;
+	if (!roiFilter.clipROI(static_cast<int32_t>(hdr.cols), static_cast<int32_t>(hdr.rows))) {
+		std::cerr << "ERROR: EBI::PackedEventData::load() invalid ROI" << std::endl;
+		return false;
+	}
+	m_camSpecs.sensorW = hdr.cols;
+	m_camSpecs.sensorH = hdr.rows;
+	m_timeStamp = hdr.TimeStamp;
+	// events of later time segments are beyond EBI::PACKED_TIME_MAX, the segment table follows the events
+	uint64_t nEventsLeft = UINT64_MAX;
+	if (bSegmented) {
+		nEventsLeft = hdr.EventCount;
+		if (hdr.SegmentCount > 0) {
+			_EVENT_FILE_SEGMENT seg;
+			inFile.seekg(_EVENT_FILE_HDR_SIZE + hdr.EventCount * _PACKED_EVENT_SIZE, std::ios::beg);
+			if (inFile.read(reinterpret_cast<char*>(&seg), _EVENT_FILE_SEGMENT_SIZE))
+				nEventsLeft = std::min<uint64_t>(nEventsLeft, seg.FirstEvent);
+			inFile.clear();
+			inFile.seekg(_EVENT_FILE_HDR_SIZE, std::ios::beg);
+		}
+	}
+
+	std::vector<EBI::PackedEvent> block(READ_BLOCK);
+	std::vector<uint8_t> mask;
+	EBI::EventSelection sel;
+	if (roiFilter.hasROI()) {
+		sel.setROI(roiFilter.roiX, roiFilter.roiY, roiFilter.roiW, roiFilter.roiH);
+		m_camSpecs.sensorW = static_cast<uint32_t>(roiFilter.roiW);
+		m_camSpecs.sensorH = static_cast<uint32_t>(roiFilter.roiH);
+	}
+	sel.setPolarity(roiFilter.evPol);
+	size_t nOut = 0;
+	bool bFirst = true;
+	bool bDone = false;
+	uint32_t tN = 0;
+	while (!bDone && (nEventsLeft > 0) && (nOut < m_maxEvents)) {
+		inFile.read(reinterpret_cast<char*>(block.data()), std::min<uint64_t>(READ_BLOCK, nEventsLeft) * _PACKED_EVENT_SIZE);
+		size_t n = static_cast<size_t>(inFile.gcount()) / _PACKED_EVENT_SIZE;
+		if (n == 0)
+			break;
+		nEventsLeft -= n;
+		if (bFirst) {
+			// time window relative to the first event
+			const uint64_t t0 = block[0].t() + static_cast<uint64_t>(filter.offsetUSec);
+			const uint64_t tEnd = (filter.durationUSec == 0) ? block[0].t() + nDuration
+				: t0 + filter.durationUSec;
+			tN = static_cast<uint32_t>(std::min<uint64_t>(tEnd, EBI::PACKED_TIME_MAX));
+			sel.setTime(static_cast<uint32_t>(std::min<uint64_t>(t0, EBI::PACKED_TIME_MAX)), tN, false);
+			bFirst = false;
+		}
+		// loading stops at the first event after the time window
+		for (size_t i = 0; i < n; i++) {
+			if (block[i].t() > tN) {
+				n = i;
+				bDone = true;
+				break;
+			}
+		}
+		nOut = static_cast<size_t>(std::min<uint64_t>(_selectEvents(block.data(), n, sel, m_events, nOut, mask), m_maxEvents));
+		m_events.resize(nOut);
+	}
+	m_loadStats.nEvents = m_events.size();
+	if (m_nDebugLevel > 0)
+		std::cout << "EBI::PackedEventData::load('" << fnameEvents << "') " << m_events.size() << " events" << std::endl;
+	return true;
+}
@@ -0,0 +1,550 @@
+#include "ebi.h"
+#include "ebi_paged.h"
+#include "ebi_rawevt3.h"
+#include "ebi_evtfile.h"
+#include "ebi_evtcodec.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+static constexpr uint64_t RAW_WORDS_PER_READ = 262144;	// raw words decoded at once while the block file is written
+static constexpr size_t EVT_EVENTS_PER_READ = 65536;	// packed events read at once from own event files
+static constexpr uint64_t CACHE_SIZE_DEFAULT = 256ULL << 20;	// resident blocks in [byte]
+static constexpr uint32_t TILE_SIZE_DEFAULT = 32;		// tile size of resident blocks used by getSamples() if none is set
+
+/*! \cond
+ * header of block files, followed by the events of each block as PACKED_EVENT
+ * with time relative to the start of the block, then by the block table
+ */
+struct _PAGED_FILE_HDR
+{
+	char		Signature[4];	//!< "EBPG"
+	uint32_t	Version;		//!< 1
+	uint64_t	SourceFileSize;	//!< size of RAW or EVT file the blocks were written from, 0 if unknown
+	uint64_t	TimeStamp;		//!< time in [usec] of first event of the source file
+	uint64_t	EventCount;		//!< number of events in all blocks
+	uint64_t	Duration;		//!< time of last event in [usec], relative to first event
+	uint64_t	TableOffset;	//!< byte offset of the block table
+	uint32_t	BlockUSec;		//!< duration of each block in [usec]
+	uint32_t	BlockCount;		//!< number of _PAGED_FILE_BLOCK in the block table
+	uint32_t	cols, rows;		//!< size of image
+	uint32_t	HeaderLength;	//!< should be 80
+	uint32_t	_reserved;		//!< bytes 77...80
+};
+#define _PAGED_FILE_HDR_SIZE 80
+#define _PAGED_FILE_VERSION 1
+
+/*
+ * entry of the block table, block k holds the events in [k * BlockUSec, (k + 1) * BlockUSec)
+ */
+struct _PAGED_FILE_BLOCK
+{
+	uint64_t	Offset;			//!< byte offset of the events of the block
+	uint64_t	EventCount;		//!< number of events of the block, 0 for gaps
+};
+#define _PAGED_FILE_BLOCK_SIZE 16
+//! \endcond
+
+/*!
+Writes events in order of arrival to the blocks of a block file. An event stepping
+back before the start of the current block is moved to the start of the block.
+*/
+struct _BlockWriter
+{
+	std::ofstream& outFile;
+	const uint32_t blockUSec;
+	std::vector<_PAGED_FILE_BLOCK> table;
+	std::vector<PACKED_EVENT> events;	//!< events of the current block
+	uint64_t tBlock;		//!< start of the current block
+	uint64_t nEvents;
+	uint64_t tLast;
+	uint64_t nMoved;		//!< events moved to the start of a later block
+
+	_BlockWriter(std::ofstream& outFileIN, const uint32_t blockUSecIN)
+		: outFile(outFileIN), blockUSec(blockUSecIN)
+	{
+		tBlock = 0;
+		nEvents = 0;
+		tLast = 0;
+		nMoved = 0;
+	}
+	void add(const EBI::Event& ev, uint64_t t)
+	{
+		while (t - tBlock >= blockUSec && t > tBlock)
+			flush();
+		if (t < tBlock) {
+			t = tBlock;
+			nMoved++;
+		}
+		PACKED_EVENT pe;
+		pe.x = ev.x;
+		pe.y = ev.y;
+		pe.timePol = static_cast<uint32_t>(t - tBlock) << 1;
+		if (ev.p > 0)
+			pe.timePol |= 0x1;
+		events.push_back(pe);
+		tLast = std::max(tLast, t);
+		nEvents++;
+	}
+	//! write the current block and start the next one
+	void flush()
+	{
+		_PAGED_FILE_BLOCK entry;
+		entry.Offset = static_cast<uint64_t>(outFile.tellp());
+		entry.EventCount = events.size();
+		table.push_back(entry);
+		outFile.write(reinterpret_cast<const char*>(events.data()), events.size() * _PACKED_EVENT_SIZE);
+		events.clear();
+		tBlock += blockUSec;
+	}
+};
+
+EBI::PagedEventData::PagedEventData()
+{
+	m_nCacheBytes = CACHE_SIZE_DEFAULT;
+	m_tileSize = 0;
+	m_decodeParams.init();
+	m_nDebugLevel = 0;
+	close();
+}
+
+EBI::PagedEventData::~PagedEventData()
+{
+	close();
+}
+
+void EBI::PagedEventData::close()
+{
+	if (m_file.is_open())
+		m_file.close();
+	m_file.clear();
+	m_blocks.clear();
+	m_cache.clear();
+	m_nUseCount = 0;
+	m_nBlockReads = 0;
+	m_nResidentBytes = 0;
+	m_blockUSec = 0;
+	m_nEvents = 0;
+	m_duration = 0;
+	m_camSpecs.init();
+	m_timeStamp = 0;
+}
+
+/*!
+Limit the blocks kept in memory to \a nBytes, the block in use is always kept
+*/
+void EBI::PagedEventData::setCacheSize(const uint64_t nBytes)
+{
+	m_nCacheBytes = nBytes;
+}
+
+/*!
+Use a tile index of \a tileSize x \a tileSize pixels in each resident block, see EventData::setTileSize()
+*/
+void EBI::PagedEventData::setTileSize(const uint32_t tileSize)
+{
+	m_tileSize = tileSize;
+	for (CachedBlock& cached : m_cache)
+		cached.events.setTileSize(tileSize);
+}
+
+/*!
+Open event file \a fnameEvents, either Metavision RAW or own EVT3 / EVT4 / EVTZ, through its block file.
+The block file <fnameEvents>.ebpg is written with blocks of \a blockUSec if it does not
+exist or was written for another version of the file or another block duration.
+\a fnameEvents may also be a block file itself.
+\return true on success
+*/
+bool EBI::PagedEventData::open(const std::string& fnameEvents, const uint32_t blockUSec)
+{
+	close();
+	std::string errMsg;
+	try {
+		// times within a block are stored in the 31 bits of PACKED_EVENT
+		if ((blockUSec == 0) || (blockUSec > _EVENT_FILE_SEGMENT_USEC)) {
+			errMsg = "invalid block duration";
+			throw (-1);
+		}
+		std::ifstream inFile(fnameEvents, std::ios::in | std::ios::binary);
+		if (!inFile.is_open()) {
+			errMsg = "failed opening file";
+			throw (-2);
+		}
+		char signature[4] = {};
+		inFile.read(signature, 4);
+		inFile.seekg(0, std::ios::end);
+		const uint64_t nSourceSize = static_cast<uint64_t>(inFile.tellg());
+		inFile.close();
+
+		if (memcmp(signature, "EBPG", 4) == 0) {
+			if (!openBlockFile(fnameEvents, 0, 0)) {
+				errMsg = "invalid block file";
+				throw (-3);
+			}
+			return true;
+		}
+		const std::string fnamePaged = fileName(fnameEvents);
+		if (openBlockFile(fnamePaged, nSourceSize, blockUSec))
+			return true;
+		if (!build(fnameEvents, fnamePaged, blockUSec)) {
+			errMsg = "failed writing block file '" + fnamePaged + "'";
+			throw (-4);
+		}
+		if (!openBlockFile(fnamePaged, nSourceSize, blockUSec)) {
+			errMsg = "failed reading block file '" + fnamePaged + "'";
+			throw (-5);
+		}
+	}
+	catch (int errCode)
+	{
+		std::cerr << "ERROR(" << errCode << "): EBI::PagedEventData::open() " << errMsg << std::endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+/*!
+Open block file \a fnamePaged and read its block table. With \a nSourceSize > 0 the file
+must have been written from a source file of this size with blocks of \a blockUSec.
+\return true on success
+*/
+bool EBI::PagedEventData::openBlockFile(const std::string& fnamePaged, const uint64_t nSourceSize, const uint32_t blockUSec)
+{
+	close();
+	m_file.open(fnamePaged, std::ios::in | std::ios::binary);
+	if (!m_file.is_open())
+		return false;
+	_PAGED_FILE_HDR hdr;
+	m_file.read(reinterpret_cast<char*>(&hdr), _PAGED_FILE_HDR_SIZE);
+	if (!m_file || (memcmp(hdr.Signature, "EBPG", 4) != 0) || (hdr.Version != _PAGED_FILE_VERSION)
+		|| (hdr.HeaderLength != _PAGED_FILE_HDR_SIZE) || (hdr.BlockUSec == 0)
+		|| ((nSourceSize > 0) && ((hdr.SourceFileSize != nSourceSize) || (hdr.BlockUSec != blockUSec)))) {
+		close();
+		return false;
+	}
+	std::vector<_PAGED_FILE_BLOCK> table(hdr.BlockCount);
+	m_file.seekg(hdr.TableOffset, std::ios::beg);
+	m_file.read(reinterpret_cast<char*>(table.data()), table.size() * _PAGED_FILE_BLOCK_SIZE);
+	if (!m_file) {
+		close();
+		return false;
+	}
+	m_blocks.reserve(table.size());
+	for (const _PAGED_FILE_BLOCK& entry : table) {
+		BlockEntry block;
+		block.offset = entry.Offset;
+		block.nEvents = entry.EventCount;
+		m_blocks.push_back(block);
+	}
+	m_blockUSec = hdr.BlockUSec;
+	m_nEvents = hdr.EventCount;
+	m_duration = hdr.Duration;
+	m_camSpecs.sensorW = hdr.cols;
+	m_camSpecs.sensorH = hdr.rows;
+	m_timeStamp = hdr.TimeStamp;
+	if (m_nDebugLevel > 0)
+		std::cout << "EBI::PagedEventData: " << m_nEvents << " events in " << m_blocks.size()
+			<< " blocks of " << m_blockUSec << " usec" << std::endl;
+	return true;
+}
+
+/*!
+Write the events of \a fnameEvents to block file \a fnamePaged in a single pass,
+only the events of the current block are held in memory
+\return true on success
+*/
+bool EBI::PagedEventData::build(const std::string& fnameEvents, const std::string& fnamePaged, const uint32_t blockUSec)
+{
+	std::ofstream outFile(fnamePaged, std::ios::out | std::ios::binary);
+	if (!outFile.is_open())
+		return false;
+	_PAGED_FILE_HDR hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.Signature, "EBPG", 4);
+	hdr.Version = _PAGED_FILE_VERSION;
+	hdr.BlockUSec = blockUSec;
+	hdr.HeaderLength = _PAGED_FILE_HDR_SIZE;
+	outFile.write(reinterpret_cast<const char*>(&hdr), _PAGED_FILE_HDR_SIZE);
+
+	_BlockWriter writer(outFile, blockUSec);
+	std::ifstream inFile(fnameEvents, std::ios::in | std::ios::binary);
+	_EVENT_FILE_HDR evtHdr;
+	memset(&evtHdr, 0, sizeof(evtHdr));
+	inFile.read(reinterpret_cast<char*>(&evtHdr), _EVENT_FILE_HDR_SIZE);
+	inFile.seekg(0, std::ios::end);
+	hdr.SourceFileSize = static_cast<uint64_t>(inFile.tellg());
+
+	const bool bCoded = (evtHdr.Signature == _EVENT_FILE_CODED_SIGNATURE);
+	const bool bBlocks = bCoded || (evtHdr.Signature == _EVENT_FILE_BLOCKS_SIGNATURE);
+	if ((evtHdr.Signature == _EVENT_FILE_SIGNATURE) || bBlocks) {
+		// own event file, times in 31 bits of their segment as in EventData::load()
+		std::vector<_EVENT_FILE_SEGMENT> segments;
+		std::vector<_EVENT_FILE_BLOCK> fileBlocks;
+		uint64_t nEventsLeft = UINT64_MAX;
+		if (bBlocks) {
+			// consecutive blocks, each with the time of its first event as time base
+			_EVENT_FILE_FOOTER footer = {};
+			inFile.seekg(-static_cast<std::streamoff>(_EVENT_FILE_FOOTER_SIZE), std::ios::end);
+			inFile.read(reinterpret_cast<char*>(&footer), _EVENT_FILE_FOOTER_SIZE);
+			if (!inFile || (footer.Signature != _EVENT_FILE_FOOTER_SIGNATURE))
+				return false;
+			fileBlocks.resize(footer.BlockCount);
+			inFile.seekg(footer.IndexOffset, std::ios::beg);
+			inFile.read(reinterpret_cast<char*>(fileBlocks.data()), fileBlocks.size() * _EVENT_FILE_BLOCK_SIZE);
+			if (!inFile)
+				return false;
+			nEventsLeft = 0;
+			for (const _EVENT_FILE_BLOCK& block : fileBlocks) {
+				if (!bCoded && (block.Offset != _EVENT_FILE_HDR_SIZE + nEventsLeft * _PACKED_EVENT_SIZE))
+					return false;
+				_EVENT_FILE_SEGMENT seg = { block.TimeFirst, nEventsLeft };
+				segments.push_back(seg);
+				nEventsLeft += block.EventCount;
+			}
+		}
+		else if (evtHdr.SegmentSignature == _EVENT_FILE_SEGMENT_SIGNATURE) {
+			nEventsLeft = evtHdr.EventCount;
+			segments.resize(evtHdr.SegmentCount);
+			inFile.seekg(_EVENT_FILE_HDR_SIZE + evtHdr.EventCount * _PACKED_EVENT_SIZE, std::ios::beg);
+			inFile.read(reinterpret_cast<char*>(segments.data()), segments.size() * _EVENT_FILE_SEGMENT_SIZE);
+			if (!inFile)
+				return false;
+		}
+		inFile.seekg(_EVENT_FILE_HDR_SIZE, std::ios::beg);
+		hdr.TimeStamp = evtHdr.TimeStamp;
+		hdr.cols = evtHdr.cols;
+		hdr.rows = evtHdr.rows;
+		std::vector<PACKED_EVENT> buffer(EVT_EVENTS_PER_READ);
+		std::vector<uint8_t> coded;
+		uint64_t iEvent = 0;
+		size_t nNextSegment = 0;
+		size_t nNextBlock = 0;
+		uint64_t tBase = 0;
+		while (nEventsLeft > 0) {
+			size_t n = 0;
+			if (bCoded) {
+				// one compressed block at a time
+				if (nNextBlock == fileBlocks.size())
+					break;
+				const _EVENT_FILE_BLOCK& block = fileBlocks[nNextBlock++];
+				coded.resize(block.ByteCount);
+				buffer.resize(std::max<size_t>(buffer.size(), block.EventCount));
+				inFile.seekg(block.Offset, std::ios::beg);
+				inFile.read(reinterpret_cast<char*>(coded.data()), coded.size());
+				if (!inFile || !EBI::DecodeEventBlock(coded.data(), coded.size(), block.EventCount, buffer.data()))
+					return false;
+				n = block.EventCount;
+			}
+			else {
+				inFile.read(reinterpret_cast<char*>(buffer.data()), std::min<uint64_t>(EVT_EVENTS_PER_READ, nEventsLeft) * _PACKED_EVENT_SIZE);
+				n = static_cast<size_t>(inFile.gcount() / _PACKED_EVENT_SIZE);
+			}
+			if (n == 0)
+				break;
+			nEventsLeft -= n;
+			for (size_t i = 0; i < n; i++, iEvent++) {
+				while ((nNextSegment < segments.size()) && (segments[nNextSegment].FirstEvent <= iEvent))
+					tBase = segments[nNextSegment++].TimeBase;
+				const PACKED_EVENT& pe = buffer[i];
+				writer.add(EBI::Event(pe.x, pe.y, (pe.timePol & 0x1) ? 1 : 0, 0), tBase + (pe.timePol >> 1));
+			}
+		}
+	}
+	else {
+		inFile.close();
+		EBI::RawEventReader reader;
+		if (!reader.open(fnameEvents, 0, 0, m_decodeParams, m_nDebugLevel > 0))
+			return false;
+		std::vector<EBI::Event> events;
+		std::vector<EBI::TriggerEvent> triggers;
+		std::vector<EBI::TimeSegment> evSegments, triggerSegments;
+		while (!reader.isEnd()) {
+			events.clear();
+			triggers.clear();
+			// the latest segment continues with the first event of this read
+			const uint64_t tBase = evSegments.empty() ? 0 : evSegments.back().tBase;
+			evSegments.assign(1, EBI::TimeSegment(tBase, 0));
+			triggerSegments.clear();
+			reader.read(events, triggers, evSegments, triggerSegments, RAW_WORDS_PER_READ);
+			for (size_t i = 0; i < events.size(); i++)
+				writer.add(events[i], EBI::SegmentBase(evSegments, i) + events[i].t);
+		}
+		hdr.TimeStamp = reader.timeStamp();
+		hdr.cols = reader.cameraSpecs().sensorW;
+		hdr.rows = reader.cameraSpecs().sensorH;
+	}
+	if (!writer.events.empty())
+		writer.flush();
+
+	hdr.EventCount = writer.nEvents;
+	hdr.Duration = writer.tLast;
+	hdr.TableOffset = static_cast<uint64_t>(outFile.tellp());
+	hdr.BlockCount = static_cast<uint32_t>(writer.table.size());
+	outFile.write(reinterpret_cast<const char*>(writer.table.data()), writer.table.size() * _PAGED_FILE_BLOCK_SIZE);
+	outFile.seekp(0, std::ios::beg);
+	outFile.write(reinterpret_cast<const char*>(&hdr), _PAGED_FILE_HDR_SIZE);
+	if (m_nDebugLevel > 0)
+		std::cout << "EBI::PagedEventData: wrote " << writer.nEvents << " events in " << writer.table.size()
+			<< " blocks to '" << fnamePaged << "', " << writer.nMoved << " moved to the start of a block" << std::endl;
+	return outFile.good();
+}
+
+/*!
+Events of block \a k with times relative to the start of the block, read from
+disk if not resident. Least recently used blocks are dropped to stay within the
+cache size. The reference is valid until the next call.
+*/
+EBI::EventData& EBI::PagedEventData::block(const size_t k) const
+{
+	m_nUseCount++;
+	for (CachedBlock& cached : m_cache) {
+		if (cached.k == k) {
+			cached.lastUse = m_nUseCount;
+			return cached.events;
+		}
+	}
+	const uint64_t nBytes = m_blocks[k].nEvents * sizeof(EBI::Event);
+	while (!m_cache.empty() && (m_nResidentBytes + nBytes > m_nCacheBytes)) {
+		auto itOldest = std::min_element(m_cache.begin(), m_cache.end(),
+			[](const CachedBlock& a, const CachedBlock& b) { return a.lastUse < b.lastUse; });
+		m_nResidentBytes -= itOldest->events.size() * sizeof(EBI::Event);
+		m_cache.erase(itOldest);
+	}
+
+	std::vector<PACKED_EVENT> buffer(m_blocks[k].nEvents);
+	m_file.clear();
+	m_file.seekg(m_blocks[k].offset, std::ios::beg);
+	m_file.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * _PACKED_EVENT_SIZE);
+	const size_t nRead = static_cast<size_t>(m_file.gcount() / _PACKED_EVENT_SIZE);
+	if (nRead < buffer.size())
+		std::cerr << "ERROR: EBI::PagedEventData failed reading block " << k << std::endl;
+
+	m_cache.emplace_back();
+	CachedBlock& cached = m_cache.back();
+	cached.k = k;
+	cached.lastUse = m_nUseCount;
+	cached.events.setTileSize(m_tileSize);
+	std::vector<EBI::Event>& events = cached.events.dataRef();
+	events.resize(nRead);
+	for (size_t i = 0; i < nRead; i++) {
+		const PACKED_EVENT& pe = buffer[i];
+		events[i] = EBI::Event(pe.x, pe.y, (pe.timePol & 0x1) ? 1 : 0, pe.timePol >> 1);
+	}
+	m_nResidentBytes += nRead * sizeof(EBI::Event);
+	m_nBlockReads++;
+	return cached.events;
+}
+
+/*!
+Call \a fn(block, tBlock, tLow, tHigh) for each block with events overlapping [\a t1, \a t2],
+in order of time. \a block holds the events from \a tBlock on, the window within it is
+[\a tLow, \a tHigh] relative to \a tBlock.
+*/
+template <typename Fn>
+void EBI::PagedEventData::forEachBlock(const uint64_t t1, const uint64_t t2, Fn fn) const
+{
+	if (m_blocks.empty() || (t2 < t1))
+		return;
+	const uint64_t kEnd = std::min<uint64_t>(t2 / m_blockUSec + 1, m_blocks.size());
+	for (uint64_t k = t1 / m_blockUSec; k < kEnd; k++) {
+		if (m_blocks[k].nEvents == 0)
+			continue;
+		const uint64_t tBlock = k * m_blockUSec;
+		const uint32_t tLow = static_cast<uint32_t>(std::max(t1, tBlock) - tBlock);
+		const uint32_t tHigh = static_cast<uint32_t>(std::min<uint64_t>(t2, tBlock + m_blockUSec - 1) - tBlock);
+		fn(block(static_cast<size_t>(k)), tBlock, tLow, tHigh);
+	}
+}
+
+/*!
+Events in ROI (\a x, \a y, \a w, \a h) and time window [t0, t0 + dur), relative to (x, y, t0),
+same as EventData::getSample(). Only the blocks overlapping the time window are read.
+\a dur = 0 samples until the end of the recording.
+*/
+std::vector<EBI::Event> EBI::PagedEventData::getSample(
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int64_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 until the end
+) const
+{
+	std::vector<EBI::Event> sample;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	const uint64_t t2 = (durationUSec == 0) ? m_duration : (t1 + static_cast<uint32_t>(durationUSec) - 1);
+	forEachBlock(t1, t2, [&](EBI::EventData& evBlock, const uint64_t tBlock, const uint32_t tLow, const uint32_t tHigh) {
+		const std::vector<EBI::Event> part = evBlock.getSample(x, y, w, h, tLow, static_cast<int32_t>(tHigh - tLow + 1));
+		const uint32_t dt = static_cast<uint32_t>(tBlock + tLow - t1);
+		for (EBI::Event ev : part) {
+			ev.t += dt;
+			sample.push_back(ev);
+		}
+	});
+	return sample;
+}
+
+/*!
+Sample the data set in each of \a windows, same as getSample() for each window.
+Windows are sampled in order of time, so each block is read once if the cache holds
+the blocks of the longest window. Uses a tile index of default size if none is set.
+*/
+std::vector<std::vector<EBI::Event> > EBI::PagedEventData::getSamples(
+	const std::vector<EBI::SampleWindow>& windows) const
+{
+	if (m_tileSize == 0) {
+		for (CachedBlock& cached : m_cache)
+			cached.events.setTileSize(TILE_SIZE_DEFAULT);
+		m_tileSize = TILE_SIZE_DEFAULT;
+	}
+	std::vector<size_t> order(windows.size());
+	for (size_t k = 0; k < order.size(); k++)
+		order[k] = k;
+	std::stable_sort(order.begin(), order.end(),
+		[&windows](const size_t a, const size_t b) { return windows[a].t0 < windows[b].t0; });
+	std::vector<std::vector<EBI::Event> > samples(windows.size());
+	for (const size_t k : order) {
+		const EBI::SampleWindow& win = windows[k];
+		samples[k] = getSample(win.x, win.y, win.w, win.h, win.t0, win.dur);
+	}
+	return samples;
+}
+
+/*!
+Copy the events with polarity \a polMode in [offsetUSec, offsetUSec + durationUSec] to \a dst,
+times relative to \a offsetUSec, to the end of the recording for \a durationUSec = 0.
+Only the blocks overlapping the time window are read.
+\return false if no file is open
+*/
+bool EBI::PagedEventData::copyTo(EBI::EventData& dst, const EBI::EventPolarity polMode,
+	const int64_t offsetUSec, const int32_t durationUSec) const
+{
+	dst.clear();
+	if (!isOpen())
+		return false;
+	dst.m_camSpecs = m_camSpecs;
+	dst.m_timeStamp = m_timeStamp;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	const uint64_t t2 = (durationUSec == 0) ? m_duration : (t1 + static_cast<uint32_t>(durationUSec));
+	uint64_t tSegment = 0;
+	forEachBlock(t1, t2, [&](const EBI::EventData& evBlock, const uint64_t tBlock, const uint32_t tLow, const uint32_t tHigh) {
+		size_t iFirst, iEnd;
+		evBlock.timeRange(tLow, tHigh, iFirst, iEnd);
+		const std::vector<EBI::Event>& events = evBlock.dataRef();
+		for (size_t i = iFirst; i < iEnd; i++) {
+			EBI::Event ev = events[i];
+			if ((ev.t < tLow) || (ev.t > tHigh))
+				continue;
+			if (((polMode == EBI::PolarityPositive) && (ev.p == 0)) || ((polMode == EBI::PolarityNegative) && (ev.p > 0)))
+				continue;
+			const uint64_t t = tBlock + ev.t - t1;
+			if ((t & ~(EBI::TIME_SEGMENT_USEC - 1)) > tSegment) {
+				tSegment = t & ~(EBI::TIME_SEGMENT_USEC - 1);
+				dst.m_timeSegments.push_back(EBI::TimeSegment(tSegment, dst.m_events.size()));
+			}
+			ev.t = static_cast<uint32_t>(t);
+			dst.m_events.push_back(ev);
+		}
+	});
+	return true;
+}
@@ -0,0 +1,2272 @@
+#include "ebi.h"
+#include "ebi_rawevt3.h"
+#include "ebi_columns.h"
+#include "ebi_packed.h"
+#include "ebi_file.h"
+#include "ebi_parallel.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstddef>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+//#define _DEBUG2
+
+static std::vector<std::string> _stringSplit(const std::string str, char delim)
+{
+	std::vector<std::string> result;
+	std::istringstream ss{ str };
+	std::string token;
+	while (std::getline(ss, token, delim)) {
+		if (!token.empty()) {
+			result.push_back(token);
+		}
+	}
+	return result;
+}
+
+/*!
+Parse the ASCII header of a Metavision RAW file and fill \a camSpecs.
+On return the stream is positioned at the first word of binary event data.
+\return true if file contains EVT 3.0 data
+*/
+bool EBI::ReadRawFileHeader(std::istream& input_file,
+	EBI::EventCameraSpecs& camSpecs,
+	const std::string& fname,
+	const bool bDebugMessages)
+{
+	// header reading part is modified to keep compatability with older raw data 
+	// (i.e. missing %end statement, missing sensor size info,...)
+
+	// header looks like this:
+	//	% camera_integrator_name CenturyArks
+	//	% date 2023 - 06 - 23 19:45 : 32
+	//	% evt 3.0
+	//	% format EVT3; height = 480; width = 640
+	//	% generation 3.1
+	//	% geometry 640x480
+	//	% integrator_name CenturyArks
+	//	% plugin_integrator_name CenturyArks
+	//	% plugin_name evc3a_plugin_gen31
+	//	% sensor_generation 3.1
+	//	% serial_number 00000097
+	//	% system_ID 40
+	//	% end
+	//-------------or------------
+	//	% date 2022 - 08 - 11 16:33 : 16
+	//	% evt 3.0
+	//	% firmware_version 4.3.0
+	//	% format EVT3
+	//	% geometry 1280x720
+	//	% integrator_name Prophesee
+	//	% plugin_name hal_plugin_gen41_evk2
+	//	% sensor_generation 4.1
+	//	% serial_number 0000a4e9
+	//	% system_ID 39
+	//----------- very early version ----
+	//  % date 2022 - 01 - 23 17:39 : 01
+	//	% evt 3.0
+	//	% firmware_version 4.3.0
+	//	% integrator_name Prophesee
+	//	% plugin_name hal_plugin_gen41_evk2
+	//	% serial_number 0000a4e9
+	//	% subsystem_ID 0
+	//	% system_ID 39
+	//-------------or-------------
+	//  % camera_integrator_name CenturyArks
+	//  % date 2024 - 01 - 26 15:39 : 08
+	//  % evt 3.0
+	//  % format EVT3; height = 720; width = 1280
+	//  % generation 4.2
+	//  % geometry 1280x720
+	//  % integrator_name CenturyArks
+	//  % plugin_integrator_name CenturyArks
+	//  % plugin_name evc4a_plugin_imx636
+	//  % sensor_generation 4.2
+	//  % serial_number 00000204
+	//  % system_ID 49
+	//  % end
+	//-------------or------------
+	//  % camera_integrator_name CenturyArks
+	//  % date 2024 - 02 - 01 14:54 : 01
+	//  % evt 3.0
+	//  % format EVT3; height = 720; width = 1280
+	//  % generation 4.2
+	//  % geometry 1280x720
+	//  % integrator_name CenturyArks
+	//  % plugin_integrator_name CenturyArks
+	//  % plugin_name silky_common_plugin
+	//  % sensor_generation 4.2
+	//  % sensor_name IMX636
+	//  % serial_number 00000204
+	//  % system_ID 49
+	//  % end
+
+	// Read the header of the input file, if present :
+	int line_first_char = input_file.peek();
+
+	if(bDebugMessages)
+		std::cout << "File: " << fname.c_str() << std::endl;
+	bool bIsEventFileType3 = false;
+	bool bhaveGeometry = false;
+	while (line_first_char == '%') {
+		std::string line;
+		std::getline(input_file, line);
+		//std::cout << line << std::endl;
+		if (line == "% end") {	// added in v4.0.0
+			break;
+		}
+
+		std::vector<std::string> vals = _stringSplit(line, ' ');
+#ifdef _DEBUG2
+		for (std::string v : vals) {
+			std::cout << " '" << v << "' ";
+		}
+		std::cout << std::endl;
+#endif
+
+		if (vals.size() == 3) {
+			if (vals[1] == "integrator_name")
+				camSpecs.strIntegrator = vals[2];
+			else if (vals[1] == "plugin_name")
+				camSpecs.strPlugin = vals[2];
+			else if (vals[1] == "firmware_version")
+				camSpecs.strFirmware = vals[2];
+			else if (vals[1] == "evt")
+				camSpecs.strEventType = vals[2];
+			else if (vals[1] == "serial_number")
+				camSpecs.strSerialNo = vals[2];
+			else if (vals[1] == "sensor_generation")
+				camSpecs.strSensorGeneration = vals[2];
+			else if (vals[1] == "generation") {
+				camSpecs.strSensorGeneration = vals[2];
+				// some implementations don't produce long headers so we assume EVT3.0 format
+				// for later generation sensors
+				if (camSpecs.strSensorGeneration == "4.2") {
+					bIsEventFileType3 = true;
+				}
+			}
+
+			else if (vals[1] == "date") {
+				camSpecs.strRecordingDate = vals[2];
+				camSpecs.strRecordingTime = vals[3];
+			}
+			else if (vals[1] == "geometry") {
+				if (vals[2] == "640x480") {
+					camSpecs.sensorH = 480;
+					camSpecs.sensorW = 640;
+					bhaveGeometry = true;
+				}
+				else if (vals[2] == "1280x720") {
+					camSpecs.sensorH = 720;
+					camSpecs.sensorW = 1280;
+					bhaveGeometry = true;
+				}
+			}
+		}
+		//std::cout << std::endl;
+
+		if (line == "% evt 3.0")
+			bIsEventFileType3 = true;
+		//else if(line.find("integrator_name"))
+		line_first_char = input_file.peek();
+	};
+	if (!bIsEventFileType3) {
+		std::cerr << "Error : not an event data file: '" << fname.c_str() << "'"
+			<< std::endl;
+		return false;
+	}
+
+	if (camSpecs.strIntegrator == "Prophesee") {
+		if (camSpecs.strPlugin == "hal_plugin_gen41_evk2") {
+			camSpecs.sensorH = 720;
+			camSpecs.sensorW = 1280;
+			bhaveGeometry = true;
+		}
+		else if (camSpecs.strPlugin == "hal_plugin_imx636_evk4") {
+			camSpecs.sensorH = 720;
+			camSpecs.sensorW = 1280;
+			bhaveGeometry = true;
+		}
+		else if (camSpecs.strPlugin == "evc3a_plugin_gen31") {
+			camSpecs.sensorH = 480;
+			camSpecs.sensorW = 640;
+			bhaveGeometry = true;
+		}
+	}
+	else if (camSpecs.strIntegrator == "CenturyArks") {
+
+		if (camSpecs.strPlugin == "evc4a_plugin_imx636") {
+			camSpecs.sensorH = 720;
+			camSpecs.sensorW = 1280;
+			bhaveGeometry = true;
+		}
+		else if (!bhaveGeometry) {
+			camSpecs.sensorH = 720;
+			camSpecs.sensorW = 1280;
+			//std::cerr << "Error : no geometry info in header - trying with default 1280x720" << std::endl;
+		}
+	}
+	if (!bhaveGeometry) {
+		camSpecs.sensorH = 720;
+		camSpecs.sensorW = 1280;
+		std::cerr << "Error : no geometry info in header - trying with default 1280x720" << std::endl;
+	}
+	if(bDebugMessages)
+		std::cout << "Sensor: " << camSpecs.strIntegrator << " - " << camSpecs.strPlugin
+			<< "\nSize: " << camSpecs.sensorW << "(W) x " << camSpecs.sensorH << "(H)"
+			<< std::endl;
+	return true;
+}
+
+/*
+Expansion of the validity masks of VECT_12 / VECT_8 words into events.
+All events of a vector word share y, polarity and time, so a kernel copies
+a template event once per set bit and only patches the x coordinate.
+Kernels may write up to eight events beyond the last valid one, the caller
+has to provide this slack in the output storage.
+*/
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define _EBI_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#define _EBI_TARGET(arch)
+#else
+#include <immintrin.h>
+#define _EBI_TARGET(arch) __attribute__((target(arch)))
+#endif
+#endif
+
+typedef size_t(*_ExpandVectorFn)(EBI::Event* pDst, uint32_t valid, const uint16_t xBase, const EBI::Event& tmpl);
+
+static inline uint32_t _bitScanForward(const uint32_t v)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward(&idx, v);
+	return static_cast<uint32_t>(idx);
+#else
+	return static_cast<uint32_t>(__builtin_ctz(v));
+#endif
+}
+
+static inline uint32_t _popCount(uint32_t v)
+{
+	v = v - ((v >> 1) & 0x55555555);
+	v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+	return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+static size_t _expandVectorScalar(EBI::Event* pDst, uint32_t valid, const uint16_t xBase, const EBI::Event& tmpl)
+{
+	size_t n = 0;
+	for (; valid != 0; valid &= valid - 1) {
+		pDst[n] = tmpl;
+		pDst[n].x = static_cast<uint16_t>(xBase + _bitScanForward(valid));
+		n++;
+	}
+	return n;
+}
+
+#ifdef _EBI_X86
+// The SIMD kernels assemble groups of events from the dwords time, x | (y << 16) and
+// polarity (padding bytes are zero). x is taken from a table of the compacted bit
+// positions of each byte of the mask.
+static_assert((sizeof(EBI::Event) == 12) && (offsetof(EBI::Event, t) == 0) && (offsetof(EBI::Event, x) == 4)
+	&& (offsetof(EBI::Event, y) == 6) && (offsetof(EBI::Event, p) == 8), "unexpected layout of EBI::Event");
+
+/*!
+Bit positions of the set bits of each byte value, e.g. 0x29 -> {0, 3, 5}
+*/
+struct _CompactBitTable
+{
+	uint8_t pos[256][8];
+	uint8_t count[256];
+
+	_CompactBitTable()
+	{
+		for (int v = 0; v < 256; v++) {
+			int n = 0;
+			for (int i = 0; i < 8; i++) {
+				pos[v][i] = 0;
+				if (v & (1 << i))
+					pos[v][n++] = static_cast<uint8_t>(i);
+			}
+			count[v] = static_cast<uint8_t>(n);
+		}
+	}
+};
+static const _CompactBitTable _compactBits;
+
+_EBI_TARGET("sse2")
+static size_t _expandVectorSSE2(EBI::Event* pDst, uint32_t valid, const uint16_t xBase, const EBI::Event& tmpl)
+{
+	// four events occupy three registers: [t xy p t] [xy p t xy] [p t xy p]
+	const __m128i t = _mm_set1_epi32(static_cast<int>(tmpl.t));
+	const __m128i y = _mm_set1_epi32(static_cast<int>(tmpl.y) << 16);
+	const __m128i p = _mm_set1_epi32(static_cast<uint8_t>(tmpl.p));
+	const __m128i maskT0 = _mm_setr_epi32(-1, 0, 0, -1), maskP0 = _mm_setr_epi32(0, 0, -1, 0);
+	const __m128i maskT1 = _mm_setr_epi32(0, 0, -1, 0), maskP1 = _mm_setr_epi32(0, -1, 0, 0);
+	const __m128i maskT2 = _mm_setr_epi32(0, -1, 0, 0), maskP2 = _mm_setr_epi32(-1, 0, 0, -1);
+	const __m128i tp0 = _mm_or_si128(_mm_and_si128(t, maskT0), _mm_and_si128(p, maskP0));
+	const __m128i tp1 = _mm_or_si128(_mm_and_si128(t, maskT1), _mm_and_si128(p, maskP1));
+	const __m128i tp2 = _mm_or_si128(_mm_and_si128(t, maskT2), _mm_and_si128(p, maskP2));
+	const __m128i maskXY0 = _mm_setr_epi32(0, -1, 0, 0);
+	const __m128i maskXY1 = _mm_setr_epi32(-1, 0, 0, -1);
+	const __m128i maskXY2 = _mm_setr_epi32(0, 0, -1, 0);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint8_t* pOut = reinterpret_cast<uint8_t*>(pDst);
+	size_t n = 0;
+	for (int nShift = 0; (valid >> nShift) != 0; nShift += 8) {
+		const uint32_t bits = (valid >> nShift) & 0xFF;
+		const uint32_t nCount = _compactBits.count[bits];
+		const __m128i xy = _mm_or_si128(y, _mm_set1_epi32(xBase + nShift));
+		const __m128i pos = _mm_unpacklo_epi8(
+			_mm_loadl_epi64(reinterpret_cast<const __m128i*>(_compactBits.pos[bits])), zero);
+		__m128i xy4 = _mm_add_epi32(_mm_unpacklo_epi16(pos, zero), xy);
+		for (uint32_t i = 0; i < nCount; i += 4) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut),
+				_mm_or_si128(tp0, _mm_and_si128(_mm_shuffle_epi32(xy4, _MM_SHUFFLE(0, 0, 0, 0)), maskXY0)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 16),
+				_mm_or_si128(tp1, _mm_and_si128(_mm_shuffle_epi32(xy4, _MM_SHUFFLE(2, 0, 0, 1)), maskXY1)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 32),
+				_mm_or_si128(tp2, _mm_and_si128(_mm_shuffle_epi32(xy4, _MM_SHUFFLE(0, 3, 0, 0)), maskXY2)));
+			pOut += 4 * sizeof(EBI::Event);
+			xy4 = _mm_add_epi32(_mm_unpackhi_epi16(pos, zero), xy);
+		}
+		// only the first nCount events of the group are valid
+		pOut -= ((nCount + 3) / 4 * 4 - nCount) * sizeof(EBI::Event);
+		n += nCount;
+	}
+	return n;
+}
+
+_EBI_TARGET("avx2")
+static size_t _expandVectorAVX2(EBI::Event* pDst, uint32_t valid, const uint16_t xBase, const EBI::Event& tmpl)
+{
+	// eight events occupy three registers: [t xy p t xy p t xy] [p t xy p t xy p t] [xy p t xy p t xy p]
+	const __m256i t = _mm256_set1_epi32(static_cast<int>(tmpl.t));
+	const __m256i p = _mm256_set1_epi32(static_cast<uint8_t>(tmpl.p));
+	const __m256i tp0 = _mm256_blend_epi32(t, p, 0x24);
+	const __m256i tp1 = _mm256_blend_epi32(t, p, 0x49);
+	const __m256i tp2 = _mm256_blend_epi32(t, p, 0x92);
+	const __m256i perm0 = _mm256_setr_epi32(0, 0, 0, 0, 1, 0, 0, 2);
+	const __m256i perm1 = _mm256_setr_epi32(0, 0, 3, 0, 0, 4, 0, 0);
+	const __m256i perm2 = _mm256_setr_epi32(5, 0, 0, 6, 0, 0, 7, 0);
+	const int y = static_cast<int>(tmpl.y) << 16;
+
+	uint8_t* pOut = reinterpret_cast<uint8_t*>(pDst);
+	size_t n = 0;
+	for (int nShift = 0; (valid >> nShift) != 0; nShift += 8) {
+		const uint32_t bits = (valid >> nShift) & 0xFF;
+		const __m256i xy = _mm256_add_epi32(
+			_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(_compactBits.pos[bits]))),
+			_mm256_set1_epi32(y | (xBase + nShift)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut),
+			_mm256_blend_epi32(tp0, _mm256_permutevar8x32_epi32(xy, perm0), 0x92));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + 32),
+			_mm256_blend_epi32(tp1, _mm256_permutevar8x32_epi32(xy, perm1), 0x24));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + 64),
+			_mm256_blend_epi32(tp2, _mm256_permutevar8x32_epi32(xy, perm2), 0x49));
+		pOut += _compactBits.count[bits] * sizeof(EBI::Event);
+		n += _compactBits.count[bits];
+	}
+	return n;
+}
+
+static bool _cpuHasSSE2()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool _cpuHasAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	const bool bOSXSave = (info[2] & (1 << 27)) != 0;
+	const bool bAVX = (info[2] & (1 << 28)) != 0;
+	if (!bOSXSave || !bAVX || ((_xgetbv(0) & 0x6) != 0x6))	// OS saves YMM registers
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // _EBI_X86
+
+/*!
+Return the kernel that is actually used for \a vecKernel, i.e. the requested
+one or the fastest one below it supported by this CPU
+*/
+EBI::RawVectorKernel EBI::GetRawVectorKernel(const EBI::RawVectorKernel vecKernel)
+{
+	EBI::RawVectorKernel kernel = (vecKernel == EBI::RawVectorAuto) ? EBI::RawVectorAVX2 : vecKernel;
+#ifdef _EBI_X86
+	static const bool bHaveAVX2 = _cpuHasAVX2();
+	static const bool bHaveSSE2 = _cpuHasSSE2();
+	if ((kernel == EBI::RawVectorAVX2) && !bHaveAVX2)
+		kernel = EBI::RawVectorSSE2;
+	if ((kernel == EBI::RawVectorSSE2) && !bHaveSSE2)
+		kernel = EBI::RawVectorScalar;
+#else
+	if (kernel > EBI::RawVectorScalar)
+		kernel = EBI::RawVectorScalar;
+#endif
+	return kernel;
+}
+
+static _ExpandVectorFn _getExpandVectorFn(const EBI::RawVectorKernel vecKernel)
+{
+	switch (EBI::GetRawVectorKernel(vecKernel)) {
+#ifdef _EBI_X86
+	case EBI::RawVectorAVX2:
+		return _expandVectorAVX2;
+	case EBI::RawVectorSSE2:
+		return _expandVectorSSE2;
+#endif
+	case EBI::RawVectorScalar:
+		return _expandVectorScalar;
+	default:
+		return nullptr;
+	}
+}
+
+/*!
+Timing of a block of consecutive events in evData, collected while the block
+is still in cache. The timing check after loading only needs to revisit blocks
+with events after the last event. All events of a block are in the same time
+segment starting at \a tBase.
+*/
+struct _TimingBlock
+{
+	size_t nFirst;		//!< index of first event of block in evData
+	size_t nCount;		//!< number of events in block
+	uint64_t tFirst, tLast, tMax;	//!< including the time segment
+	uint32_t nBackSteps;	//!< events with time before their predecessor within the block
+
+	_TimingBlock(const EBI::Event* pEv, const size_t n, const size_t nFirstIN, const uint64_t tBase)
+	{
+		nFirst = nFirstIN;
+		nCount = n;
+		uint32_t tPrev = pEv[0].t;
+		uint32_t tHigh = pEv[0].t;
+		nBackSteps = 0;
+		for (size_t i = 1; i < n; i++) {
+			const uint32_t t = pEv[i].t;
+			nBackSteps += (t < tPrev) ? 1 : 0;
+			tHigh = (t > tHigh) ? t : tHigh;
+			tPrev = t;
+		}
+		tFirst = tBase + pEv[0].t;
+		tLast = tBase + tPrev;
+		tMax = tBase + tHigh;
+	}
+};
+
+/*!
+Receives decoded events and fills the event vectors of EBI::EventData.
+Events are collected in a small staging block that stays in cache and is
+appended to \a evData when full, so \a evData never needs to be resized
+(and value-initialized) ahead of the decoded events.
+With \a pColumns or \a pPacked set, staged events go to EBI::EventColumns or
+EBI::PackedEventData instead.
+Event times are stored as offsets within their time segment of EBI::TIME_SEGMENT_USEC,
+the start of each new segment is listed in \a pSegments, if set. Without a list
+times simply wrap around, as in EBI::EventColumns.
+*/
+struct _EventVectorSink
+{
+	static constexpr size_t STAGE_SIZE = 16384;	//!< events per staging block
+	static constexpr size_t STAGE_SLACK = 20;	//!< events a vector word may write beyond STAGE_SIZE
+
+	std::vector<EBI::Event>& evData;
+	std::vector<EBI::TriggerEvent>& evTrigger;
+	EBI::EventColumns* pColumns;	//!< receives the events instead of evData, if set
+	EBI::PackedEventData* pPacked;	//!< receives the events instead of evData, if set
+	uint64_t& timeStamp;	//!< time of first event in file
+	uint64_t nStartTime;	//!< events before this time are skipped
+	uint64_t nEndTime;		//!< events after this time are skipped
+	bool bPastEnd;			//!< an event after nEndTime was seen
+	uint64_t evCount;
+	uint32_t trigCount;
+	uint64_t nEventOutOfBounds;
+	std::vector<EBI::TimeSegment>* pSegments;	//!< receives the start of each time segment of the events, if set
+	std::vector<EBI::TimeSegment>* pTriggerSegments;	//!< same for the trigger events
+	uint64_t segBase;		//!< start of time segment of the latest event
+	uint64_t trigSegBase;	//!< start of time segment of the latest trigger event
+	std::vector<EBI::Event> stage;	//!< decoded events not yet in evData
+	std::vector<_TimingBlock> timing;	//!< timing of the events in evData
+	size_t nStaged;
+	_ExpandVectorFn expandVector;	//!< nullptr to expand vector events bit by bit
+	// selection of CD events, see setFilter()
+	uint16_t roiX0, roiX1;	//!< x in [roiX0, roiX1) is kept, stored relative to roiX0
+	uint16_t roiY0, roiY1;	//!< y in [roiY0, roiY1) is kept, stored relative to roiY0
+	uint8_t polMask;		//!< bit 0 set to keep negative, bit 1 to keep positive events
+	bool bFilter;			//!< false if all events are kept
+
+	_EventVectorSink(std::vector<EBI::Event>& evDataIN,
+		std::vector<EBI::TriggerEvent>& evTriggerIN,
+		uint64_t& timeStampIN,
+		const uint64_t nStartTimeIN,
+		const uint64_t nEndTimeIN,
+		const _ExpandVectorFn expandVectorIN)
+		: evData(evDataIN), evTrigger(evTriggerIN), timeStamp(timeStampIN), stage(STAGE_SIZE + STAGE_SLACK)
+	{
+		pColumns = nullptr;
+		pPacked = nullptr;
+		nStartTime = nStartTimeIN;
+		nEndTime = nEndTimeIN;
+		bPastEnd = false;
+		evCount = 0;
+		trigCount = 0;
+		nEventOutOfBounds = 0;
+		pSegments = pTriggerSegments = nullptr;
+		segBase = trigSegBase = 0;
+		nStaged = 0;
+		expandVector = expandVectorIN;
+		roiX0 = roiY0 = 0;
+		roiX1 = roiY1 = UINT16_MAX;
+		polMask = 0x3;
+		bFilter = false;
+	}
+
+	//! keep only events selected by ROI and polarity of \a filter, the ROI must be clipped to the detector
+	void setFilter(const EBI::EventFilter& filter)
+	{
+		if (filter.hasROI()) {
+			roiX0 = static_cast<uint16_t>(filter.roiX);
+			roiX1 = static_cast<uint16_t>(filter.roiX + filter.roiW);
+			roiY0 = static_cast<uint16_t>(filter.roiY);
+			roiY1 = static_cast<uint16_t>(filter.roiY + filter.roiH);
+		}
+		polMask = (filter.hasPolarity(0) ? 0x1 : 0) | (filter.hasPolarity(1) ? 0x2 : 0);
+		bFilter = filter.hasROI() || (polMask != 0x3);
+	}
+
+	void copyFilter(const _EventVectorSink& other)
+	{
+		roiX0 = other.roiX0;
+		roiX1 = other.roiX1;
+		roiY0 = other.roiY0;
+		roiY1 = other.roiY1;
+		polMask = other.polMask;
+		bFilter = other.bFilter;
+	}
+
+	inline bool isSelected(const uint16_t x, const uint16_t y, const int8_t p) const
+	{
+		return (x >= roiX0) && (x < roiX1) && (y >= roiY0) && (y < roiY1) && ((polMask >> p) & 0x1);
+	}
+
+	//! offset of time \a t within its time segment, opens a new segment if needed
+	inline uint32_t segmentTime(const uint64_t t)
+	{
+		const uint64_t tRel = t - timeStamp;
+		if (tRel - segBase >= EBI::TIME_SEGMENT_USEC)
+			openSegment(tRel);
+		return static_cast<uint32_t>(tRel);
+	}
+
+	/*!
+	Start a new time segment for events at \a tRel after the first event. Staged events
+	are flushed first, so staging and timing blocks never span segments. Events
+	before the current segment are kept in it, the timing check finds them.
+	*/
+	void openSegment(const uint64_t tRel)
+	{
+		const uint64_t tBase = tRel & ~(EBI::TIME_SEGMENT_USEC - 1);
+		if (tBase <= segBase)
+			return;
+		flush();
+		segBase = tBase;
+		if (pSegments != nullptr)
+			pSegments->push_back(EBI::TimeSegment(tBase, outputSize()));
+	}
+
+	inline void addEvent(const uint16_t x, const uint16_t y, const int8_t p, const uint64_t t)
+	{
+		if (evCount == 0)
+			timeStamp = t;
+		if (isInWindow(t) && (!bFilter || isSelected(x, y, p))) {
+			const uint32_t tSeg = segmentTime(t);
+			stage[nStaged++] = EBI::Event(static_cast<uint16_t>(x - roiX0), static_cast<uint16_t>(y - roiY0),
+				p, tSeg);
+			if (nStaged >= STAGE_SIZE)
+				flush();
+		}
+		evCount++;
+	}
+
+	//! events of a VECT_12 or VECT_8 word, \a valid has a bit set for each x in [xBase, xBase + nBits)
+	inline void addVector(const uint16_t xBase, const uint16_t nBits, uint32_t valid,
+		const uint16_t y, const int8_t p, const uint64_t t, const uint32_t sensorW)
+	{
+		if ((expandVector == nullptr) || (xBase + nBits > sensorW)) {
+			// range check of x added 20240328
+			for (uint16_t i = 0; i != nBits; ++i) {
+				if (valid & 0x1)
+					addEvent(static_cast<uint16_t>((xBase + i) % sensorW), y, p, t);
+				valid >>= 1;
+			}
+			return;
+		}
+		if (valid == 0)
+			return;
+		if (evCount == 0)
+			timeStamp = t;
+		evCount += _popCount(valid);
+		if (!isInWindow(t))
+			return;
+		uint16_t x0 = xBase;
+		if (bFilter) {
+			if ((y < roiY0) || (y >= roiY1) || !((polMask >> p) & 0x1))
+				return;
+			// only bits of x in [roiX0, roiX1), shifted to x relative to roiX0
+			const int nLow = roiX0 - xBase;
+			const int nHigh = roiX1 - xBase;
+			if ((nHigh <= 0) || (nLow >= nBits))
+				return;
+			if (nHigh < nBits)
+				valid &= (1u << nHigh) - 1;
+			if (nLow > 0) {
+				valid >>= nLow;
+				x0 = 0;
+			}
+			else
+				x0 = static_cast<uint16_t>(xBase - roiX0);
+			if (valid == 0)
+				return;
+		}
+		const uint32_t tSeg = segmentTime(t);
+		nStaged += expandVector(stage.data() + nStaged, valid, x0,
+			EBI::Event(0, static_cast<uint16_t>(y - roiY0), p, tSeg));
+		if (nStaged >= STAGE_SIZE)
+			flush();
+	}
+
+	inline void addTrigger(const uint16_t value, const uint16_t id, const uint64_t t)
+	{
+		if (isInWindow(t)) {
+			const uint64_t tRel = t - timeStamp;
+			const uint64_t tBase = tRel & ~(EBI::TIME_SEGMENT_USEC - 1);
+			if (tBase > trigSegBase) {
+				trigSegBase = tBase;
+				if (pTriggerSegments != nullptr)
+					pTriggerSegments->push_back(EBI::TimeSegment(tBase, evTrigger.size()));
+			}
+			evTrigger.push_back(EBI::TriggerEvent(value, id, static_cast<uint32_t>(tRel)));
+			trigCount++;
+		}
+	}
+
+	//! true if \a t is in [nStartTime, nEndTime] relative to the first event
+	inline bool isInWindow(const uint64_t t)
+	{
+		const uint64_t tRel = t - timeStamp;
+		if (tRel < nStartTime)
+			return false;
+		if (tRel > nEndTime) {
+			if (t > timeStamp)
+				bPastEnd = true;
+			return false;
+		}
+		return true;
+	}
+
+	/*!
+	true if decoding of further blocks is not needed. The end of the time window
+	must also be confirmed by the decoder \a state, a single corrupt time high word
+	must not stop decoding.
+	*/
+	bool isDone(const uint64_t nMaxEventCount, const EBI::Evt3DecoderState& state) const
+	{
+		if (size() >= nMaxEventCount)
+			return true;
+		return bPastEnd && (state.time > timeStamp) && (state.time - timeStamp > nEndTime);
+	}
+
+	size_t size() const { return outputSize() + nStaged; }
+
+	//! number of events in evData, pColumns or pPacked
+	size_t outputSize() const
+	{
+		if (pColumns != nullptr)
+			return pColumns->size();
+		if (pPacked != nullptr)
+			return pPacked->size();
+		return evData.size();
+	}
+
+	//! append \a n decoded events to evData, pColumns or pPacked
+	void append(const EBI::Event* pEv, const size_t n)
+	{
+		if (pColumns != nullptr)
+			pColumns->append(pEv, n);
+		else if (pPacked != nullptr)
+			pPacked->append(pEv, n);
+		else
+			evData.insert(evData.end(), pEv, pEv + n);
+	}
+
+	//! move staged events to evData
+	void flush()
+	{
+		if (nStaged == 0)
+			return;
+		timing.push_back(_TimingBlock(stage.data(), nStaged, outputSize(), (pSegments != nullptr) ? segBase : 0));
+		append(stage.data(), nStaged);
+		nStaged = 0;
+	}
+};
+
+//! number of valid bits of a vector word at x >= sensorW
+static inline uint32_t _countOutOfBounds(const uint32_t valid, const uint16_t xBase, const uint32_t sensorW)
+{
+	return (xBase >= sensorW) ? _popCount(valid) : _popCount(valid >> (sensorW - xBase));
+}
+
+/*!
+Run the EVT3 state machine over \a nWords raw 16-bit words starting at \a pData.
+Words are fetched bytewise, so \a pData need not be aligned (header lengths
+of RAW files are arbitrary).
+Decoded events are passed on to \a sink.
+*/
+template <class Sink>
+static void _decodeEvt3Words(const uint8_t* pData, const uint64_t nWords,
+	EBI::Evt3DecoderState& state, Sink& sink)
+{
+	const uint8_t* current_word = pData;
+	const uint8_t* last_word = pData + nWords * sizeof(Metavision::Evt3::RawEvent);
+
+	// If the first event in the input file is not of type EVT_TIME_HIGH, then the times
+	// of the first events might be wrong, because we don't have a time base yet. This is why
+	// we skip the events until we find the first time high, so that we can correctly set
+	// the current_time_base
+	for (; !state.bTimeBaseSet && current_word != last_word; current_word += sizeof(uint16_t)) {
+		uint16_t w;
+		memcpy(&w, current_word, sizeof(uint16_t));
+		if (static_cast<Metavision::Evt3::EventTypes>(w >> 12) == Metavision::Evt3::EventTypes::EVT_TIME_HIGH) {
+			state.timeBase = (Metavision::Evt3::timestamp_t(w & 0xFFF) << 12);
+			state.bTimeBaseSet = true;
+			break;
+		}
+	}
+
+	// local copies of the state keep the loop in registers
+	Metavision::Evt3::timestamp_t current_time_base = state.timeBase;
+	Metavision::Evt3::timestamp_t current_time = state.time;
+	unsigned int n_time_high_loop = state.nTimeHighLoops;
+	uint16_t current_cd_y = state.y;
+	uint16_t current_x_base = state.xBase;
+	uint16_t current_polarity = state.polarity;
+	const uint32_t sensorW = state.sensorW;
+	const uint32_t sensorH = state.sensorH;
+
+	// the bit layout of the words is given by the Metavision::Evt3::RawEvent* structures
+	for (; current_word != last_word; current_word += sizeof(uint16_t)) {
+		uint16_t w;
+		memcpy(&w, current_word, sizeof(uint16_t));
+		Metavision::Evt3::EventTypes type = static_cast<Metavision::Evt3::EventTypes>(w >> 12);
+		switch (type) {
+		case Metavision::Evt3::EventTypes::EVT_ADDR_X: {
+			// RawEventXPos: x : 11, pol : 1
+			uint16_t ev_x = (w & 0x7FF);
+			// disabled in v2.3.1:
+			// current_x_base = ev_cd_posx->x; // X_POS also updates the X_BASE
+			if (ev_x >= sensorW) {
+				sink.nEventOutOfBounds++;
+			}
+			sink.addEvent(
+				static_cast<uint16_t>(ev_x % sensorW), // range check added 20240328,
+				// in v2.3.0: current_x_base,
+				current_cd_y,
+				static_cast<int8_t>((w >> 11) & 0x1),
+				current_time);
+			break;
+		}
+		case Metavision::Evt3::EventTypes::VECT_12: {
+			// RawEventVect12: valid : 12
+			uint32_t valid = (w & 0xFFF);
+			if (static_cast<uint32_t>(current_x_base) + 12 > sensorW) {
+				sink.nEventOutOfBounds += _countOutOfBounds(valid, current_x_base, sensorW);
+			}
+			sink.addVector(current_x_base, 12, valid, current_cd_y,
+				static_cast<int8_t>(current_polarity), current_time, sensorW);
+			current_x_base += 12;
+			break;
+		}
+		case Metavision::Evt3::EventTypes::VECT_8: {
+			// RawEventVect8: valid : 8, unused : 4
+			uint32_t valid = (w & 0xFF);
+			if (static_cast<uint32_t>(current_x_base) + 8 > sensorW) {
+				sink.nEventOutOfBounds += _countOutOfBounds(valid, current_x_base, sensorW);
+			}
+			sink.addVector(current_x_base, 8, valid, current_cd_y,
+				static_cast<int8_t>(current_polarity), current_time, sensorW);
+			current_x_base += 8;
+			break;
+		}
+		case Metavision::Evt3::EventTypes::EVT_ADDR_Y: {
+			// RawEventY: y : 11, orig : 1
+			uint16_t ev_y = (w & 0x7FF);
+			// bugfix 20230208: issue with y out-of-bounds for data recorded with CenturyArks SilkyEvCam VGA
+			if (ev_y >= sensorH) {
+				sink.nEventOutOfBounds++;
+			}
+			current_cd_y = static_cast<uint16_t>(ev_y % sensorH);	// quick method to treat out-of-bounds
+			break;
+		}
+
+		case Metavision::Evt3::EventTypes::VECT_BASE_X: {
+			// RawEventXBase: x : 11, pol : 1
+			current_polarity = ((w >> 11) & 0x1);
+			current_x_base = (w & 0x7FF);
+			break;
+		}
+		case Metavision::Evt3::EventTypes::EVT_TIME_HIGH: {
+			// Compute some useful constant variables :
+			//
+			// -> MaxTimestampBase is the maximum value that the variable current_time_base can have. It corresponds
+			// to the case where an event Metavision::Evt3::RawEventTime of type EVT_TIME_HIGH has all the bits of
+			// the field "timestamp" (12 bits total) set to 1 (value is (1 << 12) - 1). We then need to shift it by
+			// 12 bits because this field represents the most significant bits of the event time base (range 23 to
+			// 12). See the event description at the beginning of the file.
+			//
+			// -> TimeLoop is the loop duration (in us) before the time_high value wraps and returns to 0. Its value
+			// is MaxTimestampBase + (1 << 12)
+			//
+			// -> LoopThreshold is a threshold value used to detect if a new value of the time high has decreased
+			// because it looped. Theoretically, if the new value of the time high is lower than the last one, then
+			// it means that is has looped. In practice, to protect ourselves from a transmission error, we use a
+			// threshold value, so that we consider that the time high has looped only if it differs from the last
+			// value by a sufficient difference (i.e. greater than the threshold)
+			static constexpr Metavision::Evt3::timestamp_t MaxTimestampBase =
+				((Metavision::Evt3::timestamp_t(1) << 12) - 1) << 12;                               // = 16773120us
+			static constexpr Metavision::Evt3::timestamp_t TimeLoop = MaxTimestampBase + (1 << 12); // = 16777216us
+			static constexpr Metavision::Evt3::timestamp_t LoopThreshold =
+				(10 << 12); // It could be another value too, as long as it is a big enough value that we can be
+							// sure that the time high looped
+
+			// RawEventTime: time : 12
+			Metavision::Evt3::timestamp_t new_time_base = (Metavision::Evt3::timestamp_t(w & 0xFFF) << 12);
+			new_time_base += n_time_high_loop * TimeLoop;
+
+			if ((current_time_base > new_time_base) &&
+				(current_time_base - new_time_base >= MaxTimestampBase - LoopThreshold)) {
+				// Time High loop :  we consider that we went in the past because the timestamp looped
+				new_time_base += TimeLoop;
+				++n_time_high_loop;
+			}
+
+			current_time_base = new_time_base;
+			current_time = current_time_base;
+			break;
+		}
+		case Metavision::Evt3::EventTypes::EVT_TIME_LOW: {
+			// RawEventTime: time : 12
+			current_time = current_time_base + (w & 0xFFF);
+			break;
+		}
+		case Metavision::Evt3::EventTypes::EXT_TRIGGER: {
+			// RawEventExtTrigger: value : 1, unused : 7, id : 4
+			// We have a new Event Trigger with
+			// value = ev_trigg->value
+			// id = ev_trigg->id
+			// time = current_time (in us)
+			sink.addTrigger((w & 0x1), ((w >> 8) & 0xF), current_time);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	state.timeBase = current_time_base;
+	state.time = current_time;
+	state.nTimeHighLoops = n_time_high_loop;
+	state.y = current_cd_y;
+	state.xBase = current_x_base;
+	state.polarity = current_polarity;
+}
+
+static constexpr uint32_t WORDS_TO_READ = 1000000; // Number of words to decode at a time
+
+/*!
+Decode raw words by reading blocks from the already opened \a input_file
+*/
+template <class Sink>
+static void _decodeStream(std::istream& input_file,
+	EBI::Evt3DecoderState& state, Sink& sink,
+	const uint64_t nMaxEventCount)
+{
+	// Vector where we'll read the raw data
+	std::vector<Metavision::Evt3::RawEvent> buffer_read(WORDS_TO_READ);
+
+	while (input_file) {
+		input_file.read(reinterpret_cast<char *>(buffer_read.data()),
+			WORDS_TO_READ * sizeof(Metavision::Evt3::RawEvent));
+		uint64_t nWords = input_file.gcount() / sizeof(Metavision::Evt3::RawEvent);
+		_decodeEvt3Words(reinterpret_cast<const uint8_t*>(buffer_read.data()), nWords, state, sink);
+		if (sink.isDone(nMaxEventCount, state)) {
+			// buffer full or end of requested time window
+			break;
+		}
+	}
+}
+
+/*!
+Decode raw words read from the already opened \a input_file by a separate I/O thread.
+The I/O thread fills a ring of \a nQueueDepth buffers of \a nBufferWords words
+while the calling thread decodes the buffers in order, so reading and decoding overlap.
+Truncation at \a nMaxEventCount is checked after each buffer, with the default
+buffer size the result is identical to _decodeStream().
+*/
+template <class Sink>
+static void _decodePipelined(std::istream& input_file,
+	EBI::Evt3DecoderState& state, Sink& sink,
+	const uint64_t nMaxEventCount,
+	const uint32_t nBufferWords,
+	const uint32_t nQueueDepth)
+{
+	const size_t nBuffers = (nQueueDepth > 1) ? nQueueDepth : 2;
+	const size_t nWordsPerBuffer = (nBufferWords > 0) ? nBufferWords : WORDS_TO_READ;
+	std::vector<std::vector<Metavision::Evt3::RawEvent>> buffers(nBuffers);
+	std::vector<uint64_t> bufferWords(nBuffers, 0);
+
+	std::mutex mtx;
+	std::condition_variable cvFilled, cvFree;
+	size_t nFilled = 0;		// buffers filled by the I/O thread so far
+	size_t nConsumed = 0;	// buffers decoded so far
+	bool bEndOfFile = false;
+	bool bStop = false;		// decoding done, no more data needed
+
+	std::thread reader([&]() {
+		for (size_t nBuf = 0; ; nBuf++) {
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cvFree.wait(lock, [&]() { return bStop || (nBuf - nConsumed < nBuffers); });
+				if (bStop)
+					break;
+			}
+			// buffer nBuf is not in use by the decoder
+			std::vector<Metavision::Evt3::RawEvent>& buffer = buffers[nBuf % nBuffers];
+			buffer.resize(nWordsPerBuffer);
+			input_file.read(reinterpret_cast<char *>(buffer.data()),
+				nWordsPerBuffer * sizeof(Metavision::Evt3::RawEvent));
+			bufferWords[nBuf % nBuffers] = input_file.gcount() / sizeof(Metavision::Evt3::RawEvent);
+			const bool bEnd = !input_file;
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				nFilled = nBuf + 1;
+				bEndOfFile = bEnd;
+			}
+			cvFilled.notify_one();
+			if (bEnd)
+				break;
+		}
+	});
+
+	for (size_t nBuf = 0; ; nBuf++) {
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			cvFilled.wait(lock, [&]() { return (nFilled > nBuf) || bEndOfFile; });
+			if (nFilled <= nBuf)
+				break;
+		}
+		_decodeEvt3Words(reinterpret_cast<const uint8_t*>(buffers[nBuf % nBuffers].data()),
+			bufferWords[nBuf % nBuffers], state, sink);
+		const bool bDone = sink.isDone(nMaxEventCount, state);
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			nConsumed = nBuf + 1;
+			bStop = bDone;
+		}
+		cvFree.notify_one();
+		if (bDone) {
+			// buffer full or end of requested time window
+			break;
+		}
+	}
+	reader.join();
+}
+
+/*!
+Decode raw words directly from the pages of a memory-mapped file, avoiding
+the copy into an intermediate read buffer.
+Blocks are decoded in the same size as in _decodeStream() so that
+truncation at \a nMaxEventCount produces identical results.
+\return false if file could not be mapped, nothing has been decoded in that case
+*/
+template <class Sink>
+static bool _decodeMapped(const std::string& fname, const uint64_t nPayloadOffset,
+	EBI::Evt3DecoderState& state, Sink& sink,
+	const uint64_t nMaxEventCount,
+	const bool bDebugMessages)
+{
+	EBI::MappedFile mappedFile;
+	if (!mappedFile.open(fname, EBI::MappedFile::AccessSequential)) {
+		if (bDebugMessages)
+			std::cout << "Failed mapping file '" << fname.c_str() << "' to memory" << std::endl;
+		return false;
+	}
+	if (mappedFile.size() < nPayloadOffset)
+		return false;
+
+	const uint8_t* pData = mappedFile.data() + nPayloadOffset;
+	const uint64_t nWordsTotal = (mappedFile.size() - nPayloadOffset) / sizeof(Metavision::Evt3::RawEvent);
+	const uint64_t nBlockBytes = WORDS_TO_READ * sizeof(Metavision::Evt3::RawEvent);
+	for (uint64_t nWordPos = 0; nWordPos < nWordsTotal; nWordPos += WORDS_TO_READ) {
+		uint64_t nWords = nWordsTotal - nWordPos;
+		if (nWords > WORDS_TO_READ)
+			nWords = WORDS_TO_READ;
+		_decodeEvt3Words(pData, nWords, state, sink);
+		// decoded pages are not needed anymore
+		mappedFile.release(static_cast<uint64_t>(pData - mappedFile.data()), nBlockBytes);
+		pData += nBlockBytes;
+		if (sink.isDone(nMaxEventCount, state)) {
+			// buffer full or end of requested time window
+			break;
+		}
+	}
+	return true;
+}
+
+// constants of the time high loop, see EVT_TIME_HIGH in _decodeEvt3Words()
+static constexpr Metavision::Evt3::timestamp_t _MaxTimestampBase = ((Metavision::Evt3::timestamp_t(1) << 12) - 1) << 12;
+static constexpr Metavision::Evt3::timestamp_t _TimeLoop = _MaxTimestampBase + (1 << 12);
+static constexpr Metavision::Evt3::timestamp_t _LoopThreshold = (10 << 12);
+
+/*!
+Accumulated effect of a contiguous range of raw words on the decoder state.
+Ranges can be summarized independently of each other and later applied in order
+to an initial state, which yields the exact decoder state at the end of the range.
+*/
+struct _Evt3RangeSummary
+{
+	bool bHaveTimeHigh;
+	uint16_t firstTimeHigh, lastTimeHigh;	//!< raw 12-bit values
+	uint32_t nTimeHighLoops;	//!< loops detected between time high words of this range
+	bool bHaveTimeWord;
+	bool bLastTimeIsLow;	//!< last time word was EVT_TIME_LOW
+	uint16_t lastTimeLow;
+	bool bHaveY;
+	uint16_t y;
+	bool bHaveXBase;
+	uint16_t xBase;			//!< base x if bHaveXBase, otherwise increment by vector events
+	uint16_t polarity;
+	bool bHaveCD;			//!< range contains at least one CD event
+
+	void init()
+	{
+		bHaveTimeHigh = bHaveTimeWord = bLastTimeIsLow = bHaveY = bHaveXBase = bHaveCD = false;
+		firstTimeHigh = lastTimeHigh = lastTimeLow = 0;
+		nTimeHighLoops = 0;
+		y = xBase = polarity = 0;
+	}
+	_Evt3RangeSummary() { init(); }
+
+	inline void addWord(const uint16_t w, const uint32_t sensorH)
+	{
+		switch (static_cast<Metavision::Evt3::EventTypes>(w >> 12)) {
+		case Metavision::Evt3::EventTypes::EVT_ADDR_X:
+			bHaveCD = true;
+			break;
+		case Metavision::Evt3::EventTypes::VECT_12:
+			bHaveCD |= ((w & 0xFFF) != 0);
+			xBase += 12;
+			break;
+		case Metavision::Evt3::EventTypes::VECT_8:
+			bHaveCD |= ((w & 0xFF) != 0);
+			xBase += 8;
+			break;
+		case Metavision::Evt3::EventTypes::EVT_ADDR_Y:
+			y = static_cast<uint16_t>((w & 0x7FF) % sensorH);
+			bHaveY = true;
+			break;
+		case Metavision::Evt3::EventTypes::VECT_BASE_X:
+			polarity = ((w >> 11) & 0x1);
+			xBase = (w & 0x7FF);
+			bHaveXBase = true;
+			break;
+		case Metavision::Evt3::EventTypes::EVT_TIME_HIGH: {
+			uint16_t th = (w & 0xFFF);
+			if (!bHaveTimeHigh) {
+				firstTimeHigh = th;
+				bHaveTimeHigh = true;
+			}
+			else if ((lastTimeHigh > th) &&
+				((Metavision::Evt3::timestamp_t(lastTimeHigh - th) << 12) >= _MaxTimestampBase - _LoopThreshold)) {
+				nTimeHighLoops++;
+			}
+			lastTimeHigh = th;
+			bHaveTimeWord = true;
+			bLastTimeIsLow = false;
+			break;
+		}
+		case Metavision::Evt3::EventTypes::EVT_TIME_LOW:
+			lastTimeLow = (w & 0xFFF);
+			bHaveTimeWord = true;
+			bLastTimeIsLow = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	//! advance \a state (with time base set) across this range
+	void apply(EBI::Evt3DecoderState& state) const
+	{
+		if (bHaveTimeHigh) {
+			uint32_t nLoops = state.nTimeHighLoops;
+			Metavision::Evt3::timestamp_t new_time_base = (Metavision::Evt3::timestamp_t(firstTimeHigh) << 12) + nLoops * _TimeLoop;
+			if ((state.timeBase > new_time_base) &&
+				(state.timeBase - new_time_base >= _MaxTimestampBase - _LoopThreshold)) {
+				nLoops++;
+			}
+			nLoops += nTimeHighLoops;
+			state.nTimeHighLoops = nLoops;
+			state.timeBase = (Metavision::Evt3::timestamp_t(lastTimeHigh) << 12) + nLoops * _TimeLoop;
+		}
+		if (bHaveTimeWord)
+			state.time = bLastTimeIsLow ? (state.timeBase + lastTimeLow) : state.timeBase;
+		if (bHaveY)
+			state.y = y;
+		if (bHaveXBase) {
+			state.xBase = xBase;
+			state.polarity = polarity;
+		}
+		else {
+			state.xBase += xBase;
+		}
+	}
+};
+
+/*!
+Summary of one chunk of raw words, split at the first EVT_TIME_HIGH because
+words before the first time high of a file are skipped by the decoder
+*/
+struct _Evt3ChunkSummary
+{
+	_Evt3RangeSummary pre;	//!< words before first time high
+	_Evt3RangeSummary post;	//!< words from first time high to end of chunk
+
+	void scan(const uint8_t* pData, const uint64_t nWords, const uint32_t sensorH)
+	{
+		pre.init();
+		post.init();
+		uint64_t i = 0;
+		for (; i < nWords; i++) {
+			uint16_t w;
+			memcpy(&w, pData + i * sizeof(uint16_t), sizeof(uint16_t));
+			if (static_cast<Metavision::Evt3::EventTypes>(w >> 12) == Metavision::Evt3::EventTypes::EVT_TIME_HIGH)
+				break;
+			pre.addWord(w, sensorH);
+		}
+		for (; i < nWords; i++) {
+			uint16_t w;
+			memcpy(&w, pData + i * sizeof(uint16_t), sizeof(uint16_t));
+			post.addWord(w, sensorH);
+		}
+	}
+
+	//! true if decoding this chunk from \a state produces CD events
+	bool hasEvents(const EBI::Evt3DecoderState& state) const
+	{
+		if (state.bTimeBaseSet)
+			return (pre.bHaveCD || post.bHaveCD);
+		return post.bHaveCD;
+	}
+
+	//! advance \a state to the end of the chunk
+	void apply(EBI::Evt3DecoderState& state) const
+	{
+		if (state.bTimeBaseSet) {
+			pre.apply(state);
+			post.apply(state);
+		}
+		else if (post.bHaveTimeHigh) {
+			state.timeBase = (Metavision::Evt3::timestamp_t(post.firstTimeHigh) << 12);
+			state.bTimeBaseSet = true;
+			post.apply(state);
+		}
+	}
+};
+
+/*!
+Decode a memory-mapped file in chunks on several threads.
+Each chunk is first summarized (in parallel), the exact decoder state at the
+start of each chunk is then obtained by applying the summaries in order. Knowing
+the state, chunks are decoded in parallel into separate vectors and finally
+appended in order. Chunks have the block size of _decodeStream(), so results,
+including truncation at \a nMaxEventCount, are identical to the serial decoder.
+Chunks are processed in rounds to avoid decoding beyond \a nMaxEventCount
+or the end of the requested time window.
+\return false if file could not be mapped, nothing has been decoded in that case
+*/
+static bool _decodeParallel(const std::string& fname, const uint64_t nPayloadOffset,
+	EBI::Evt3DecoderState& state, _EventVectorSink& sink,
+	const uint64_t nMaxEventCount,
+	const int32_t nThreadsIN,
+	const bool bDebugMessages)
+{
+	const int32_t nThreads = EBI::ThreadCount(nThreadsIN);
+
+	EBI::MappedFile mappedFile;
+	if (!mappedFile.open(fname, EBI::MappedFile::AccessSequential)) {
+		if (bDebugMessages)
+			std::cout << "Failed mapping file '" << fname.c_str() << "' to memory" << std::endl;
+		return false;
+	}
+	if (mappedFile.size() < nPayloadOffset)
+		return false;
+
+	const uint8_t* pPayload = mappedFile.data() + nPayloadOffset;
+	const uint64_t nWordsTotal = (mappedFile.size() - nPayloadOffset) / sizeof(Metavision::Evt3::RawEvent);
+	const uint64_t nChunks = (nWordsTotal + WORDS_TO_READ - 1) / WORDS_TO_READ;
+	const size_t nChunksPerRound = static_cast<size_t>(2 * nThreads);
+	if (bDebugMessages)
+		std::cout << "Decoding " << nChunks << " chunks on " << nThreads << " threads" << std::endl;
+
+	struct ChunkResult {
+		std::vector<EBI::Event> events;
+		std::vector<EBI::TriggerEvent> triggers;
+		std::vector<_TimingBlock> timing;
+		std::vector<EBI::TimeSegment> segments;
+		std::vector<EBI::TimeSegment> triggerSegments;
+		uint64_t timeStamp;
+		uint64_t nEventOutOfBounds;
+		bool bPastEnd;
+		EBI::Evt3DecoderState exit;	//!< decoder state at end of chunk
+		_Evt3ChunkSummary summary;
+		EBI::Evt3DecoderState entry;
+	};
+	std::vector<ChunkResult> chunks;
+	bool bHaveTimeStamp = (sink.evCount > 0);
+
+	for (uint64_t nFirstChunk = 0; nFirstChunk < nChunks; nFirstChunk += nChunksPerRound) {
+		size_t nRoundChunks = nChunksPerRound;
+		if (nFirstChunk + nRoundChunks > nChunks)
+			nRoundChunks = static_cast<size_t>(nChunks - nFirstChunk);
+		chunks.clear();
+		chunks.resize(nRoundChunks);
+		auto chunkWords = [&](const size_t i, const uint8_t*& pData, uint64_t& nWords) {
+			uint64_t nWordPos = (nFirstChunk + i) * WORDS_TO_READ;
+			pData = pPayload + nWordPos * sizeof(uint16_t);
+			nWords = nWordsTotal - nWordPos;
+			if (nWords > WORDS_TO_READ)
+				nWords = WORDS_TO_READ;
+		};
+
+		// pass 1: summarize chunks
+		EBI::ParallelFor(nRoundChunks, nThreads, [&](const size_t i) {
+			const uint8_t* pData;
+			uint64_t nWords;
+			chunkWords(i, pData, nWords);
+			chunks[i].summary.scan(pData, nWords, state.sensorH);
+		});
+
+		// resynchronise: exact decoder state at start of each chunk
+		size_t nFirstEventChunk = nRoundChunks;
+		for (size_t i = 0; i < nRoundChunks; i++) {
+			chunks[i].entry = state;
+			if (!bHaveTimeStamp && (nFirstEventChunk == nRoundChunks) && chunks[i].summary.hasEvents(state))
+				nFirstEventChunk = i;
+			chunks[i].summary.apply(state);
+		}
+
+		// pass 2: decode chunks, the chunk holding the very first event defines 
+		// the time stamp for all following ones
+		auto decodeChunk = [&](const size_t i, const bool bKnownTimeStamp) {
+			const uint8_t* pData;
+			uint64_t nWords;
+			chunkWords(i, pData, nWords);
+			ChunkResult& chunk = chunks[i];
+			chunk.timeStamp = bKnownTimeStamp ? sink.timeStamp : 0;
+			_EventVectorSink chunkSink(chunk.events, chunk.triggers, chunk.timeStamp,
+				sink.nStartTime, sink.nEndTime, sink.expandVector);
+			chunkSink.copyFilter(sink);
+			if (sink.pSegments != nullptr)
+				chunkSink.pSegments = &chunk.segments;
+			if (sink.pTriggerSegments != nullptr)
+				chunkSink.pTriggerSegments = &chunk.triggerSegments;
+			if (bKnownTimeStamp)
+				chunkSink.evCount = 1;
+			EBI::Evt3DecoderState chunkState = chunk.entry;
+			_decodeEvt3Words(pData, nWords, chunkState, chunkSink);
+			chunkSink.flush();
+			chunk.timing.swap(chunkSink.timing);
+			chunk.nEventOutOfBounds = chunkSink.nEventOutOfBounds;
+			chunk.bPastEnd = chunkSink.bPastEnd;
+			chunk.exit = chunkState;
+			mappedFile.release(static_cast<uint64_t>(pData - mappedFile.data()), nWords * sizeof(uint16_t));
+		};
+		const bool bKnownTimeStamp = bHaveTimeStamp;
+		if (nFirstEventChunk < nRoundChunks) {
+			decodeChunk(nFirstEventChunk, false);
+			sink.timeStamp = chunks[nFirstEventChunk].timeStamp;
+			bHaveTimeStamp = true;
+		}
+		EBI::ParallelFor(nRoundChunks, nThreads, [&](const size_t i) {
+			if (i != nFirstEventChunk)
+				decodeChunk(i, bKnownTimeStamp || (bHaveTimeStamp && (i > nFirstEventChunk)));
+		});
+
+		// stitch chunks in order
+		for (size_t i = 0; i < nRoundChunks; i++) {
+			ChunkResult& chunk = chunks[i];
+			for (_TimingBlock& block : chunk.timing) {
+				block.nFirst += sink.outputSize();
+				sink.timing.push_back(block);
+			}
+			std::vector<_TimingBlock>().swap(chunk.timing);
+			sink.nEventOutOfBounds += chunk.nEventOutOfBounds;
+			// segments a chunk shares with its predecessor are not repeated
+			for (const EBI::TimeSegment& seg : chunk.segments) {
+				if (seg.tBase > sink.segBase) {
+					sink.segBase = seg.tBase;
+					sink.pSegments->push_back(EBI::TimeSegment(seg.tBase, seg.iFirst + sink.outputSize()));
+				}
+			}
+			for (const EBI::TimeSegment& seg : chunk.triggerSegments) {
+				if (seg.tBase > sink.trigSegBase) {
+					sink.trigSegBase = seg.tBase;
+					sink.pTriggerSegments->push_back(EBI::TimeSegment(seg.tBase, seg.iFirst + sink.evTrigger.size()));
+				}
+			}
+			if (!chunk.events.empty())
+				sink.append(chunk.events.data(), chunk.events.size());
+			sink.evTrigger.insert(sink.evTrigger.end(), chunk.triggers.begin(), chunk.triggers.end());
+			sink.trigCount += static_cast<uint32_t>(chunk.triggers.size());
+			std::vector<EBI::Event>().swap(chunk.events);
+			sink.bPastEnd |= chunk.bPastEnd;
+			if (sink.isDone(nMaxEventCount, chunk.exit)) {
+				// buffer full or end of requested time window
+				return true;
+			}
+		}
+		if (bHaveTimeStamp)
+			sink.evCount = 1;
+	}
+	return true;
+}
+
+/*! \cond
+ * header of index files
+ */
+struct _RAW_INDEX_HDR
+{
+	char		Signature[4];	//!< "EBIX"
+	uint32_t	Version;		//!< 1
+	uint64_t	RawFileSize;	//!< size of RAW file in bytes
+	uint64_t	PayloadOffset;	//!< byte offset of event data in RAW file
+	uint64_t	TimeStamp;		//!< time in [usec] of first event in RAW file
+	uint32_t	Interval;		//!< time between entries in [usec]
+	uint32_t	EntryCount;		//!< number of RawIndexEntry following the header
+	uint32_t	HeaderLength;	//!< should be 64
+	uint32_t	_reserved[5];	//!< bytes 45...64
+};
+#define _RAW_INDEX_HDR_SIZE 64
+#define _RAW_INDEX_VERSION 1
+//! \endcond
+
+/*!
+Only keeps track of the time of the first event while the index is built
+*/
+struct _IndexSink
+{
+	uint64_t timeStamp;
+	uint64_t evCount;
+	uint64_t nEventOutOfBounds;
+
+	_IndexSink() { timeStamp = 0; evCount = 0; nEventOutOfBounds = 0; }
+
+	inline void addEvent(const uint16_t, const uint16_t, const int8_t, const uint64_t t)
+	{
+		if (evCount == 0)
+			timeStamp = t;
+		evCount++;
+	}
+	inline void addVector(const uint16_t, const uint16_t, const uint32_t valid,
+		const uint16_t, const int8_t, const uint64_t t, const uint32_t)
+	{
+		if (valid != 0)
+			addEvent(0, 0, 0, t);
+	}
+	inline void addTrigger(const uint16_t, const uint16_t, const uint64_t) {}
+	size_t size() const { return 0; }
+};
+
+EBI::RawFileIndex::RawFileIndex()
+{
+	clear();
+}
+
+EBI::RawFileIndex::~RawFileIndex()
+{
+
+}
+
+void EBI::RawFileIndex::clear()
+{
+	m_entries.clear();
+	m_nRawFileSize = 0;
+	m_nPayloadOffset = 0;
+	m_timeStamp = 0;
+	m_nInterval = 0;
+}
+
+/*!
+Scan the entire RAW file \a fnameRaw and record the decoder state every \a nInterval microseconds
+\return true on success
+*/
+bool EBI::RawFileIndex::build(const std::string& fnameRaw, const uint32_t nInterval, const bool bDebugMessages)
+{
+	clear();
+	if (nInterval == 0)
+		return false;
+	std::ifstream input_file(fnameRaw, std::ios::in | std::ios::binary);
+	if (!input_file.is_open()) {
+		std::cerr << "Error : could not open file '" << fnameRaw.c_str() << "' for reading" << std::endl;
+		return false;
+	}
+	EBI::EventCameraSpecs camSpecs;
+	if (!EBI::ReadRawFileHeader(input_file, camSpecs, fnameRaw, false))
+		return false;
+	m_nPayloadOffset = static_cast<uint64_t>(input_file.tellg());
+	input_file.seekg(0, std::ios::end);
+	m_nRawFileSize = static_cast<uint64_t>(input_file.tellg());
+	input_file.seekg(m_nPayloadOffset, std::ios::beg);
+	m_nInterval = nInterval;
+	if (bDebugMessages)
+		std::cout << "Building index of '" << fnameRaw.c_str() << "'" << std::endl;
+
+	EBI::Evt3DecoderState state;
+	state.sensorW = static_cast<uint16_t>(camSpecs.sensorW);
+	state.sensorH = static_cast<uint16_t>(camSpecs.sensorH);
+	_IndexSink sink;
+	uint64_t nNextTime = 0;
+	uint64_t nBlockPos = 0;
+	std::vector<uint16_t> buffer_read(WORDS_TO_READ);
+	while (input_file) {
+		input_file.read(reinterpret_cast<char*>(buffer_read.data()), WORDS_TO_READ * sizeof(uint16_t));
+		const uint64_t nWords = input_file.gcount() / sizeof(uint16_t);
+		const uint8_t* pData = reinterpret_cast<const uint8_t*>(buffer_read.data());
+		uint64_t nDecoded = 0;
+		for (uint64_t i = 0; i < nWords; i++) {
+			if (static_cast<Metavision::Evt3::EventTypes>(buffer_read[i] >> 12) != Metavision::Evt3::EventTypes::EVT_TIME_HIGH)
+				continue;
+			// advance to the time high word and look at the time base it sets
+			_decodeEvt3Words(pData + nDecoded * sizeof(uint16_t), i - nDecoded, state, sink);
+			EBI::Evt3DecoderState stateNext = state;
+			_decodeEvt3Words(pData + i * sizeof(uint16_t), 1, stateNext, sink);
+			if ((sink.evCount > 0) && (stateNext.timeBase >= sink.timeStamp)
+				&& (stateNext.timeBase - sink.timeStamp >= nNextTime)) {
+				EBI::RawIndexEntry entry;
+				memset(&entry, 0, sizeof(entry));
+				entry.wordPos = nBlockPos + i;
+				entry.startTime = stateNext.timeBase - sink.timeStamp;
+				entry.timeBase = state.timeBase;
+				entry.time = state.time;
+				entry.nTimeHighLoops = state.nTimeHighLoops;
+				entry.y = state.y;
+				entry.xBase = state.xBase;
+				entry.polarity = state.polarity;
+				m_entries.push_back(entry);
+				nNextTime = (entry.startTime / nInterval + 1) * nInterval;
+			}
+			state = stateNext;
+			nDecoded = i + 1;
+		}
+		_decodeEvt3Words(pData + nDecoded * sizeof(uint16_t), nWords - nDecoded, state, sink);
+		nBlockPos += nWords;
+	}
+	m_timeStamp = sink.timeStamp;
+	if (bDebugMessages)
+		std::cout << "Index has " << m_entries.size() << " entries" << std::endl;
+	return true;
+}
+
+/*!
+Load index from file \a fnameIndex
+\return true on success
+*/
+bool EBI::RawFileIndex::load(const std::string& fnameIndex)
+{
+	clear();
+	std::ifstream inFile(fnameIndex, std::ios::in | std::ios::binary);
+	if (!inFile.is_open())
+		return false;
+	_RAW_INDEX_HDR hdr;
+	inFile.read(reinterpret_cast<char*>(&hdr), _RAW_INDEX_HDR_SIZE);
+	if (!inFile || (memcmp(hdr.Signature, "EBIX", 4) != 0) || (hdr.Version != _RAW_INDEX_VERSION)
+		|| (hdr.HeaderLength != _RAW_INDEX_HDR_SIZE))
+		return false;
+	m_entries.resize(hdr.EntryCount);
+	inFile.read(reinterpret_cast<char*>(m_entries.data()), hdr.EntryCount * sizeof(EBI::RawIndexEntry));
+	if (!inFile) {
+		clear();
+		return false;
+	}
+	m_nRawFileSize = hdr.RawFileSize;
+	m_nPayloadOffset = hdr.PayloadOffset;
+	m_timeStamp = hdr.TimeStamp;
+	m_nInterval = hdr.Interval;
+	return true;
+}
+
+/*!
+Save index to file \a fnameIndex
+\return true on success
+*/
+bool EBI::RawFileIndex::save(const std::string& fnameIndex) const
+{
+	std::ofstream outFile(fnameIndex, std::ios::out | std::ios::binary);
+	if (!outFile.is_open())
+		return false;
+	_RAW_INDEX_HDR hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.Signature, "EBIX", 4);
+	hdr.Version = _RAW_INDEX_VERSION;
+	hdr.RawFileSize = m_nRawFileSize;
+	hdr.PayloadOffset = m_nPayloadOffset;
+	hdr.TimeStamp = m_timeStamp;
+	hdr.Interval = m_nInterval;
+	hdr.EntryCount = static_cast<uint32_t>(m_entries.size());
+	hdr.HeaderLength = _RAW_INDEX_HDR_SIZE;
+	outFile.write(reinterpret_cast<const char*>(&hdr), _RAW_INDEX_HDR_SIZE);
+	outFile.write(reinterpret_cast<const char*>(m_entries.data()), m_entries.size() * sizeof(EBI::RawIndexEntry));
+	return outFile.good();
+}
+
+/*!
+\return true if index was built for a RAW file with the given layout
+*/
+bool EBI::RawFileIndex::isValidFor(const uint64_t nRawFileSize, const uint64_t nPayloadOffset) const
+{
+	return (m_nInterval > 0) && (m_nRawFileSize == nRawFileSize) && (m_nPayloadOffset == nPayloadOffset);
+}
+
+/*!
+\return last entry at or before \a nStartTime (relative to first event), nullptr if there is none
+*/
+const EBI::RawIndexEntry* EBI::RawFileIndex::find(const uint64_t nStartTime) const
+{
+	auto it = std::upper_bound(m_entries.begin(), m_entries.end(), nStartTime,
+		[](const uint64_t t, const EBI::RawIndexEntry& entry) { return t < entry.startTime; });
+	if (it == m_entries.begin())
+		return nullptr;
+	return &(*(it - 1));
+}
+
+/*!
+Get index of RAW file \a fnameRaw: loaded from <fnameRaw>.ebidx if up to date,
+otherwise built and saved for later use
+\return true if \a index is valid
+*/
+bool EBI::GetRawFileIndex(const std::string& fnameRaw,
+	const uint32_t nInterval,
+	EBI::RawFileIndex& index,
+	const bool bDebugMessages)
+{
+	std::ifstream input_file(fnameRaw, std::ios::in | std::ios::binary);
+	EBI::EventCameraSpecs camSpecs;
+	if (!input_file.is_open() || !EBI::ReadRawFileHeader(input_file, camSpecs, fnameRaw, false))
+		return false;
+	uint64_t nPayloadOffset = static_cast<uint64_t>(input_file.tellg());
+	input_file.seekg(0, std::ios::end);
+	uint64_t nRawFileSize = static_cast<uint64_t>(input_file.tellg());
+	input_file.close();
+
+	std::string fnameIndex = EBI::RawFileIndex::fileName(fnameRaw);
+	if (index.load(fnameIndex) && index.isValidFor(nRawFileSize, nPayloadOffset))
+		return true;
+	if (!index.build(fnameRaw, nInterval, bDebugMessages))
+		return false;
+	if (!index.save(fnameIndex) && bDebugMessages)
+		std::cout << "Could not save index file '" << fnameIndex.c_str() << "'" << std::endl;
+	return true;
+}
+
+/*!
+Prepare decoding of a time window starting at \a nStartTime: set \a state,
+\a timeStamp and \a nPayloadOffset from the closest entry of the index of
+\a fname. The index is built if needed.
+\return true if decoding can start at the new \a nPayloadOffset
+*/
+static bool _seekRawIndex(const std::string& fname,
+	const uint64_t nStartTime,
+	const EBI::RawDecodeParams& decParams,
+	EBI::Evt3DecoderState& state,
+	uint64_t& timeStamp,
+	uint64_t& nPayloadOffset,
+	const bool bDebugMessages)
+{
+	if ((nStartTime == 0) || (decParams.indexInterval == 0))
+		return false;
+	EBI::RawFileIndex index;
+	if (!EBI::GetRawFileIndex(fname, decParams.indexInterval, index, bDebugMessages))
+		return false;
+	const EBI::RawIndexEntry* pEntry = index.find(nStartTime);
+	if (pEntry == nullptr)
+		return false;
+	state.timeBase = pEntry->timeBase;
+	state.time = pEntry->time;
+	state.nTimeHighLoops = pEntry->nTimeHighLoops;
+	state.y = pEntry->y;
+	state.xBase = pEntry->xBase;
+	state.polarity = pEntry->polarity;
+	state.bTimeBaseSet = true;
+	timeStamp = index.timeStamp();
+	nPayloadOffset += pEntry->wordPos * sizeof(Metavision::Evt3::RawEvent);
+	if (bDebugMessages)
+		std::cout << "Starting at t=" << pEntry->startTime << " us" << std::endl;
+	return true;
+}
+
+/*!
+Consistency check of the event times - not part of Metavision SDK, tries to
+deal with corrupt data: events after the last event get the time of their
+predecessor, events before their predecessor are counted.
+Only blocks of \a timing with events after the last event are visited.
+\a timeAt(i) returns the full time of event i of the \a nEvents loaded, \a setTime(i, t) changes it
+to the full time \a t.
+*/
+template <typename TimeAt, typename SetTime>
+static void _checkTiming(const size_t nEvents, TimeAt timeAt, SetTime setTime,
+	const std::vector<_TimingBlock>& timing,
+	EBI::EventLoadStats& stats)
+{
+	if (nEvents == 0)
+		return;
+	int64_t t_prev = timeAt(0);
+	const int64_t t_end = timeAt(nEvents - 1);
+	if (t_prev > t_end) {
+		stats.bFirstEventRepaired = true;
+		setTime(0, 0);
+		t_prev = 0;
+	}
+	for (const _TimingBlock& block : timing) {
+		if (static_cast<int64_t>(block.tMax) > t_end) {
+			for (size_t i = block.nFirst; i < block.nFirst + block.nCount; i++) {
+				int64_t t_now = timeAt(i);
+				if (t_now > t_end) {
+					stats.nBadTiming++;
+					stats.nTimeRepaired++;
+					// correct if exceeding t_max
+					setTime(i, static_cast<uint64_t>(t_prev));
+				}
+				else if (t_now < t_prev) {
+					stats.nBadTiming++;
+				}
+				t_prev = timeAt(i);
+			}
+		}
+		else {
+			if (static_cast<int64_t>(block.tFirst) < t_prev)
+				stats.nBadTiming++;
+			stats.nBadTiming += block.nBackSteps;
+			t_prev = static_cast<int64_t>(block.tLast);
+		}
+	}
+}
+
+/*!
+Decode a RAW file into \a sink, common part of both versions of LoadRawEventData()
+\return true on success
+*/
+static bool _loadRawEventData(const std::string& fname,
+	_EventVectorSink& sink,
+	EBI::EventCameraSpecs& camSpecs,
+	const uint64_t nStartTime,
+	const uint64_t nMaxEventCount,
+	const EBI::RawDecodeParams& decParams,
+	const EBI::EventFilter& filter,
+	const bool bDebugMessages)
+{
+	bool retCode = true; // on success
+	uint64_t& timeStamp = sink.timeStamp;
+	EBI::EventFilter roiFilter = filter;
+
+	// open file
+	std::ifstream input_file(fname, std::ios::in | std::ios::binary);
+	try {
+		if (!input_file.is_open()) {
+			std::cerr << "Error : could not open file '" << fname.c_str() << "' for reading" << std::endl;
+			throw (-1);
+		}
+		if (!EBI::ReadRawFileHeader(input_file, camSpecs, fname, bDebugMessages)) {
+			throw (-2);
+		}
+
+		EBI::Evt3DecoderState state;
+		state.sensorW = static_cast<uint16_t>(camSpecs.sensorW);
+		state.sensorH = static_cast<uint16_t>(camSpecs.sensorH);
+		uint64_t nPayloadOffset = static_cast<uint64_t>(input_file.tellg());
+
+		if (!roiFilter.clipROI(static_cast<int32_t>(camSpecs.sensorW), static_cast<int32_t>(camSpecs.sensorH))) {
+			std::cerr << "ERROR: invalid ROI: X=" << roiFilter.roiX << " Y=" << roiFilter.roiY
+				<< " W=" << roiFilter.roiW << " H=" << roiFilter.roiH
+				<< "  image size: " << camSpecs.sensorW << "(W) x " << camSpecs.sensorH << "(H)"
+				<< std::endl;
+			throw (-3);
+		}
+		sink.setFilter(roiFilter);
+
+		// jump close to start of time window
+		if (_seekRawIndex(fname, nStartTime, decParams, state, timeStamp, nPayloadOffset, bDebugMessages)) {
+			sink.evCount = 1;	// time stamp is known
+			input_file.seekg(nPayloadOffset, std::ios::beg);
+		}
+
+		bool bDecoded = false;
+		if ((decParams.decMode == EBI::RawDecodeMapped) || (decParams.decMode == EBI::RawDecodeParallel)) {
+			if (decParams.decMode == EBI::RawDecodeParallel)
+				bDecoded = _decodeParallel(fname, nPayloadOffset, state, sink, nMaxEventCount, decParams.nThreads, bDebugMessages);
+			else
+				bDecoded = _decodeMapped(fname, nPayloadOffset, state, sink, nMaxEventCount, bDebugMessages);
+			if (!bDecoded && bDebugMessages)
+				std::cout << "Memory mapping not available - using stream" << std::endl;
+		}
+		if (!bDecoded) {
+			if (decParams.decMode == EBI::RawDecodePipelined)
+				_decodePipelined(input_file, state, sink, nMaxEventCount, decParams.nBufferWords, decParams.nQueueDepth);
+			else
+				_decodeStream(input_file, state, sink, nMaxEventCount);
+		}
+	}
+	catch (int errCode) {
+		std::cerr << "_loadRawEventData() - ERROR(" << errCode << ")" << std::endl;
+		retCode = false;
+	}
+	sink.flush();
+	if(input_file.is_open())
+		input_file.close();
+	if (retCode && roiFilter.hasROI()) {
+		// coordinates are relative to the ROI, as after EventData::cropROI()
+		camSpecs.sensorW = static_cast<uint32_t>(roiFilter.roiW);
+		camSpecs.sensorH = static_cast<uint32_t>(roiFilter.roiH);
+	}
+	return retCode;
+}
+
+//! report inconsistencies found while loading
+static void _reportLoadStats(const EBI::EventLoadStats& stats, const bool bDebugMessages)
+{
+	if (bDebugMessages) {
+		if (stats.bFirstEventRepaired)
+			std::cout << "CAUTION: data may be faulty! first event after end" << std::endl;
+		if (stats.nBadTiming > 0)
+			std::cout << "CAUTION: data may be faulty! Have " << stats.nBadTiming << " timing inconsistencies (non-monotonic)" << std::endl;
+		if (stats.nOutOfBounds > 0)
+			std::cout << "CAUTION: data may be faulty! Have " << stats.nOutOfBounds << " out-of-bound events" << std::endl;
+		if (stats.bTruncated)
+			std::cout << "CAUTION: events end at the latest time the data set can hold" << std::endl;
+		std::cout << "Number of events: " << stats.nEvents
+			<< "\nNumber of trigger events: " << stats.nTriggerEvents << std::endl;
+	}
+}
+
+/*!
+Load events from a Metavision RAW file (EVT 3.0 format).
+Events in [\a nStartTime, \a nStartTime + \a nDuration] relative to the first event are kept,
+the same window as for own event files.
+For \a nStartTime > 0 decoding starts at the closest entry of the index file
+(see RawFileIndex), it stops at the end of the time window.
+Times are offsets within time segments of EBI::TIME_SEGMENT_USEC, \a evSegments and
+\a triggerSegments receive the start of every segment after the first, see EBI::TimeSegment.
+\return true on success
+*/
+bool EBI::LoadRawEventData(const std::string& fname,
+	std::vector<EBI::Event>& evData,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	std::vector<EBI::TimeSegment>& evSegments,	//!< start of time segments of evData (output)
+	std::vector<EBI::TimeSegment>& triggerSegments,	//!< start of time segments of evTrigger (output)
+	uint64_t& timeStamp,	// from first event in file
+	EBI::EventCameraSpecs& camSpecs,
+	const uint64_t nStartTime,	//!< offset within file in microseconds (input)
+	const uint64_t nDuration,	//!< duration to load in microseconds, 0 for entire file
+	const uint64_t nMaxEventCount,	//!< maximum number of events to load
+	const EBI::RawDecodeParams& decParams,	//!< how to read the file
+	EBI::EventLoadStats& stats,	//!< number of events and of inconsistencies found (output)
+	const EBI::EventFilter& filter,	//!< ROI and polarity of events to keep, the time window is given by nStartTime and nDuration
+	const bool bDebugMessages	//!< true to enable diagnostic output
+	)
+{
+	timeStamp = 0UL;
+	stats.init();
+	const uint64_t nEndTime = (nDuration > 0) ? (nStartTime + nDuration) : UINT64_MAX;
+	evSegments.clear();
+	triggerSegments.clear();
+	_EventVectorSink sink(evData, evTrigger, timeStamp, nStartTime, nEndTime, _getExpandVectorFn(decParams.vecKernel));
+	sink.pSegments = &evSegments;
+	sink.pTriggerSegments = &triggerSegments;
+	bool retCode = _loadRawEventData(fname, sink, camSpecs, nStartTime, nMaxEventCount, decParams, filter, bDebugMessages);
+
+	stats.nEvents = evData.size();
+	stats.nTriggerEvents = evTrigger.size();
+	stats.nOutOfBounds = sink.nEventOutOfBounds;
+	_checkTiming(evData.size(),
+		[&evData, &evSegments](const size_t i) { return EBI::SegmentBase(evSegments, i) + evData[i].t; },
+		[&evData, &evSegments](const size_t i, const uint64_t t) {
+			// a repaired event may be the first of its time segment, e.g. after a corrupt TIME_HIGH
+			const uint64_t tBase = EBI::SegmentBase(evSegments, i);
+			evData[i].t = (t > tBase) ? static_cast<uint32_t>(t - tBase) : 0;
+		},
+		sink.timing, stats);
+	_reportLoadStats(stats, bDebugMessages);
+	return retCode;
+}
+
+/*!
+Load events from a Metavision RAW file into separate columns of time, x, y and polarity.
+The decoder stages events in a small block and scatters it into the columns.
+The columns have no time segments, so decoding stops before EBI::TIME_SEGMENT_USEC after
+the first event, otherwise the events are identical to those of the version filling a
+vector of EBI::Event.
+\return true on success
+*/
+bool EBI::LoadRawEventData(const std::string& fname,
+	EBI::EventColumns& evColumns,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	uint64_t& timeStamp,
+	EBI::EventCameraSpecs& camSpecs,
+	const uint64_t nStartTime,
+	const uint64_t nDuration,
+	const uint64_t nMaxEventCount,
+	const EBI::RawDecodeParams& decParams,
+	EBI::EventLoadStats& stats,
+	const EBI::EventFilter& filter,
+	const bool bDebugMessages
+	)
+{
+	timeStamp = 0UL;
+	stats.init();
+	// times wrapped at 2^32 usec would be taken as corrupt by _checkTiming()
+	const uint64_t nEndTime = std::min<uint64_t>((nDuration > 0) ? (nStartTime + nDuration) : UINT64_MAX, EBI::TIME_SEGMENT_USEC - 1);
+	std::vector<EBI::Event> evUnused;
+	_EventVectorSink sink(evUnused, evTrigger, timeStamp, nStartTime, nEndTime, _getExpandVectorFn(decParams.vecKernel));
+	sink.pColumns = &evColumns;
+	bool retCode = _loadRawEventData(fname, sink, camSpecs, nStartTime, nMaxEventCount, decParams, filter, bDebugMessages);
+
+	stats.nEvents = evColumns.size();
+	stats.nTriggerEvents = evTrigger.size();
+	stats.nOutOfBounds = sink.nEventOutOfBounds;
+	uint32_t* pTime = evColumns.t();
+	_checkTiming(evColumns.size(),
+		[pTime](const size_t i) { return pTime[i]; },
+		[pTime](const size_t i, const uint64_t t) { pTime[i] = static_cast<uint32_t>(t); },
+		sink.timing, stats);
+	stats.bTruncated = sink.bPastEnd && (nEndTime == EBI::TIME_SEGMENT_USEC - 1);
+	_reportLoadStats(stats, bDebugMessages);
+	return retCode;
+}
+
+/*!
+Load events from a Metavision RAW file as 8-byte EBI::PackedEvent.
+Decoding stops at EBI::PACKED_TIME_MAX after the first event, otherwise
+the events are identical to those of the version filling a vector of EBI::Event.
+\return true on success
+*/
+bool EBI::LoadRawEventData(const std::string& fname,
+	EBI::PackedEventData& evPacked,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	uint64_t& timeStamp,
+	EBI::EventCameraSpecs& camSpecs,
+	const uint64_t nStartTime,
+	const uint64_t nDuration,
+	const uint64_t nMaxEventCount,
+	const EBI::RawDecodeParams& decParams,
+	EBI::EventLoadStats& stats,
+	const EBI::EventFilter& filter,
+	const bool bDebugMessages
+	)
+{
+	timeStamp = 0UL;
+	stats.init();
+	const uint64_t nEndTime = std::min<uint64_t>((nDuration > 0) ? (nStartTime + nDuration) : UINT64_MAX, EBI::PACKED_TIME_MAX);
+	std::vector<EBI::Event> evUnused;
+	_EventVectorSink sink(evUnused, evTrigger, timeStamp, nStartTime, nEndTime, _getExpandVectorFn(decParams.vecKernel));
+	sink.pPacked = &evPacked;
+	bool retCode = _loadRawEventData(fname, sink, camSpecs, nStartTime, nMaxEventCount, decParams, filter, bDebugMessages);
+
+	stats.nEvents = evPacked.size();
+	stats.nTriggerEvents = evTrigger.size();
+	stats.nOutOfBounds = sink.nEventOutOfBounds;
+	EBI::PackedEvent* pEv = evPacked.dataRef().data();
+	_checkTiming(evPacked.size(),
+		[pEv](const size_t i) { return pEv[i].t(); },
+		[pEv](const size_t i, const uint64_t t) { pEv[i].timePol = (static_cast<uint32_t>(t) << 1) | (pEv[i].timePol & 0x1); },
+		sink.timing, stats);
+	stats.bTruncated = sink.bPastEnd && (nEndTime == EBI::PACKED_TIME_MAX);
+	_reportLoadStats(stats, bDebugMessages);
+	return retCode;
+}
+
+/*!
+Receives decoded words while scanning for trigger events: CD events are only
+counted per second, never stored
+*/
+struct _TriggerScanSink
+{
+	static constexpr uint64_t RATE_BIN = 1000000;	//!< width of event rate bins in [usec]
+
+	std::vector<EBI::TriggerEvent>& evTrigger;
+	std::vector<EBI::TimeSegment>& triggerSegments;
+	std::vector<uint32_t>& eventRate;
+	uint64_t timeStamp;		//!< time of first event in file
+	uint64_t trigSegBase;	//!< start of time segment of the latest trigger event
+	uint64_t evCount;
+	uint64_t nEventOutOfBounds;
+	uint64_t binStart, binEnd;	//!< time range of current rate bin
+	size_t nBin;
+
+	_TriggerScanSink(std::vector<EBI::TriggerEvent>& evTriggerIN, std::vector<EBI::TimeSegment>& triggerSegmentsIN,
+		std::vector<uint32_t>& eventRateIN)
+		: evTrigger(evTriggerIN), triggerSegments(triggerSegmentsIN), eventRate(eventRateIN)
+	{
+		timeStamp = 0;
+		trigSegBase = 0;
+		evCount = 0;
+		nEventOutOfBounds = 0;
+		binStart = binEnd = 0;
+		nBin = 0;
+	}
+
+	inline void countEvents(const uint64_t t, const uint32_t n)
+	{
+		if (evCount == 0)
+			timeStamp = t;
+		evCount += n;
+		if ((t < binStart) || (t >= binEnd)) {
+			nBin = static_cast<size_t>(((t > timeStamp) ? (t - timeStamp) : 0) / RATE_BIN);
+			if (nBin >= eventRate.size())
+				eventRate.resize(nBin + 1, 0);
+			binStart = timeStamp + nBin * RATE_BIN;
+			binEnd = binStart + RATE_BIN;
+		}
+		eventRate[nBin] += n;
+	}
+	inline void addEvent(const uint16_t, const uint16_t, const int8_t, const uint64_t t)
+	{
+		countEvents(t, 1);
+	}
+	inline void addVector(const uint16_t, const uint16_t, const uint32_t valid,
+		const uint16_t, const int8_t, const uint64_t t, const uint32_t)
+	{
+		if (valid != 0)
+			countEvents(t, _popCount(valid));
+	}
+	inline void addTrigger(const uint16_t value, const uint16_t id, const uint64_t t)
+	{
+		// same selection, time and time segments as _EventVectorSink with an unlimited time window
+		if (t != timeStamp) {
+			const uint64_t tRel = t - timeStamp;
+			const uint64_t tBase = tRel & ~(EBI::TIME_SEGMENT_USEC - 1);
+			if (tBase > trigSegBase) {
+				trigSegBase = tBase;
+				triggerSegments.push_back(EBI::TimeSegment(tBase, evTrigger.size()));
+			}
+			evTrigger.push_back(EBI::TriggerEvent(value, id, static_cast<uint32_t>(tRel)));
+		}
+	}
+	bool isDone(const uint64_t, const EBI::Evt3DecoderState&) const { return false; }
+	size_t size() const { return 0; }
+};
+
+/*!
+Read only the trigger events of RAW file \a fname, e.g. for synchronisation with
+pulsed illumination. CD events are not stored, only counted in \a eventRate
+for each second after the first event. Much faster than loading the file
+and needs no memory for the events.
+Trigger events and their time segments are the same as in \a evTrigger and
+\a triggerSegments of LoadRawEventData().
+\return true on success
+*/
+bool EBI::ScanTriggers(const std::string& fname,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	std::vector<EBI::TimeSegment>& triggerSegments,	//!< start of time segments of evTrigger after the first, see EBI::TimeSegment
+	std::vector<uint32_t>& eventRate,	//!< number of CD events per second
+	uint64_t& timeStamp,	//!< time of first event in file
+	EBI::EventCameraSpecs& camSpecs,
+	const EBI::RawDecodeParams& decParams,	//!< how to read the file, RawDecodeParallel is treated as RawDecodeMapped
+	const bool bDebugMessages
+	)
+{
+	bool retCode = true;
+	evTrigger.clear();
+	triggerSegments.clear();
+	eventRate.clear();
+	_TriggerScanSink sink(evTrigger, triggerSegments, eventRate);
+
+	std::ifstream input_file(fname, std::ios::in | std::ios::binary);
+	try {
+		if (!input_file.is_open()) {
+			std::cerr << "Error : could not open file '" << fname.c_str() << "' for reading" << std::endl;
+			throw (-1);
+		}
+		if (!EBI::ReadRawFileHeader(input_file, camSpecs, fname, bDebugMessages)) {
+			throw (-2);
+		}
+		EBI::Evt3DecoderState state;
+		state.sensorW = static_cast<uint16_t>(camSpecs.sensorW);
+		state.sensorH = static_cast<uint16_t>(camSpecs.sensorH);
+		const uint64_t nPayloadOffset = static_cast<uint64_t>(input_file.tellg());
+
+		bool bDecoded = false;
+		if ((decParams.decMode == EBI::RawDecodeMapped) || (decParams.decMode == EBI::RawDecodeParallel))
+			bDecoded = _decodeMapped(fname, nPayloadOffset, state, sink, UINT64_MAX, bDebugMessages);
+		if (!bDecoded) {
+			if (decParams.decMode == EBI::RawDecodePipelined)
+				_decodePipelined(input_file, state, sink, UINT64_MAX, decParams.nBufferWords, decParams.nQueueDepth);
+			else
+				_decodeStream(input_file, state, sink, UINT64_MAX);
+		}
+	}
+	catch (int errCode) {
+		std::cerr << "ScanTriggers() - ERROR(" << errCode << ")" << std::endl;
+		retCode = false;
+	}
+	timeStamp = sink.timeStamp;
+	if (bDebugMessages) {
+		std::cout << "Number of events: " << sink.evCount
+			<< "\nNumber of trigger events: " << evTrigger.size() << std::endl;
+	}
+	return retCode;
+}
+
+EBI::RawEventReader::RawEventReader()
+{
+	m_bFollow = false;
+	m_bStop = false;
+	close();
+}
+
+EBI::RawEventReader::~RawEventReader()
+{
+	close();
+}
+
+void EBI::RawEventReader::close()
+{
+	if (m_file.is_open())
+		m_file.close();
+	m_file.clear();
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+	m_camSpecs.init();
+	m_state.init();
+	m_vecKernel = EBI::RawVectorAuto;
+	m_timeStamp = 0;
+	m_evCount = 0;
+	m_nStartTime = 0;
+	m_nEndTime = UINT64_MAX;
+	m_segBase = m_trigSegBase = 0;
+	m_bEnd = true;
+	m_nFilePos = 0;
+}
+
+/*!
+Open RAW file \a fname for reading of the events in [\a nStartTime, \a nStartTime + \a nDuration]
+relative to the first event. As in LoadRawEventData() the index file is used to
+start close to \a nStartTime. Only \a decParams.vecKernel and \a decParams.indexInterval
+apply, the file is always read through a stream.
+In follow mode the index is not used and the header must be complete, i.e. be followed
+by event data, otherwise open() fails and should be retried later.
+\return true on success
+*/
+bool EBI::RawEventReader::open(const std::string& fname,
+	const uint64_t nStartTime,
+	const uint64_t nDuration,
+	const EBI::RawDecodeParams& decParams,
+	const bool bDebugMessages)
+{
+	close();
+	m_file.open(fname, std::ios::in | std::ios::binary);
+	if (!m_file.is_open()) {
+		// in follow mode the recording may not have started yet
+		if (!m_bFollow || bDebugMessages)
+			std::cerr << "Error : could not open file '" << fname.c_str() << "' for reading" << std::endl;
+		return false;
+	}
+	if (!EBI::ReadRawFileHeader(m_file, m_camSpecs, fname, bDebugMessages)) {
+		close();
+		return false;
+	}
+	if (m_bFollow && (m_file.peek() == std::char_traits<char>::eof())) {
+		// recording has just started, header may still be written
+		if (bDebugMessages)
+			std::cout << "RawEventReader: no event data yet in '" << fname.c_str() << "'" << std::endl;
+		close();
+		return false;
+	}
+	m_state.sensorW = static_cast<uint16_t>(m_camSpecs.sensorW);
+	m_state.sensorH = static_cast<uint16_t>(m_camSpecs.sensorH);
+	m_vecKernel = decParams.vecKernel;
+	m_nStartTime = nStartTime;
+	m_nEndTime = (nDuration > 0) ? (nStartTime + nDuration) : UINT64_MAX;
+
+	uint64_t nPayloadOffset = static_cast<uint64_t>(m_file.tellg());
+	// index of a growing file would be rebuilt on every open
+	if (!m_bFollow && _seekRawIndex(fname, nStartTime, decParams, m_state, m_timeStamp, nPayloadOffset, bDebugMessages)) {
+		m_evCount = 1;	// time stamp is known
+		m_file.seekg(nPayloadOffset, std::ios::beg);
+	}
+	m_nFilePos = nPayloadOffset;
+	m_bEnd = false;
+	m_bStop = false;
+	return true;
+}
+
+/*!
+Decode the next \a nWords raw words and append the events within the time window
+to \a evData and \a evTrigger. Times are relative to the first event in the file
+modulo 2^32, the timing check of LoadRawEventData() is not applied.
+\return number of events appended to \a evData
+*/
+uint64_t EBI::RawEventReader::read(std::vector<EBI::Event>& evData,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	const uint64_t nWords)
+{
+	return readWords(evData, evTrigger, nullptr, nullptr, nWords);
+}
+
+/*!
+Same as above, each time segment entered by the new events is appended to \a evSegments,
+with the index of its first event in \a evData, and likewise to \a triggerSegments,
+see EBI::TimeSegment. The times of the events are relative to their segment, so the full
+time of an event is EBI::SegmentBase(evSegments, i) + evData[i].t as long as evData and
+the segments are kept together between the calls.
+\return number of events appended to \a evData
+*/
+uint64_t EBI::RawEventReader::read(std::vector<EBI::Event>& evData,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	std::vector<EBI::TimeSegment>& evSegments,
+	std::vector<EBI::TimeSegment>& triggerSegments,
+	const uint64_t nWords)
+{
+	return readWords(evData, evTrigger, &evSegments, &triggerSegments, nWords);
+}
+
+uint64_t EBI::RawEventReader::readWords(std::vector<EBI::Event>& evData,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	std::vector<EBI::TimeSegment>* pSegments,
+	std::vector<EBI::TimeSegment>* pTriggerSegments,
+	const uint64_t nWords)
+{
+	if (m_bEnd || !m_file.is_open())
+		return 0;
+	const size_t nSizeIn = evData.size();
+	m_buffer.resize(static_cast<size_t>(nWords));
+	m_file.read(reinterpret_cast<char*>(m_buffer.data()), nWords * sizeof(uint16_t));
+	const uint64_t nWordsRead = m_file.gcount() / sizeof(uint16_t);
+	m_nFilePos += nWordsRead * sizeof(uint16_t);
+	if (m_bFollow && (nWordsRead < nWords)) {
+		// writer may have appended half a word, continue after the last complete one
+		m_file.clear();
+		m_file.seekg(m_nFilePos, std::ios::beg);
+	}
+
+	_EventVectorSink sink(evData, evTrigger, m_timeStamp, m_nStartTime, m_nEndTime, _getExpandVectorFn(m_vecKernel));
+	sink.evCount = m_evCount;
+	// segments continue from the previous call
+	sink.pSegments = pSegments;
+	sink.pTriggerSegments = pTriggerSegments;
+	sink.segBase = m_segBase;
+	sink.trigSegBase = m_trigSegBase;
+	_decodeEvt3Words(reinterpret_cast<const uint8_t*>(m_buffer.data()), nWordsRead, m_state, sink);
+	sink.flush();
+	m_evCount = sink.evCount;
+	m_segBase = sink.segBase;
+	m_trigSegBase = sink.trigSegBase;
+	if (sink.isDone(UINT64_MAX, m_state))
+		m_bEnd = true;
+	else if (!m_bFollow && (!m_file || (nWordsRead < nWords)))
+		m_bEnd = true;
+	return evData.size() - nSizeIn;
+}
+
+/*!
+Follow a file that is still being recorded: decode all data appended to the
+file and pass the new events to \a callback, then wait \a pollIntervalMSec for
+more data. The delay between writing and delivery of an event is bounded by the
+poll interval and the time to decode \a nWords raw words. As with read() without
+segments, times are relative to the first event modulo 2^32.
+Returns when \a callback returns false, stop() is called, the time window of open()
+ends or the file did not grow for \a idleTimeoutMSec (0 to wait forever).
+\return number of events passed to \a callback
+*/
+uint64_t EBI::RawEventReader::follow(const FollowCallback& callback,
+	const uint32_t pollIntervalMSec,
+	const uint32_t idleTimeoutMSec,
+	const uint64_t nWords)
+{
+	m_bFollow = true;
+	std::vector<EBI::Event> evData;
+	std::vector<EBI::TriggerEvent> evTrigger;
+	uint64_t nTotal = 0;
+	auto tLastData = std::chrono::steady_clock::now();
+	while (!m_bStop && !m_bEnd && m_file.is_open()) {
+		const uint64_t nPos = m_nFilePos;
+		read(evData, evTrigger, nWords);
+		if (!evData.empty() || !evTrigger.empty()) {
+			nTotal += evData.size();
+			if (!callback(evData, evTrigger))
+				break;
+			evData.clear();
+			evTrigger.clear();
+		}
+		if (m_nFilePos - nPos == nWords * sizeof(uint16_t)) {
+			// more data is waiting
+			tLastData = std::chrono::steady_clock::now();
+			continue;
+		}
+		auto tNow = std::chrono::steady_clock::now();
+		if (m_nFilePos > nPos)
+			tLastData = tNow;
+		else if ((idleTimeoutMSec > 0)
+			&& (std::chrono::duration_cast<std::chrono::milliseconds>(tNow - tLastData).count() >= idleTimeoutMSec))
+			break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(pollIntervalMSec));
+	}
+	return nTotal;
+}
+
+/*!
+Decode a block of EVT3 words held in memory, using the vector expansion
+kernel \a vecKernel. Intended for benchmarking of the decoder.
+\return number of events appended to \a evData
+*/
+uint64_t EBI::DecodeRawEvt3Words(const uint8_t* pData,
+	const uint64_t nWords,
+	EBI::Evt3DecoderState& state,
+	std::vector<EBI::Event>& evData,
+	std::vector<EBI::TriggerEvent>& evTrigger,
+	uint64_t& timeStamp,
+	const EBI::RawVectorKernel vecKernel
+	)
+{
+	const size_t n0 = evData.size();
+	_EventVectorSink sink(evData, evTrigger, timeStamp, 0, UINT64_MAX, _getExpandVectorFn(vecKernel));
+	sink.evCount = (n0 > 0) ? 1 : 0;	// time stamp is known
+	_decodeEvt3Words(pData, nWords, state, sink);
+	sink.flush();
+	return evData.size() - n0;
+}
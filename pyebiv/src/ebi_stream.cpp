@@ -0,0 +1,419 @@
+#include "ebi.h"
+#include "ebi_stream.h"
+#include "ebi_evtfile.h"
+#include "ebi_evtcodec.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+static constexpr uint64_t RAW_WORDS_PER_BLOCK = 262144;	// raw words decoded per refill
+static constexpr uint64_t EVT_EVENTS_PER_BLOCK = 65536;	// packed events read per refill
+
+/*!
+Drop the time segments of the first \a nDrop events, the segment of the first
+remaining event is kept and moved to index 0
+*/
+static void _dropSegments(std::vector<EBI::TimeSegment>& segments, const size_t nDrop)
+{
+	size_t nStarted = 0;
+	while ((nStarted < segments.size()) && (segments[nStarted].iFirst <= nDrop))
+		nStarted++;
+	if (nStarted > 1)
+		segments.erase(segments.begin(), segments.begin() + (nStarted - 1));
+	if (nStarted > 0)
+		segments[0].iFirst = nDrop;
+	for (EBI::TimeSegment& seg : segments)
+		seg.iFirst -= nDrop;
+}
+
+/*!
+Time segments of the events [\a nFirst, \a nEnd) of \a segments,
+relative to index \a nFirst
+*/
+static void _copySegments(const std::vector<EBI::TimeSegment>& segments, const size_t nFirst, const size_t nEnd,
+	std::vector<EBI::TimeSegment>& batchSegments)
+{
+	batchSegments.clear();
+	const uint64_t tBase = EBI::SegmentBase(segments, nFirst);
+	if (tBase > 0)
+		batchSegments.push_back(EBI::TimeSegment(tBase, 0));
+	for (const EBI::TimeSegment& seg : segments) {
+		if ((seg.iFirst > nFirst) && (seg.iFirst < nEnd))
+			batchSegments.push_back(EBI::TimeSegment(seg.tBase, seg.iFirst - nFirst));
+	}
+}
+
+EBI::EventStream::EventStream()
+{
+	m_decodeParams.init();
+	m_nDebugLevel = 0;
+	m_batchDuration = 10000;
+	m_batchSize = 1000000;
+	close();
+}
+
+EBI::EventStream::~EventStream()
+{
+	close();
+}
+
+void EBI::EventStream::close()
+{
+	m_rawReader.close();
+	if (m_evtFile.is_open())
+		m_evtFile.close();
+	m_evtFile.clear();
+	m_evtSegments.clear();
+	m_evtBlockBytes.clear();
+	m_nEvtBlock = 0;
+	m_nEvtSegment = 0;
+	m_evtTimeBase = 0;
+	m_nEvtIndex = 0;
+	m_nEvtLeft = UINT64_MAX;
+	m_eType = EBI::FILE_FORMAT_UNKNOWN;
+	m_camSpecs.init();
+	m_timeStamp = 0;
+	m_startTime = m_nextStart = 0;
+	m_endTime = UINT64_MAX;
+	m_bSourceEnd = true;
+	m_pending.clear();
+	m_pendingTrigger.clear();
+	m_pendingSegments.clear();
+	m_pendingTriggerSegments.clear();
+	m_nPendingPos = 0;
+	m_nPendingTriggerPos = 0;
+	m_batch.clear();
+	m_batchTrigger.clear();
+	m_batchSegments.clear();
+	m_batchTriggerSegments.clear();
+	m_batchStart = m_batchEnd = 0;
+	m_nBatch = 0;
+}
+
+/*!
+Batches cover \a durationUSec each, the last one may be shorter.
+Batches without events are returned for gaps in the recording.
+*/
+void EBI::EventStream::setBatchDuration(const uint32_t durationUSec)
+{
+	m_batchDuration = durationUSec;
+}
+
+/*!
+Batches contain \a nEvents each, the last one may contain fewer
+*/
+void EBI::EventStream::setBatchSize(const uint64_t nEvents)
+{
+	m_batchSize = (nEvents > 0) ? nEvents : 1;
+	m_batchDuration = 0;
+}
+
+/*!
+Set options used for decoding of Metavision RAW files, takes effect with the next open().
+RAW files are always read through a stream, \a decParams.decMode is ignored.
+*/
+void EBI::EventStream::setDecodeParams(const EBI::RawDecodeParams& decParams)
+{
+	m_decodeParams = decParams;
+}
+
+void EBI::EventStream::setDebugLevel(const int32_t nLevel)
+{
+	m_nDebugLevel = nLevel;
+}
+
+/*!
+Open event file for reading in batches, either Metavision RAW or own EVT3.
+The time window is the same as for EventData::load().
+\return true on success
+*/
+bool EBI::EventStream::open(
+	const std::string& fnameEvents,	//!< file name, can be either Metavision RAW or own EVT3
+	const uint32_t offsetUSec,		//!< offset from start in [usec]
+	const uint32_t durationUSec		//!< duration to read in [usec], 0 to read entire set
+)
+{
+	close();
+	std::string errMsg;
+	try {
+		// own event files carry a signature, RAW files a text header
+		std::ifstream inFile(fnameEvents, std::ios::in | std::ios::binary);
+		if (!inFile.is_open()) {
+			errMsg = "failed opening file";
+			throw (-1);
+		}
+		_EVENT_FILE_HDR hdr;
+		memset(&hdr, 0, sizeof(hdr));
+		inFile.read((char*)&hdr, _EVENT_FILE_HDR_SIZE);
+		inFile.close();
+
+		const bool bCoded = (hdr.Signature == _EVENT_FILE_CODED_SIGNATURE);
+		const bool bBlocks = bCoded || (hdr.Signature == _EVENT_FILE_BLOCKS_SIGNATURE);
+		if ((hdr.Signature == _EVENT_FILE_SIGNATURE) || bBlocks) {
+			m_evtFile.open(fnameEvents, std::ios::in | std::ios::binary);
+			m_evtFile.seekg(hdr.HeaderLength, std::ios::beg);
+			PACKED_EVENT pe;
+			if (!m_evtFile.read((char*)&pe, _PACKED_EVENT_SIZE)) {
+				errMsg = "no events in file";
+				throw (-2);
+			}
+			// the first event of a compressed block is at its time base, see EBI::EncodeEventBlock()
+			if (bCoded)
+				pe.timePol = 0;
+			const bool bSegmented = (hdr.SegmentSignature == _EVENT_FILE_SEGMENT_SIGNATURE);
+			const uint64_t nDuration = bSegmented ? ((static_cast<uint64_t>(hdr.DurationHigh) << 32) | hdr.Duration)
+				: hdr.Duration;
+			if (offsetUSec > nDuration) {
+				errMsg = "start beyond end of file";
+				throw (-3);
+			}
+			// blocks follow each other after the header, each with its time base, see _EVENT_FILE_BLOCK
+			if (bBlocks) {
+				m_nEvtLeft = hdr.EventCount;
+				_EVENT_FILE_FOOTER footer = {};
+				m_evtFile.seekg(-static_cast<std::streamoff>(_EVENT_FILE_FOOTER_SIZE), std::ios::end);
+				m_evtFile.read(reinterpret_cast<char*>(&footer), _EVENT_FILE_FOOTER_SIZE);
+				std::vector<_EVENT_FILE_BLOCK> fileBlocks(footer.BlockCount);
+				m_evtFile.seekg(footer.IndexOffset, std::ios::beg);
+				if ((footer.Signature != _EVENT_FILE_FOOTER_SIGNATURE) || !m_evtFile.read(reinterpret_cast<char*>(fileBlocks.data()),
+					fileBlocks.size() * _EVENT_FILE_BLOCK_SIZE)) {
+					errMsg = "failed reading block index";
+					throw (-2);
+				}
+				uint64_t nFirst = 0;
+				uint64_t nOffset = hdr.HeaderLength;
+				for (const _EVENT_FILE_BLOCK& block : fileBlocks) {
+					if (block.Offset != nOffset) {
+						errMsg = "blocks not in order";
+						throw (-2);
+					}
+					m_evtSegments.push_back(EBI::TimeSegment(block.TimeFirst, nFirst));
+					if (bCoded)
+						m_evtBlockBytes.push_back(block.ByteCount);
+					nFirst += block.EventCount;
+					nOffset += bCoded ? block.ByteCount : (block.EventCount * _PACKED_EVENT_SIZE);
+				}
+			}
+			// segment table after the events, see _EVENT_FILE_SEGMENT
+			else if (bSegmented) {
+				m_nEvtLeft = hdr.EventCount;
+				std::vector<_EVENT_FILE_SEGMENT> fileSegments(hdr.SegmentCount);
+				m_evtFile.seekg(hdr.HeaderLength + hdr.EventCount * _PACKED_EVENT_SIZE, std::ios::beg);
+				if (!m_evtFile.read(reinterpret_cast<char*>(fileSegments.data()), fileSegments.size() * _EVENT_FILE_SEGMENT_SIZE)) {
+					errMsg = "failed reading time segments";
+					throw (-2);
+				}
+				for (const _EVENT_FILE_SEGMENT& seg : fileSegments)
+					m_evtSegments.push_back(EBI::TimeSegment(seg.TimeBase, seg.FirstEvent));
+			}
+			m_evtFile.seekg(hdr.HeaderLength, std::ios::beg);
+			m_camSpecs.sensorW = hdr.cols;
+			m_camSpecs.sensorH = hdr.rows;
+			m_timeStamp = hdr.TimeStamp;
+			// events in [t0, t0 + duration] as in EventData::load()
+			const uint64_t tFirstBase = (!m_evtSegments.empty() && (m_evtSegments[0].iFirst == 0)) ? m_evtSegments[0].tBase : 0;
+			m_startTime = tFirstBase + (pe.timePol >> 1) + offsetUSec;
+			m_nextStart = m_startTime;
+			m_endTime = m_nextStart + ((durationUSec > 0) ? durationUSec : nDuration) + 1;
+			m_eType = EBI::FILE_FORMAT_EVT3;
+		}
+		else if (EBI::GetFileType(fnameEvents) == EBI::FILE_FORMAT_RAWEVT3) {
+			if (!m_rawReader.open(fnameEvents, offsetUSec, durationUSec, m_decodeParams, m_nDebugLevel > 0)) {
+				errMsg = "failed reading RAW file";
+				throw (-4);
+			}
+			m_camSpecs = m_rawReader.cameraSpecs();
+			m_timeStamp = m_rawReader.timeStamp();
+			// events in [offset, offset + duration] as in LoadRawEventData()
+			m_startTime = m_nextStart = offsetUSec;
+			m_endTime = (durationUSec > 0) ? (static_cast<uint64_t>(offsetUSec) + durationUSec + 1) : UINT64_MAX;
+			m_eType = EBI::FILE_FORMAT_RAWEVT3;
+		}
+		else {
+			errMsg = "unknown file type";
+			throw (-5);
+		}
+	}
+	catch (int errCode)
+	{
+		std::cerr << "ERROR(" << errCode << "): EBI::EventStream::open() " << errMsg << std::endl;
+		close();
+		return false;
+	}
+	m_bSourceEnd = false;
+	return true;
+}
+
+/*!
+Read the next block of packed events of an EVT file, or decode the next block of an EVTZ file,
+into the pending buffer
+\return false at end of file or time window
+*/
+bool EBI::EventStream::readEvtBlock()
+{
+	uint64_t nRead = std::min<uint64_t>(EVT_EVENTS_PER_BLOCK, m_nEvtLeft);
+	size_t nEvents = 0;
+	if (!m_evtBlockBytes.empty()) {
+		// blocks of an EVTZ file are listed as time segments, see open()
+		if (m_nEvtBlock == m_evtBlockBytes.size())
+			return false;
+		nRead = ((m_nEvtBlock + 1 < m_evtSegments.size()) ? m_evtSegments[m_nEvtBlock + 1].iFirst : (m_nEvtIndex + m_nEvtLeft))
+			- m_evtSegments[m_nEvtBlock].iFirst;
+		m_evtCoded.resize(m_evtBlockBytes[m_nEvtBlock++]);
+		m_evtBuffer.resize(static_cast<size_t>(nRead) * _PACKED_EVENT_SIZE);
+		m_evtFile.read(reinterpret_cast<char*>(m_evtCoded.data()), m_evtCoded.size());
+		if (m_evtFile && EBI::DecodeEventBlock(m_evtCoded.data(), m_evtCoded.size(), static_cast<size_t>(nRead),
+			reinterpret_cast<PACKED_EVENT*>(m_evtBuffer.data())))
+			nEvents = static_cast<size_t>(nRead);
+	}
+	else {
+		m_evtBuffer.resize(EVT_EVENTS_PER_BLOCK * _PACKED_EVENT_SIZE);
+		m_evtFile.read(reinterpret_cast<char*>(m_evtBuffer.data()), nRead * _PACKED_EVENT_SIZE);
+		nEvents = static_cast<size_t>(m_evtFile.gcount() / _PACKED_EVENT_SIZE);
+	}
+	m_nEvtLeft -= nEvents;
+	const uint8_t* pData = m_evtBuffer.data();
+	for (size_t i = 0; i < nEvents; i++, pData += _PACKED_EVENT_SIZE, m_nEvtIndex++) {
+		PACKED_EVENT pe;
+		memcpy(&pe, pData, _PACKED_EVENT_SIZE);
+		while ((m_nEvtSegment < m_evtSegments.size()) && (m_evtSegments[m_nEvtSegment].iFirst <= m_nEvtIndex))
+			m_evtTimeBase = m_evtSegments[m_nEvtSegment++].tBase;
+		const uint64_t curTime = m_evtTimeBase + (pe.timePol >> 1);
+		if (curTime < m_startTime) {
+			// skip - before start of time window
+			continue;
+		}
+		if (curTime >= m_endTime)
+			return false;
+		// times within their segment, as from RawEventReader::read()
+		const uint64_t tBase = curTime & ~(EBI::TIME_SEGMENT_USEC - 1);
+		if (tBase > (m_pendingSegments.empty() ? 0 : m_pendingSegments.back().tBase))
+			m_pendingSegments.push_back(EBI::TimeSegment(tBase, m_pending.size()));
+		m_pending.push_back(EBI::Event(pe.x, pe.y, (pe.timePol & 0x1) ? 1 : 0, static_cast<uint32_t>(curTime)));
+	}
+	return (nEvents == nRead) && (m_nEvtLeft > 0) && static_cast<bool>(m_evtFile);
+}
+
+/*!
+Move consumed events out of the pending buffers and read the next block of the file
+\return false if no more data is available
+*/
+bool EBI::EventStream::refill()
+{
+	if (m_bSourceEnd)
+		return false;
+	m_pending.erase(m_pending.begin(), m_pending.begin() + m_nPendingPos);
+	m_pendingTrigger.erase(m_pendingTrigger.begin(), m_pendingTrigger.begin() + m_nPendingTriggerPos);
+	_dropSegments(m_pendingSegments, m_nPendingPos);
+	_dropSegments(m_pendingTriggerSegments, m_nPendingTriggerPos);
+	m_nPendingPos = m_nPendingTriggerPos = 0;
+
+	if (m_eType == EBI::FILE_FORMAT_EVT3) {
+		m_bSourceEnd = !readEvtBlock();
+	}
+	else {
+		// blocks before the time window yield no events
+		const size_t nTrigger = m_pendingTrigger.size();
+		while ((m_rawReader.read(m_pending, m_pendingTrigger, m_pendingSegments, m_pendingTriggerSegments,
+			RAW_WORDS_PER_BLOCK) == 0)
+			&& (m_pendingTrigger.size() == nTrigger) && !m_rawReader.isEnd()) {
+		}
+		m_timeStamp = m_rawReader.timeStamp();
+		m_bSourceEnd = m_rawReader.isEnd();
+	}
+	return true;
+}
+
+/*!
+Fill \a evBatch and \a evTrigger with the next batch of events, and \a evSegments
+and \a triggerSegments with their time segments
+\return false if the end of the stream was reached
+*/
+bool EBI::EventStream::fillBatch(std::vector<EBI::Event>& evBatch, std::vector<EBI::TriggerEvent>& evTrigger,
+	std::vector<EBI::TimeSegment>& evSegments, std::vector<EBI::TimeSegment>& triggerSegments)
+{
+	evBatch.clear();
+	evTrigger.clear();
+	evSegments.clear();
+	triggerSegments.clear();
+	if (m_eType == EBI::FILE_FORMAT_UNKNOWN)
+		return false;
+
+	uint64_t tEnd = 0;
+	if (m_batchDuration > 0) {
+		if (m_nextStart >= m_endTime)
+			return false;
+		tEnd = std::min(m_nextStart + m_batchDuration, m_endTime);
+		// need an event beyond the batch to know it is complete
+		while (!m_bSourceEnd && ((m_nPendingPos == m_pending.size()) || (pendingTime(m_pending.size() - 1) < tEnd)))
+			refill();
+		if (m_bSourceEnd && (m_nPendingPos == m_pending.size()) && (m_nPendingTriggerPos == m_pendingTrigger.size()))
+			return false;
+		m_batchStart = m_nextStart;
+	}
+	else {
+		while (!m_bSourceEnd && (m_pending.size() - m_nPendingPos < m_batchSize))
+			refill();
+		const size_t nAvail = std::min(static_cast<size_t>(m_batchSize), m_pending.size() - m_nPendingPos);
+		if (nAvail == 0) {
+			if (m_nPendingTriggerPos == m_pendingTrigger.size())
+				return false;
+			tEnd = UINT64_MAX;	// only trigger events left
+		}
+		else if (m_bSourceEnd && (nAvail == m_pending.size() - m_nPendingPos))
+			tEnd = UINT64_MAX;	// last batch takes all remaining trigger events
+		else
+			tEnd = pendingTime(m_nPendingPos + nAvail - 1) + 1;
+		m_batchStart = (nAvail > 0) ? pendingTime(m_nPendingPos) : m_nextStart;
+	}
+
+	size_t nPos = m_nPendingPos;
+	const size_t nLast = (m_batchDuration > 0) ? m_pending.size()
+		: (m_nPendingPos + std::min(static_cast<size_t>(m_batchSize), m_pending.size() - m_nPendingPos));
+	while ((nPos < nLast) && (pendingTime(nPos) < tEnd))
+		nPos++;
+	evBatch.assign(m_pending.begin() + m_nPendingPos, m_pending.begin() + nPos);
+	_copySegments(m_pendingSegments, m_nPendingPos, nPos, evSegments);
+	const uint64_t tLast = (nPos > m_nPendingPos) ? pendingTime(nPos - 1) : 0;
+	m_nPendingPos = nPos;
+
+	nPos = m_nPendingTriggerPos;
+	while ((nPos < m_pendingTrigger.size()) && (pendingTriggerTime(nPos) < tEnd))
+		nPos++;
+	evTrigger.assign(m_pendingTrigger.begin() + m_nPendingTriggerPos, m_pendingTrigger.begin() + nPos);
+	_copySegments(m_pendingTriggerSegments, m_nPendingTriggerPos, nPos, triggerSegments);
+	m_nPendingTriggerPos = nPos;
+
+	if (m_batchDuration > 0)
+		m_batchEnd = tEnd;
+	else
+		m_batchEnd = evBatch.empty() ? m_batchStart : (tLast + 1);
+	m_nextStart = m_batchEnd;
+	m_nBatch++;
+	return true;
+}
+
+/*!
+Read the next batch, available through events() and triggerEvents()
+\return false if the end of the stream was reached
+*/
+bool EBI::EventStream::next()
+{
+	return fillBatch(m_batch, m_batchTrigger, m_batchSegments, m_batchTriggerSegments);
+}
+
+/*!
+Read the next batch into \a evData, replacing its events.
+Storage of \a evData is reused from batch to batch.
+\return false if the end of the stream was reached
+*/
+bool EBI::EventStream::next(EBI::EventData& evData)
+{
+	evData.invalidateIndex();
+	if (!fillBatch(evData.m_events, evData.m_triggerEvents, evData.m_timeSegments, evData.m_triggerSegments))
+		return false;
+	evData.m_camSpecs = m_camSpecs;
+	evData.m_timeStamp = m_timeStamp;
+	return true;
+}
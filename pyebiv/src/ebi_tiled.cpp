@@ -0,0 +1,266 @@
+#include "ebi.h"
+#include "ebi_tiled.h"
+#include "ebi_evtfile.h"
+#include "ebi_parallel.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+EBI::TiledEventData::TiledEventData()
+	: m_nBytesRead(0)
+{
+	m_nThreads = 0;
+	m_nDebugLevel = 0;
+	close();
+}
+
+EBI::TiledEventData::~TiledEventData()
+{
+	close();
+}
+
+void EBI::TiledEventData::close()
+{
+	m_file.close();
+	m_blocks.clear();
+	m_tileFirst.clear();
+	m_tileW = m_tileH = 0;
+	m_tilesX = m_tilesY = 0;
+	m_blockUSec = 0;
+	m_nEvents = 0;
+	m_duration = 0;
+	m_camSpecs.init();
+	m_timeStamp = 0;
+	m_nBytesRead = 0;
+}
+
+/*!
+Open tiled event file \a fnameEvents written by EventData::saveTiled() and read its block index.
+\return true on success
+*/
+bool EBI::TiledEventData::open(const std::string& fnameEvents)
+{
+	close();
+	std::string errMsg;
+	try {
+		if (!m_file.open(fnameEvents, EBI::MappedFile::AccessRandom)) {
+			errMsg = "failed opening file";
+			throw (-1);
+		}
+		_EVENT_FILE_HDR hdr = {};
+		_EVENT_FILE_TILES_FOOTER footer = {};
+		if (m_file.size() >= _EVENT_FILE_HDR_SIZE + _EVENT_FILE_TILES_FOOTER_SIZE) {
+			memcpy(&hdr, m_file.data(), _EVENT_FILE_HDR_SIZE);
+			memcpy(&footer, m_file.data() + m_file.size() - _EVENT_FILE_TILES_FOOTER_SIZE, _EVENT_FILE_TILES_FOOTER_SIZE);
+		}
+		if (hdr.Signature != _EVENT_FILE_TILES_SIGNATURE) {
+			errMsg = "not a tiled event file";
+			throw (-2);
+		}
+		const uint64_t nTiles = static_cast<uint64_t>(footer.TilesX) * footer.TilesY;
+		if ((footer.Signature != _EVENT_FILE_TILES_FOOTER_SIGNATURE) || (footer.Version != _EVENT_FILE_TILES_VERSION)
+			|| (footer.TileW == 0) || (footer.TileH == 0) || (footer.BlockUSec == 0) || (nTiles == 0)
+			|| (footer.IndexOffset + footer.BlockCount * _EVENT_FILE_TILE_BLOCK_SIZE + (nTiles + 1) * sizeof(uint32_t)
+				+ _EVENT_FILE_TILES_FOOTER_SIZE != m_file.size())) {
+			errMsg = "failed reading block index";
+			throw (-3);
+		}
+
+		// first block of each tile, rising up to the number of blocks
+		m_tileFirst.resize(nTiles + 1);
+		memcpy(m_tileFirst.data(), m_file.data() + footer.IndexOffset + footer.BlockCount * _EVENT_FILE_TILE_BLOCK_SIZE,
+			m_tileFirst.size() * sizeof(uint32_t));
+		if ((m_tileFirst[0] != 0) || (m_tileFirst[nTiles] != footer.BlockCount)
+			|| !std::is_sorted(m_tileFirst.begin(), m_tileFirst.end())) {
+			errMsg = "invalid tile table";
+			throw (-4);
+		}
+
+		std::vector<_EVENT_FILE_TILE_BLOCK> index(footer.BlockCount);
+		memcpy(index.data(), m_file.data() + footer.IndexOffset, index.size() * _EVENT_FILE_TILE_BLOCK_SIZE);
+		m_blocks.reserve(index.size());
+		uint64_t nEvents = 0;
+		for (size_t k = 0; k < nTiles; k++) {
+			for (uint32_t b = m_tileFirst[k]; b < m_tileFirst[k + 1]; b++) {
+				const _EVENT_FILE_TILE_BLOCK& entry = index[b];
+				if ((entry.Tile != k) || (entry.Offset % 8 != 0)
+					|| (entry.Offset + entry.EventCount * 13ULL > footer.IndexOffset)
+					|| (entry.TimeLast < entry.TimeFirst)
+					|| ((b > m_tileFirst[k]) && (entry.TimeFirst / footer.BlockUSec < m_blocks.back().timeFirst / footer.BlockUSec))) {
+					errMsg = "invalid block index";
+					throw (-5);
+				}
+				BlockEntry block;
+				block.offset = entry.Offset;
+				block.firstEvent = entry.FirstEvent;
+				block.timeFirst = entry.TimeFirst;
+				block.timeLast = entry.TimeLast;
+				block.nEvents = entry.EventCount;
+				m_blocks.push_back(block);
+				nEvents += entry.EventCount;
+			}
+		}
+		if (nEvents != hdr.EventCount) {
+			errMsg = "event count does not match the block index";
+			throw (-6);
+		}
+		m_tileW = footer.TileW;
+		m_tileH = footer.TileH;
+		m_tilesX = footer.TilesX;
+		m_tilesY = footer.TilesY;
+		m_blockUSec = footer.BlockUSec;
+		m_nEvents = hdr.EventCount;
+		m_duration = (static_cast<uint64_t>(hdr.DurationHigh) << 32) | hdr.Duration;
+		m_camSpecs.sensorW = hdr.cols;
+		m_camSpecs.sensorH = hdr.rows;
+		m_timeStamp = hdr.TimeStamp;
+	}
+	catch (int errCode)
+	{
+		std::cerr << "ERROR(" << errCode << "): EBI::TiledEventData::open() " << errMsg << std::endl;
+		close();
+		return false;
+	}
+	if (m_nDebugLevel > 0)
+		std::cout << "EBI::TiledEventData::open('" << fnameEvents << "') - " << m_nEvents << " events in "
+			<< m_blocks.size() << " blocks of " << m_tilesX << " x " << m_tilesY << " tiles" << std::endl;
+	return true;
+}
+
+/*!
+\return numbers of the tiles overlapping the region (\a x, \a y, \a w, \a h), in row-major order
+*/
+std::vector<uint32_t> EBI::TiledEventData::tiles(
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h) const
+{
+	std::vector<uint32_t> result;
+	if (!isOpen() || (w <= 0) || (h <= 0) || (x + w <= 0) || (y + h <= 0))
+		return result;
+	// events beyond the last tile are stored in it
+	const uint32_t tx1 = std::min(static_cast<uint32_t>(std::max(x, 0)) / m_tileW, m_tilesX - 1);
+	const uint32_t tx2 = std::min(static_cast<uint32_t>(x + w - 1) / m_tileW, m_tilesX - 1);
+	const uint32_t ty1 = std::min(static_cast<uint32_t>(std::max(y, 0)) / m_tileH, m_tilesY - 1);
+	const uint32_t ty2 = std::min(static_cast<uint32_t>(y + h - 1) / m_tileH, m_tilesY - 1);
+	for (uint32_t ty = ty1; ty <= ty2; ty++) {
+		for (uint32_t tx = tx1; tx <= tx2; tx++)
+			result.push_back(ty * m_tilesX + tx);
+	}
+	return result;
+}
+
+/*!
+Append the events of \a tiles with time in [\a tSel1, \a tSel2] within [\a x1, \a x2) x [\a y1, \a y2)
+to \a events, coordinates relative to (\a x1, \a y1) and times relative to \a tOffset, in order of the file.
+Only the blocks of the tiles overlapping the time window are read, found by binary search.
+*/
+void EBI::TiledEventData::select(const std::vector<uint32_t>& tiles, const uint64_t tSel1, const uint64_t tSel2,
+	const int32_t x1, const int32_t y1, const int32_t x2, const int32_t y2,
+	const uint64_t tOffset, std::vector<EBI::Event>& events) const
+{
+	std::vector<std::pair<uint64_t, EBI::Event> > selected;	// number in the file and event
+	const uint64_t key1 = tSel1 / m_blockUSec;
+	const uint64_t key2 = tSel2 / m_blockUSec;
+	uint64_t nBytes = 0;
+	bool bOrdered = true;
+	for (const uint32_t tile : tiles) {
+		if (tile + 1 >= m_tileFirst.size())
+			continue;
+		const BlockEntry* pFirst = m_blocks.data() + m_tileFirst[tile];
+		const BlockEntry* pEnd = m_blocks.data() + m_tileFirst[tile + 1];
+		const BlockEntry* pBlock = std::lower_bound(pFirst, pEnd, key1,
+			[this](const BlockEntry& block, const uint64_t key) { return block.timeFirst / m_blockUSec < key; });
+		for (; (pBlock < pEnd) && (pBlock->timeFirst / m_blockUSec <= key2); pBlock++) {
+			if ((pBlock->timeLast < tSel1) || (pBlock->timeFirst > tSel2))
+				continue;
+			const size_t n = pBlock->nEvents;
+			const uint8_t* pData = m_file.data() + pBlock->offset;
+			const uint32_t* pT = reinterpret_cast<const uint32_t*>(pData);
+			const uint32_t* pN = pT + n;
+			const uint16_t* pX = reinterpret_cast<const uint16_t*>(pN + n);
+			const uint16_t* pY = pX + n;
+			const uint8_t* pP = reinterpret_cast<const uint8_t*>(pY + n);
+			nBytes += n * 13;
+			if (!selected.empty() && (pBlock->firstEvent < selected.back().first))
+				bOrdered = false;
+			for (size_t i = 0; i < n; i++) {
+				const uint64_t t = pBlock->timeFirst + pT[i];
+				if ((t < tSel1) || (t > tSel2) || (pX[i] < x1) || (pX[i] >= x2) || (pY[i] < y1) || (pY[i] >= y2))
+					continue;
+				EBI::Event ev;
+				ev.t = static_cast<uint32_t>(t - tOffset);
+				ev.x = static_cast<uint16_t>(pX[i] - x1);
+				ev.y = static_cast<uint16_t>(pY[i] - y1);
+				ev.p = static_cast<int8_t>(pP[i]);
+				selected.push_back(std::make_pair(pBlock->firstEvent + pN[i], ev));
+			}
+		}
+	}
+	m_nBytesRead += nBytes;
+
+	// events of several tiles or time blocks are merged into the order of the file
+	if (!bOrdered)
+		std::sort(selected.begin(), selected.end(),
+			[](const std::pair<uint64_t, EBI::Event>& a, const std::pair<uint64_t, EBI::Event>& b) { return a.first < b.first; });
+	events.reserve(events.size() + selected.size());
+	for (const std::pair<uint64_t, EBI::Event>& entry : selected)
+		events.push_back(entry.second);
+}
+
+/*!
+Events of \a tiles in [t0, t0 + dur), all times for \a dur = 0, in order of the file.
+Times are relative to \a t0, coordinates stay relative to the image.
+*/
+std::vector<EBI::Event> EBI::TiledEventData::getTiles(
+	const std::vector<uint32_t>& tiles,
+	const int64_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for all times
+) const
+{
+	std::vector<EBI::Event> events;
+	if (!isOpen() || (m_nEvents == 0))
+		return events;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	const uint64_t tSel1 = (durationUSec == 0) ? 0 : t1;
+	const uint64_t tSel2 = (durationUSec == 0) ? m_duration : (t1 + static_cast<uint32_t>(durationUSec) - 1);
+	select(tiles, tSel1, tSel2, 0, 0, INT32_MAX, INT32_MAX, t1, events);
+	return events;
+}
+
+/*!
+Events in ROI (\a x, \a y, \a w, \a h) and time window [t0, t0 + dur), coordinates relative to
+the ROI and times relative to \a t0, same as EventData::getSample() of the saved data.
+Reads only the blocks of the tiles overlapping the ROI.
+*/
+std::vector<EBI::Event> EBI::TiledEventData::getSample(
+	const int32_t x, const int32_t y,
+	const int32_t w, const int32_t h,
+	const int64_t offsetUSec,	//!< offset from start in [usec]
+	const int32_t durationUSec	//!< duration in [usec], 0 for all times
+) const
+{
+	std::vector<EBI::Event> sample;
+	if (!isOpen() || (m_nEvents == 0))
+		return sample;
+	const uint64_t t1 = static_cast<uint64_t>(offsetUSec);
+	const uint64_t tSel1 = (durationUSec == 0) ? 0 : t1;
+	const uint64_t tSel2 = (durationUSec == 0) ? m_duration : (t1 + static_cast<uint32_t>(durationUSec) - 1);
+	select(tiles(x, y, w, h), tSel1, tSel2, x, y, x + w, y + h, t1, sample);
+	return sample;
+}
+
+/*!
+Sample the data set in each of \a windows, same as getSample() for each window.
+Windows are sampled on setThreadCount() threads, each reading only the tiles of its window.
+*/
+std::vector<std::vector<EBI::Event> > EBI::TiledEventData::getSamples(
+	const std::vector<EBI::SampleWindow>& windows) const
+{
+	std::vector<std::vector<EBI::Event> > samples(windows.size());
+	EBI::ParallelFor(windows.size(), EBI::ThreadCount(m_nThreads), [&](const size_t k) {
+		const EBI::SampleWindow& win = windows[k];
+		samples[k] = getSample(win.x, win.y, win.w, win.h, win.t0, win.dur);
+	});
+	return samples;
+}
@@ -1,11 +1,25 @@
 #include "ebi.h"
+#include "ebi_file.h"
+#include "ebi_evtfile.h"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cmath>
 
 #ifdef _WIN32
 #include <io.h>   // For access().
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+#include <windows.h>	// For CreateFileMapping().
+#else
+#include <fcntl.h>		// For open().
+#include <unistd.h>		// For close().
+#include <sys/mman.h>	// For mmap().
 #endif
 #include <sys/types.h>  // For stat().
 #include <sys/stat.h>   // For stat().
@@ -60,6 +74,20 @@ EBI::FileFormat EBI::GetFileType(const std::string& fnIN)
 		std::cerr << "ERROR: failed opening file: '" << fnIN << "'" << std::endl;
 		return EBI::FILE_FORMAT_UNKNOWN;
 	}
+	// own event files start with their signature
+	int32_t signature = 0;
+	inFile.read(reinterpret_cast<char*>(&signature), sizeof(signature));
+	if (inFile && (signature == _EVENT_FILE_SIGNATURE))
+		return EBI::FILE_FORMAT_EVT3;
+	if (inFile && (signature == _EVENT_FILE_BLOCKS_SIGNATURE))
+		return EBI::FILE_FORMAT_EVT4;
+	if (inFile && (signature == _EVENT_FILE_CODED_SIGNATURE))
+		return EBI::FILE_FORMAT_EVTZ;
+	if (inFile && (signature == _EVENT_FILE_TILES_SIGNATURE))
+		return EBI::FILE_FORMAT_EVTT;
+	inFile.clear();
+	inFile.seekg(0, std::ios::beg);
+
 	// Read the header of the input file, if present :
 	int line_first_char = inFile.peek();
 
@@ -178,6 +206,150 @@ bool EBI::CheckDirectoryExistence(const std::string& dirIN)
 	return false;
 }
 
+EBI::MappedFile::MappedFile()
+{
+	m_pData = nullptr;
+	m_nSize = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = nullptr;
+#else
+	m_fd = -1;
+#endif
+}
+
+EBI::MappedFile::~MappedFile()
+{
+	close();
+}
+
+/*!
+Map complete file \a fname into memory for reading
+\return true on success, false if file could not be opened or mapped (e.g. empty file, 
+address space exhausted on 32-bit systems)
+*/
+bool EBI::MappedFile::open(const std::string& fname, const AccessHint eHint)
+{
+	close();
+#ifdef _WIN32
+	DWORD dwFlags = FILE_ATTRIBUTE_NORMAL;
+	if (eHint == AccessSequential)
+		dwFlags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if (eHint == AccessRandom)
+		dwFlags |= FILE_FLAG_RANDOM_ACCESS;
+	HANDLE hFile = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, dwFlags, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || (fileSize.QuadPart == 0)
+		|| (static_cast<uint64_t>(fileSize.QuadPart) > static_cast<uint64_t>(SIZE_MAX))) {
+		CloseHandle(hFile);
+		return false;
+	}
+	HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == NULL) {
+		CloseHandle(hFile);
+		return false;
+	}
+	void* ptr = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (ptr == NULL) {
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_nSize = static_cast<uint64_t>(fileSize.QuadPart);
+	m_pData = static_cast<const uint8_t*>(ptr);
+#else
+	int fd = ::open(fname.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat status;
+	if ((fstat(fd, &status) != 0) || (status.st_size <= 0)
+		|| (static_cast<uint64_t>(status.st_size) > static_cast<uint64_t>(SIZE_MAX))) {
+		::close(fd);
+		return false;
+	}
+	void* ptr = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED) {
+		::close(fd);
+		return false;
+	}
+	m_fd = fd;
+	m_nSize = static_cast<uint64_t>(status.st_size);
+	m_pData = static_cast<const uint8_t*>(ptr);
+	advise(eHint);
+#endif
+	return true;
+}
+
+void EBI::MappedFile::close()
+{
+#ifdef _WIN32
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(m_hFile);
+	m_hMapping = nullptr;
+	m_hFile = INVALID_HANDLE_VALUE;
+#else
+	if (m_pData)
+		munmap(const_cast<uint8_t*>(m_pData), static_cast<size_t>(m_nSize));
+	if (m_fd >= 0)
+		::close(m_fd);
+	m_fd = -1;
+#endif
+	m_pData = nullptr;
+	m_nSize = 0;
+}
+
+/*!
+Pass expected access pattern on to the kernel's read-ahead (POSIX only, 
+on Windows the hint is given when opening the file)
+*/
+void EBI::MappedFile::advise(const AccessHint eHint)
+{
+#ifndef _WIN32
+	if (!m_pData)
+		return;
+	int advice = MADV_NORMAL;
+	if (eHint == AccessSequential)
+		advice = MADV_SEQUENTIAL;
+	else if (eHint == AccessRandom)
+		advice = MADV_RANDOM;
+	madvise(const_cast<uint8_t*>(m_pData), static_cast<size_t>(m_nSize), advice);
+#else
+	(void)eHint;
+#endif
+}
+
+/*!
+Drop pages of range [offset, offset+length) that are no longer needed from the
+resident set. Keeps memory pressure low when streaming through very large files.
+*/
+void EBI::MappedFile::release(const uint64_t offset, const uint64_t length)
+{
+	if (!m_pData || (offset >= m_nSize))
+		return;
+	uint64_t nEnd = offset + length;
+	if (nEnd > m_nSize)
+		nEnd = m_nSize;
+#ifdef _WIN32
+	VirtualUnlock(const_cast<uint8_t*>(m_pData + offset), static_cast<SIZE_T>(nEnd - offset));
+#else
+	// madvise() requires page aligned ranges, only release complete pages
+	const uint64_t nPageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+	uint64_t nStart = ((offset + nPageSize - 1) / nPageSize) * nPageSize;
+	nEnd = (nEnd / nPageSize) * nPageSize;
+	if (nEnd > nStart)
+		madvise(const_cast<uint8_t*>(m_pData + nStart), static_cast<size_t>(nEnd - nStart), MADV_DONTNEED);
+#endif
+}
+
 std::string EBI::FileBaseName(const std::string& sIN)
 {
 	std::string::size_type i = sIN.rfind('.', sIN.length());
@@ -220,6 +392,24 @@ std::string EBI::FileReplaceExtension(const std::string& sIN, const std::string&
 	return sOUT;
 }
 
+/*!
+Sub-volumes sampled by the flow evaluation: windows of sampleX x sampleY pixels and sampleTime
+on a grid of stepX, stepY and stepTime, all within the image and within [\a tStart, \a tEnd].
+Windows are ordered by time, then row, then column.
+*/
+std::vector<EBI::SampleWindow> EBI::FlowSampleWindows(const EBI::EventFlowEvalParams& params,
+	const int64_t tStart, const int64_t tEnd)
+{
+	std::vector<EBI::SampleWindow> windows;
+	if ((params.stepX <= 0) || (params.stepY <= 0) || (params.stepTime <= 0))
+		return windows;
+	for (int64_t t0 = tStart; t0 + params.sampleTime <= tEnd; t0 += params.stepTime)
+		for (int32_t y = 0; y + params.sampleY <= params.imgH; y += params.stepY)
+			for (int32_t x = 0; x + params.sampleX <= params.imgW; x += params.stepX)
+				windows.push_back(EBI::SampleWindow(x, y, params.sampleX, params.sampleY, t0, params.sampleTime));
+	return windows;
+}
+
 /*!
 Determine mean histogram of events over specified number of periods.
 The data is referenced to the beginning of the event record (t=0), so the pulse
@@ -228,7 +418,28 @@ is not necessarily centered within the period.
 \return Vector of histogram entries (mean counts) in events per microsecond
 */
 std::vector<double> EBI::MeanPulseHistogram(
-	EBI::EventData& evData, 	//!< input data
+	const EBI::EventData& evData, 	//!< input data
+	const double freqInHz,
+	const int32_t nBinWidthInMicrosec,
+	const int32_t nPeriods,		//!< number of periods to sample
+	const int32_t nStartPeriod, //!< at which period to begin sampling
+	const int32_t nDebug		//!< enables debugging output
+	)
+{
+	double period = 1e6 / freqInHz;
+	int32_t t0 = int32_t(period * nStartPeriod);	// start on some time into data set
+	int32_t sampleTime = int32_t(nPeriods * period);
+	// get N samples without copying, keeping the times of the record
+	EBI::EventView evSlab(evData, EBI::EventPolarity::PolarityPositive, t0, sampleTime, false); // use only positive events
+	return EBI::MeanPulseHistogram(evSlab, freqInHz, nBinWidthInMicrosec, nPeriods, nStartPeriod, nDebug);
+}
+
+/*!
+Mean histogram of the events selected by \a evData, same as for EBI::EventData
+with the times relative to the view
+*/
+std::vector<double> EBI::MeanPulseHistogram(
+	const EBI::EventView& evData, 	//!< input data
 	const double freqInHz,
 	const int32_t nBinWidthInMicrosec,
 	const int32_t nPeriods,		//!< number of periods to sample
@@ -244,24 +455,23 @@ std::vector<double> EBI::MeanPulseHistogram(
 		histData[i] = 0;
 	int32_t t0 = int32_t(period * nStartPeriod);	// start on some time into data set
 	int32_t sampleTime = int32_t(nPeriods * period);
-	// get N samples
-	EBI::EventData evSlab(evData, EBI::EventPolarity::PolarityPositive, t0, sampleTime); // use only positive events
-
-	EBI::Event ev0 = evSlab.data()[0];
-	EBI::Event evN = evSlab.data().back();
+	const uint32_t t1 = static_cast<uint32_t>(t0);
+	const uint32_t t2 = t1 + static_cast<uint32_t>(sampleTime);
+
+	uint64_t nEvents = 0;
+	uint32_t tFirst = 0, tLast = 0;
+	for (const EBI::Event& evIn : evData) {
+		if (!evData.contains(evIn) || (evIn.p <= 0))	// use only positive events
+			continue;
+		const EBI::Event ev = evData.relative(evIn);
+		if ((ev.t < t1) || (ev.t > t2))
+			continue;
+		if (nEvents++ == 0)
+			tFirst = ev.t;
+		tLast = ev.t;
 
-	if (nDebug>0)
-		std::cout << "Subset of events starting at " << t0 << " usec" << std::endl
-			<< "event count  " << evSlab.data().size() << std::endl
-			<< "first event  " << ev0.t << " usec" << std::endl
-			<< "last event   " << evN.t << " usec" << std::endl
-			<< "frequency    " << freqInHz << " Hz" << std::endl
-			<< "period       " << period << " usec" << std::endl
-			<< "bin width    " << nBinWidthInMicrosec << " usec" << std::endl
-			<< "start time   " << t0 << " usec" << std::endl;
-	for (EBI::Event ev : evSlab.data()) {
 		// find remainder
-		double curTime = ev.t + t0;
+		double curTime = ev.t;
 		double relTime = floor(curTime / period);
 		double rem = floor(curTime - (relTime * period));
 
@@ -272,6 +482,16 @@ std::vector<double> EBI::MeanPulseHistogram(
 		}
 	}
 
+	if (nDebug>0)
+		std::cout << "Subset of events starting at " << t0 << " usec" << std::endl
+			<< "event count  " << nEvents << std::endl
+			<< "first event  " << (tFirst - t1) << " usec" << std::endl
+			<< "last event   " << (tLast - t1) << " usec" << std::endl
+			<< "frequency    " << freqInHz << " Hz" << std::endl
+			<< "period       " << period << " usec" << std::endl
+			<< "bin width    " << nBinWidthInMicrosec << " usec" << std::endl
+			<< "start time   " << t0 << " usec" << std::endl;
+
 	// normalize to get events/microsecond
 	for (size_t i = 0; i < histData.size(); i++) {
 		histData[i] /= (nPeriods * nBinWidthInMicrosec);
@@ -291,22 +511,12 @@ std::vector<double> EBI::MeanPulseHistogram(
 }
 
 /*!
-Determine optimal sampling time-offset to capture events generated by pulsed illumination
-at fixed frequency \a freq
+Optimal sampling time-offset from mean pulse histogram \a histData with bins of \a nBinWidth
 \return offset-time in [usec]
 */
-int32_t EBI::DetermineOffsetTime(
-	EBI::EventData& evData,		//!< input data
-	const double freqInHz,		//!< sampling frequency = light pulsing frequency
-	const int32_t nBinWidth,	//!< in [usec]
-	const int32_t nPeriods,		//!< number of periods to sample
-	const int32_t nStartPeriod,	//!< at which period to begin sampling
-	const int32_t nDebug		//!< enables debugging output
-)
+static int32_t _offsetTimeFromHistogram(const std::vector<double>& histData,
+	const int32_t nBinWidth, const int32_t nDebug)
 {
-	std::vector<double> histData = EBI::MeanPulseHistogram(
-		evData, freqInHz, nBinWidth, nPeriods, nDebug);
-
 	int32_t bestStartTime = 0;
 	int32_t maxIdx = 0;
 	int32_t szHist = static_cast<int>(histData.size());
@@ -342,3 +552,39 @@ int32_t EBI::DetermineOffsetTime(
 
 	return static_cast<int32_t>(bestStartTime);
 }
+
+/*!
+Determine optimal sampling time-offset to capture events generated by pulsed illumination
+at fixed frequency \a freq
+\return offset-time in [usec]
+*/
+int32_t EBI::DetermineOffsetTime(
+	const EBI::EventData& evData,	//!< input data
+	const double freqInHz,		//!< sampling frequency = light pulsing frequency
+	const int32_t nBinWidth,	//!< in [usec]
+	const int32_t nPeriods,		//!< number of periods to sample
+	const int32_t nStartPeriod,	//!< at which period to begin sampling
+	const int32_t nDebug		//!< enables debugging output
+)
+{
+	std::vector<double> histData = EBI::MeanPulseHistogram(
+		evData, freqInHz, nBinWidth, nPeriods, nDebug);
+	return _offsetTimeFromHistogram(histData, nBinWidth, nDebug);
+}
+
+/*!
+Optimal sampling time-offset for the events selected by \a evData, see DetermineOffsetTime() for EBI::EventData
+*/
+int32_t EBI::DetermineOffsetTime(
+	const EBI::EventView& evData,	//!< input data
+	const double freqInHz,		//!< sampling frequency = light pulsing frequency
+	const int32_t nBinWidth,	//!< in [usec]
+	const int32_t nPeriods,		//!< number of periods to sample
+	const int32_t nStartPeriod,	//!< at which period to begin sampling
+	const int32_t nDebug		//!< enables debugging output
+)
+{
+	std::vector<double> histData = EBI::MeanPulseHistogram(
+		evData, freqInHz, nBinWidth, nPeriods, nDebug);
+	return _offsetTimeFromHistogram(histData, nBinWidth, nDebug);
+}
@@ -0,0 +1,1407 @@
+/*
+Benchmarks of the EBI library
+
+Compile (from directory pyebiv):
+	Linux:   g++ -std=c++14 -O2 -pthread -Iinclude tools/ebiv_bench.cpp src/ebi_*.cpp -o ebiv_bench
+	Windows: cl /std:c++14 /O2 /EHsc /Iinclude tools\ebiv_bench.cpp src\ebi_*.cpp
+
+Usage:
+	ebiv_bench vector [million words] [bits per vector word]
+		expansion of VECT_12 / VECT_8 validity masks for each kernel
+	ebiv_bench generate <file.raw> [scene options]
+		write a synthetic Metavision RAW file (EVT 3.0)
+	ebiv_bench decode [file.raw] [scene options] [--runs n]
+		load the file in each decode mode and report throughput, a synthetic
+		file ebiv_bench.raw is generated if no file is given
+	ebiv_bench follow [file.raw] [scene options] [--timeout ms]
+		decode a file while it is being written, e.g. by "generate --realtime 1"
+		in another process; without a file a writer thread records ebiv_follow.raw
+		and the delivery latency is reported
+	ebiv_bench columns [file.raw] [scene options] [--runs n]
+		load into EBI::EventData, EBI::EventColumns and EBI::PackedEventData and
+		compare time window, ROI and polarity filters of all layouts
+	ebiv_bench samples [file.raw] [scene options] [--runs n]
+		sample a grid of sub-volumes as the flow evaluation does, scanning the
+		time window of each versus EBI::EventData::getSamples() with a tile index
+	ebiv_bench paged [file.raw] [scene options] [--cache MB]
+		sample the flow grid over the whole recording and copy time windows from
+		EBI::PagedEventData with a small block cache, results must equal those of
+		EBI::EventData loaded into memory
+	ebiv_bench save [file.raw] [scene options] [--runs n]
+		save the events as EVT file in chunks versus one write per event as before,
+		for all events and for a view with ROI and polarity; files must be identical
+	ebiv_bench load [file.raw] [scene options] [--runs n]
+		save the events as EVT3 and EVT4 file, then load each entirely and in windows
+		of 10 ms spread over the recording; windows must equal those copied in memory
+	ebiv_bench codec [file.raw] [scene options] [--runs n]
+		save the events as EVT4 and compressed EVTZ file and load them again, for
+		the events of the file and for the same times with moving edges as real
+		recordings have; report compression ratio and throughput
+	ebiv_bench tiled [file.raw] [scene options] [--runs n]
+		save the events as tiled EVTT file for the flow grid and sample the grid over
+		the whole recording from EBI::TiledEventData on all cores, results must equal
+		EBI::EventData::getSamples(); report the bytes each window reads
+	ebiv_bench select [file.raw] [scene options] [--runs n]
+		time the selections of EBI::EventData on 1, 2, 4, ... threads up to all cores,
+		results must not depend on the number of threads
+	ebiv_bench alloc [file.raw] [scene options]
+		count heap allocations of copy, filter and access methods of EBI::EventData,
+		fails if an operation into a reused instance allocates more than expected
+
+Scene options:
+	--geometry 640x480|1280x720	detector size (640x480)
+	--rate r		event rate in [MEv/s] (10)
+	--vector f		fraction of events sent as vector words (0.5)
+	--trigger f		trigger rate in [Hz] (1000)
+	--duration s	recording length in [s] (10)
+	--t0 t			sensor time of first word in [usec], default is 0.5 s before a time high loop
+	--realtime 1	write the file at the pace of the recording
+*/
+#include "ebi.h"
+#include "ebi_rawevt3.h"
+#include "ebi_columns.h"
+#include "ebi_packed.h"
+#include "ebi_paged.h"
+#include "ebi_tiled.h"
+#include "ebi_image.h"
+#include "ebi_evtfile.h"
+#include "ebi_parallel.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// all heap allocations of the process are counted for "ebiv_bench alloc", every form of
+// operator new and delete is replaced, so that each allocation is released by its counterpart
+static std::atomic<uint64_t> g_nAllocs(0);
+
+#ifdef _MSC_VER
+#define EBI_BENCH_NOINLINE __declspec(noinline)
+#else
+#define EBI_BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+static void* _allocCounted(const size_t nBytes) noexcept
+{
+	g_nAllocs++;
+	return std::malloc(nBytes > 0 ? nBytes : 1);
+}
+// not inlined, so the compiler does not take free() as release of memory from operator new
+static EBI_BENCH_NOINLINE void _freeCounted(void* p) noexcept
+{
+	std::free(p);
+}
+
+void* operator new(size_t nBytes)
+{
+	if (void* p = _allocCounted(nBytes))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t nBytes)
+{
+	if (void* p = _allocCounted(nBytes))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new(size_t nBytes, const std::nothrow_t&) noexcept { return _allocCounted(nBytes); }
+void* operator new[](size_t nBytes, const std::nothrow_t&) noexcept { return _allocCounted(nBytes); }
+void operator delete(void* p) noexcept { _freeCounted(p); }
+void operator delete[](void* p) noexcept { _freeCounted(p); }
+void operator delete(void* p, size_t) noexcept { _freeCounted(p); }
+void operator delete[](void* p, size_t) noexcept { _freeCounted(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { _freeCounted(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { _freeCounted(p); }
+
+#ifdef __cpp_aligned_new
+// over-aligned types of C++17
+static void* _allocCountedAligned(const size_t nBytes, const std::align_val_t align) noexcept
+{
+	g_nAllocs++;
+	const size_t nAlign = std::max(static_cast<size_t>(align), sizeof(void*));
+	void* p = nullptr;
+#ifdef _WIN32
+	p = _aligned_malloc(nBytes > 0 ? nBytes : 1, nAlign);
+#else
+	if (posix_memalign(&p, nAlign, nBytes > 0 ? nBytes : 1) != 0)
+		p = nullptr;
+#endif
+	return p;
+}
+static EBI_BENCH_NOINLINE void _freeCountedAligned(void* p) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void* operator new(size_t nBytes, std::align_val_t align)
+{
+	if (void* p = _allocCountedAligned(nBytes, align))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t nBytes, std::align_val_t align)
+{
+	if (void* p = _allocCountedAligned(nBytes, align))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new(size_t nBytes, std::align_val_t align, const std::nothrow_t&) noexcept { return _allocCountedAligned(nBytes, align); }
+void* operator new[](size_t nBytes, std::align_val_t align, const std::nothrow_t&) noexcept { return _allocCountedAligned(nBytes, align); }
+void operator delete(void* p, std::align_val_t) noexcept { _freeCountedAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { _freeCountedAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { _freeCountedAligned(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { _freeCountedAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { _freeCountedAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { _freeCountedAligned(p); }
+#endif
+
+static const char* _kernelName(const EBI::RawVectorKernel kernel)
+{
+	switch (kernel) {
+	case EBI::RawVectorBitwise: return "bitwise";
+	case EBI::RawVectorScalar: return "scalar";
+	case EBI::RawVectorSSE2: return "SSE2";
+	case EBI::RawVectorAVX2: return "AVX2";
+	default: return "auto";
+	}
+}
+
+static inline uint16_t _word(const Metavision::Evt3::EventTypes type, const uint32_t val)
+{
+	return static_cast<uint16_t>((static_cast<uint32_t>(type) << 12) | (val & 0xFFF));
+}
+
+/*!
+Raw EVT3 words of a densely seeded 1280x720 scene: rows of vector words with
+\a nBitsPerWord valid bits on average, a new time low word every row
+*/
+static std::vector<uint16_t> _makeVectorWords(const uint64_t nWords, const int nBitsPerWord)
+{
+	std::vector<uint16_t> words;
+	words.reserve(nWords + 64);
+	std::mt19937 rng(4711);
+	std::bernoulli_distribution bit(nBitsPerWord / 12.0);
+	uint32_t t = 0;
+	words.push_back(_word(Metavision::Evt3::EventTypes::EVT_TIME_HIGH, 0));
+	while (words.size() < nWords) {
+		t += 1;
+		if ((t & 0xFFF) == 0)
+			words.push_back(_word(Metavision::Evt3::EventTypes::EVT_TIME_HIGH, t >> 12));
+		words.push_back(_word(Metavision::Evt3::EventTypes::EVT_TIME_LOW, t));
+		words.push_back(_word(Metavision::Evt3::EventTypes::EVT_ADDR_Y, rng() % 720));
+		uint32_t x = rng() % 1000;
+		words.push_back(_word(Metavision::Evt3::EventTypes::VECT_BASE_X, x | ((t & 0x1) << 11)));
+		for (int nVect = 0; nVect < 20; nVect++) {
+			uint32_t valid = 0;
+			for (int i = 0; i < 12; i++)
+				valid |= (bit(rng) ? 1 : 0) << i;
+			if (nVect == 19)
+				words.push_back(_word(Metavision::Evt3::EventTypes::VECT_8, valid & 0xFF));
+			else
+				words.push_back(_word(Metavision::Evt3::EventTypes::VECT_12, valid));
+		}
+	}
+	words.resize(nWords);
+	return words;
+}
+
+static int _benchVector(const uint64_t nWords, const int nBitsPerWord)
+{
+	std::vector<uint16_t> words = _makeVectorWords(nWords, nBitsPerWord);
+	std::cout << "Vector expansion: " << nWords << " words, " << nBitsPerWord
+		<< " of 12 bits valid on average" << std::endl;
+
+	const EBI::RawVectorKernel kernels[] = { EBI::RawVectorBitwise, EBI::RawVectorScalar,
+		EBI::RawVectorSSE2, EBI::RawVectorAVX2 };
+	std::vector<EBI::Event> evReference;
+	double refWordsPerSec = 0;
+	int retCode = 0;
+	for (const EBI::RawVectorKernel kernel : kernels) {
+		if (EBI::GetRawVectorKernel(kernel) != kernel) {
+			std::cout << std::setw(10) << _kernelName(kernel) << ": not supported by CPU" << std::endl;
+			continue;
+		}
+		// storage is kept between the runs, so page faults are not part of the timing
+		double bestSec = 1e30;
+		std::vector<EBI::Event> evData;
+		std::vector<EBI::TriggerEvent> evTrigger;
+		bool bCount = true;
+		for (int nRun = 0; nRun < 5; nRun++) {
+			evData.clear();
+			evTrigger.clear();
+			EBI::Evt3DecoderState state;
+			state.sensorW = 1280;
+			state.sensorH = 720;
+			uint64_t timeStamp = 0;
+			// decoded in two parts, the second one appends to the events of the first
+			const size_t nHalf = words.size() / 2;
+			auto t0 = std::chrono::steady_clock::now();
+			const uint64_t nFirst = EBI::DecodeRawEvt3Words(reinterpret_cast<const uint8_t*>(words.data()), nHalf,
+				state, evData, evTrigger, timeStamp, kernel);
+			const size_t nSizeFirst = evData.size();
+			const uint64_t nSecond = EBI::DecodeRawEvt3Words(reinterpret_cast<const uint8_t*>(words.data() + nHalf),
+				words.size() - nHalf, state, evData, evTrigger, timeStamp, kernel);
+			double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			if ((nFirst != nSizeFirst) || (nSecond != evData.size() - nSizeFirst))
+				bCount = false;
+			if (sec < bestSec)
+				bestSec = sec;
+		}
+		double wordsPerSec = nWords / bestSec;
+		if (kernel == EBI::RawVectorBitwise) {
+			refWordsPerSec = wordsPerSec;
+			evReference.swap(evData);
+		}
+		bool bSame = (kernel == EBI::RawVectorBitwise) || ((evData.size() == evReference.size()) &&
+			std::equal(evData.begin(), evData.end(), evReference.begin(),
+				[](const EBI::Event& a, const EBI::Event& b) {
+					return (a.t == b.t) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p); }));
+		if (!bSame || !bCount)
+			retCode = 1;
+		std::cout << std::setw(10) << _kernelName(kernel) << ": "
+			<< std::fixed << std::setprecision(1) << std::setw(8) << wordsPerSec * 1e-6 << " Mwords/s "
+			<< std::setw(8) << (kernel == EBI::RawVectorBitwise ? evReference.size() : evData.size()) / bestSec * 1e-6 << " MEv/s "
+			<< std::setprecision(2) << " x" << wordsPerSec / refWordsPerSec
+			<< (bSame ? "" : "  MISMATCH") << (bCount ? "" : "  COUNT MISMATCH") << std::endl;
+	}
+	return retCode;
+}
+
+/*!
+Scene of a synthetic recording
+*/
+struct _SceneParams
+{
+	uint32_t sensorW, sensorH;
+	double eventRate;		//!< in [MEv/s]
+	double vectorRatio;		//!< fraction of events sent as VECT_12 words
+	double triggerRate;		//!< in [Hz]
+	double duration;		//!< in [s]
+	uint64_t t0;			//!< sensor time of the first word in [usec]
+	bool bRealtime;			//!< write at the pace of the recording, flushed each millisecond
+
+	_SceneParams()
+	{
+		sensorW = 640;
+		sensorH = 480;
+		eventRate = 10;
+		vectorRatio = 0.5;
+		triggerRate = 1000;
+		duration = 10;
+		t0 = (uint64_t(1) << 24) - 500000;
+		bRealtime = false;
+	}
+
+	//! parse options from argv[nFirst]..., \return false on unknown option
+	bool parse(int argc, char** argv, int nFirst)
+	{
+		for (int i = nFirst; i + 1 < argc; i += 2) {
+			std::string strKey = argv[i];
+			std::string strVal = argv[i + 1];
+			if (strKey == "--geometry") {
+				if (strVal == "1280x720") {
+					sensorW = 1280;
+					sensorH = 720;
+				}
+				else if (strVal == "640x480") {
+					sensorW = 640;
+					sensorH = 480;
+				}
+				else
+					return false;
+			}
+			else if (strKey == "--rate")
+				eventRate = atof(strVal.c_str());
+			else if (strKey == "--vector")
+				vectorRatio = atof(strVal.c_str());
+			else if (strKey == "--trigger")
+				triggerRate = atof(strVal.c_str());
+			else if (strKey == "--duration")
+				duration = atof(strVal.c_str());
+			else if (strKey == "--t0")
+				t0 = strtoull(strVal.c_str(), nullptr, 10);
+			else if (strKey == "--realtime")
+				bRealtime = (atoi(strVal.c_str()) != 0);
+			else if ((strKey != "--runs") && (strKey != "--timeout") && (strKey != "--cache"))
+				return false;
+		}
+		return true;
+	}
+};
+
+//! small and fast generator, the scene does not need statistical quality
+struct _XorShift
+{
+	uint64_t s;
+	_XorShift(const uint64_t seed) : s(seed) {}
+	inline uint32_t operator()()
+	{
+		s ^= s << 13;
+		s ^= s >> 7;
+		s ^= s << 17;
+		return static_cast<uint32_t>(s >> 16);
+	}
+	inline double uniform() { return (*this)() * (1.0 / 4294967296.0); }
+};
+
+/*!
+Write a synthetic RAW file: events are spread uniformly over the detector and in
+time, either as single events (EVT_ADDR_Y, EVT_ADDR_X) or in vector words
+(EVT_ADDR_Y, VECT_BASE_X, VECT_12). Trigger events alternate between rising
+and falling edge. The default start time makes the time high counter loop
+after 0.5 s.
+*/
+static bool _writeRawFile(const std::string& fname, const _SceneParams& scene,
+	uint64_t& nEvents, uint64_t& nTriggers, uint64_t& nWords)
+{
+	std::ofstream outFile(fname, std::ios::out | std::ios::binary);
+	if (!outFile.is_open()) {
+		std::cerr << "ERROR: failed opening file '" << fname << "' for writing" << std::endl;
+		return false;
+	}
+	outFile << "% date 2024-01-01 00:00:00\n"
+		<< "% evt 3.0\n"
+		<< "% format EVT3;height=" << scene.sensorH << ";width=" << scene.sensorW << "\n"
+		<< "% geometry " << scene.sensorW << "x" << scene.sensorH << "\n"
+		<< "% integrator_name ebiv_bench\n"
+		<< "% plugin_name synthetic\n"
+		<< "% serial_number 00000000\n"
+		<< "% end\n";
+	outFile.flush();
+
+	using Metavision::Evt3::EventTypes;
+	std::vector<uint16_t> words;
+	words.reserve(1 << 20);
+	_XorShift rng(4711);
+	nEvents = nTriggers = nWords = 0;
+	const uint64_t nDuration = static_cast<uint64_t>(scene.duration * 1e6);
+	const double eventsPerUSec = scene.eventRate;
+	const double triggersPerUSec = scene.triggerRate * 1e-6;
+	const uint32_t nMaxBase = scene.sensorW - 12;
+	double fEvents = 0, fTriggers = 0;
+	uint32_t nTimeHigh = UINT32_MAX;
+	int triggerValue = 0;
+	auto tStart = std::chrono::steady_clock::now();
+	for (uint64_t t = scene.t0; t < scene.t0 + nDuration; t++) {
+		if (scene.bRealtime && ((t - scene.t0) % 1000 == 0) && !words.empty()) {
+			outFile.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint16_t));
+			outFile.flush();
+			nWords += words.size();
+			words.clear();
+			std::this_thread::sleep_until(tStart + std::chrono::microseconds(t - scene.t0));
+		}
+		fEvents += eventsPerUSec;
+		fTriggers += triggersPerUSec;
+		if ((fEvents < 1) && (fTriggers < 1))
+			continue;
+		const uint32_t nHigh = static_cast<uint32_t>(t >> 12) & 0xFFF;
+		if (nHigh != nTimeHigh) {
+			words.push_back(_word(EventTypes::EVT_TIME_HIGH, nHigh));
+			nTimeHigh = nHigh;
+		}
+		words.push_back(_word(EventTypes::EVT_TIME_LOW, static_cast<uint32_t>(t)));
+		while (fEvents >= 1) {
+			const uint32_t pol = rng() & 0x1;
+			words.push_back(_word(EventTypes::EVT_ADDR_Y, rng() % scene.sensorH));
+			if ((fEvents >= 2) && (rng.uniform() < scene.vectorRatio)) {
+				// up to 12 events in one vector word
+				uint32_t nBits = 2 + rng() % 11;
+				if (nBits > fEvents)
+					nBits = static_cast<uint32_t>(fEvents);
+				uint32_t valid = 0;
+				for (uint32_t n = 0; n < nBits; ) {
+					const uint32_t bit = 1u << (rng() % 12);
+					if (!(valid & bit)) {
+						valid |= bit;
+						n++;
+					}
+				}
+				words.push_back(_word(EventTypes::VECT_BASE_X, (rng() % nMaxBase) | (pol << 11)));
+				words.push_back(_word(EventTypes::VECT_12, valid));
+				fEvents -= nBits;
+				nEvents += nBits;
+			}
+			else {
+				words.push_back(_word(EventTypes::EVT_ADDR_X, (rng() % scene.sensorW) | (pol << 11)));
+				fEvents -= 1;
+				nEvents++;
+			}
+		}
+		while (fTriggers >= 1) {
+			words.push_back(_word(EventTypes::EXT_TRIGGER, static_cast<uint32_t>(triggerValue)));
+			triggerValue ^= 1;
+			fTriggers -= 1;
+			nTriggers++;
+		}
+		if (words.size() >= (1 << 20) - 64) {
+			outFile.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint16_t));
+			nWords += words.size();
+			words.clear();
+		}
+	}
+	outFile.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint16_t));
+	nWords += words.size();
+	return static_cast<bool>(outFile);
+}
+
+static int _generate(const std::string& fname, const _SceneParams& scene)
+{
+	uint64_t nEvents, nTriggers, nWords;
+	auto t0 = std::chrono::steady_clock::now();
+	if (!_writeRawFile(fname, scene, nEvents, nTriggers, nWords))
+		return 1;
+	double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	std::cout << "Generated '" << fname << "': " << scene.sensorW << "x" << scene.sensorH << ", "
+		<< scene.duration << " s, " << nEvents << " events, " << nTriggers << " triggers, "
+		<< nWords * sizeof(uint16_t) / 1e6 << " MB in " << std::setprecision(3) << sec << " s" << std::endl;
+	return 0;
+}
+
+/*!
+Follow \a fname while it is written. Without \a bWriter the file is written by another
+process, otherwise a writer thread records the scene in real time and the delay between
+writing and delivery of the events is measured. Finally the followed events are compared
+with a load of the complete file.
+*/
+static int _benchFollow(const std::string& fname, const _SceneParams& scene, const bool bWriter,
+	const uint32_t timeoutMSec)
+{
+	std::thread writer;
+	uint64_t nGenEvents = 0, nGenTriggers = 0, nGenWords = 0;
+	bool bWriteOK = true;
+	auto tStart = std::chrono::steady_clock::now();
+	if (bWriter) {
+		remove(fname.c_str());
+		_SceneParams sceneRT = scene;
+		sceneRT.bRealtime = true;
+		writer = std::thread([&, sceneRT]() {
+			bWriteOK = _writeRawFile(fname, sceneRT, nGenEvents, nGenTriggers, nGenWords); });
+	}
+
+	// wait for header and first data
+	EBI::RawEventReader reader;
+	reader.setFollow(true);
+	while (!reader.open(fname)) {
+		if (std::chrono::steady_clock::now() - tStart > std::chrono::milliseconds(timeoutMSec)) {
+			std::cerr << "ERROR: no data in '" << fname << "' after " << timeoutMSec << " ms" << std::endl;
+			if (writer.joinable())
+				writer.join();
+			return 1;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	std::cout << "Following '" << fname << "' (" << reader.cameraSpecs().sensorW << "x"
+		<< reader.cameraSpecs().sensorH << ")" << std::endl;
+
+	std::vector<EBI::Event> evAll;
+	uint64_t nTriggers = 0, nBatches = 0;
+	double latencySum = 0, latencyMax = 0;
+	auto tReport = std::chrono::steady_clock::now();
+	reader.follow([&](const std::vector<EBI::Event>& ev, const std::vector<EBI::TriggerEvent>& evTrigger) {
+		auto tNow = std::chrono::steady_clock::now();
+		evAll.insert(evAll.end(), ev.begin(), ev.end());
+		nTriggers += evTrigger.size();
+		nBatches++;
+		if (bWriter && !ev.empty()) {
+			// writer reaches sensor time t at tStart + t
+			double latency = std::chrono::duration<double>(tNow - tStart).count() - ev.back().t * 1e-6;
+			latencySum += latency;
+			latencyMax = std::max(latencyMax, latency);
+		}
+		if (tNow - tReport >= std::chrono::seconds(1)) {
+			std::cout << std::fixed << std::setprecision(1) << "  t = " << evAll.back().t * 1e-6 << " s, "
+				<< evAll.size() * 1e-6 << " MEv, " << nTriggers << " triggers" << std::endl;
+			tReport = tNow;
+		}
+		return true;
+	}, 5, timeoutMSec);
+	if (writer.joinable())
+		writer.join();
+
+	std::cout << std::fixed << "Received " << evAll.size() << " events, " << nTriggers << " triggers in "
+		<< nBatches << " batches" << std::endl;
+	if (bWriter)
+		std::cout << "Written " << nGenEvents << " events, " << nGenTriggers << " triggers" << std::endl;
+	if (bWriter && (nBatches > 0)) {
+		std::cout << std::setprecision(2) << "Latency: mean " << latencySum / nBatches * 1e3
+			<< " ms, max " << latencyMax * 1e3 << " ms" << std::endl;
+	}
+
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!bWriteOK || !evData.load(fname))
+		return 1;
+	const std::vector<EBI::Event>& evRef = evData.dataRef();
+	bool bSame = (evAll.size() == evRef.size()) && std::equal(evAll.begin(), evAll.end(), evRef.begin(),
+		[](const EBI::Event& a, const EBI::Event& b) {
+			return (a.t == b.t) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p); });
+	bSame = bSame && (nTriggers == evData.triggerRef().size());
+	std::cout << (bSame ? "Identical to load of complete file" : "MISMATCH with load of complete file") << std::endl;
+	return bSame ? 0 : 1;
+}
+
+static const char* _modeName(const EBI::RawDecodeMode mode)
+{
+	switch (mode) {
+	case EBI::RawDecodeStream: return "stream";
+	case EBI::RawDecodeMapped: return "mapped";
+	case EBI::RawDecodeParallel: return "parallel";
+	case EBI::RawDecodePipelined: return "pipelined";
+	default: return "?";
+	}
+}
+
+/*!
+Load \a fname in each decode mode, best of \a nRuns.
+The file is read once before, so all modes see a warm page cache.
+*/
+static int _benchDecode(const std::string& fname, const int nRuns)
+{
+	std::ifstream inFile(fname, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!inFile.is_open()) {
+		std::cerr << "ERROR: failed opening file '" << fname << "'" << std::endl;
+		return 1;
+	}
+	const double nMegaBytes = static_cast<double>(inFile.tellg()) / 1e6;
+	inFile.close();
+	std::cout << "Decoding '" << fname << "' (" << std::fixed << std::setprecision(1) << nMegaBytes
+		<< " MB), best of " << nRuns << " runs, " << std::thread::hardware_concurrency() << " threads" << std::endl;
+
+	const EBI::RawDecodeMode modes[] = { EBI::RawDecodeStream, EBI::RawDecodeMapped,
+		EBI::RawDecodeParallel, EBI::RawDecodePipelined };
+	EBI::EventData evRef;
+	int retCode = 0;
+	for (const EBI::RawDecodeMode mode : modes) {
+		EBI::RawDecodeParams decParams;
+		decParams.decMode = mode;
+		EBI::EventData evData;
+		evData.setMaximumSize(UINT64_MAX);
+		evData.setDecodeParams(decParams);
+		double bestSec = 1e30;
+		for (int nRun = 0; nRun < nRuns; nRun++) {
+			auto t0 = std::chrono::steady_clock::now();
+			if (!evData.load(fname))
+				return 1;
+			double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			if (sec < bestSec)
+				bestSec = sec;
+		}
+		const std::vector<EBI::Event>& ev = evData.dataRef();
+		if (mode == EBI::RawDecodeStream)
+			evRef.copyFrom(evData);
+		bool bSame = (ev.size() == evRef.dataRef().size()) &&
+			std::equal(ev.begin(), ev.end(), evRef.dataRef().begin(),
+				[](const EBI::Event& a, const EBI::Event& b) {
+					return (a.t == b.t) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p); });
+		if (!bSame)
+			retCode = 1;
+		std::cout << std::setw(10) << _modeName(mode) << ": "
+			<< std::setprecision(1) << std::setw(8) << nMegaBytes / bestSec << " MB/s "
+			<< std::setw(8) << ev.size() / bestSec * 1e-6 << " MEv/s "
+			<< std::setprecision(3) << std::setw(8) << bestSec << " s"
+			<< (bSame ? "" : "  MISMATCH") << std::endl;
+	}
+	return retCode;
+}
+
+//! true if \a ev and \a cols hold the same events
+static bool _sameEvents(const std::vector<EBI::Event>& ev, const EBI::EventColumns& cols)
+{
+	if (ev.size() != cols.size())
+		return false;
+	for (size_t i = 0; i < ev.size(); i++) {
+		if ((ev[i].t != cols.t()[i]) || (ev[i].x != cols.x()[i]) || (ev[i].y != cols.y()[i]) || (ev[i].p != cols.p()[i]))
+			return false;
+	}
+	return true;
+}
+
+//! true if \a ev and \a packed hold the same events
+static bool _sameEvents(const std::vector<EBI::Event>& ev, const EBI::PackedEventData& packed)
+{
+	const std::vector<EBI::PackedEvent>& evPacked = packed.dataRef();
+	if (ev.size() != evPacked.size())
+		return false;
+	for (size_t i = 0; i < ev.size(); i++) {
+		if ((ev[i].t != evPacked[i].t()) || (ev[i].x != evPacked[i].x) || (ev[i].y != evPacked[i].y) || (ev[i].p != evPacked[i].p()))
+			return false;
+	}
+	return true;
+}
+
+//! best time of \a nRuns calls of \a fn in [s]
+template <typename Fn>
+static double _bestOf(const int nRuns, Fn fn)
+{
+	double bestSec = 1e30;
+	for (int nRun = 0; nRun < nRuns; nRun++) {
+		auto t0 = std::chrono::steady_clock::now();
+		fn();
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		if (sec < bestSec)
+			bestSec = sec;
+	}
+	return bestSec;
+}
+
+/*!
+Load \a fname into EBI::EventData, EBI::EventColumns and EBI::PackedEventData, then
+run the same filters on all of them, best of \a nRuns. Results of all layouts must
+be identical.
+*/
+static int _benchColumns(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	EBI::EventColumns evCols;
+	evCols.setMaximumSize(UINT64_MAX);
+	EBI::PackedEventData evPacked;
+	evPacked.setMaximumSize(UINT64_MAX);
+	double secAoS = _bestOf(nRuns, [&]() { evData.load(fname); });
+	double secSoA = _bestOf(nRuns, [&]() { evCols.load(fname); });
+	double secPacked = _bestOf(nRuns, [&]() { evPacked.load(fname); });
+	if (evData.dataRef().empty())
+		return 1;
+	const size_t nEvents = evData.dataRef().size();
+	int retCode = 0;
+	auto report = [&](const char* name, const size_t nOut, const bool bSame) {
+		if (!bSame)
+			retCode = 1;
+		std::cout << std::setw(10) << name << ": " << std::fixed
+			<< std::setprecision(1) << std::setw(8) << nEvents / secAoS * 1e-6 << " MEv/s (events) "
+			<< std::setw(8) << nEvents / secSoA * 1e-6 << " MEv/s (columns) "
+			<< std::setw(8) << nEvents / secPacked * 1e-6 << " MEv/s (packed) "
+			<< std::setw(10) << nOut << " events" << (bSame ? "" : "  MISMATCH") << std::endl;
+	};
+	std::cout << "Filtering " << nEvents << " events of '" << fname << "', best of " << nRuns << " runs, "
+		<< std::fixed << std::setprecision(1) << nEvents * sizeof(EBI::Event) / 1e6 << " / "
+		<< nEvents * sizeof(EBI::PackedEvent) / 1e6 << " MB as events / packed" << std::endl;
+	report("load", evCols.size(), _sameEvents(evData.dataRef(), evCols) && _sameEvents(evData.dataRef(), evPacked));
+
+	const int32_t imgW = evData.imageWidth(), imgH = evData.imageHeight();
+	const int32_t tEnd = static_cast<int32_t>(evData.dataRef().back().t);
+	const int32_t x = imgW / 4, y = imgH / 4, w = imgW / 8, h = imgH / 8;
+	const int32_t t0 = tEnd / 4, dur = tEnd / 2;
+
+	std::vector<EBI::Event> sample;
+	EBI::EventColumns sampleCols;
+	EBI::PackedEventData samplePacked;
+	secAoS = _bestOf(nRuns, [&]() { sample = evData.getSample(x, y, w, h, t0, dur); });
+	secSoA = _bestOf(nRuns, [&]() { evCols.getSample(sampleCols, x, y, w, h, t0, dur); });
+	secPacked = _bestOf(nRuns, [&]() { evPacked.getSample(samplePacked, x, y, w, h, t0, dur); });
+	report("getSample", sampleCols.size(), _sameEvents(sample, sampleCols) && _sameEvents(sample, samplePacked));
+
+	EBI::EventData evCopy;
+	EBI::EventColumns colsCopy;
+	EBI::PackedEventData packedCopy;
+	secAoS = _bestOf(nRuns, [&]() { evCopy.copyFrom(evData, EBI::PolarityPositive, t0, dur); });
+	secSoA = _bestOf(nRuns, [&]() { colsCopy.copyFrom(evCols, EBI::PolarityPositive, t0, dur); });
+	secPacked = _bestOf(nRuns, [&]() { packedCopy.copyFrom(evPacked, EBI::PolarityPositive, t0, dur); });
+	report("time", colsCopy.size(), _sameEvents(evCopy.dataRef(), colsCopy) && _sameEvents(evCopy.dataRef(), packedCopy));
+
+	secAoS = _bestOf(nRuns, [&]() { evCopy.copyFrom(evData, x, y, imgW / 2, imgH / 2); });
+	secSoA = _bestOf(nRuns, [&]() { colsCopy.copyFrom(evCols, x, y, imgW / 2, imgH / 2); });
+	secPacked = _bestOf(nRuns, [&]() { packedCopy.copyFrom(evPacked, x, y, imgW / 2, imgH / 2); });
+	report("roi", colsCopy.size(), _sameEvents(evCopy.dataRef(), colsCopy) && _sameEvents(evCopy.dataRef(), packedCopy));
+
+	// 10 ms slab: EBI::EventData only visits the window through its time index
+	secAoS = _bestOf(nRuns, [&]() { evCopy.copyFrom(evData, EBI::PolarityBoth, t0, 10000); });
+	secSoA = _bestOf(nRuns, [&]() { colsCopy.copyFrom(evCols, EBI::PolarityBoth, t0, 10000); });
+	secPacked = _bestOf(nRuns, [&]() { packedCopy.copyFrom(evPacked, EBI::PolarityBoth, t0, 10000); });
+	report("slab", colsCopy.size(), _sameEvents(evCopy.dataRef(), colsCopy) && _sameEvents(evCopy.dataRef(), packedCopy));
+
+	// cropROI works in place, so each run crops a fresh copy
+	secAoS = _bestOf(nRuns, [&]() { evCopy.copyFrom(evData); evCopy.cropROI(x, y, w, h, t0, dur); });
+	secSoA = _bestOf(nRuns, [&]() { colsCopy = evCols; colsCopy.cropROI(x, y, w, h, t0, dur); });
+	secPacked = _bestOf(nRuns, [&]() { packedCopy = evPacked; packedCopy.cropROI(x, y, w, h, t0, dur); });
+	report("cropROI", colsCopy.size(), _sameEvents(evCopy.dataRef(), colsCopy) && _sameEvents(evCopy.dataRef(), packedCopy));
+
+	// images only exist for events and packed events
+	EBI::EventImage img, imgPacked;
+	secAoS = _bestOf(nRuns, [&]() { img.fromEventData(evData, EBI::PolarityBoth, t0, dur); });
+	secSoA = 1e30;
+	secPacked = _bestOf(nRuns, [&]() { imgPacked.fromEventData(evPacked, EBI::PolarityBoth, t0, dur); });
+	report("image", static_cast<size_t>(imgPacked.width()) * imgPacked.height(), img.dataRef() == imgPacked.dataRef());
+	return retCode;
+}
+
+/*!
+Sample sub-volumes of 40 x 40 pixels and 20 ms on a grid of 20 pixels and 10 ms (defaults
+of EBI::EventFlowEvalParams) during the first 100 ms of \a fname, once by getSample() without and once by
+getSamples() with a tile index, best of \a nRuns. Both must give identical samples.
+*/
+static int _benchSamples(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	const EBI::EventFlowEvalParams params;
+	const int32_t imgW = evData.imageWidth(), imgH = evData.imageHeight();
+	const int32_t tEnd = static_cast<int32_t>(evData.dataRef().back().t);
+	std::vector<EBI::SampleWindow> windows;
+	for (int32_t t0 = 0; (t0 + params.sampleTime <= tEnd) && (t0 < 100000); t0 += params.stepTime)
+		for (int32_t y = 0; y + params.sampleY <= imgH; y += params.stepY)
+			for (int32_t x = 0; x + params.sampleX <= imgW; x += params.stepX)
+				windows.push_back(EBI::SampleWindow(x, y, params.sampleX, params.sampleY, t0, params.sampleTime));
+
+	std::vector<std::vector<EBI::Event> > samplesScan, samplesTiles;
+	size_t nSampled = 0;
+	evData.setTileSize(0);
+	const double secScan = _bestOf(nRuns, [&]() {
+		samplesScan.resize(windows.size());
+		for (size_t k = 0; k < windows.size(); k++) {
+			const EBI::SampleWindow& win = windows[k];
+			samplesScan[k] = evData.getSample(win.x, win.y, win.w, win.h, win.t0, win.dur);
+		}
+	});
+	auto t0 = std::chrono::steady_clock::now();
+	evData.setTileSize(32);
+	evData.getSample(0, 0, 1, 1, 0, 1);
+	const double secBuild = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	const double secTiles = _bestOf(nRuns, [&]() { samplesTiles = evData.getSamples(windows); });
+
+	bool bSame = (samplesScan.size() == samplesTiles.size());
+	for (size_t k = 0; bSame && (k < samplesScan.size()); k++) {
+		bSame = (samplesScan[k].size() == samplesTiles[k].size()) &&
+			std::equal(samplesScan[k].begin(), samplesScan[k].end(), samplesTiles[k].begin(),
+				[](const EBI::Event& a, const EBI::Event& b) {
+					return (a.t == b.t) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p); });
+		nSampled += samplesScan[k].size();
+	}
+	std::cout << "Sampling " << windows.size() << " windows of " << evData.dataRef().size() << " events of '"
+		<< fname << "', best of " << nRuns << " runs" << std::endl << std::fixed << std::setprecision(3)
+		<< "      scan: " << std::setw(8) << secScan << " s" << std::endl
+		<< "     tiles: " << std::setw(8) << secTiles << " s (index built in " << secBuild << " s)  "
+		<< nSampled << " events" << (bSame ? "" : "  MISMATCH") << std::endl;
+	return bSame ? 0 : 1;
+}
+
+/*!
+Sample the sub-volumes of _benchSamples() over the whole of \a fname and copy time windows
+from EBI::PagedEventData, which keeps at most \a nCacheMB of blocks in memory. Samples,
+copies and images must equal those of EBI::EventData holding all events.
+*/
+static int _benchPaged(const std::string& fname, const uint64_t nCacheMB)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	std::remove(EBI::PagedEventData::fileName(fname).c_str());
+	EBI::PagedEventData evPaged;
+	evPaged.setCacheSize(nCacheMB << 20);
+	auto t0 = std::chrono::steady_clock::now();
+	if (!evPaged.open(fname))
+		return 1;
+	const double secBuild = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	auto same = [](const std::vector<EBI::Event>& a, const std::vector<EBI::Event>& b) {
+		return (a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin(),
+			[](const EBI::Event& u, const EBI::Event& v) {
+				return (u.t == v.t) && (u.x == v.x) && (u.y == v.y) && (u.p == v.p); });
+	};
+	bool bSame = (evPaged.size() == evData.size()) && (evPaged.duration() == evData.eventTime(evData.size() - 1));
+
+	// flow grid, one time step at a time, as a velocity time series would be computed
+	const EBI::EventFlowEvalParams params;
+	const int32_t imgW = evData.imageWidth(), imgH = evData.imageHeight();
+	const int64_t tEnd = static_cast<int64_t>(evPaged.duration());
+	evData.setTileSize(32);
+	double secMemory = 0, secPaged = 0;
+	size_t nWindows = 0, nSampled = 0;
+	uint64_t nPeakBytes = 0;
+	for (int64_t tStart = 0; tStart + params.sampleTime <= tEnd; tStart += params.stepTime) {
+		std::vector<EBI::SampleWindow> windows;
+		for (int32_t y = 0; y + params.sampleY <= imgH; y += params.stepY)
+			for (int32_t x = 0; x + params.sampleX <= imgW; x += params.stepX)
+				windows.push_back(EBI::SampleWindow(x, y, params.sampleX, params.sampleY, tStart, params.sampleTime));
+		t0 = std::chrono::steady_clock::now();
+		const std::vector<std::vector<EBI::Event> > samplesMemory = evData.getSamples(windows);
+		secMemory += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		t0 = std::chrono::steady_clock::now();
+		const std::vector<std::vector<EBI::Event> > samplesPaged = evPaged.getSamples(windows);
+		secPaged += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		nPeakBytes = std::max(nPeakBytes, evPaged.residentBytes());
+		for (size_t k = 0; k < windows.size(); k++) {
+			bSame = bSame && same(samplesMemory[k], samplesPaged[k]);
+			nSampled += samplesMemory[k].size();
+		}
+		nWindows += windows.size();
+	}
+	const uint64_t nSampleReads = evPaged.blockReads();
+
+	// time windows across block borders, and to the end of the recording
+	const int64_t offsets[] = { 0, tEnd / 3 + 12345, tEnd - tEnd / 5 };
+	const int32_t durations[] = { 250000, 0 };
+	for (const int64_t offset : offsets) {
+		for (const int32_t dur : durations) {
+			EBI::EventData copyMemory, copyPaged;
+			copyMemory.copyFrom(evData, EBI::PolarityPositive, offset, dur, true);
+			evPaged.copyTo(copyPaged, EBI::PolarityPositive, offset, dur);
+			bSame = bSame && same(copyMemory.dataRef(), copyPaged.dataRef());
+			EBI::EventImage imgMemory(copyMemory, EBI::PolarityBoth, 0, static_cast<uint32_t>(dur));
+			EBI::EventImage imgPaged(evPaged, EBI::PolarityPositive, static_cast<uint64_t>(offset), static_cast<uint32_t>(dur));
+			bSame = bSame && (imgMemory.dataRef() == imgPaged.dataRef());
+		}
+	}
+
+	std::cout << "Paging " << evPaged.size() << " events of '" << fname << "' in " << evPaged.blockCount()
+		<< " blocks of " << evPaged.blockDuration() << " usec, cache " << nCacheMB << " MB" << std::endl
+		<< std::fixed << std::setprecision(3)
+		<< "     build: " << std::setw(8) << secBuild << " s" << std::endl
+		<< "    memory: " << std::setw(8) << secMemory << " s  " << nWindows << " windows, " << nSampled << " events, "
+		<< (evData.size() * sizeof(EBI::Event) >> 20) << " MB of events" << std::endl
+		<< "     paged: " << std::setw(8) << secPaged << " s  " << nSampleReads << " block reads, at most "
+		<< (nPeakBytes >> 20) << " MB resident" << (bSame ? "" : "  MISMATCH") << std::endl;
+	return bSame ? 0 : 1;
+}
+
+/*!
+Reference writer of EVT files as EBI::EventData::save() did before writing in chunks:
+each event is packed and written on its own
+*/
+static bool _saveEventsPerEvent(const std::string& fnameEvents, const EBI::EventView& view, const uint64_t durationUSec)
+{
+	std::ofstream outFile(fnameEvents, std::ios::out | std::ios::binary);
+	_EVENT_FILE_HDR hdr = {};
+	hdr.Signature = _EVENT_FILE_SIGNATURE;
+	hdr.Duration = static_cast<uint32_t>(durationUSec);
+	hdr.DurationHigh = static_cast<uint32_t>(durationUSec >> 32);
+	hdr.SegmentSignature = _EVENT_FILE_SEGMENT_SIGNATURE;
+	hdr.TimeStamp = view.timeStamp();
+	hdr.cols = static_cast<uint32_t>(view.imageWidth());
+	hdr.rows = static_cast<uint32_t>(view.imageHeight());
+	hdr.HeaderLength = sizeof(_EVENT_FILE_HDR);
+	outFile.write(reinterpret_cast<char*>(&hdr), _EVENT_FILE_HDR_SIZE);
+	std::vector<_EVENT_FILE_SEGMENT> segments;
+	uint64_t tSegment = 0;
+	for (const EBI::Event& evIn : view) {
+		if (!view.contains(evIn))
+			continue;
+		const EBI::Event ev = view.relative(evIn);
+		const uint64_t t = view.time(evIn);
+		if ((static_cast<int64_t>(t) >= 0) && (t - tSegment >= _EVENT_FILE_SEGMENT_USEC)
+			&& ((t & ~(_EVENT_FILE_SEGMENT_USEC - 1)) > tSegment)) {
+			tSegment = t & ~(_EVENT_FILE_SEGMENT_USEC - 1);
+			segments.push_back({ tSegment, hdr.EventCount });
+		}
+		PACKED_EVENT pe;
+		pe.x = ev.x;
+		pe.y = ev.y;
+		pe.timePol = (static_cast<uint32_t>(t - tSegment) << 1) | ((ev.p > 0) ? 0x1 : 0x0);
+		outFile.write(reinterpret_cast<const char*>(&pe), _PACKED_EVENT_SIZE);
+		hdr.EventCount++;
+	}
+	outFile.write(reinterpret_cast<const char*>(segments.data()), segments.size() * _EVENT_FILE_SEGMENT_SIZE);
+	hdr.SegmentCount = static_cast<uint32_t>(segments.size());
+	hdr.FileSize = sizeof(_EVENT_FILE_HDR) + hdr.EventCount * _PACKED_EVENT_SIZE + segments.size() * _EVENT_FILE_SEGMENT_SIZE;
+	outFile.seekp(0, std::ios::beg);
+	outFile.write(reinterpret_cast<char*>(&hdr), _EVENT_FILE_HDR_SIZE);
+	return outFile.good();
+}
+
+//! true if files \a fname1 and \a fname2 have identical content
+static bool _sameFiles(const std::string& fname1, const std::string& fname2)
+{
+	std::ifstream file1(fname1, std::ios::in | std::ios::binary), file2(fname2, std::ios::in | std::ios::binary);
+	std::vector<char> buf1(1 << 20), buf2(1 << 20);
+	while (file1 && file2) {
+		file1.read(buf1.data(), buf1.size());
+		file2.read(buf2.data(), buf2.size());
+		if ((file1.gcount() != file2.gcount()) || !std::equal(buf1.begin(), buf1.begin() + file1.gcount(), buf2.begin()))
+			return false;
+	}
+	return file1.eof() && file2.eof();
+}
+
+/*!
+Save all events of \a fname and a view with ROI and polarity as EVT files through
+EBI::EventData::save() and EBI::EventView::save(), versus _saveEventsPerEvent(),
+best of \a nRuns. Files must be identical.
+*/
+static int _benchSave(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	const uint64_t tLast = evData.eventTime(evData.size() - 1);
+	const std::string fnameChunks = "ebiv_bench_chunks.evt", fnamePerEvent = "ebiv_bench_per_event.evt";
+	const int32_t imgW = evData.imageWidth(), imgH = evData.imageHeight();
+	const EBI::EventView all(evData, EBI::PolarityBoth, static_cast<int64_t>(0), 0, false);
+	const EBI::EventView roi(evData, EBI::PolarityPositive, imgW / 4, imgH / 4, imgW / 2, imgH / 2,
+		static_cast<int64_t>(tLast / 8), static_cast<int32_t>(std::min<uint64_t>(tLast / 2, INT32_MAX)));
+
+	std::cout << "Saving " << evData.size() << " events of '" << fname << "', best of " << nRuns << " runs" << std::endl
+		<< "              per event     chunks   [MEv/s]" << std::endl << std::fixed << std::setprecision(1);
+	bool bSame = true;
+	auto report = [&](const char* strName, const size_t nEvents, const double secPerEvent, const double secChunks) {
+		const bool bFileSame = _sameFiles(fnameChunks, fnamePerEvent);
+		bSame = bSame && bFileSame;
+		std::cout << std::setw(10) << strName << "   " << std::setw(10) << nEvents / secPerEvent * 1e-6
+			<< " " << std::setw(10) << nEvents / secChunks * 1e-6 << (bFileSame ? "" : "  MISMATCH") << std::endl;
+	};
+	double secPerEvent = _bestOf(nRuns, [&]() { _saveEventsPerEvent(fnamePerEvent, all, tLast + 1); });
+	double secChunks = _bestOf(nRuns, [&]() { evData.save(fnameChunks); });
+	report("all", evData.size(), secPerEvent, secChunks);
+	const size_t nROI = roi.count();
+	secPerEvent = _bestOf(nRuns, [&]() { _saveEventsPerEvent(fnamePerEvent, roi, roi.duration()); });
+	secChunks = _bestOf(nRuns, [&]() { roi.save(fnameChunks); });
+	report("roi", nROI, secPerEvent, secChunks);
+	std::remove(fnameChunks.c_str());
+	std::remove(fnamePerEvent.c_str());
+	return bSame ? 0 : 1;
+}
+
+/*!
+Load the EVT3 and EVT4 files of the events of \a fname entirely and in 100 windows of 10 ms,
+best of \a nRuns. Each window must equal the events copied from the data set in memory.
+*/
+static int _benchLoad(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	const uint64_t tLast = evData.eventTime(evData.size() - 1) - evData.eventTime(0);
+	const uint32_t windowUSec = 10000;
+	const int nWindows = 100;
+
+	std::cout << "Loading EVT files of " << evData.size() << " events of '" << fname << "', best of " << nRuns << " runs"
+		<< std::endl << std::fixed << std::setprecision(3);
+	bool bSame = true;
+	const EBI::FileFormat formats[] = { EBI::FILE_FORMAT_EVT3, EBI::FILE_FORMAT_EVT4 };
+	for (const EBI::FileFormat eFormat : formats) {
+		const char* strFormat = (eFormat == EBI::FILE_FORMAT_EVT4) ? "EVT4" : "EVT3";
+		const std::string fnameEvt = "ebiv_bench_load.evt";
+		if (!evData.save(fnameEvt, 0, 0, eFormat))
+			return 1;
+		EBI::EventData evLoaded;
+		evLoaded.setMaximumSize(UINT64_MAX);
+		const double secAll = _bestOf(nRuns, [&]() { evLoaded.load(fnameEvt); });
+		bool bFormatSame = (evLoaded.size() == evData.size());
+		double secWindows = 0;
+		size_t nLoaded = 0;
+		EBI::EventData evWindow, evCopy;
+		for (int k = 0; k < nWindows; k++) {
+			const uint64_t offset = (tLast > windowUSec) ? (tLast - windowUSec) / nWindows * k : 0;
+			secWindows += _bestOf(nRuns, [&]() { evWindow.load(fnameEvt, offset, windowUSec); });
+			// offsets of load() are relative to the first event
+			evCopy.copyFrom(evData, EBI::PolarityBoth, static_cast<int64_t>(evData.eventTime(0) + offset), static_cast<int32_t>(windowUSec), false);
+			bool bWindowSame = (evWindow.size() == evCopy.size());
+			for (size_t i = 0; bWindowSame && (i < evCopy.size()); i++) {
+				const EBI::Event& a = evWindow.dataRef()[i];
+				const EBI::Event& b = evCopy.dataRef()[i];
+				bWindowSame = (evWindow.eventTime(i) == evCopy.eventTime(i)) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p);
+			}
+			bFormatSame = bFormatSame && bWindowSame;
+			nLoaded += evWindow.size();
+		}
+		std::remove(fnameEvt.c_str());
+		bSame = bSame && bFormatSame;
+		std::cout << strFormat << "   all: " << std::setw(10) << secAll * 1e3 << " ms  " << evData.size() / secAll * 1e-6 << " MEv/s" << std::endl
+			<< "    window: " << std::setw(10) << secWindows / nWindows * 1e3 << " ms  mean of " << nWindows << " windows of "
+			<< windowUSec << " usec, " << nLoaded / nWindows << " events each" << (bFormatSame ? "" : "  MISMATCH") << std::endl;
+	}
+	return bSame ? 0 : 1;
+}
+
+/*!
+Replace coordinates and polarities of the events of \a evData, keeping their times, by those
+of a scene closer to real recordings: edges of a few bars moving across the detector fire runs
+of neighbouring pixels in a row, with 10 % noise events spread uniformly.
+*/
+static void _makeEdgeScene(EBI::EventData& evData)
+{
+	struct Bar { double x0, speed; int32_t y0, h; int8_t p; };
+	const int32_t w = evData.imageWidth(), h = evData.imageHeight();
+	_XorShift rng(815);
+	std::vector<Bar> bars;
+	for (int k = 0; k < 8; k++)
+		bars.push_back({ rng.uniform() * w, (rng.uniform() - 0.5) * 400, static_cast<int32_t>(rng() % (h / 2)), h / 4 + static_cast<int32_t>(rng() % (h / 4)), static_cast<int8_t>(k & 0x1) });
+	std::vector<EBI::Event>& events = evData.dataRef();
+	for (size_t i = 0; i < events.size(); ) {
+		if (rng() % 10 == 0) {
+			EBI::Event& ev = events[i++];
+			ev.x = static_cast<uint16_t>(rng() % w);
+			ev.y = static_cast<uint16_t>(rng() % h);
+			ev.p = static_cast<int8_t>(rng() & 0x1);
+			continue;
+		}
+		const Bar& bar = bars[rng() % bars.size()];
+		const double x = bar.x0 + bar.speed * (evData.eventTime(i) * 1e-6);
+		const int32_t xEdge = static_cast<int32_t>(x - std::floor(x / w) * w);
+		const uint16_t y = static_cast<uint16_t>(bar.y0 + rng() % bar.h);
+		for (size_t n = 1 + rng() % 6; (n > 0) && (i < events.size()); n--, i++) {
+			events[i].x = static_cast<uint16_t>(std::min(w - 1, xEdge + static_cast<int32_t>(n)));
+			events[i].y = y;
+			events[i].p = bar.p;
+		}
+	}
+}
+
+/*!
+Save the events of \a fname as EVT4 and EVTZ file and load them again, best of \a nRuns,
+once as decoded and once with the moving edges of _makeEdgeScene(). Loaded events must equal
+the saved ones. Throughput is in [MB/s] of the packed events of EVT3 / EVT4 files.
+*/
+static int _benchCodec(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	const std::string fnameBlocks = "ebiv_bench_codec.evt";
+	const std::string fnameCoded = "ebiv_bench_codec.evtz";
+	const double nPackedMB = evData.size() * _PACKED_EVENT_SIZE * 1e-6;
+	auto fileSize = [](const std::string& fnameFile) {
+		std::ifstream inFile(fnameFile, std::ios::in | std::ios::binary | std::ios::ate);
+		return static_cast<double>(inFile.tellg());
+	};
+	auto same = [&evData](const EBI::EventData& evLoaded) {
+		bool bSame = (evLoaded.size() == evData.size());
+		for (size_t i = 0; bSame && (i < evData.size()); i++) {
+			const EBI::Event& a = evLoaded.dataRef()[i];
+			const EBI::Event& b = evData.dataRef()[i];
+			bSame = (evLoaded.eventTime(i) == evData.eventTime(i)) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p);
+		}
+		return bSame;
+	};
+
+	std::cout << "Coding " << evData.size() << " events of '" << fname << "' on " << EBI::ThreadCount(evData.threadCount())
+		<< " threads, best of " << nRuns << " runs" << std::endl
+		<< "     scene   EVT4 [MB]  EVTZ [MB]   ratio   save EVT4 / EVTZ   load EVT4 / EVTZ  [MB/s]" << std::endl
+		<< std::fixed << std::setprecision(1);
+	bool bSame = true;
+	const char* strScenes[] = { "file", "edges" };
+	for (const char* strScene : strScenes) {
+		if (strcmp(strScene, "edges") == 0)
+			_makeEdgeScene(evData);
+		const double secSaveBlocks = _bestOf(nRuns, [&]() { evData.save(fnameBlocks, 0, 0, EBI::FILE_FORMAT_EVT4); });
+		const double secSaveCoded = _bestOf(nRuns, [&]() { evData.save(fnameCoded, 0, 0, EBI::FILE_FORMAT_EVTZ); });
+		EBI::EventData evBlocks, evCoded;
+		evBlocks.setMaximumSize(UINT64_MAX);
+		evCoded.setMaximumSize(UINT64_MAX);
+		const double secLoadBlocks = _bestOf(nRuns, [&]() { evBlocks.load(fnameBlocks); });
+		const double secLoadCoded = _bestOf(nRuns, [&]() { evCoded.load(fnameCoded); });
+		const bool bSceneSame = same(evBlocks) && same(evCoded);
+		bSame = bSame && bSceneSame;
+		const double nBlocksMB = fileSize(fnameBlocks) * 1e-6;
+		const double nCodedMB = fileSize(fnameCoded) * 1e-6;
+		std::cout << std::setw(10) << strScene << std::setw(12) << nBlocksMB << std::setw(11) << nCodedMB
+			<< std::setw(8) << std::setprecision(2) << nBlocksMB / nCodedMB << std::setprecision(1)
+			<< std::setw(12) << nPackedMB / secSaveBlocks << std::setw(8) << nPackedMB / secSaveCoded
+			<< std::setw(11) << nPackedMB / secLoadBlocks << std::setw(8) << nPackedMB / secLoadCoded
+			<< (bSceneSame ? "" : "  MISMATCH") << std::endl;
+	}
+	std::remove(fnameBlocks.c_str());
+	std::remove(fnameCoded.c_str());
+	return bSame ? 0 : 1;
+}
+
+/*!
+Save the events of \a fname as tiled EVTT file for the grid of the default EBI::EventFlowEvalParams
+and sample the grid over the whole recording from EBI::TiledEventData, best of \a nRuns, versus
+EBI::EventData::getSamples() with a tile index. Samples must be identical.
+*/
+static int _benchTiled(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	const std::string fnameTiled = "ebiv_bench_tiled.evtt";
+	EBI::EventFlowEvalParams params;
+	params.imgW = evData.imageWidth();
+	params.imgH = evData.imageHeight();
+	const double secSave = _bestOf(nRuns, [&]() { evData.saveTiled(fnameTiled, params); });
+	EBI::TiledEventData evTiled;
+	if (!evTiled.open(fnameTiled))
+		return 1;
+	std::ifstream inFile(fnameTiled, std::ios::in | std::ios::binary | std::ios::ate);
+	const uint64_t nFileBytes = static_cast<uint64_t>(inFile.tellg());
+	inFile.close();
+
+	const std::vector<EBI::SampleWindow> windows = EBI::FlowSampleWindows(params, 0,
+		static_cast<int64_t>(evData.eventTime(evData.size() - 1)));
+	std::vector<std::vector<EBI::Event> > samplesMemory, samplesTiled;
+	evData.setTileSize(32);
+	const double secMemory = _bestOf(nRuns, [&]() { samplesMemory = evData.getSamples(windows); });
+	uint64_t nBytesRead = 0;
+	const double secTiled = _bestOf(nRuns, [&]() {
+		const uint64_t nBefore = evTiled.bytesRead();
+		samplesTiled = evTiled.getSamples(windows);
+		nBytesRead = evTiled.bytesRead() - nBefore;
+	});
+
+	bool bSame = (evTiled.size() == evData.size()) && (samplesMemory.size() == samplesTiled.size());
+	size_t nSampled = 0;
+	for (size_t k = 0; bSame && (k < samplesMemory.size()); k++) {
+		bSame = (samplesMemory[k].size() == samplesTiled[k].size()) &&
+			std::equal(samplesMemory[k].begin(), samplesMemory[k].end(), samplesTiled[k].begin(),
+				[](const EBI::Event& a, const EBI::Event& b) {
+					return (a.t == b.t) && (a.x == b.x) && (a.y == b.y) && (a.p == b.p); });
+		nSampled += samplesMemory[k].size();
+	}
+	const double nWindows = static_cast<double>(std::max<size_t>(windows.size(), 1));
+	std::cout << "Tiling " << evTiled.size() << " events of '" << fname << "' in " << evTiled.blockCount() << " blocks of "
+		<< evTiled.tilesX() << " x " << evTiled.tilesY() << " tiles of " << evTiled.tileWidth() << " x " << evTiled.tileHeight()
+		<< " pixels and " << evTiled.blockDuration() << " usec, best of " << nRuns << " runs" << std::endl
+		<< std::fixed << std::setprecision(3)
+		<< "      save: " << std::setw(8) << secSave << " s  " << (nFileBytes >> 20) << " MB" << std::endl
+		<< "    memory: " << std::setw(8) << secMemory << " s  " << windows.size() << " windows, " << nSampled << " events" << std::endl
+		<< "     tiled: " << std::setw(8) << secTiled << " s  on " << EBI::ThreadCount(evTiled.threadCount()) << " threads, "
+		<< std::setprecision(1) << nBytesRead / nWindows / 1024.0 << " kB of " << (nFileBytes >> 20) << " MB read per window"
+		<< (bSame ? "" : "  MISMATCH") << std::endl;
+	evTiled.close();
+	std::remove(fnameTiled.c_str());
+	return bSame ? 0 : 1;
+}
+
+/*!
+Time copyFrom() filters, cropROI() and getSample() of EBI::EventData on \a fname with
+1, 2, 4, ... threads up to all cores, best of \a nRuns. Results must equal those of one thread.
+*/
+static int _benchSelect(const std::string& fname, const int nRuns)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	evData.timeIndex();
+	const EBI::EventData& src = evData;
+	const size_t nEvents = src.size();
+	const int32_t imgW = src.imageWidth(), imgH = src.imageHeight();
+	const int32_t tEnd = static_cast<int32_t>(src.dataRef().back().t);
+	const int32_t x = imgW / 4, y = imgH / 4, w = imgW / 2, h = imgH / 2;
+	const int32_t t0 = tEnd / 8, dur = tEnd * 3 / 4;
+
+	std::vector<int32_t> threadCounts;
+	const int32_t nMaxThreads = EBI::ThreadCount(0);
+	for (int32_t n = 1; n < nMaxThreads; n *= 2)
+		threadCounts.push_back(n);
+	threadCounts.push_back(nMaxThreads);
+
+	std::cout << "Selecting from " << nEvents << " events of '" << fname << "', best of " << nRuns << " runs" << std::endl
+		<< " threads     polarity          roi      cropROI    getSample   [MEv/s]" << std::endl;
+	EBI::EventData refPol, refROI, refCrop, dst, work;
+	std::vector<EBI::Event> refSample, sample;
+	auto same = [](const std::vector<EBI::Event>& a, const std::vector<EBI::Event>& b) {
+		return (a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin(),
+			[](const EBI::Event& e1, const EBI::Event& e2) {
+				return (e1.t == e2.t) && (e1.x == e2.x) && (e1.y == e2.y) && (e1.p == e2.p); });
+	};
+	int retCode = 0;
+	for (const int32_t nThreads : threadCounts) {
+		evData.setThreadCount(nThreads);
+		dst.setThreadCount(nThreads);
+		work.setThreadCount(nThreads);
+		const double secPol = _bestOf(nRuns, [&]() { dst.copyFrom(src, EBI::PolarityPositive, t0, dur); });
+		bool bSame = (nThreads == 1) ? refPol.copyFrom(dst) : same(dst.dataRef(), refPol.dataRef());
+		const double secROI = _bestOf(nRuns, [&]() { dst.copyFrom(src, x, y, w, h, t0, dur); });
+		bSame = bSame && ((nThreads == 1) ? refROI.copyFrom(dst) : same(dst.dataRef(), refROI.dataRef()));
+		double secCrop = 1e30;
+		for (int nRun = 0; nRun < nRuns; nRun++) {
+			work.copyFrom(src);
+			work.timeIndex();
+			secCrop = std::min(secCrop, _bestOf(1, [&]() { work.cropROI(x, y, w, h, t0, dur); }));
+		}
+		bSame = bSame && ((nThreads == 1) ? refCrop.copyFrom(work) : same(work.dataRef(), refCrop.dataRef()));
+		const double secSample = _bestOf(nRuns, [&]() { sample = evData.getSample(x, y, w, h, t0, dur); });
+		if (nThreads == 1)
+			refSample = sample;
+		bSame = bSame && same(sample, refSample);
+		if (!bSame)
+			retCode = 1;
+		std::cout << std::setw(8) << nThreads << std::fixed << std::setprecision(1)
+			<< std::setw(13) << nEvents / secPol * 1e-6 << std::setw(13) << nEvents / secROI * 1e-6
+			<< std::setw(13) << nEvents / secCrop * 1e-6 << std::setw(13) << nEvents / secSample * 1e-6
+			<< (bSame ? "" : "  MISMATCH") << std::endl;
+	}
+	return retCode;
+}
+
+/*!
+Count the heap allocations of copy, filter and access methods of EBI::EventData on \a fname,
+first into a new instance, then into the same instance again. Operations into a reused
+instance must not allocate more than expected, e.g. filters none at all.
+*/
+static int _benchAlloc(const std::string& fname)
+{
+	EBI::EventData evData;
+	evData.setMaximumSize(UINT64_MAX);
+	if (!evData.load(fname) || evData.dataRef().empty())
+		return 1;
+	evData.timeIndex();	// built once, not counted with the first operation
+	evData.setThreadCount(1);	// worker threads allocate on their own
+	const EBI::EventData& src = evData;
+	const size_t nEvents = src.size();
+	const int32_t imgW = src.imageWidth(), imgH = src.imageHeight();
+	const int32_t tEnd = static_cast<int32_t>(src.dataRef().back().t);
+	const int32_t x = imgW / 4, y = imgH / 4, w = imgW / 2, h = imgH / 2;
+	const int32_t t0 = tEnd / 4, dur = tEnd / 2;
+
+	std::cout << "Allocations of operations on " << nEvents << " events of '" << fname << "'" << std::endl
+		<< "                 new     reused  expected        time" << std::endl;
+	int retCode = 0;
+	auto measure = [&](const char* name, const uint64_t nExpected, std::function<void()> prepare, std::function<void()> fn) {
+		uint64_t nAllocs[2];
+		double sec = 0;
+		for (int nRun = 0; nRun < 2; nRun++) {
+			prepare();
+			const uint64_t nBefore = g_nAllocs;
+			auto tStart = std::chrono::steady_clock::now();
+			fn();
+			sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+			nAllocs[nRun] = g_nAllocs - nBefore;
+		}
+		const bool bOK = (nAllocs[1] <= nExpected);
+		if (!bOK)
+			retCode = 1;
+		std::cout << std::setw(12) << name << ": " << std::setw(8) << nAllocs[0] << " " << std::setw(10) << nAllocs[1]
+			<< " " << std::setw(9) << nExpected << " " << std::fixed << std::setprecision(4) << std::setw(10) << sec << " s"
+			<< (bOK ? "" : "  REGRESSION") << std::endl;
+	};
+	auto none = []() {};
+
+	// the first run of each operation fills a new instance, the second one the same again
+	std::unique_ptr<EBI::EventData> pDst;
+	auto newDst = [&]() {
+		if (!pDst) {
+			pDst.reset(new EBI::EventData());
+			pDst->setThreadCount(1);
+		}
+	};
+	measure("copyFrom", 0, newDst, [&]() { pDst->copyFrom(src); });
+	pDst.reset();
+	measure("time", 0, newDst, [&]() { pDst->copyFrom(src, t0, dur); });
+	pDst.reset();
+	measure("polarity", 0, newDst, [&]() { pDst->copyFrom(src, EBI::PolarityPositive, t0, dur); });
+	pDst.reset();
+	measure("roi", 0, newDst, [&]() { pDst->copyFrom(src, x, y, w, h, t0, dur); });
+
+	// cropROI works in place on a copy made before counting
+	EBI::EventData work;
+	work.setThreadCount(1);
+	measure("cropROI", 0, [&]() { work.copyFrom(src); work.timeIndex(); }, [&]() { work.cropROI(x, y, w, h, t0, dur); });
+	measure("getSample", 1, none, [&]() { std::vector<EBI::Event> sample = evData.getSample(x, y, w, h, t0, dur); });
+
+	size_t nRead = 0;
+	measure("dataRef", 0, none, [&]() { nRead = src.dataRef().size(); });
+	measure("data", 1, none, [&]() { nRead = src.data().size(); });
+	measure("move", 0, [&]() { work.copyFrom(src); },
+		[&]() { EBI::EventData moved(std::move(work)); work = std::move(moved); });
+	return (nRead == nEvents) ? retCode : 1;
+}
+
+static void _usage()
+{
+	std::cerr << "Usage: ebiv_bench vector [million words] [bits per vector word]\n"
+		<< "       ebiv_bench generate <file.raw> [--geometry 640x480|1280x720] [--rate MEv/s]\n"
+		<< "                  [--vector fraction] [--trigger Hz] [--duration s] [--t0 usec]\n"
+		<< "                  [--realtime 1]\n"
+		<< "       ebiv_bench decode [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench follow [file.raw] [scene options] [--timeout ms]\n"
+		<< "       ebiv_bench columns [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench samples [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench paged [file.raw] [scene options] [--cache MB]\n"
+		<< "       ebiv_bench save [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench load [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench codec [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench tiled [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench select [file.raw] [scene options] [--runs n]\n"
+		<< "       ebiv_bench alloc [file.raw] [scene options]" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::string strBench = (argc > 1) ? argv[1] : "vector";
+	if (strBench == "vector") {
+		uint64_t nWords = (argc > 2) ? static_cast<uint64_t>(atof(argv[2]) * 1e6) : 10000000;
+		int nBitsPerWord = (argc > 3) ? atoi(argv[3]) : 6;
+		return _benchVector(nWords, nBitsPerWord);
+	}
+	if ((strBench == "generate") && (argc > 2)) {
+		_SceneParams scene;
+		if (!scene.parse(argc, argv, 3)) {
+			_usage();
+			return 1;
+		}
+		return _generate(argv[2], scene);
+	}
+	if ((strBench == "decode") || (strBench == "columns") || (strBench == "samples") || (strBench == "paged") || (strBench == "save") || (strBench == "load") || (strBench == "codec") || (strBench == "tiled") || (strBench == "select") || (strBench == "alloc")) {
+		// optional file name before the options
+		const bool bHaveFile = (argc > 2) && (strncmp(argv[2], "--", 2) != 0);
+		const int nFirstOption = bHaveFile ? 3 : 2;
+		_SceneParams scene;
+		int nRuns = 3;
+		uint64_t nCacheMB = 32;
+		for (int i = nFirstOption; i + 1 < argc; i += 2) {
+			if (strcmp(argv[i], "--runs") == 0)
+				nRuns = atoi(argv[i + 1]);
+			else if (strcmp(argv[i], "--cache") == 0)
+				nCacheMB = static_cast<uint64_t>(atoll(argv[i + 1]));
+		}
+		if (!scene.parse(argc, argv, nFirstOption) || (nRuns < 1)) {
+			_usage();
+			return 1;
+		}
+		std::string fname = bHaveFile ? argv[2] : "ebiv_bench.raw";
+		if (!bHaveFile && (_generate(fname, scene) != 0))
+			return 1;
+		if (strBench == "samples")
+			return _benchSamples(fname, nRuns);
+		if (strBench == "paged")
+			return _benchPaged(fname, nCacheMB);
+		if (strBench == "save")
+			return _benchSave(fname, nRuns);
+		if (strBench == "load")
+			return _benchLoad(fname, nRuns);
+		if (strBench == "codec")
+			return _benchCodec(fname, nRuns);
+		if (strBench == "tiled")
+			return _benchTiled(fname, nRuns);
+		if (strBench == "select")
+			return _benchSelect(fname, nRuns);
+		if (strBench == "alloc")
+			return _benchAlloc(fname);
+		return (strBench == "columns") ? _benchColumns(fname, nRuns) : _benchDecode(fname, nRuns);
+	}
+	if (strBench == "follow") {
+		const bool bHaveFile = (argc > 2) && (strncmp(argv[2], "--", 2) != 0);
+		const int nFirstOption = bHaveFile ? 3 : 2;
+		_SceneParams scene;
+		uint32_t timeoutMSec = 2000;
+		for (int i = nFirstOption; i + 1 < argc; i += 2) {
+			if (strcmp(argv[i], "--timeout") == 0)
+				timeoutMSec = static_cast<uint32_t>(atoi(argv[i + 1]));
+		}
+		if (!scene.parse(argc, argv, nFirstOption)) {
+			_usage();
+			return 1;
+		}
+		return _benchFollow(bHaveFile ? argv[2] : "ebiv_follow.raw", scene, !bHaveFile, timeoutMSec);
+	}
+	_usage();
+	return 1;
+}
@@ -14,7 +14,10 @@ from struct import unpack,pack
 
 def EBILoadEvents(
         fnIN:str,       # input file
-        dbg = False
+        dbg = False,
+        offset = 0,     # start of time window in [usec]
+        duration = 0,   # length of time window in [usec], 0 for all events
+        roi = None,     # region (x,y,w,h) in [pixel], None for the entire sensor
         ):
     """
     Load events from file
@@ -22,9 +25,16 @@ def EBILoadEvents(
     Parameters
     ----------
     fnIN : str
-        full path of file with binary event data in simplified 64-bit format
+        full path of file with binary event data in simplified 64-bit format,
+        either EVT3 or EVT4 (events in blocks with time index)
     dbg : bool, optional
         produce debugging output during execution. The default is False.
+    offset, duration : int, optional
+        only events in [offset, offset + duration] are returned, all events
+        for duration = 0. Blocks of EVT4 files outside the window are not read.
+    roi : tuple, optional
+        only events in (x,y,w,h) are returned, coordinates stay relative to the
+        sensor. Blocks of EVT4 files whose bounding box misses it are not read.
 
     Raises
     ------
@@ -35,7 +45,7 @@ def EBILoadEvents(
     -------
     dict
         numpy arrays: 
-            event time 't' in [usec], 
+            event time 't' in [usec], 64-bit for files with time segments or blocks
             event position 'x' in [pixel], 
             event position 'y' in [pixel], 
             event polarity 'p' [0,1]
@@ -48,33 +58,88 @@ def EBILoadEvents(
     # open as binary file
     with open(fnIN, "rb") as binary_file:
         binary_file.seek(0, 2)  # Seek the end
-        #num_bytes = binary_file.tell()  # Get the file size
-        #print('file size: '+str(num_bytes))
+        num_bytes = binary_file.tell()  # Get the file size
         binary_file.seek(0)
-        header = binary_file.read( 48 )
-        sig, fileSize, eventCnt, timeStamp, duration, hdrLen, w, h =\
-            unpack('4s3Q4L',header)
-        if not (sig == b'EVT3'):
+        header = binary_file.read( 64 )
+        sig, fileSize, eventCnt, timeStamp, duration32, hdrLen, w, h, \
+            segCnt, segSig, durationHigh, _ = unpack('<4s4x3Q5I4s2I',header)
+        if sig in [b'EVTZ', b'EVTT']:
+            raise IOError('Compressed and tiled event files are read through pyebiv only')
+        if not (sig in [b'EVT3', b'EVT4']):
             raise IOError('Not an event file')
+        # newer files mark the time segments and upper bits of the duration
+        bSegmented = (segSig == b'SEGS')
+        fileDuration = ((durationHigh << 32) | duration32) if bSegmented else duration32
+        if not (bSegmented or (sig == b'EVT4')):
+            # events of older files fill the rest of the file
+            eventCnt = (num_bytes - hdrLen) // 8
         if dbg:
             print("signature:      " + str(sig))
             print("file size:      " + str(fileSize))
             print("header lenth:   " + str(hdrLen))
             print("event count:    " + str(eventCnt))
-            print("duration [us]:  " + str(duration))
+            print("duration [us]:  " + str(fileDuration))
             print("timeStamp [us]: " + str(timeStamp))
             print("image size [h,w]" + str([h,w]))
-        
-        binary_file.seek(hdrLen)
-        dataIN = np.fromfile(binary_file, 
-                             dtype=np.uint32, count=(eventCnt*2)).reshape(eventCnt,2)
+
+        t1 = offset
+        t2 = (offset + duration) if (duration > 0) else None
+        if sig == b'EVT4':
+            # block index found through the footer "EIDX" in the last 24 bytes
+            binary_file.seek(num_bytes - 24)
+            indexOffset, blockCnt, blockEvents, version, footerSig = \
+                unpack('<QLLL4s', binary_file.read(24))
+            if not (footerSig == b'EIDX'):
+                raise IOError('Invalid block index')
+            binary_file.seek(indexOffset)
+            blocks = np.frombuffer(binary_file.read(blockCnt * 40), dtype=np.dtype([
+                ('offset','<u8'), ('time_first','<u8'), ('time_last','<u8'), ('count','<u4'),
+                ('x_min','<u2'), ('y_min','<u2'), ('x_max','<u2'), ('y_max','<u2'), ('bytes','<u4')]))
+            # select blocks overlapping time window and ROI
+            bSel = np.ones(blockCnt, dtype=bool)
+            if t2 is not None:
+                bSel &= (blocks['time_last'] >= t1) & (blocks['time_first'] <= t2)
+            if roi is not None:
+                x,y,rw,rh = roi
+                bSel &= (blocks['x_max'] >= x) & (blocks['x_min'] < x + rw) \
+                    & (blocks['y_max'] >= y) & (blocks['y_min'] < y + rh)
+            parts = []
+            times = []
+            for b in blocks[bSel]:
+                binary_file.seek(int(b['offset']))
+                part = np.fromfile(binary_file, dtype=np.uint32,
+                                   count=int(b['count'])*2).reshape(-1,2)
+                parts.append(part)
+                times.append((part[:,1] >> 1).astype(np.uint64) + b['time_first'])
+            dataIN = np.concatenate(parts) if parts else np.zeros((0,2), dtype=np.uint32)
+            evTime = np.concatenate(times) if times else np.zeros(0, dtype=np.uint64)
+        else:
+            binary_file.seek(hdrLen)
+            dataIN = np.fromfile(binary_file, 
+                                 dtype=np.uint32, count=(eventCnt*2)).reshape(-1,2)
+            evTime = (dataIN[:,1] >> 1)
+            if bSegmented and (segCnt > 0):
+                # time segments of 2^31 usec listed after the events
+                binary_file.seek(hdrLen + eventCnt*8)
+                segments = np.fromfile(binary_file, dtype=np.uint64,
+                                       count=segCnt*2).reshape(-1,2)
+                evTime = evTime.astype(np.uint64)
+                for timeBase, firstEvent in segments:
+                    evTime[int(firstEvent):] = (dataIN[int(firstEvent):,1] >> 1) + timeBase
         binary_file.close()
         
         # unpack event data
-        evTime = (dataIN[:,1] >> 1)
         evY = (dataIN[:,0] >> 16)
         evX = (dataIN[:,0] & 0xFFFF)
         evPol = (dataIN[:,1] & 0x1)
+        if (t2 is not None) or (roi is not None):
+            bSel = np.ones(evTime.size, dtype=bool)
+            if t2 is not None:
+                bSel &= (evTime >= t1) & (evTime <= t2)
+            if roi is not None:
+                x,y,rw,rh = roi
+                bSel &= (evX >= x) & (evX < x + rw) & (evY >= y) & (evY < y + rh)
+            evTime, evX, evY, evPol = evTime[bSel], evX[bSel], evY[bSel], evPol[bSel]
         # return as dict
         return {'t':evTime, 'x':evX, 'y':evY, 'p':evPol, \
                 'time_stamp':timeStamp, 'image_size':[h,w] }